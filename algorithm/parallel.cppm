@@ -0,0 +1,432 @@
+module;
+#include "../data_structure/array/dynamic_array.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <utility>
+export module parallel;
+import thread_pool;
+
+/*
+ * Parallel versions of the common linear algorithms over random access ranges (DynamicArray iterators,
+ * pointers, ...).
+ *
+ *   - The range is cut into fixed-size chunks of roughly `chunkBytes` bytes, sized so a chunk stays in the
+ *     private L2 cache while a thread works on it. The chunk boundaries only depend on the range length and
+ *     the element size, never on the number of threads.
+ *   - Per-chunk results are always combined left to right, so reduce/scan give bit-identical results from
+ *     run to run and for any thread count, even for non-associative operations such as floating point
+ *     addition (the result may still differ from a plain serial std::accumulate).
+ *   - Ranges that fit in a single chunk run inline on the calling thread.
+ *   - The chunks run on a concurrency::ThreadPool (the shared one unless the Policy names another), the
+ *     calling thread works on them too instead of blocking.
+ *   - If an operation throws, no further chunks are started and the first exception is rethrown to the
+ *     caller once the running chunks finished.
+ * */
+
+namespace parallel {
+
+export struct Policy {
+  unsigned threads = 0;                    // 0: every worker of the pool plus the calling thread
+  size_t chunkBytes = 0;                   // 0: defaultChunkBytes
+  concurrency::ThreadPool* pool = nullptr; // nullptr: concurrency::ThreadPool::shared()
+};
+
+export inline constexpr size_t defaultChunkBytes = size_t{1} << 16;
+
+namespace detail {
+
+inline concurrency::ThreadPool& pool(const Policy& policy) {
+  return policy.pool != nullptr ? *policy.pool : concurrency::ThreadPool::shared();
+}
+
+// the calling thread works too, so by default one more than the pool has workers
+inline size_t threadCount(const Policy& policy) {
+  if (policy.threads != 0) return policy.threads;
+  return pool(policy).size() + 1;
+}
+
+template <typename T> size_t chunkLength(const Policy& policy) noexcept {
+  size_t bytes = policy.chunkBytes != 0 ? policy.chunkBytes : defaultChunkBytes;
+  return std::max<size_t>(1, bytes / sizeof(T));
+}
+
+// [begin, end) of chunk `c` when `n` elements are split into chunks of `length`
+struct ChunkGrid {
+  size_t n;
+  size_t length;
+
+  [[nodiscard]] size_t count() const noexcept { return (n + length - 1) / length; }
+  [[nodiscard]] size_t begin(size_t c) const noexcept { return c * length; }
+  [[nodiscard]] size_t end(size_t c) const noexcept { return std::min(n, (c + 1) * length); }
+};
+
+template <typename T> ChunkGrid makeGrid(size_t n, const Policy& policy) noexcept {
+  return {n, chunkLength<T>(policy)};
+}
+
+// calls fn(c) for every chunk c in [0, chunks), the calling thread takes part in the work.
+// chunks are claimed dynamically, so uneven chunks don't leave threads idle.
+template <typename Fn> void forEachChunk(size_t chunks, const Policy& policy, Fn&& fn) {
+  if (chunks == 0) return;
+  size_t threads = std::min<size_t>(threadCount(policy), chunks);
+  if (threads <= 1) {
+    for (size_t c = 0; c < chunks; ++c) fn(c);
+    return;
+  }
+
+  std::atomic<size_t> next{0};
+  std::atomic<bool> failed{false};
+  auto work = [&] {
+    while (!failed.load(std::memory_order_relaxed)) {
+      size_t c = next.fetch_add(1, std::memory_order_relaxed);
+      if (c >= chunks) return;
+      try {
+        fn(c);
+      } catch (...) {
+        failed.store(true, std::memory_order_relaxed);
+        throw;
+      }
+    }
+  };
+
+  concurrency::TaskGroup group(pool(policy));
+  for (size_t t = 1; t < threads; ++t) group.run(work);
+  work();
+  group.wait();
+}
+
+template <typename It> using Value = std::iter_value_t<It>;
+
+} // namespace detail
+
+/**
+ * @brief Calls fn on every element of [first, last), in no particular order.
+ */
+export template <std::random_access_iterator It, typename Fn>
+void forEach(const Policy& policy, It first, It last, Fn fn) {
+  detail::ChunkGrid grid = detail::makeGrid<detail::Value<It>>(std::distance(first, last), policy);
+  detail::forEachChunk(grid.count(), policy, [&](size_t c) {
+    std::for_each(first + grid.begin(c), first + grid.end(c), fn);
+  });
+}
+
+export template <std::random_access_iterator It, typename Fn> void forEach(It first, It last, Fn fn) {
+  forEach(Policy{}, first, last, std::move(fn));
+}
+
+export template <std::random_access_iterator It, typename T>
+void fill(const Policy& policy, It first, It last, const T& value) {
+  detail::ChunkGrid grid = detail::makeGrid<detail::Value<It>>(std::distance(first, last), policy);
+  detail::forEachChunk(grid.count(), policy, [&](size_t c) {
+    std::fill(first + grid.begin(c), first + grid.end(c), value);
+  });
+}
+
+export template <std::random_access_iterator It, typename T> void fill(It first, It last, const T& value) {
+  fill(Policy{}, first, last, value);
+}
+
+/**
+ * @brief Writes op(x) for every x of [first, last) to the range starting at out.
+ * @return The end of the output range.
+ */
+export template <std::random_access_iterator It, std::random_access_iterator OutIt, typename UnaryOp>
+OutIt transform(const Policy& policy, It first, It last, OutIt out, UnaryOp op) {
+  size_t n = std::distance(first, last);
+  detail::ChunkGrid grid = detail::makeGrid<detail::Value<It>>(n, policy);
+  detail::forEachChunk(grid.count(), policy, [&](size_t c) {
+    std::transform(first + grid.begin(c), first + grid.end(c), out + grid.begin(c), op);
+  });
+  return out + n;
+}
+
+export template <std::random_access_iterator It, std::random_access_iterator OutIt, typename UnaryOp>
+OutIt transform(It first, It last, OutIt out, UnaryOp op) {
+  return transform(Policy{}, first, last, out, std::move(op));
+}
+
+/**
+ * @brief init op t(x0) op t(x1) op ..., where each chunk is folded on its own and the chunk results are
+ *        then folded left to right onto init.
+ * @note op has to be associative for the result to match a serial fold (up to rounding).
+ */
+export template <std::random_access_iterator It, typename T, typename ReduceOp, typename TransformOp>
+T transformReduce(
+    const Policy& policy, It first, It last, T init, ReduceOp reduceOp, TransformOp transformOp
+) {
+  detail::ChunkGrid grid = detail::makeGrid<detail::Value<It>>(std::distance(first, last), policy);
+  // the partials are only ever built from an element, so T doesn't have to be default constructible
+  array::DynamicArray<std::optional<T>> partials(grid.count());
+
+  detail::forEachChunk(grid.count(), policy, [&](size_t c) {
+    It it = first + grid.begin(c);
+    It end = first + grid.end(c);
+    T acc = transformOp(*it);
+    for (++it; it != end; ++it) acc = reduceOp(std::move(acc), transformOp(*it));
+    partials[c].emplace(std::move(acc));
+  });
+
+  for (std::optional<T>& partial : partials) init = reduceOp(std::move(init), std::move(*partial));
+  return init;
+}
+
+export template <std::random_access_iterator It, typename T, typename ReduceOp, typename TransformOp>
+T transformReduce(It first, It last, T init, ReduceOp reduceOp, TransformOp transformOp) {
+  return transformReduce(Policy{}, first, last, std::move(init), std::move(reduceOp), std::move(transformOp));
+}
+
+export template <std::random_access_iterator It, typename T, typename BinaryOp = std::plus<>>
+T reduce(const Policy& policy, It first, It last, T init, BinaryOp op = {}) {
+  return transformReduce(policy, first, last, std::move(init), std::move(op), std::identity{});
+}
+
+export template <std::random_access_iterator It, typename T, typename BinaryOp = std::plus<>>
+T reduce(It first, It last, T init, BinaryOp op = {}) {
+  return reduce(Policy{}, first, last, std::move(init), std::move(op));
+}
+
+export template <std::random_access_iterator It, typename Predicate>
+size_t countIf(const Policy& policy, It first, It last, Predicate pred) {
+  return transformReduce(policy, first, last, size_t{0}, std::plus<>{}, [&](const auto& x) -> size_t {
+    return pred(x) ? 1 : 0;
+  });
+}
+
+export template <std::random_access_iterator It, typename Predicate>
+size_t countIf(It first, It last, Predicate pred) {
+  return countIf(Policy{}, first, last, std::move(pred));
+}
+
+namespace detail {
+
+// scan in three passes: fold every chunk, carry the chunk totals left to right, then rescan every chunk
+// starting from its carry. Reading the input twice is cheaper than the serial dependency it removes.
+template <bool Inclusive, typename It, typename OutIt, typename T, typename BinaryOp>
+OutIt scan(const Policy& policy, It first, It last, OutIt out, std::optional<T> init, BinaryOp op) {
+  size_t n = std::distance(first, last);
+  if (n == 0) return out;
+  ChunkGrid grid = makeGrid<Value<It>>(n, policy);
+  size_t chunks = grid.count();
+
+  array::DynamicArray<std::optional<T>> carries(chunks);
+  carries[0] = std::move(init);
+  if (chunks > 1) {
+    array::DynamicArray<std::optional<T>> totals(chunks);
+    // the last chunk's total is never needed
+    forEachChunk(chunks - 1, policy, [&](size_t c) {
+      It it = first + grid.begin(c);
+      It end = first + grid.end(c);
+      T acc = *it;
+      for (++it; it != end; ++it) acc = op(std::move(acc), *it);
+      totals[c].emplace(std::move(acc));
+    });
+    for (size_t c = 1; c < chunks; ++c) {
+      carries[c].emplace(carries[c - 1] ? op(*carries[c - 1], *totals[c - 1]) : std::move(*totals[c - 1]));
+    }
+  }
+
+  forEachChunk(chunks, policy, [&](size_t c) {
+    It it = first + grid.begin(c);
+    It end = first + grid.end(c);
+    OutIt dest = out + grid.begin(c);
+    std::optional<T>& carry = carries[c];
+    for (; it != end; ++it, ++dest) {
+      // read before writing, the output may alias the input
+      if constexpr (Inclusive) {
+        carry.emplace(carry ? op(std::move(*carry), *it) : T(*it));
+        *dest = *carry;
+      } else {
+        T next = op(*carry, *it);
+        *dest = std::move(*carry);
+        carry.emplace(std::move(next));
+      }
+    }
+  });
+  return out + n;
+}
+
+} // namespace detail
+
+/**
+ * @brief out[i] = x0 op x1 op ... op xi. The output may be the input range itself.
+ * @return The end of the output range.
+ */
+export template <
+    std::random_access_iterator It, std::random_access_iterator OutIt, typename BinaryOp = std::plus<>>
+OutIt inclusiveScan(const Policy& policy, It first, It last, OutIt out, BinaryOp op = {}) {
+  using T = detail::Value<It>;
+  return detail::scan<true>(policy, first, last, out, std::optional<T>{}, std::move(op));
+}
+
+export template <
+    std::random_access_iterator It, std::random_access_iterator OutIt, typename BinaryOp = std::plus<>>
+OutIt inclusiveScan(It first, It last, OutIt out, BinaryOp op = {}) {
+  return inclusiveScan(Policy{}, first, last, out, std::move(op));
+}
+
+/**
+ * @brief out[i] = init op x0 op ... op x(i-1), out[0] = init. The output may be the input range itself.
+ * @return The end of the output range.
+ */
+export template <
+    std::random_access_iterator It, std::random_access_iterator OutIt, typename T,
+    typename BinaryOp = std::plus<>>
+OutIt exclusiveScan(const Policy& policy, It first, It last, OutIt out, T init, BinaryOp op = {}) {
+  return detail::scan<false>(policy, first, last, out, std::optional<T>{std::move(init)}, std::move(op));
+}
+
+export template <
+    std::random_access_iterator It, std::random_access_iterator OutIt, typename T,
+    typename BinaryOp = std::plus<>>
+OutIt exclusiveScan(It first, It last, OutIt out, T init, BinaryOp op = {}) {
+  return exclusiveScan(Policy{}, first, last, out, std::move(init), std::move(op));
+}
+
+/**
+ * @brief Stable compaction: copies the elements satisfying pred to out, keeping their relative order.
+ *        The output must not overlap the input. pred is called exactly once per element, its results are
+ *        kept in a one byte per element flag buffer between the counting and the copying pass.
+ * @return The end of the output range.
+ */
+export template <std::random_access_iterator It, std::random_access_iterator OutIt, typename Predicate>
+OutIt copyIf(const Policy& policy, It first, It last, OutIt out, Predicate pred) {
+  size_t n = std::distance(first, last);
+  detail::ChunkGrid grid = detail::makeGrid<detail::Value<It>>(n, policy);
+  size_t chunks = grid.count();
+  if (chunks == 0) return out;
+
+  // flag and count the survivors of every chunk, their prefix sum is where each chunk writes
+  array::DynamicArray<unsigned char> keep(n, 0);
+  array::DynamicArray<size_t> offsets(chunks + 1, 0);
+  detail::forEachChunk(chunks, policy, [&](size_t c) {
+    size_t survivors = 0;
+    for (size_t i = grid.begin(c); i < grid.end(c); ++i) {
+      keep[i] = pred(first[i]) ? 1 : 0;
+      survivors += keep[i];
+    }
+    offsets[c + 1] = survivors;
+  });
+  for (size_t c = 0; c < chunks; ++c) offsets[c + 1] += offsets[c];
+
+  detail::forEachChunk(chunks, policy, [&](size_t c) {
+    OutIt des = out + offsets[c];
+    for (size_t i = grid.begin(c); i < grid.end(c); ++i) {
+      if (keep[i] != 0) *des++ = first[i];
+    }
+  });
+  return out + offsets[chunks];
+}
+
+export template <std::random_access_iterator It, std::random_access_iterator OutIt, typename Predicate>
+OutIt copyIf(It first, It last, OutIt out, Predicate pred) {
+  return copyIf(Policy{}, first, last, out, std::move(pred));
+}
+
+namespace detail {
+
+// how many of the first k elements of the stable merge of a and b come from a, found by binary search
+template <typename It, typename Compare>
+size_t coRank(size_t k, It a, size_t aLength, It b, size_t bLength, Compare& compare) {
+  size_t low = k > bLength ? k - bLength : 0;
+  size_t high = std::min(k, aLength);
+  while (low < high) {
+    size_t i = low + ((high - low) / 2);
+    // a[i] is among the first k iff it doesn't come after b[k - i - 1], ties go to a
+    if (!compare(b[k - i - 1], a[i])) {
+      low = i + 1;
+    } else {
+      high = i;
+    }
+  }
+  return low;
+}
+
+// merges the sorted runs of `run` elements of src pairwise into dst, every merge cut into chunk-sized pieces
+template <typename SrcIt, typename DstIt, typename Compare>
+void mergeRuns(
+    const Policy& policy, SrcIt src, DstIt dst, size_t n, size_t run, size_t piece, Compare& compare
+) {
+  size_t pairs = (n + (2 * run) - 1) / (2 * run);
+  size_t piecesPerPair = ((2 * run) + piece - 1) / piece;
+  size_t pieces = pairs * piecesPerPair;
+
+  // all the co-ranks first: a piece moves elements out of src that other pieces' binary searches would read
+  array::DynamicArray<size_t> splits(pieces + 1, 0);
+  forEachChunk(pieces, policy, [&](size_t p) {
+    size_t pairBegin = (p / piecesPerPair) * 2 * run;
+    size_t mid = std::min(n, pairBegin + run);
+    size_t pairEnd = std::min(n, pairBegin + (2 * run));
+    size_t k = std::min(pairEnd - pairBegin, (p % piecesPerPair) * piece);
+    splits[p] = coRank(k, src + pairBegin, mid - pairBegin, src + mid, pairEnd - mid, compare);
+  });
+
+  forEachChunk(pieces, policy, [&](size_t p) {
+    size_t pairBegin = (p / piecesPerPair) * 2 * run;
+    size_t mid = std::min(n, pairBegin + run);
+    size_t pairEnd = std::min(n, pairBegin + (2 * run));
+    size_t kBegin = std::min(pairEnd - pairBegin, (p % piecesPerPair) * piece);
+    size_t kEnd = std::min(pairEnd - pairBegin, kBegin + piece);
+    if (kBegin == kEnd) return;
+    bool lastPiece = (p + 1) % piecesPerPair == 0 || kEnd == pairEnd - pairBegin;
+    size_t aBegin = splits[p];
+    size_t aEnd = lastPiece ? mid - pairBegin : splits[p + 1];
+    SrcIt a = src + pairBegin;
+    SrcIt b = src + mid;
+    std::merge(
+        std::make_move_iterator(a + aBegin), std::make_move_iterator(a + aEnd),
+        std::make_move_iterator(b + (kBegin - aBegin)), std::make_move_iterator(b + (kEnd - aEnd)),
+        dst + pairBegin + kBegin, compare
+    );
+  });
+}
+
+} // namespace detail
+
+/**
+ * @brief Sorts [first, last), not stable. Every chunk is sorted on its own, then sorted runs are merged
+ *        pairwise. A merge is cut into chunk-sized pieces at their co-ranks (where the piece starts in either
+ *        run), so even the final merge of the two halves runs on every thread.
+ */
+export template <std::random_access_iterator It, typename Compare = std::less<>>
+void sort(const Policy& policy, It first, It last, Compare compare = {}) {
+  using T = detail::Value<It>;
+  size_t n = std::distance(first, last);
+  detail::ChunkGrid grid = detail::makeGrid<T>(n, policy);
+  size_t chunks = grid.count();
+  if (chunks <= 1) {
+    std::sort(first, last, compare);
+    return;
+  }
+  detail::forEachChunk(chunks, policy, [&](size_t c) {
+    std::sort(first + grid.begin(c), first + grid.end(c), compare);
+  });
+
+  // the runs move back and forth between the range and the buffer
+  array::DynamicArray<T> buffer(first, last);
+  bool inBuffer = false;
+  for (size_t run = grid.length; run < n; run *= 2) {
+    if (inBuffer) {
+      detail::mergeRuns(policy, buffer.begin(), first, n, run, grid.length, compare);
+    } else {
+      detail::mergeRuns(policy, first, buffer.begin(), n, run, grid.length, compare);
+    }
+    inBuffer = !inBuffer;
+  }
+  if (inBuffer) {
+    detail::forEachChunk(chunks, policy, [&](size_t c) {
+      std::move(buffer.begin() + grid.begin(c), buffer.begin() + grid.end(c), first + grid.begin(c));
+    });
+  }
+}
+
+export template <std::random_access_iterator It, typename Compare = std::less<>>
+void sort(It first, It last, Compare compare = {}) {
+  sort(Policy{}, first, last, std::move(compare));
+}
+
+} // namespace parallel
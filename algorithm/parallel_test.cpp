@@ -0,0 +1,212 @@
+#include "../data_structure/array/dynamic_array.hpp"
+#include <algorithm>
+#include <atomic>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_range_equals.hpp>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+import parallel;
+
+namespace {
+// small chunks so even the test inputs are split over many chunks and threads
+constexpr parallel::Policy smallChunks{.threads = 4, .chunkBytes = 256};
+
+array::DynamicArray<int64_t> iota(size_t n) {
+  array::DynamicArray<int64_t> arr(n, 0);
+  std::iota(arr.begin(), arr.end(), int64_t{1});
+  return arr;
+}
+} // namespace
+
+TEST_CASE("parallel reduce", "[parallel]") {
+  array::DynamicArray<int64_t> arr = iota(10'000);
+
+  SECTION("Matches the serial result") {
+    CHECK(parallel::reduce(smallChunks, arr.begin(), arr.end(), int64_t{0}) == 50'005'000);
+    CHECK(parallel::reduce(arr.begin(), arr.end(), int64_t{5}) == 50'005'005);
+  }
+
+  SECTION("Empty ranges return init") {
+    CHECK(parallel::reduce(smallChunks, arr.begin(), arr.begin(), int64_t{42}) == 42);
+  }
+
+  SECTION("Non-commutative operations keep the left to right order") {
+    array::DynamicArray<std::string> letters;
+    for (int i = 0; i < 1000; ++i) letters.pushBack(std::string(1, static_cast<char>('a' + (i % 26))));
+    std::string serial = std::accumulate(letters.begin(), letters.end(), std::string{});
+    CHECK(parallel::reduce(smallChunks, letters.begin(), letters.end(), std::string{}) == serial);
+  }
+
+  SECTION("Floating point results don't depend on the thread count") {
+    array::DynamicArray<double> values(100'000, 0.0);
+    for (size_t i = 0; i < values.size(); ++i) values[i] = 1.0 / static_cast<double>(i + 1);
+    double one = parallel::reduce({.threads = 1}, values.begin(), values.end(), 0.0);
+    double many = parallel::reduce({.threads = 8}, values.begin(), values.end(), 0.0);
+    CHECK(one == many);
+  }
+
+  SECTION("transformReduce and countIf") {
+    auto square = [](int64_t x) { return x * x; };
+    CHECK(
+        parallel::transformReduce(smallChunks, arr.begin(), arr.end(), int64_t{0}, std::plus<>{}, square) ==
+        std::transform_reduce(arr.begin(), arr.end(), int64_t{0}, std::plus<>{}, square)
+    );
+    auto divisibleByThree = [](int64_t x) { return x % 3 == 0; };
+    CHECK(parallel::countIf(smallChunks, arr.begin(), arr.end(), divisibleByThree) == 3333);
+  }
+}
+
+TEST_CASE("parallel scans", "[parallel]") {
+  array::DynamicArray<int64_t> arr = iota(5'000);
+  array::DynamicArray<int64_t> expected(arr.size(), 0);
+  array::DynamicArray<int64_t> out(arr.size(), 0);
+
+  SECTION("inclusiveScan") {
+    std::inclusive_scan(arr.begin(), arr.end(), expected.begin());
+    auto end = parallel::inclusiveScan(smallChunks, arr.begin(), arr.end(), out.begin());
+    CHECK(end == out.end());
+    CHECK_THAT(out, Catch::Matchers::RangeEquals(expected));
+  }
+
+  SECTION("exclusiveScan") {
+    std::exclusive_scan(arr.begin(), arr.end(), expected.begin(), int64_t{10});
+    parallel::exclusiveScan(smallChunks, arr.begin(), arr.end(), out.begin(), int64_t{10});
+    CHECK_THAT(out, Catch::Matchers::RangeEquals(expected));
+  }
+
+  SECTION("Scans can run in place") {
+    std::exclusive_scan(arr.begin(), arr.end(), expected.begin(), int64_t{0});
+    parallel::exclusiveScan(smallChunks, arr.begin(), arr.end(), arr.begin(), int64_t{0});
+    CHECK_THAT(arr, Catch::Matchers::RangeEquals(expected));
+
+    std::inclusive_scan(arr.begin(), arr.end(), expected.begin());
+    parallel::inclusiveScan(smallChunks, arr.begin(), arr.end(), arr.begin());
+    CHECK_THAT(arr, Catch::Matchers::RangeEquals(expected));
+  }
+
+  SECTION("Pointer ranges") {
+    int64_t raw[] = {3, 1, 4, 1, 5};
+    int64_t scanned[5] = {};
+    parallel::inclusiveScan(std::begin(raw), std::end(raw), std::begin(scanned));
+    CHECK(scanned[4] == 14);
+  }
+}
+
+TEST_CASE("parallel copyIf, forEach, fill and transform", "[parallel]") {
+  array::DynamicArray<int64_t> arr = iota(10'000);
+
+  SECTION("copyIf is stable") {
+    array::DynamicArray<int64_t> out(arr.size(), 0);
+    auto end = parallel::copyIf(smallChunks, arr.begin(), arr.end(), out.begin(), [](int64_t x) {
+      return x % 7 == 0;
+    });
+    REQUIRE(end - out.begin() == 1428);
+    for (size_t i = 0; i < 1428; ++i) CHECK(out[i] == static_cast<int64_t>((i + 1) * 7));
+  }
+
+  SECTION("copyIf calls the predicate once per element") {
+    array::DynamicArray<int64_t> out(arr.size(), 0);
+    std::atomic<size_t> calls = 0;
+    parallel::copyIf(smallChunks, arr.begin(), arr.end(), out.begin(), [&](int64_t x) {
+      calls.fetch_add(1, std::memory_order_relaxed);
+      return x % 2 == 0;
+    });
+    CHECK(calls == arr.size());
+  }
+
+  SECTION("forEach, fill and transform touch every element once") {
+    parallel::forEach(smallChunks, arr.begin(), arr.end(), [](int64_t& x) { x *= 2; });
+    CHECK(parallel::reduce(arr.begin(), arr.end(), int64_t{0}) == 100'010'000);
+
+    parallel::fill(smallChunks, arr.begin(), arr.end(), 3);
+    array::DynamicArray<int64_t> out(arr.size(), 0);
+    parallel::transform(smallChunks, arr.begin(), arr.end(), out.begin(), [](int64_t x) { return x + 1; });
+    CHECK(std::all_of(out.begin(), out.end(), [](int64_t x) { return x == 4; }));
+  }
+
+  SECTION("The first exception reaches the caller") {
+    auto throwing = [](int64_t x) {
+      if (x == 5'000) throw std::runtime_error("bad element");
+    };
+    REQUIRE_THROWS_AS(parallel::forEach(smallChunks, arr.begin(), arr.end(), throwing), std::runtime_error);
+  }
+}
+
+TEST_CASE("parallel sort", "[parallel]") {
+  std::mt19937_64 gen{7};
+
+  SECTION("Matches std::sort for every length around the chunk boundaries") {
+    std::uniform_int_distribution<int64_t> value(-1000, 1000); // plenty of duplicates
+    for (size_t n : {0, 1, 2, 31, 32, 33, 64, 100, 1000, 4097, 30'000}) {
+      array::DynamicArray<int64_t> arr(n, 0);
+      for (int64_t& x : arr) x = value(gen);
+      array::DynamicArray<int64_t> expected = arr;
+      std::sort(expected.begin(), expected.end());
+      parallel::sort(smallChunks, arr.begin(), arr.end());
+      CHECK(std::ranges::equal(arr, expected));
+    }
+  }
+
+  SECTION("Custom comparator") {
+    array::DynamicArray<int64_t> arr = iota(10'000);
+    std::shuffle(arr.begin(), arr.end(), gen);
+    parallel::sort(smallChunks, arr.begin(), arr.end(), std::greater<>());
+    CHECK(std::is_sorted(arr.begin(), arr.end(), std::greater<>()));
+    CHECK(arr[0] == 10'000);
+  }
+
+  SECTION("Non-trivial elements") {
+    array::DynamicArray<std::string> arr(5000, std::string{});
+    for (size_t i = 0; i < arr.size(); ++i) arr[i] = std::to_string(gen() % 100'000);
+    array::DynamicArray<std::string> expected = arr;
+    std::sort(expected.begin(), expected.end());
+    parallel::sort(smallChunks, arr.begin(), arr.end());
+    CHECK(std::ranges::equal(arr, expected));
+    parallel::sort(arr.begin(), arr.end()); // already sorted, one chunk
+    CHECK(std::ranges::equal(arr, expected));
+  }
+}
+
+TEST_CASE("parallel algorithm scaling", "[parallel][.benchmark]") {
+  constexpr size_t n = size_t{1} << 26;
+  array::DynamicArray<uint64_t> arr(n, 1);
+  array::DynamicArray<uint64_t> out(n, 0);
+
+  array::DynamicArray<uint64_t> shuffled(n, 0);
+  std::mt19937_64 gen{1};
+  for (uint64_t& x : shuffled) x = gen();
+
+  BENCHMARK("std::accumulate") { return std::accumulate(arr.begin(), arr.end(), uint64_t{0}); };
+  BENCHMARK("std::inclusive_scan") {
+    return *(std::inclusive_scan(arr.begin(), arr.end(), out.begin()) - 1);
+  };
+  BENCHMARK("std::sort") {
+    std::copy(shuffled.begin(), shuffled.end(), out.begin());
+    std::sort(out.begin(), out.end());
+    return out[0];
+  };
+
+  for (unsigned threads = 1; threads <= std::max(1U, std::thread::hardware_concurrency()); threads *= 2) {
+    parallel::Policy policy{.threads = threads};
+    std::string suffix = " x" + std::to_string(threads);
+    BENCHMARK("reduce" + suffix) { return parallel::reduce(policy, arr.begin(), arr.end(), uint64_t{0}); };
+    BENCHMARK("inclusiveScan" + suffix) {
+      return *(parallel::inclusiveScan(policy, arr.begin(), arr.end(), out.begin()) - 1);
+    };
+    BENCHMARK("copyIf" + suffix) {
+      return parallel::copyIf(policy, arr.begin(), arr.end(), out.begin(), [](uint64_t x) { return x != 0; });
+    };
+    BENCHMARK("sort" + suffix) {
+      std::copy(shuffled.begin(), shuffled.end(), out.begin());
+      parallel::sort(policy, out.begin(), out.end());
+      return out[0];
+    };
+  }
+}
@@ -59,13 +59,15 @@ template <std::random_access_iterator RandomIt, typename Compare = std::less<>>
   requires detail::Comparator<RandomIt, Compare>
 void insertionSort(RandomIt first, RandomIt last, Compare compare = {}) {
   for (RandomIt i = first + 1; i < last; i++) {
-    auto current = *i;
+    // iter_value_t rather than auto: for proxy iterators `auto` would copy the proxy, not the element.
+    // iter_move moves through proxies too, std::move(*i) would only move the proxy
+    std::iter_value_t<RandomIt> current = std::ranges::iter_move(i);
     RandomIt j = i;
     while (j > first && compare(current, *(j - 1))) {
-      *(j) = *(j - 1);
+      *(j) = std::ranges::iter_move(j - 1);
       j--;
     }
-    *j = current;
+    *j = std::move(current);
   }
 }
 
@@ -90,24 +92,24 @@ void mergeSortImpl(RandomIt first, RandomIt last, BufferIt bufferStart, Compare
   // while both partitions have element
   while (left < mid && right < last) {
     if (compare(*left, *right)) {
-      *des = std::move(*left);
+      *des = std::ranges::iter_move(left);
       ++left;
       ++des;
     } else {
-      *des = std::move(*right);
+      *des = std::ranges::iter_move(right);
       ++right;
       ++des;
     }
   }
 
   while (left < mid) {
-    *des = std::move(*left);
+    *des = std::ranges::iter_move(left);
     ++left;
     ++des;
   }
 
   while (right < last) {
-    *des = std::move(*right);
+    *des = std::ranges::iter_move(right);
     ++right;
     ++des;
   }
@@ -0,0 +1,177 @@
+module;
+#include "../data_structure/array/dynamic_array.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+export module epoch;
+
+/*
+ * Epoch-based reclamation for structures whose readers must never block: readers pin the domain, writers
+ * unlink memory and retire it, and retired memory is reclaimed once no reader can still reach it.
+ *
+ *   auto guard = domain.pin();            // reader, wait-free unless it races an epoch change
+ *   ... read the published structure ...
+ *
+ *   publish(newVersion);                  // writer
+ *   domain.retire([old] { destroy(old); });
+ *   domain.reclaim();                     // frees what no reader can see anymore, never waits
+ *
+ * Readers count themselves into the current epoch's parity (one of two counters) in a slot picked by their
+ * thread. The epoch only moves from e to e + 1 once the readers of e - 1 (the other parity) are gone, so at
+ * most two epochs are ever pinned, and memory retired during e - 1 is unreachable by then: every reader
+ * still pinned entered e or later, after that memory was unlinked.
+ * Reader counters are spread over cache line sized slots, so readers on different cores don't write the
+ * same line.
+ * */
+
+namespace concurrency {
+
+namespace detail {
+inline std::atomic<size_t> g_nextReaderSlot{0};
+// each thread sticks to one slot, threads are spread round-robin over the slots
+inline thread_local const size_t t_readerSlot = g_nextReaderSlot.fetch_add(1, std::memory_order_relaxed);
+} // namespace detail
+
+export class EpochDomain {
+public:
+  static constexpr size_t slotCount = 64;
+
+private:
+  struct alignas(64) Slot {
+    std::array<std::atomic<size_t>, 2> readers{}; // pinned readers per epoch parity
+  };
+
+  struct Retired {
+    uint64_t epoch;
+    std::function<void()> reclaim;
+  };
+
+  std::array<Slot, slotCount> m_slots;
+  std::atomic<uint64_t> m_epoch{1};
+  std::mutex m_retiredMutex;
+  array::DynamicArray<Retired> m_retired;
+
+  [[nodiscard]] size_t readers(uint64_t epoch) const noexcept {
+    size_t count = 0;
+    for (const Slot& slot : m_slots) count += slot.readers[epoch & 1].load();
+    return count;
+  }
+
+public:
+  // keeps the domain pinned, memory retired from now on isn't reclaimed while it lives
+  class Guard {
+    std::atomic<size_t>* m_counter = nullptr;
+
+  public:
+    Guard() = default;
+    explicit Guard(std::atomic<size_t>* counter) noexcept : m_counter(counter) {}
+
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+    Guard(Guard&& other) noexcept : m_counter(std::exchange(other.m_counter, nullptr)) {}
+    Guard& operator=(Guard&& other) noexcept {
+      if (this != &other) {
+        release();
+        m_counter = std::exchange(other.m_counter, nullptr);
+      }
+      return *this;
+    }
+
+    ~Guard() noexcept { release(); }
+
+    void release() noexcept {
+      if (m_counter != nullptr) std::exchange(m_counter, nullptr)->fetch_sub(1, std::memory_order_release);
+    }
+  };
+
+  EpochDomain() = default;
+  EpochDomain(const EpochDomain&) = delete;
+  EpochDomain& operator=(const EpochDomain&) = delete;
+  EpochDomain(EpochDomain&&) = delete;
+  EpochDomain& operator=(EpochDomain&&) = delete;
+
+  // no reader may be pinned anymore, everything still retired is reclaimed
+  ~EpochDomain() noexcept {
+    for (Retired& retired : m_retired) retired.reclaim();
+  }
+
+  [[nodiscard]] Guard pin() noexcept {
+    Slot& slot = m_slots[detail::t_readerSlot % slotCount];
+    while (true) {
+      uint64_t epoch = m_epoch.load();
+      std::atomic<size_t>& counter = slot.readers[epoch & 1];
+      counter.fetch_add(1);
+      // the epoch may have moved on between the load and the increment, its parity may be drained already
+      if (m_epoch.load() == epoch) return Guard{&counter};
+      counter.fetch_sub(1);
+    }
+  }
+
+  [[nodiscard]] uint64_t epoch() const noexcept { return m_epoch.load(); }
+
+  // reclaim runs once no reader pinned before this call is left, on the thread calling reclaim().
+  // doesn't throw if a slot was reserved for it.
+  void retire(std::function<void()> reclaim) {
+    std::lock_guard lock(m_retiredMutex);
+    m_retired.emplaceBack(m_epoch.load(), std::move(reclaim));
+  }
+
+  // makes room for count more retire() calls, for writers that must retire right after publishing
+  void reserve(size_t count) {
+    std::lock_guard lock(m_retiredMutex);
+    m_retired.reserve(m_retired.size() + count);
+  }
+
+  /**
+   * @brief Advances the epoch if the readers of the previous one are gone and runs everything that became
+   *        unreachable. Never waits for readers.
+   * @return The number of retired callbacks still pending.
+   * @throws std::bad_alloc before anything was taken off the retired list, a later call reclaims it.
+   */
+  size_t reclaim() {
+    array::DynamicArray<std::function<void()>> ready;
+    size_t pending = 0;
+    {
+      std::lock_guard lock(m_retiredMutex);
+      uint64_t epoch = m_epoch.load();
+      if (readers(epoch - 1) == 0) {
+        // every reader left entered this epoch, after everything retired in earlier ones was unlinked
+        ready.reserve(m_retired.size());
+        // compacted in place, the capacity reserved by writers stays
+        size_t kept = 0;
+        for (size_t i = 0; i < m_retired.size(); ++i) {
+          if (m_retired[i].epoch < epoch) {
+            ready.emplaceBack(std::move(m_retired[i].reclaim));
+          } else if (kept++ != i) {
+            m_retired[kept - 1] = std::move(m_retired[i]);
+          }
+        }
+        m_retired.resize(kept);
+        m_epoch.store(epoch + 1);
+      }
+      pending = m_retired.size();
+    }
+    for (std::function<void()>& fn : ready) fn();
+    return pending;
+  }
+
+  // waits until everything retired before the call was taken off the retired list, run here or by a
+  // concurrent reclaim(). Readers keep running meanwhile, and so may writers: memory retired after the
+  // call isn't waited for. The caller must not be pinned, the epoch can't advance past its own guard.
+  void synchronize() {
+    // what was retired during epoch e is reclaimed when the epoch moves from e + 1 to e + 2
+    uint64_t target = m_epoch.load() + 2;
+    while (true) {
+      reclaim();
+      if (m_epoch.load() >= target) return;
+      std::this_thread::yield();
+    }
+  }
+};
+
+} // namespace concurrency
@@ -0,0 +1,111 @@
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+import epoch;
+
+TEST_CASE("EpochDomain defers reclamation past pinned readers", "[concurrency][EpochDomain]") {
+  concurrency::EpochDomain domain;
+  int reclaimed = 0;
+
+  SECTION("Nothing pinned, retired memory goes within two reclaims") {
+    domain.retire([&] { ++reclaimed; });
+    domain.reclaim();
+    domain.reclaim();
+    CHECK(reclaimed == 1);
+  }
+
+  SECTION("A reader pinned before retire holds it back") {
+    auto guard = domain.pin();
+    domain.retire([&] { ++reclaimed; });
+    for (int i = 0; i < 4; ++i) domain.reclaim();
+    CHECK(reclaimed == 0);
+
+    guard.release();
+    domain.synchronize();
+    CHECK(reclaimed == 1);
+  }
+
+  SECTION("Readers pinned after retire don't") {
+    domain.retire([&] { ++reclaimed; });
+    domain.reclaim();
+    auto guard = domain.pin();
+    domain.reclaim();
+    CHECK(reclaimed == 1);
+  }
+
+  SECTION("Reclaiming keeps what is still pinned") {
+    domain.reserve(2);
+    domain.retire([&] { reclaimed += 1; });
+    domain.reclaim();
+    auto guard = domain.pin();
+    domain.retire([&] { reclaimed += 10; });
+    CHECK(domain.reclaim() == 1);
+    CHECK(domain.reclaim() == 1);
+    CHECK(reclaimed == 1);
+
+    guard.release();
+    domain.synchronize();
+    CHECK(reclaimed == 11);
+  }
+
+  SECTION("Writers retiring meanwhile don't keep synchronize waiting") {
+    std::atomic<bool> stop{false};
+    std::jthread writer([&] {
+      while (!stop.load()) {
+        domain.retire([] {});
+        domain.reclaim();
+      }
+    });
+    domain.retire([&] { ++reclaimed; });
+    domain.synchronize();
+    stop.store(true);
+    writer.join();
+    CHECK(reclaimed == 1);
+  }
+
+  SECTION("The destructor runs what is left") {
+    {
+      concurrency::EpochDomain scoped;
+      scoped.retire([&] { ++reclaimed; });
+    }
+    CHECK(reclaimed == 1);
+  }
+}
+
+TEST_CASE("EpochDomain keeps swapped out objects alive for readers", "[concurrency][EpochDomain]") {
+  concurrency::EpochDomain domain;
+  std::atomic<uint64_t*> current{new uint64_t{0}};
+  std::atomic<bool> stop{false};
+  std::atomic<bool> torn{false};
+
+  {
+    std::vector<std::jthread> readers;
+    for (int t = 0; t < 3; ++t) {
+      readers.emplace_back([&] {
+        while (!stop.load()) {
+          auto guard = domain.pin();
+          const uint64_t* value = current.load(std::memory_order_acquire);
+          // reclaimed values are overwritten before they are freed
+          if (*value == ~uint64_t{0}) torn.store(true);
+        }
+      });
+    }
+
+    for (uint64_t i = 1; i <= 2000; ++i) {
+      uint64_t* old = current.exchange(new uint64_t{i}, std::memory_order_acq_rel);
+      domain.retire([old] {
+        *old = ~uint64_t{0};
+        delete old; // NOLINT
+      });
+      domain.reclaim();
+    }
+    stop.store(true);
+  }
+  domain.synchronize();
+  delete current.load(); // NOLINT
+  CHECK_FALSE(torn.load());
+}
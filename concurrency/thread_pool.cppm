@@ -0,0 +1,448 @@
+module;
+#include "../data_structure/array/dynamic_array.hpp"
+#include "../data_structure/queue/deque.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+export module thread_pool;
+
+/*
+ * A work-stealing thread pool shared by everything in the project that runs work concurrently.
+ *
+ *   - Every worker owns one deque per priority. A worker pushes and pops its own work at the back (LIFO, the
+ *     freshest task is the one whose data is still in cache), idle workers steal from the front of other
+ *     workers' deques (FIFO, the oldest task is usually the biggest piece of a recursively split job).
+ *     Tasks submitted from outside the pool are spread round-robin over the workers.
+ *   - Higher priorities are always looked at first, both in the own deques and when stealing.
+ *   - A worker that runs out of work backs off in three steps: it spins for a while, then yields its time
+ *     slice, and finally sleeps on a condition variable until something is submitted.
+ *   - `TaskGroup` is the fork/join building block: `wait()` doesn't block, it keeps running pending tasks of
+ *     the pool until the group is done, so nested parallelism (a task waiting for its own subtasks) can't
+ *     deadlock the pool. `parallelFor` and `invoke` are built on it.
+ *   - When there is nothing left to run, `TaskGroup::wait()` doesn't spin either: it waits on a progress
+ *     counter the pool bumps whenever a task is submitted or finished.
+ *   - `stats()` reports executed tasks, steals, idle time and the current queue depths per worker. Tasks
+ *     run by threads outside the pool (waiting groups, `runPendingTask()`) are counted separately.
+ * */
+
+namespace concurrency {
+
+export enum class Priority : uint8_t { High, Normal, Low };
+
+export class ThreadPool;
+
+namespace detail {
+
+inline constexpr size_t priorityCount = 3;
+inline constexpr size_t noWorker = static_cast<size_t>(-1);
+
+// the pool and worker index of the calling thread, lets submissions from a worker go to its own deque
+struct CurrentWorker {
+  const ThreadPool* pool = nullptr;
+  size_t index = noWorker;
+};
+inline thread_local CurrentWorker t_current;
+
+// a move-only `void()` callable, std::function would require copyable tasks (no packaged_task)
+class Task {
+private:
+  struct Base {
+    Base() = default;
+    Base(const Base&) = delete;
+    Base& operator=(const Base&) = delete;
+    Base(Base&&) = delete;
+    Base& operator=(Base&&) = delete;
+    virtual ~Base() = default;
+    virtual void run() = 0;
+  };
+
+  template <typename Fn> struct Impl final : Base {
+    Fn m_fn;
+    explicit Impl(Fn fn) : m_fn(std::move(fn)) {}
+    void run() override { m_fn(); }
+  };
+
+  std::unique_ptr<Base> m_fn;
+
+public:
+  template <typename Fn>
+    requires(!std::same_as<std::remove_cvref_t<Fn>, Task>)
+  explicit Task(Fn&& fn) : m_fn(std::make_unique<Impl<std::decay_t<Fn>>>(std::forward<Fn>(fn))) {}
+
+  void operator()() { m_fn->run(); }
+};
+
+} // namespace detail
+
+export class ThreadPool {
+public:
+  struct Stats {
+    uint64_t tasksExecuted = 0; // includes externalTasks
+    uint64_t externalTasks = 0; // run by threads that aren't workers of this pool
+    uint64_t steals = 0;
+    std::chrono::nanoseconds idleTime{0};
+    array::DynamicArray<size_t> queueDepths; // tasks waiting in each worker's deques
+  };
+
+  // how many times an idle worker looks for work before it starts yielding, and then before it sleeps
+  static constexpr unsigned spinRounds = 64;
+  static constexpr unsigned yieldRounds = 16;
+
+private:
+  static constexpr size_t noWorker = detail::noWorker;
+
+  struct alignas(64) Worker {
+    std::mutex mutex;
+    std::array<queue::Deque<detail::Task>, detail::priorityCount> queues;
+    std::atomic<size_t> depth{0};
+    std::atomic<uint64_t> executed{0};
+    std::atomic<uint64_t> steals{0};
+    std::atomic<uint64_t> idleNanos{0};
+    std::jthread thread;
+  };
+
+  array::DynamicArray<std::unique_ptr<Worker>> m_workers;
+  std::atomic<size_t> m_queued{0};
+  std::atomic<size_t> m_sleepers{0};
+  std::atomic<size_t> m_nextQueue{0};
+  std::atomic<bool> m_stopping{false};
+  std::atomic<uint64_t> m_externalExecuted{0};
+  // bumped after every submission and every executed task, TaskGroup::join() waits on it
+  std::atomic<uint32_t> m_progress{0};
+  std::mutex m_sleepMutex;
+  std::condition_variable m_wake;
+
+  friend class TaskGroup;
+
+  [[nodiscard]] size_t currentIndex() const noexcept {
+    return detail::t_current.pool == this ? detail::t_current.index : noWorker;
+  }
+
+  void push(detail::Task task, Priority priority) {
+    size_t target = currentIndex();
+    if (target == noWorker) target = m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+
+    Worker& worker = *m_workers[target];
+    {
+      std::lock_guard lock(worker.mutex);
+      worker.queues[static_cast<size_t>(priority)].pushBack(std::move(task));
+      worker.depth.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // pairs with sleep(): either the sleeper sees the new task, or we see the sleeper and wake it
+    m_queued.fetch_add(1);
+    if (m_sleepers.load() > 0) {
+      std::lock_guard lock(m_sleepMutex);
+      m_wake.notify_one();
+    }
+    notifyProgress();
+  }
+
+  void notifyProgress() noexcept {
+    m_progress.fetch_add(1, std::memory_order_release);
+    m_progress.notify_all();
+  }
+
+  std::optional<detail::Task> takeFrom(Worker& worker, size_t priority, bool back) {
+    if (worker.depth.load(std::memory_order_relaxed) == 0) return std::nullopt;
+    std::lock_guard lock(worker.mutex);
+    auto& queue = worker.queues[priority];
+    if (queue.empty()) return std::nullopt;
+
+    std::optional<detail::Task> task;
+    if (back) {
+      task.emplace(std::move(queue.back()));
+      queue.popBack();
+    } else {
+      task.emplace(std::move(queue.front()));
+      queue.popFront();
+    }
+    worker.depth.fetch_sub(1, std::memory_order_relaxed);
+    m_queued.fetch_sub(1, std::memory_order_relaxed);
+    return task;
+  }
+
+  // own deque first, then steal, for every priority from high to low
+  std::optional<detail::Task> findTask(size_t self) {
+    size_t n = m_workers.size();
+    size_t start = self == noWorker ? m_nextQueue.load(std::memory_order_relaxed) : self + 1;
+    for (size_t priority = 0; priority < detail::priorityCount; ++priority) {
+      if (self != noWorker) {
+        if (auto task = takeFrom(*m_workers[self], priority, true)) return task;
+      }
+      for (size_t k = 0; k < n; ++k) {
+        size_t victim = (start + k) % n;
+        if (victim == self) continue;
+        if (auto task = takeFrom(*m_workers[victim], priority, false)) {
+          if (self != noWorker) m_workers[self]->steals.fetch_add(1, std::memory_order_relaxed);
+          return task;
+        }
+      }
+    }
+    return std::nullopt;
+  }
+
+  void execute(detail::Task& task, size_t self) {
+    task();
+    if (self != noWorker) {
+      m_workers[self]->executed.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      m_externalExecuted.fetch_add(1, std::memory_order_relaxed);
+    }
+    notifyProgress();
+  }
+
+  // returns false once the pool is stopping and every queued task has been run
+  bool sleep() {
+    std::unique_lock lock(m_sleepMutex);
+    m_sleepers.fetch_add(1);
+    m_wake.wait(lock, [this] { return m_queued.load() > 0 || m_stopping.load(); });
+    m_sleepers.fetch_sub(1);
+    return m_queued.load() > 0 || !m_stopping.load();
+  }
+
+  // an exception escaping a submitted task terminates, just like one escaping a std::thread
+  void workerLoop(size_t self) noexcept {
+    detail::t_current = {this, self};
+    Worker& worker = *m_workers[self];
+
+    while (true) {
+      if (auto task = findTask(self)) {
+        execute(*task, self);
+        continue;
+      }
+
+      auto idleStart = std::chrono::steady_clock::now();
+      std::optional<detail::Task> task;
+      for (unsigned round = 0; !task && round < spinRounds + yieldRounds; ++round) {
+        if (round >= spinRounds) std::this_thread::yield();
+        task = findTask(self);
+      }
+      bool keepRunning = task.has_value() || sleep();
+      auto idle = std::chrono::steady_clock::now() - idleStart;
+      worker.idleNanos.fetch_add(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(idle).count(), std::memory_order_relaxed
+      );
+
+      if (task) execute(*task, self);
+      if (!keepRunning) return;
+    }
+  }
+
+public:
+  /**
+   * @param threads Number of workers, 0 for std::thread::hardware_concurrency().
+   */
+  explicit ThreadPool(unsigned threads = 0) {
+    if (threads == 0) threads = std::max(1U, std::thread::hardware_concurrency());
+    m_workers.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) m_workers.pushBack(std::make_unique<Worker>());
+    // every worker exists before the first thread starts stealing from them
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+      m_workers[i]->thread = std::jthread([this, i] { workerLoop(i); });
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  ThreadPool(ThreadPool&&) = delete;
+  ThreadPool& operator=(ThreadPool&&) = delete;
+
+  // runs every task that is still queued, then joins the workers
+  ~ThreadPool() noexcept {
+    {
+      std::lock_guard lock(m_sleepMutex);
+      m_stopping.store(true);
+    }
+    m_wake.notify_all();
+    // join before any worker (and its deques) is destroyed, the others might still steal from it
+    for (auto& worker : m_workers) worker->thread.join();
+  }
+
+  /**
+   * @brief The process wide pool, sized to the hardware concurrency.
+   */
+  static ThreadPool& shared() {
+    static ThreadPool pool;
+    return pool;
+  }
+
+  /**
+   * @brief Fire and forget, an exception escaping fn terminates the program.
+   */
+  template <typename Fn> void submit(Fn&& fn, Priority priority = Priority::Normal) {
+    push(detail::Task{std::forward<Fn>(fn)}, priority);
+  }
+
+  /**
+   * @return A future for the result (or the exception) of fn.
+   */
+  template <typename Fn>
+  std::future<std::invoke_result_t<std::decay_t<Fn>>> async(Fn&& fn, Priority priority = Priority::Normal) {
+    std::packaged_task<std::invoke_result_t<std::decay_t<Fn>>()> task(std::forward<Fn>(fn));
+    auto future = task.get_future();
+    push(detail::Task{std::move(task)}, priority);
+    return future;
+  }
+
+  /**
+   * @brief Runs one queued task on the calling thread, if there is any.
+   * @return Whether a task was run.
+   */
+  bool runPendingTask() {
+    size_t self = currentIndex();
+    auto task = findTask(self);
+    if (!task) return false;
+    execute(*task, self);
+    return true;
+  }
+
+  /**
+   * @brief Calls fn(begin, end) on disjoint sub-ranges covering [first, last), none longer than grain,
+   *        and returns once all of them are done. The range is split recursively, so idle workers steal
+   *        the biggest remaining halves.
+   * @param grain The largest range handed to fn, 0 picks about 8 ranges per worker.
+   */
+  template <typename Fn>
+  void parallelFor(
+      size_t first, size_t last, Fn&& fn, size_t grain = 0, Priority priority = Priority::Normal
+  );
+
+  /**
+   * @brief Runs all fns concurrently (the first one on the calling thread) and returns once all are done.
+   */
+  template <typename... Fns> void invoke(Fns&&... fns);
+
+  [[nodiscard]] size_t size() const noexcept { return m_workers.size(); }
+
+  [[nodiscard]] Stats stats() const {
+    Stats stats;
+    stats.externalTasks = m_externalExecuted.load(std::memory_order_relaxed);
+    stats.tasksExecuted = stats.externalTasks;
+    stats.queueDepths.reserve(m_workers.size());
+    for (const auto& worker : m_workers) {
+      stats.tasksExecuted += worker->executed.load(std::memory_order_relaxed);
+      stats.steals += worker->steals.load(std::memory_order_relaxed);
+      stats.idleTime += std::chrono::nanoseconds(worker->idleNanos.load(std::memory_order_relaxed));
+      stats.queueDepths.pushBack(worker->depth.load(std::memory_order_relaxed));
+    }
+    return stats;
+  }
+
+  void resetStats() noexcept {
+    m_externalExecuted.store(0, std::memory_order_relaxed);
+    for (auto& worker : m_workers) {
+      worker->executed.store(0, std::memory_order_relaxed);
+      worker->steals.store(0, std::memory_order_relaxed);
+      worker->idleNanos.store(0, std::memory_order_relaxed);
+    }
+  }
+};
+
+/**
+ * @brief A set of tasks that can be waited for together. The first exception thrown by a task is rethrown
+ *        by wait(), the remaining tasks still run.
+ */
+export class TaskGroup {
+private:
+  ThreadPool& m_pool;
+  std::atomic<size_t> m_pending{0};
+  std::mutex m_errorMutex;
+  std::exception_ptr m_error;
+
+  // the last task of the group decrements m_pending before the pool bumps its progress, so reading the
+  // progress first and m_pending second can't miss the wake-up of the final task
+  void join() noexcept {
+    while (m_pending.load(std::memory_order_acquire) != 0) {
+      uint32_t seen = m_pool.m_progress.load(std::memory_order_acquire);
+      if (m_pool.runPendingTask()) continue;
+      if (m_pending.load(std::memory_order_acquire) == 0) break;
+      m_pool.m_progress.wait(seen, std::memory_order_acquire);
+    }
+  }
+
+public:
+  explicit TaskGroup(ThreadPool& pool = ThreadPool::shared()) : m_pool(pool) {}
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+  TaskGroup(TaskGroup&&) = delete;
+  TaskGroup& operator=(TaskGroup&&) = delete;
+
+  ~TaskGroup() noexcept { join(); }
+
+  template <typename Fn> void run(Fn&& fn, Priority priority = Priority::Normal) {
+    m_pending.fetch_add(1, std::memory_order_relaxed);
+    m_pool.submit(
+        [this, fn = std::forward<Fn>(fn)]() mutable noexcept {
+          try {
+            fn();
+          } catch (...) {
+            std::lock_guard lock(m_errorMutex);
+            if (!m_error) m_error = std::current_exception();
+          }
+          // the group may be gone right after this, it must be the last access to `this`
+          m_pending.fetch_sub(1, std::memory_order_release);
+        },
+        priority
+    );
+  }
+
+  /**
+   * @brief Helps running the pool's tasks until every task of this group finished.
+   */
+  void wait() {
+    join();
+    std::exception_ptr error;
+    {
+      std::lock_guard lock(m_errorMutex);
+      error = std::exchange(m_error, nullptr);
+    }
+    if (error) std::rethrow_exception(error);
+  }
+};
+
+template <typename Fn>
+void ThreadPool::parallelFor(size_t first, size_t last, Fn&& fn, size_t grain, Priority priority) {
+  if (last <= first) return;
+  if (grain == 0) grain = std::max<size_t>(1, (last - first) / (m_workers.size() * 8));
+
+  TaskGroup group(*this);
+  auto split = [&](auto& self, size_t begin, size_t end) -> void {
+    while (end - begin > grain) {
+      size_t mid = begin + ((end - begin) / 2);
+      group.run([&self, mid, end] { self(self, mid, end); }, priority);
+      end = mid;
+    }
+    fn(begin, end);
+  };
+  split(split, first, last);
+  group.wait();
+}
+
+template <typename... Fns> void ThreadPool::invoke(Fns&&... fns) {
+  if constexpr (sizeof...(Fns) > 0) {
+    TaskGroup group(*this);
+    [&](auto& head, auto&... rest) {
+      (group.run([&rest] { rest(); }), ...);
+      head();
+    }(fns...);
+    group.wait();
+  }
+}
+
+} // namespace concurrency
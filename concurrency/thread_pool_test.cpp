@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <atomic>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+import thread_pool;
+
+namespace {
+uint64_t fib(concurrency::ThreadPool& pool, unsigned n) {
+  if (n < 12) return n < 2 ? n : fib(pool, n - 1) + fib(pool, n - 2);
+  uint64_t a = 0;
+  uint64_t b = 0;
+  pool.invoke([&] { a = fib(pool, n - 1); }, [&] { b = fib(pool, n - 2); });
+  return a + b;
+}
+} // namespace
+
+TEST_CASE("ThreadPool runs submitted work", "[concurrency][ThreadPool]") {
+  concurrency::ThreadPool pool(4);
+  REQUIRE(pool.size() == 4);
+
+  SECTION("async returns results and exceptions through futures") {
+    auto answer = pool.async([] { return 42; });
+    auto moveOnly = pool.async([p = std::make_unique<int>(7)] { return *p; });
+    auto failing = pool.async([]() -> int { throw std::runtime_error("boom"); });
+    CHECK(answer.get() == 42);
+    CHECK(moveOnly.get() == 7);
+    CHECK_THROWS_AS(failing.get(), std::runtime_error);
+  }
+
+  SECTION("submit from many threads") {
+    std::atomic<int> counter{0};
+    {
+      std::vector<std::jthread> producers;
+      for (int t = 0; t < 4; ++t) {
+        producers.emplace_back([&] {
+          for (int i = 0; i < 1000; ++i) pool.submit([&] { counter.fetch_add(1); });
+        });
+      }
+    }
+    concurrency::TaskGroup group(pool);
+    group.run([] {});
+    group.wait();
+    while (counter.load() != 4000) std::this_thread::yield();
+    CHECK(counter.load() == 4000);
+  }
+}
+
+TEST_CASE("ThreadPool fork/join primitives", "[concurrency][ThreadPool]") {
+  concurrency::ThreadPool pool(4);
+
+  SECTION("parallelFor covers the range exactly once") {
+    std::vector<std::atomic<int>> hits(10'000);
+    auto mark = [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) hits[i].fetch_add(1);
+    };
+    pool.parallelFor(0, hits.size(), mark, 64);
+    CHECK(std::all_of(hits.begin(), hits.end(), [](const std::atomic<int>& h) { return h.load() == 1; }));
+  }
+
+  SECTION("Nested invoke doesn't deadlock") { CHECK(fib(pool, 25) == 75025); }
+
+  SECTION("TaskGroup rethrows the first exception after all tasks ran") {
+    std::atomic<int> ran{0};
+    concurrency::TaskGroup group(pool);
+    for (int i = 0; i < 100; ++i) {
+      group.run([&, i] {
+        ran.fetch_add(1);
+        if (i == 50) throw std::logic_error("task 50");
+      });
+    }
+    CHECK_THROWS_AS(group.wait(), std::logic_error);
+    CHECK(ran.load() == 100);
+  }
+
+  SECTION("Statistics") {
+    pool.resetStats();
+    // the caller may run parallelFor's tasks itself, a blocking get() can only be served by a worker
+    for (int i = 0; i < 4; ++i) pool.async([] {}).get();
+    // a task is counted right after it returned, which may be just after get() woke up
+    while (pool.stats().tasksExecuted < 4) std::this_thread::yield();
+    concurrency::ThreadPool::Stats stats = pool.stats();
+    CHECK(stats.tasksExecuted >= 4);
+    CHECK(stats.queueDepths.size() == 4);
+  }
+}
+
+TEST_CASE("ThreadPool priorities", "[concurrency][ThreadPool]") {
+  concurrency::ThreadPool pool(1);
+  std::mutex mutex;
+  std::vector<concurrency::Priority> order;
+  std::atomic<bool> release{false};
+
+  // keep the only worker busy until everything is queued
+  pool.submit([&] {
+    while (!release.load()) std::this_thread::yield();
+  });
+  using concurrency::Priority;
+  for (auto priority : {Priority::Low, Priority::Normal, Priority::High}) {
+    auto record = [&, priority] {
+      std::lock_guard lock(mutex);
+      order.push_back(priority);
+    };
+    pool.submit(record, priority);
+  }
+  release.store(true);
+
+  auto finished = [&] {
+    std::lock_guard lock(mutex);
+    return order.size() == 3;
+  };
+  while (!finished()) std::this_thread::yield();
+  CHECK(order[0] == concurrency::Priority::High);
+  CHECK(order[1] == concurrency::Priority::Normal);
+  CHECK(order[2] == concurrency::Priority::Low);
+}
+
+TEST_CASE("ThreadPool tasks run by other threads", "[concurrency][ThreadPool]") {
+  concurrency::ThreadPool pool(1);
+  std::atomic<bool> started{false};
+  std::atomic<bool> release{false};
+  pool.submit([&] {
+    started.store(true);
+    while (!release.load()) std::this_thread::yield();
+  });
+  while (!started.load()) std::this_thread::yield();
+
+  // the only worker is busy, so the task is left for the caller
+  pool.resetStats();
+  bool ran = false;
+  pool.submit([&] { ran = true; });
+  CHECK(pool.runPendingTask());
+  CHECK(ran);
+  CHECK_FALSE(pool.runPendingTask());
+  release.store(true);
+
+  concurrency::ThreadPool::Stats stats = pool.stats();
+  CHECK(stats.externalTasks == 1);
+  CHECK(stats.tasksExecuted >= 1);
+}
+
+TEST_CASE("ThreadPool fork/join overhead", "[concurrency][ThreadPool][.benchmark]") {
+  concurrency::ThreadPool& pool = concurrency::ThreadPool::shared();
+  BENCHMARK("fib(30) with invoke") { return fib(pool, 30); };
+  BENCHMARK("parallelFor over 1M indices, grain 1024") {
+    std::atomic<uint64_t> sum{0};
+    auto sumRange = [&](size_t begin, size_t end) {
+      uint64_t local = 0;
+      for (size_t i = begin; i < end; ++i) local += i;
+      sum.fetch_add(local, std::memory_order_relaxed);
+    };
+    pool.parallelFor(0, 1 << 20, sumRange, 1024);
+    return sum.load();
+  };
+}
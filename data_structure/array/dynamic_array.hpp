@@ -1,4 +1,5 @@
 #pragma once
+#include "../memory_stats.hpp"
 #include <algorithm>
 #include <cassert>
 #include <concepts>
@@ -32,10 +33,193 @@ concept ValueStreamable = requires(const T& val) {
 
 } // namespace
 
+namespace array::detail {
+
+/**
+ * @brief Recursively unwraps and prints a generic element to an output stream.
+ *
+ * Why `std::remove_cvref_t`:
+ *    - The parameter `const E& e` forces `decltype(e)` to resolve to a reference type
+ *      (e.g., `const Node* const&`).
+ *    - Type traits like `std::is_pointer_v` look only at the outermost wrapper and will
+ *      evaluate to false on a reference-to-pointer.
+ *    - Stripping `const`, `volatile`, and `&` exposes the raw underlying type for accurate
+ *      `if constexpr` compile-time branching.
+ */
+template <typename E> void printElement(std::ostream& os, const E& e) {
+  using Element = std::remove_cvref_t<decltype(e)>;
+
+  if constexpr (std::is_pointer_v<Element>) {
+    if (e == nullptr) {
+      os << "nullptr";
+      return;
+    }
+    printElement(os, *e);
+    return;
+  } else if constexpr (ValStreamable<Element>) {
+    os << e.val();
+  } else if constexpr (ValueStreamable<Element>) {
+    os << e.value();
+  } else if constexpr (DereferenceStreamable<Element>) {
+    os << *e;
+  } else if constexpr (Streamable<Element>) {
+    os << e;
+  } else {
+    os << "Unstreamable Type";
+  }
+}
+
+// shared by every contiguous sequence in this namespace, prints as [e0, e1, ...]
+template <typename Seq> std::ostream& printSequence(std::ostream& os, const Seq& seq) {
+  os << "[";
+  size_t n = seq.size();
+  for (size_t i = 0; i < n; ++i) {
+    printElement(os, seq[i]);
+    if (i < n - 1) os << ", ";
+  };
+  os << "]";
+  return os;
+}
+
+} // namespace array::detail
+
 namespace array {
 
-template <typename T> class DynamicArray {
+/**
+ * @brief The default storage policy of DynamicArray, a plain aligned `::operator new`.
+ *
+ * A storage policy hands out raw, uninitialized memory for `n` elements of `T`; DynamicArray owns the
+ * element lifetimes. Policies are stored inside the array (stateless ones take no space) and may optionally
+ * provide `reallocate`, which DynamicArray uses to grow trivially copyable elements without copying.
+ */
+struct HeapStorage {
+  template <typename T> static T* allocate(size_t capacity) {
+    if (capacity == 0) return nullptr;
+    return static_cast<T*>(::operator new(capacity * sizeof(T), std::align_val_t{alignof(T)}));
+  }
+
+  template <typename T> static void deallocate(T* ptr, size_t /*capacity*/) noexcept {
+    if (ptr == nullptr) return;
+    ::operator delete(ptr, std::align_val_t{alignof(T)});
+  }
+
+  bool operator==(const HeapStorage&) const = default;
+};
+
+namespace detail {
+
+template <typename S, typename T>
+concept Storage = std::copy_constructible<S> && requires(S& s, T* p, size_t n) {
+  { s.template allocate<T>(n) } -> std::same_as<T*>;
+  { s.template deallocate<T>(p, n) };
+};
+
+// a storage that can resize a block, returns nullptr when it can't, the caller then falls back to
+// allocate + relocate + deallocate
+template <typename S, typename T>
+concept ReallocatingStorage = Storage<S, T> && requires(S& s, T* p, size_t n) {
+  { s.template reallocate<T>(p, n, n) } -> std::same_as<T*>;
+};
+
+template <typename T, bool IsConst> class DynamicArrayIterator {
+  // Each instantiation of a class template is a distinct type
+  template <typename, bool> friend class DynamicArrayIterator;
+
 private:
+  using RawPtr = std::conditional_t<IsConst, const T*, T*>;
+  RawPtr m_ptr = nullptr;
+
+public:
+  using value_type = T;
+  using reference = std::conditional_t<IsConst, const T&, T&>;
+  using pointer = RawPtr;
+  using difference_type = std::ptrdiff_t;
+  using iterator_category = std::random_access_iterator_tag;
+  using iterator_concept = std::random_access_iterator_tag;
+
+  constexpr DynamicArrayIterator() = default;
+  constexpr DynamicArrayIterator(const DynamicArrayIterator&) = default;
+  constexpr DynamicArrayIterator(DynamicArrayIterator&&) noexcept = default;
+  constexpr DynamicArrayIterator& operator=(const DynamicArrayIterator&) = default;
+  constexpr DynamicArrayIterator& operator=(DynamicArrayIterator&&) noexcept = default;
+  constexpr ~DynamicArrayIterator() noexcept = default;
+
+  constexpr explicit DynamicArrayIterator(pointer p) : m_ptr(p) {};
+
+  // Conversion constructor for mutable iterator to const iterator, not a copy constructor.
+  constexpr DynamicArrayIterator(const DynamicArrayIterator<T, false>& other)
+    requires IsConst
+      : m_ptr(other.m_ptr) {}
+
+  constexpr reference operator*() const { return *m_ptr; }
+  constexpr pointer operator->() const { return m_ptr; }
+
+  constexpr reference operator[](difference_type n) const { return *(m_ptr + n); }
+
+  constexpr DynamicArrayIterator& operator++() {
+    m_ptr++;
+    return *this;
+  }
+
+  constexpr DynamicArrayIterator operator++(int) {
+    DynamicArrayIterator snapshot = *this;
+    m_ptr++;
+    return snapshot;
+  }
+
+  constexpr DynamicArrayIterator& operator--() {
+    m_ptr--;
+    return *this;
+  }
+
+  constexpr DynamicArrayIterator operator--(int) {
+    DynamicArrayIterator snapshot = *this;
+    m_ptr--;
+    return snapshot;
+  }
+
+  constexpr DynamicArrayIterator& operator+=(difference_type n) {
+    m_ptr += n;
+    return *this;
+  }
+
+  constexpr DynamicArrayIterator& operator-=(difference_type n) {
+    m_ptr -= n;
+    return *this;
+  }
+
+  constexpr DynamicArrayIterator operator+(difference_type n) const {
+    return DynamicArrayIterator(m_ptr + n);
+  }
+
+  friend constexpr DynamicArrayIterator
+  operator+(difference_type n, const DynamicArrayIterator& it) noexcept {
+    return it + n;
+  }
+
+  constexpr DynamicArrayIterator operator-(difference_type n) const {
+    return DynamicArrayIterator(m_ptr - n);
+  }
+  constexpr difference_type operator-(const DynamicArrayIterator& other) const {
+    return m_ptr - other.m_ptr;
+  }
+
+  constexpr bool operator==(const DynamicArrayIterator& other) const { return m_ptr == other.m_ptr; }
+  constexpr bool operator!=(const DynamicArrayIterator& other) const { return m_ptr != other.m_ptr; }
+  constexpr bool operator>(const DynamicArrayIterator& other) const { return m_ptr > other.m_ptr; }
+  constexpr bool operator<(const DynamicArrayIterator& other) const { return m_ptr < other.m_ptr; }
+  constexpr bool operator>=(const DynamicArrayIterator& other) const { return m_ptr >= other.m_ptr; }
+  constexpr bool operator<=(const DynamicArrayIterator& other) const { return m_ptr <= other.m_ptr; }
+};
+
+} // namespace detail
+
+template <typename T, typename Storage = HeapStorage>
+  requires detail::Storage<Storage, T>
+class DynamicArray {
+private:
+  // declared first, the other members are initialized through it
+  [[no_unique_address]] Storage m_storage;
   T* m_data = nullptr;
   size_t m_length = 0;
   size_t m_capacity = 0;
@@ -53,20 +237,21 @@ private:
 
   constexpr void release() noexcept {
     clear();
-    deallocate(m_data);
+    deallocate(m_data, m_capacity);
     m_data = nullptr;
     m_length = 0;
     m_capacity = 0;
   }
 
-  constexpr void deepCopy(const DynamicArray<T>& other) {
+  constexpr void deepCopy(const DynamicArray& other) {
     m_length = other.m_length;
     m_capacity = other.m_capacity;
     m_data = allocate(m_capacity);
     for (size_t i = 0; i < m_length; i++) new (m_data + i) T(other.m_data[i]);
   }
 
-  constexpr void move(DynamicArray<T>&& other) noexcept { // NOLINT
+  constexpr void move(DynamicArray&& other) noexcept { // NOLINT
+    m_storage = other.m_storage;
     m_length = other.m_length;
     m_capacity = other.m_capacity;
     m_data = other.m_data;
@@ -75,119 +260,12 @@ private:
     other.m_data = nullptr;
   }
 
-  static T* allocate(size_t capacity) noexcept {
-    if (capacity == 0) return nullptr;
-    return static_cast<T*>(::operator new(capacity * sizeof(T), std::align_val_t{alignof(T)}));
-  }
+  T* allocate(size_t capacity) { return m_storage.template allocate<T>(capacity); }
 
-  static void deallocate(T* ptr) noexcept {
-    if (ptr == nullptr) return;
-    ::operator delete(ptr, std::align_val_t{alignof(T)});
-  }
-
-  // constexpr static T* allocate(size_t capacity) noexcept {
-  //   if (capacity == 0) return nullptr;
-  //   return std::allocator<T>{}.allocate(capacity);
-  // }
-  //
-  // constexpr static void deallocate(T* ptr, size_t capacity) noexcept {
-  //   if (ptr == nullptr) return;
-  //
-  //   // This IS constexpr-friendly
-  //   std::allocator<T>{}.deallocate(ptr, capacity);
-  // }
+  void deallocate(T* ptr, size_t capacity) noexcept { m_storage.template deallocate<T>(ptr, capacity); }
 
 public:
-  template <bool IsConst> class DynamicArrayIterator {
-    // Each instantiation of a class template is a distinct type
-    template <bool> friend class DynamicArrayIterator;
-
-  private:
-    using RawPtr = std::conditional_t<IsConst, const T*, T*>;
-    RawPtr m_ptr = nullptr;
-
-  public:
-    using value_type = T;
-    using reference = std::conditional_t<IsConst, const T&, T&>;
-    using pointer = RawPtr;
-    using difference_type = std::ptrdiff_t;
-    using iterator_category = std::random_access_iterator_tag;
-    using iterator_concept = std::random_access_iterator_tag;
-
-    constexpr DynamicArrayIterator() = default;
-    constexpr DynamicArrayIterator(const DynamicArrayIterator&) = default;
-    constexpr DynamicArrayIterator(DynamicArrayIterator&&) noexcept = default;
-    constexpr DynamicArrayIterator& operator=(const DynamicArrayIterator&) = default;
-    constexpr DynamicArrayIterator& operator=(DynamicArrayIterator&&) noexcept = default;
-    constexpr ~DynamicArrayIterator() noexcept = default;
-
-    constexpr explicit DynamicArrayIterator(pointer p) : m_ptr(p) {};
-
-    // Conversion constructor for mutable iterator to const iterator, not a copy constructor.
-    constexpr DynamicArrayIterator(const DynamicArrayIterator<false>& other)
-      requires IsConst
-        : m_ptr(other.m_ptr) {}
-
-    constexpr reference operator*() const { return *m_ptr; }
-    constexpr pointer operator->() const { return m_ptr; }
-
-    constexpr reference operator[](difference_type n) const { return *(m_ptr + n); }
-
-    constexpr DynamicArrayIterator& operator++() {
-      m_ptr++;
-      return *this;
-    }
-
-    constexpr DynamicArrayIterator operator++(int) {
-      DynamicArrayIterator snapshot = *this;
-      m_ptr++;
-      return snapshot;
-    }
-
-    constexpr DynamicArrayIterator& operator--() {
-      m_ptr--;
-      return *this;
-    }
-
-    constexpr DynamicArrayIterator operator--(int) {
-      DynamicArrayIterator snapshot = *this;
-      m_ptr--;
-      return snapshot;
-    }
-
-    constexpr DynamicArrayIterator& operator+=(difference_type n) {
-      m_ptr += n;
-      return *this;
-    }
-
-    constexpr DynamicArrayIterator& operator-=(difference_type n) {
-      m_ptr -= n;
-      return *this;
-    }
-
-    constexpr DynamicArrayIterator operator+(difference_type n) const {
-      return DynamicArrayIterator(m_ptr + n);
-    }
-
-    friend constexpr DynamicArrayIterator
-    operator+(difference_type n, const DynamicArrayIterator& it) noexcept {
-      return it + n;
-    }
-
-    constexpr DynamicArrayIterator operator-(difference_type n) const {
-      return DynamicArrayIterator(m_ptr - n);
-    }
-    constexpr difference_type operator-(const DynamicArrayIterator& other) const {
-      return m_ptr - other.m_ptr;
-    }
-
-    constexpr bool operator==(const DynamicArrayIterator& other) const { return m_ptr == other.m_ptr; }
-    constexpr bool operator!=(const DynamicArrayIterator& other) const { return m_ptr != other.m_ptr; }
-    constexpr bool operator>(const DynamicArrayIterator& other) const { return m_ptr > other.m_ptr; }
-    constexpr bool operator<(const DynamicArrayIterator& other) const { return m_ptr < other.m_ptr; }
-    constexpr bool operator>=(const DynamicArrayIterator& other) const { return m_ptr >= other.m_ptr; }
-    constexpr bool operator<=(const DynamicArrayIterator& other) const { return m_ptr <= other.m_ptr; }
-  };
+  template <bool IsConst> using DynamicArrayIterator = detail::DynamicArrayIterator<T, IsConst>;
 
   using value_type = T;
   using size_type = size_t;
@@ -200,16 +278,19 @@ public:
   using reverse_iterator = std::reverse_iterator<iterator>;
   using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
-  constexpr DynamicArray() : m_capacity(2), m_data(allocate(2)) {};
+  constexpr DynamicArray() : m_data(allocate(2)), m_capacity(2) {};
+
+  constexpr explicit DynamicArray(Storage storage) : m_storage(std::move(storage)) {}
 
   constexpr DynamicArray(size_t size) : DynamicArray(size, T{}) {}
 
-  constexpr DynamicArray(size_t size, const T& value) : m_capacity(size), m_length(size) {
+  constexpr DynamicArray(size_t size, const T& value, Storage storage = {})
+      : m_storage(std::move(storage)), m_length(size), m_capacity(size) {
     m_data = allocate(m_capacity);
     try {
       std::uninitialized_fill_n(m_data, m_length, value);
     } catch (...) {
-      deallocate(m_data);
+      deallocate(m_data, m_capacity);
       throw;
     }
   }
@@ -218,7 +299,7 @@ public:
 
   template <std::input_iterator InputIt>
     requires std::constructible_from<T, std::iter_value_t<InputIt>>
-  constexpr DynamicArray(InputIt first, InputIt last) {
+  constexpr DynamicArray(InputIt first, InputIt last, Storage storage = {}) : m_storage(std::move(storage)) {
     size_t size = std::distance(first, last);
     if (size <= 0) {
       m_capacity = 0;
@@ -239,23 +320,26 @@ public:
       }
     } catch (...) {
       for (size_t j = 0; j < i; ++j) m_data[j].~T();
-      deallocate(m_data);
+      deallocate(m_data, m_capacity);
       throw;
     }
   }
 
-  constexpr DynamicArray(const DynamicArray<T>& other) { deepCopy(other); }; // NOLINT
+  constexpr DynamicArray(const DynamicArray& other) : m_storage(other.m_storage) { // NOLINT
+    deepCopy(other);
+  };
 
-  constexpr DynamicArray(DynamicArray<T>&& other) noexcept { move(std::move(other)); }; // NOLINT
+  constexpr DynamicArray(DynamicArray&& other) noexcept { move(std::move(other)); }; // NOLINT
 
-  constexpr DynamicArray<T>& operator=(const DynamicArray<T>& other) {
+  constexpr DynamicArray& operator=(const DynamicArray& other) {
     if (&other == this) return *this;
     release();
+    m_storage = other.m_storage;
     deepCopy(other);
     return *this;
   };
 
-  constexpr DynamicArray<T>& operator=(DynamicArray<T>&& other) noexcept {
+  constexpr DynamicArray& operator=(DynamicArray&& other) noexcept {
     if (&other == this) return *this;
     release();
     move(std::move(other));
@@ -342,6 +426,18 @@ public:
 
   constexpr void reserve(size_t newCapacity) {
     if (newCapacity <= m_capacity) return;
+
+    // trivially copyable elements may be moved by the storage itself (e.g. mremap), no per-element work
+    if constexpr (std::is_trivially_copyable_v<T> && detail::ReallocatingStorage<Storage, T>) {
+      if (m_data != nullptr) {
+        if (T* grown = m_storage.template reallocate<T>(m_data, m_capacity, newCapacity)) {
+          m_data = grown;
+          m_capacity = newCapacity;
+          return;
+        }
+      }
+    }
+
     size_t i = 0;
     T* newData = allocate(newCapacity);
 
@@ -358,12 +454,12 @@ public:
       }
     } catch (...) {
       for (size_t j = 0; j < i; j++) { newData[j].~T(); }
-      deallocate(newData);
+      deallocate(newData, newCapacity);
       throw;
     }
 
     for (size_t i = 0; i < m_length; i++) m_data[i].~T();
-    deallocate(m_data);
+    deallocate(m_data, m_capacity);
     m_data = newData;
     m_capacity = newCapacity;
   }
@@ -395,63 +491,33 @@ public:
 
   constexpr void swap(DynamicArray& other) noexcept {
     using std::swap;
+    swap(m_storage, other.m_storage);
     swap(m_data, other.m_data);
     swap(m_length, other.m_length);
     swap(m_capacity, other.m_capacity);
   }
 
   friend std::ostream& operator<<(std::ostream& os, const DynamicArray& arr) {
-    /**
-     * @brief Recursively unwraps and prints a generic element to an output stream.
-     *
-     * 1. Why `auto` instead of `std::function`:
-     *    - `std::function` cannot have templated (`auto`) parameters, which this function requires.
-     *
-     * 2. Why `std::remove_cvref_t`:
-     *    - The parameter `const auto& e` forces `decltype(e)` to resolve to a reference type
-     *      (e.g., `const Node* const&`).
-     *    - Type traits like `std::is_pointer_v` look only at the outermost wrapper and will
-     *      evaluate to false on a reference-to-pointer.
-     *    - Stripping `const`, `volatile`, and `&` exposes the raw underlying type for accurate
-     *      `if constexpr` compile-time branching.
-     */
-    auto printElement = [&](auto&& self, const auto& e) -> void {
-      using Element = std::remove_cvref_t<decltype(e)>;
-
-      if constexpr (std::is_pointer_v<Element>) {
-        if (e == nullptr) {
-          os << "nullptr";
-          return;
-        }
-        self(self, *e);
-        return;
-      } else if constexpr (ValStreamable<Element>) {
-        os << e.val();
-      } else if constexpr (ValueStreamable<Element>) {
-        os << e.value();
-      } else if constexpr (DereferenceStreamable<Element>) {
-        os << *e;
-      } else if constexpr (Streamable<Element>) {
-        os << e;
-      } else {
-        os << "Unstreamable Type";
-      }
-    };
-
-    os << "[";
-    size_t n = arr.size();
-    for (size_t i = 0; i < n; ++i) {
-      printElement(printElement, arr[i]);
-      if (i < n - 1) os << ", ";
-    };
-    os << "]";
-    return os;
+    return detail::printSequence(os, arr);
   }
 
   [[nodiscard]] constexpr size_t size() const noexcept { return m_length; };
   [[nodiscard]] constexpr size_t capacity() const noexcept { return m_capacity; };
   [[nodiscard]] constexpr bool empty() const noexcept { return m_length == 0; }
 
+  [[nodiscard]] constexpr const Storage& storage() const noexcept { return m_storage; }
+
+  // O(1), the elements' own heap memory isn't followed
+  [[nodiscard]] stats::MemoryStats memoryStats() const noexcept {
+    stats::MemoryStats result;
+    result.bytesAllocated = m_capacity * sizeof(T);
+    result.bytesUsed = m_length * sizeof(T);
+    result.elementCount = m_length;
+    result.capacity = m_capacity;
+    if (m_capacity != 0) result.loadFactor = static_cast<double>(m_length) / static_cast<double>(m_capacity);
+    return result;
+  }
+
   constexpr pointer data() noexcept { return m_data; }
   constexpr const_pointer data() const noexcept { return m_data; }
 
@@ -472,5 +538,8 @@ public:
   constexpr const_reverse_iterator crend() const noexcept { return const_reverse_iterator{begin()}; }
 };
 
-template <typename T> void swap(DynamicArray<T>& a, DynamicArray<T>& b) noexcept { a.swap(b); } // for ADL
+template <typename T, typename Storage>
+void swap(DynamicArray<T, Storage>& a, DynamicArray<T, Storage>& b) noexcept { // for ADL
+  a.swap(b);
+}
 } // namespace array
@@ -0,0 +1,98 @@
+#include "./dynamic_array.hpp"
+#include "./mapped_storage.hpp"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <string>
+
+namespace {
+using MappedArray = array::DynamicArray<uint64_t, array::MappedStorage>;
+
+// enough elements to cross the huge page size, so the mmap + mremap paths are exercised
+constexpr size_t largeCount = (array::MappedStorage::hugePageSize / sizeof(uint64_t)) * 2;
+} // namespace
+
+TEST_CASE("DynamicArray with MappedStorage", "[array][DynamicArray][MappedStorage]") {
+  SECTION("Small arrays behave like heap arrays") {
+    MappedArray arr{array::MappedStorage{}};
+    for (uint64_t i = 0; i < 100; ++i) arr.pushBack(i);
+    REQUIRE(arr.size() == 100);
+    CHECK(arr[99] == 99);
+  }
+
+  SECTION("Growing past the map threshold keeps the contents") {
+    MappedArray arr{array::MappedStorage{}};
+    for (uint64_t i = 0; i < largeCount; ++i) arr.pushBack(i);
+    REQUIRE(arr.size() == largeCount);
+    CHECK(arr.capacity() >= largeCount);
+    CHECK(std::accumulate(arr.begin(), arr.end(), uint64_t{0}) == largeCount * (largeCount - 1) / 2);
+  }
+
+  SECTION("Prefaulted mappings start out zero-filled") {
+    // large enough for Parallel to touch the pages with its threads
+    constexpr size_t count = array::MappedStorage::parallelTouchThreshold / sizeof(uint64_t);
+    auto zero = [](const uint64_t* first, const uint64_t* last) {
+      return std::all_of(first, last, [](uint64_t v) { return v == 0; });
+    };
+    for (auto mode : {array::MappedStorage::Prefault::Populate, array::MappedStorage::Prefault::Parallel}) {
+      // the raw storage is read, no element was ever written to it
+      array::MappedStorage storage{mode, 4};
+      uint64_t* block = storage.allocate<uint64_t>(count);
+      CHECK(zero(block, block + count));
+      size_t capacity = count;
+      if (uint64_t* grown = storage.reallocate<uint64_t>(block, count, count * 2)) {
+        block = grown;
+        capacity = count * 2;
+        CHECK(zero(block + count, block + capacity));
+      }
+      storage.deallocate(block, capacity);
+
+      MappedArray arr{array::MappedStorage{mode, 4}};
+      arr.reserve(largeCount);
+      CHECK(arr.storage().prefault() == mode);
+      arr.resize(largeCount);
+      arr.reserve(largeCount * 3);
+      CHECK(arr.size() == largeCount);
+    }
+  }
+
+  SECTION("Non-trivially copyable elements are relocated one by one") {
+    array::DynamicArray<std::string, array::MappedStorage> arr{array::MappedStorage{}};
+    for (size_t i = 0; i < 5000; ++i) arr.emplaceBack(std::to_string(i));
+    CHECK(arr[4999] == "4999");
+  }
+
+  SECTION("Copies and moves carry the storage policy") {
+    MappedArray arr(largeCount, 7, array::MappedStorage{array::MappedStorage::Prefault::Populate});
+    MappedArray copy{arr};
+    CHECK(copy.storage() == arr.storage());
+    CHECK(copy[largeCount - 1] == 7);
+
+    MappedArray moved{std::move(copy)};
+    CHECK(moved.size() == largeCount);
+    CHECK(moved.storage().prefault() == array::MappedStorage::Prefault::Populate);
+  }
+}
+
+TEST_CASE("DynamicArray fill and scan throughput", "[array][DynamicArray][.benchmark]") {
+  constexpr size_t n = size_t{1} << 26; // 512 MiB of uint64_t
+
+  auto fillAndScan = [&]<typename Storage>(Storage storage) {
+    array::DynamicArray<uint64_t, Storage> arr{storage};
+    for (uint64_t i = 0; i < n; ++i) arr.pushBack(i);
+    return std::accumulate(arr.begin(), arr.end(), uint64_t{0});
+  };
+
+  BENCHMARK("heap: pushBack fill + scan") { return fillAndScan(array::HeapStorage{}); };
+  BENCHMARK("mmap: pushBack fill + scan") { return fillAndScan(array::MappedStorage{}); };
+  BENCHMARK("mmap + parallel prefault: pushBack fill + scan") {
+    return fillAndScan(array::MappedStorage{array::MappedStorage::Prefault::Parallel});
+  };
+
+  array::DynamicArray<uint64_t> heap(n, 1);
+  MappedArray mapped(n, 1, array::MappedStorage{array::MappedStorage::Prefault::Parallel});
+  BENCHMARK("heap: scan") { return std::accumulate(heap.begin(), heap.end(), uint64_t{0}); };
+  BENCHMARK("mmap: scan") { return std::accumulate(mapped.begin(), mapped.end(), uint64_t{0}); };
+}
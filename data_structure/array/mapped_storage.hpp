@@ -0,0 +1,208 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define DSA_HAS_MMAP 1
+#endif
+
+/*
+ * MappedStorage is a DynamicArray storage policy for very large arrays:
+ *   array::DynamicArray<int, array::MappedStorage> arr{array::MappedStorage{}};
+ *
+ *   - Blocks of at least `mapThreshold` bytes are backed by anonymous `mmap` instead of the heap. Anything
+ *     smaller (e.g. the default capacity of 2) stays on the heap, a page per tiny array would be wasteful.
+ *   - Blocks of at least `hugePageSize` bytes are rounded up to a whole number of huge pages and first
+ *     requested with MAP_HUGETLB (explicit huge pages). If the system has no huge pages reserved, we fall
+ *     back to a normal mapping with an madvise(MADV_HUGEPAGE) hint so transparent huge pages can back it.
+ *   - Growth of trivially copyable elements goes through `mremap`, which lets the kernel extend the mapping
+ *     in place or move the page tables instead of copying the bytes.
+ *   - Prefaulting touches every page up front, so the page faults happen in one burst (optionally spread
+ *     over several threads) instead of stalling the first pass over the data.
+ *
+ * The mapping length is a pure function of the requested capacity, so deallocate only needs the capacity
+ * DynamicArray already tracks. On platforms without mmap everything silently uses the heap.
+ * */
+
+namespace array {
+
+class MappedStorage {
+public:
+  enum class Prefault : uint8_t {
+    None,     // pages are faulted in lazily on first touch
+    Populate, // the kernel populates the mapping (MAP_POPULATE, MADV_POPULATE_WRITE on growth)
+    Parallel  // the pages are touched by `prefaultThreads` threads
+  };
+
+  static constexpr size_t mapThreshold = size_t{1} << 16;
+  static constexpr size_t hugePageSize = size_t{1} << 21;
+  // Parallel prefaulting touches smaller mappings (and growth) on the calling thread, spawning the threads
+  // would cost more than the page faults
+  static constexpr size_t parallelTouchThreshold = size_t{1} << 24;
+
+private:
+  Prefault m_prefault = Prefault::None;
+  unsigned m_prefaultThreads = 0;
+
+  static size_t pageSize() noexcept {
+#ifdef DSA_HAS_MMAP
+    static const size_t size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    return size;
+#else
+    return 4096;
+#endif
+  }
+
+  static size_t roundUp(size_t bytes, size_t granularity) noexcept {
+    return (bytes + granularity - 1) / granularity * granularity;
+  }
+
+  static bool isMapped(size_t bytes) noexcept { return bytes >= mapThreshold; }
+
+  static size_t mappingLength(size_t bytes) noexcept {
+    return roundUp(bytes, bytes >= hugePageSize ? hugePageSize : pageSize());
+  }
+
+  [[nodiscard]] unsigned prefaultThreadCount() const noexcept {
+    if (m_prefaultThreads != 0) return m_prefaultThreads;
+    return std::max(1U, std::thread::hardware_concurrency());
+  }
+
+  // writes one byte per page of [first, first + length), length is a multiple of the page size.
+  // prefaulting is only an optimization: if the threads can't be spawned the pages fault in lazily.
+  void touchPages(std::byte* first, size_t length, bool threaded = true) const noexcept {
+    size_t step = pageSize();
+    size_t pages = length / step;
+    if (pages == 0) return;
+
+    auto touch = [first, step](size_t begin, size_t end) {
+      for (size_t p = begin; p < end; ++p) *(first + (p * step)) = std::byte{0};
+    };
+
+    unsigned threads = threaded ? std::min<size_t>(prefaultThreadCount(), pages) : 1;
+    if (threads <= 1) {
+      touch(0, pages);
+      return;
+    }
+
+    size_t chunk = (pages + threads - 1) / threads;
+    try {
+      std::vector<std::jthread> workers;
+      workers.reserve(threads - 1);
+      for (unsigned t = 1; t < threads; ++t) {
+        size_t begin = std::min(pages, t * chunk);
+        size_t end = std::min(pages, begin + chunk);
+        workers.emplace_back(touch, begin, end);
+      }
+      touch(0, std::min(pages, chunk));
+    } catch (...) {
+      touch(0, pages);
+    }
+  }
+
+#ifdef DSA_HAS_MMAP
+  // prefaults the pages mremap added to a mapping, there is no MAP_POPULATE for mremap
+  void prefaultGrowth(std::byte* first, size_t length) const noexcept {
+    if (m_prefault == Prefault::Populate) {
+#ifdef MADV_POPULATE_WRITE
+      ::madvise(first, length, MADV_POPULATE_WRITE);
+#endif
+    } else if (m_prefault == Prefault::Parallel) {
+      touchPages(first, length, length >= parallelTouchThreshold);
+    }
+  }
+
+  [[nodiscard]] void* map(size_t length) const {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_POPULATE
+    if (m_prefault == Prefault::Populate) flags |= MAP_POPULATE;
+#endif
+
+    void* p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    if (length % hugePageSize == 0) {
+      p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+    }
+#endif
+    if (p == MAP_FAILED) {
+      p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+      if (p == MAP_FAILED) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+      if (length % hugePageSize == 0) ::madvise(p, length, MADV_HUGEPAGE);
+#endif
+    }
+
+    if (m_prefault == Prefault::Parallel) {
+      touchPages(static_cast<std::byte*>(p), length, length >= parallelTouchThreshold);
+    }
+    return p;
+  }
+#endif
+
+public:
+  MappedStorage() = default;
+  explicit MappedStorage(Prefault prefault, unsigned prefaultThreads = 0)
+      : m_prefault(prefault), m_prefaultThreads(prefaultThreads) {}
+
+  template <typename T> T* allocate(size_t capacity) {
+    if (capacity == 0) return nullptr;
+    size_t bytes = capacity * sizeof(T);
+#ifdef DSA_HAS_MMAP
+    static_assert(alignof(T) <= 4096, "mapped storage only guarantees page alignment");
+    if (isMapped(bytes)) return static_cast<T*>(map(mappingLength(bytes)));
+#endif
+    return static_cast<T*>(::operator new(bytes, std::align_val_t{alignof(T)}));
+  }
+
+  template <typename T> void deallocate(T* ptr, size_t capacity) noexcept {
+    if (ptr == nullptr) return;
+    size_t bytes = capacity * sizeof(T);
+#ifdef DSA_HAS_MMAP
+    if (isMapped(bytes)) {
+      ::munmap(ptr, mappingLength(bytes));
+      return;
+    }
+#endif
+    ::operator delete(ptr, std::align_val_t{alignof(T)});
+  }
+
+  /**
+   * @brief Grows a mapped block with mremap, the contents are preserved bitwise.
+   * @return The (possibly moved) block, or nullptr if the block can't be remapped (heap blocks, platforms
+   *         without mremap, hugetlb mappings the kernel refuses to resize). The old block is untouched then.
+   */
+  template <typename T> T* reallocate(T* ptr, size_t oldCapacity, size_t newCapacity) noexcept {
+#if defined(DSA_HAS_MMAP) && defined(MREMAP_MAYMOVE)
+    size_t oldBytes = oldCapacity * sizeof(T);
+    size_t newBytes = newCapacity * sizeof(T);
+    if (!isMapped(oldBytes)) return nullptr;
+
+    size_t oldLength = mappingLength(oldBytes);
+    size_t newLength = mappingLength(newBytes);
+    if (newLength == oldLength) return ptr;
+
+    void* p = ::mremap(ptr, oldLength, newLength, MREMAP_MAYMOVE);
+    if (p == MAP_FAILED) return nullptr;
+#ifdef MADV_HUGEPAGE
+    if (newLength % hugePageSize == 0) ::madvise(p, newLength, MADV_HUGEPAGE);
+#endif
+    prefaultGrowth(static_cast<std::byte*>(p) + oldLength, newLength - oldLength);
+    return static_cast<T*>(p);
+#else
+    (void)ptr, (void)oldCapacity, (void)newCapacity;
+    return nullptr;
+#endif
+  }
+
+  [[nodiscard]] Prefault prefault() const noexcept { return m_prefault; }
+
+  bool operator==(const MappedStorage&) const = default;
+};
+
+} // namespace array
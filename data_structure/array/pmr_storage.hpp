@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+
+/*
+ * PmrStorage is a DynamicArray storage policy that allocates from a std::pmr::memory_resource, so scratch
+ * arrays of a pmr-aware container can come from the same arena as the container itself:
+ *   array::DynamicArray<int, array::PmrStorage> arr{array::PmrStorage{alloc.resource()}};
+ *
+ * It holds the resource by pointer rather than a polymorphic_allocator, DynamicArray assigns its storage
+ * on copy and move assignment and polymorphic_allocator isn't assignable. The resource must outlive every
+ * array using it.
+ * */
+
+namespace array {
+
+class PmrStorage {
+  std::pmr::memory_resource* m_resource = std::pmr::get_default_resource();
+
+public:
+  PmrStorage() = default;
+  explicit PmrStorage(std::pmr::memory_resource* resource) noexcept : m_resource(resource) {}
+
+  template <typename T> T* allocate(size_t capacity) {
+    if (capacity == 0) return nullptr;
+    return static_cast<T*>(m_resource->allocate(capacity * sizeof(T), alignof(T)));
+  }
+
+  template <typename T> void deallocate(T* ptr, size_t capacity) noexcept {
+    if (ptr == nullptr) return;
+    m_resource->deallocate(ptr, capacity * sizeof(T), alignof(T));
+  }
+
+  [[nodiscard]] std::pmr::memory_resource* resource() const noexcept { return m_resource; }
+
+  bool operator==(const PmrStorage&) const = default;
+};
+
+} // namespace array
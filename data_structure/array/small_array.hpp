@@ -0,0 +1,338 @@
+#pragma once
+#include "./dynamic_array.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/*
+ * SmallArray keeps its first N elements in a buffer embedded in the object itself and only touches the heap
+ * once it grows past N ("spilling"). It mirrors the DynamicArray API and re-uses DynamicArray's iterator
+ * types, so the two are interchangeable wherever code is written against the iterator aliases.
+ *
+ *   - While the elements live inline, moving a SmallArray has to move the elements one by one, it cannot
+ *     steal a pointer. Keep N small (the whole buffer is paid for by every instance).
+ *   - Once spilled, the array never goes back to the inline buffer, even if it shrinks.
+ * */
+
+namespace array {
+
+template <typename T, size_t N> class SmallArray {
+  static_assert(N > 0, "SmallArray inline capacity must be greater than 0");
+
+private:
+  T* m_data = inlineData();
+  size_t m_length = 0;
+  size_t m_capacity = N;
+  // raw storage, elements are only constructed on demand
+  alignas(T) std::byte m_inline[sizeof(T) * N]; // NOLINT
+
+  T* inlineData() noexcept { return reinterpret_cast<T*>(m_inline); }             // NOLINT
+  const T* inlineData() const noexcept { return reinterpret_cast<const T*>(m_inline); } // NOLINT
+
+  constexpr void checkBound(size_t index) const {
+    if (index >= m_length)
+      throw std::out_of_range(
+          "Index out of bounds, index: " + std::to_string(index) + ", size: " + std::to_string(m_length)
+      );
+  }
+
+  constexpr void assertBound(size_t index) const noexcept {
+    assert(index < m_length && "Index out of bounds");
+  }
+
+  static T* allocate(size_t capacity) noexcept {
+    return static_cast<T*>(::operator new(capacity * sizeof(T), std::align_val_t{alignof(T)}));
+  }
+
+  void deallocateHeap() noexcept {
+    if (isInline()) return;
+    ::operator delete(m_data, std::align_val_t{alignof(T)});
+  }
+
+  constexpr void release() noexcept {
+    clear();
+    deallocateHeap();
+    m_data = inlineData();
+    m_capacity = N;
+  }
+
+  // relocate [src, src + n) into dest, constructing in dest and destroying in src
+  static void relocate(T* src, size_t n, T* dest) {
+    constexpr bool preferMove = std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>;
+    size_t i = 0;
+    try {
+      for (; i < n; ++i) {
+        if constexpr (preferMove) {
+          new (dest + i) T(std::move(src[i]));
+        } else {
+          new (dest + i) T(src[i]);
+        }
+      }
+    } catch (...) {
+      for (size_t j = 0; j < i; ++j) dest[j].~T();
+      throw;
+    }
+    for (size_t j = 0; j < n; ++j) src[j].~T();
+  }
+
+  template <typename Other> void deepCopy(const Other& other) {
+    reserve(other.size());
+    size_t i = 0;
+    try {
+      for (const T& e : other) {
+        new (m_data + i) T(e);
+        ++i;
+      }
+    } catch (...) {
+      for (size_t j = 0; j < i; ++j) m_data[j].~T();
+      throw;
+    }
+    m_length = i;
+  }
+
+  void move(SmallArray&& other) noexcept(std::is_nothrow_move_constructible_v<T>) { // NOLINT
+    if (!other.isInline()) {
+      m_data = std::exchange(other.m_data, other.inlineData());
+      m_length = std::exchange(other.m_length, 0);
+      m_capacity = std::exchange(other.m_capacity, N);
+      return;
+    }
+    relocate(other.m_data, other.m_length, m_data);
+    m_length = std::exchange(other.m_length, 0);
+  }
+
+public:
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = value_type*;
+  using const_pointer = const value_type*;
+  // shared with DynamicArray so either container can be passed where the other's iterators are expected
+  using iterator = typename DynamicArray<T>::iterator;
+  using const_iterator = typename DynamicArray<T>::const_iterator;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  SmallArray() noexcept {}; // NOLINT: m_inline is intentionally left uninitialized
+
+  SmallArray(size_t size) : SmallArray(size, T{}) {}
+
+  SmallArray(size_t size, const T& value) {
+    reserve(size);
+    std::uninitialized_fill_n(m_data, size, value);
+    m_length = size;
+  }
+
+  SmallArray(std::initializer_list<T> init) : SmallArray(init.begin(), init.end()) {}
+
+  template <std::input_iterator InputIt>
+    requires std::constructible_from<T, std::iter_value_t<InputIt>>
+  SmallArray(InputIt first, InputIt last) {
+    if constexpr (std::forward_iterator<InputIt>) reserve(static_cast<size_t>(std::distance(first, last)));
+    try {
+      for (auto it = first; it != last; ++it) emplaceBack(*it);
+    } catch (...) {
+      release();
+      throw;
+    }
+  }
+
+  SmallArray(const SmallArray& other) { deepCopy(other); } // NOLINT
+
+  SmallArray(SmallArray&& other) noexcept(std::is_nothrow_move_constructible_v<T>) { // NOLINT
+    move(std::move(other));
+  }
+
+  SmallArray& operator=(const SmallArray& other) {
+    if (&other == this) return *this;
+    clear();
+    deepCopy(other);
+    return *this;
+  }
+
+  SmallArray& operator=(SmallArray&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+    if (&other == this) return *this;
+    release();
+    move(std::move(other));
+    return *this;
+  }
+
+  ~SmallArray() noexcept { release(); }
+
+  void clear() noexcept {
+    for (size_t i = 0; i < m_length; i++) { m_data[i].~T(); }
+    m_length = 0;
+  }
+
+  iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    if (first < cbegin() || last > cend() || last < first)
+      throw std::out_of_range("Erase positions out of range");
+
+    size_t start = static_cast<size_t>(first - cbegin());
+    size_t finish = static_cast<size_t>(last - cbegin());
+    size_t count = finish - start;
+
+    for (size_t i = start; i < finish; i++) m_data[i].~T();
+
+    constexpr bool preferMove = std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>;
+
+    for (size_t i = finish; i < m_length; i++) {
+      if constexpr (preferMove) {
+        new (m_data + i - count) T(std::move(m_data[i]));
+      } else {
+        new (m_data + i - count) T(m_data[i]);
+      }
+      m_data[i].~T();
+    }
+
+    m_length -= count;
+    return iterator{m_data + start};
+  }
+
+  void popBack() {
+    assertBound(0);
+    m_data[--m_length].~T();
+  }
+
+  template <typename... Args> iterator emplace(const_iterator pos, Args&&... args) {
+    if (pos < cbegin() || pos > cend()) throw std::out_of_range("Emplace Position out of range");
+
+    // has to happen before reserve, which may leave pos dangling
+    size_t idx = static_cast<size_t>(pos - cbegin());
+
+    if (m_length == m_capacity) reserve(m_capacity * 2);
+
+    constexpr bool preferMove = std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>;
+
+    for (size_t i = m_length; i > idx; i--) {
+      if constexpr (preferMove) {
+        new (m_data + i) T(std::move(m_data[i - 1]));
+      } else {
+        new (m_data + i) T(m_data[i - 1]);
+      }
+      m_data[i - 1].~T();
+    }
+
+    new (m_data + idx) T(std::forward<Args>(args)...);
+    m_length++;
+    return iterator{m_data + idx};
+  }
+
+  // the common case gets its own path, there is nothing to shift
+  template <typename... Args> T& emplaceBack(Args&&... args) {
+    if (m_length == m_capacity) reserve(m_capacity * 2);
+    T* slot = new (m_data + m_length) T(std::forward<Args>(args)...);
+    m_length++;
+    return *slot;
+  }
+
+  void pushBack(const T& value) { emplaceBack(value); }
+  void pushBack(T&& value) { emplaceBack(std::move(value)); }
+
+  void resize(size_t newSize) {
+    if (newSize > m_length) {
+      if (newSize > m_capacity) reserve(std::max(newSize, m_capacity * 2));
+      for (size_t i = m_length; i < newSize; i++) new (m_data + i) T{};
+    } else if (newSize < m_length) {
+      for (size_t i = newSize; i < m_length; i++) { m_data[i].~T(); }
+    }
+    m_length = newSize;
+  }
+
+  void reserve(size_t newCapacity) {
+    if (newCapacity <= m_capacity) return;
+    T* newData = allocate(newCapacity);
+    try {
+      relocate(m_data, m_length, newData);
+    } catch (...) {
+      ::operator delete(newData, std::align_val_t{alignof(T)});
+      throw;
+    }
+    deallocateHeap();
+    m_data = newData;
+    m_capacity = newCapacity;
+  }
+
+  const T& operator[](size_t index) const noexcept {
+    assertBound(index);
+    return m_data[index];
+  }
+
+  T& operator[](size_t index) noexcept {
+    assertBound(index);
+    return m_data[index];
+  }
+
+  const T& at(size_t index) const {
+    checkBound(index);
+    return m_data[index];
+  }
+  T& at(size_t index) {
+    checkBound(index);
+    return m_data[index];
+  }
+
+  const T& front() const noexcept { return operator[](0); }
+  T& front() noexcept { return operator[](0); }
+
+  const T& back() const noexcept { return operator[](m_length - 1); }
+  T& back() noexcept { return operator[](m_length - 1); }
+
+  // inline buffers can't be exchanged by pointer, fall back to three moves in that case
+  void swap(SmallArray& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+    if (!isInline() && !other.isInline()) {
+      using std::swap;
+      swap(m_data, other.m_data);
+      swap(m_length, other.m_length);
+      swap(m_capacity, other.m_capacity);
+      return;
+    }
+    SmallArray tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const SmallArray& arr) {
+    return detail::printSequence(os, arr);
+  }
+
+  [[nodiscard]] size_t size() const noexcept { return m_length; };
+  [[nodiscard]] size_t capacity() const noexcept { return m_capacity; };
+  [[nodiscard]] bool empty() const noexcept { return m_length == 0; }
+  [[nodiscard]] bool isInline() const noexcept { return m_data == inlineData(); }
+  [[nodiscard]] static constexpr size_t inlineCapacity() noexcept { return N; }
+
+  pointer data() noexcept { return m_data; }
+  const_pointer data() const noexcept { return m_data; }
+
+  iterator begin() noexcept { return iterator{m_data}; }
+  const_iterator begin() const noexcept { return const_iterator{m_data}; }
+  const_iterator cbegin() const noexcept { return const_iterator{m_data}; }
+
+  iterator end() noexcept { return iterator{m_data + m_length}; }
+  const_iterator end() const noexcept { return const_iterator{m_data + m_length}; }
+  const_iterator cend() const noexcept { return const_iterator{m_data + m_length}; }
+
+  reverse_iterator rbegin() noexcept { return reverse_iterator{end()}; }
+  const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator{end()}; }
+  const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator{end()}; }
+
+  reverse_iterator rend() noexcept { return reverse_iterator{begin()}; }
+  const_reverse_iterator rend() const noexcept { return const_reverse_iterator{begin()}; }
+  const_reverse_iterator crend() const noexcept { return const_reverse_iterator{begin()}; }
+};
+
+template <typename T, size_t N> void swap(SmallArray<T, N>& a, SmallArray<T, N>& b) noexcept { // for ADL
+  a.swap(b);
+}
+} // namespace array
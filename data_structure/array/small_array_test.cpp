@@ -0,0 +1,112 @@
+#include "./small_array.hpp"
+#include "./dynamic_array.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <memory>
+#include <sstream>
+#include <string>
+
+TEST_CASE("SmallArray inline storage", "[array][SmallArray]") {
+  SECTION("Default construction stays inline") {
+    array::SmallArray<int, 4> arr;
+    REQUIRE(arr.empty());
+    REQUIRE(arr.capacity() == 4);
+    REQUIRE(arr.isInline());
+  }
+
+  SECTION("Spills to the heap once the inline capacity is exceeded") {
+    array::SmallArray<int, 4> arr{1, 2, 3, 4};
+    REQUIRE(arr.isInline());
+
+    arr.pushBack(5);
+    REQUIRE_FALSE(arr.isInline());
+    REQUIRE(arr.size() == 5);
+    for (int i = 0; i < 5; ++i) CHECK(arr[i] == i + 1);
+  }
+
+  SECTION("Non-trivial elements survive spilling") {
+    array::SmallArray<std::string, 2> arr;
+    arr.emplaceBack("a long string that defeats the small string optimization");
+    arr.emplaceBack("b");
+    arr.emplaceBack("c");
+    REQUIRE(arr.size() == 3);
+    CHECK(arr.front() == "a long string that defeats the small string optimization");
+    CHECK(arr.back() == "c");
+  }
+}
+
+TEST_CASE("SmallArray copy and move", "[array][SmallArray]") {
+  SECTION("Copying inline and spilled arrays") {
+    array::SmallArray<int, 2> small{1, 2};
+    array::SmallArray<int, 2> big{1, 2, 3};
+
+    array::SmallArray<int, 2> smallCopy{small};
+    array::SmallArray<int, 2> bigCopy{big};
+    CHECK(smallCopy.isInline());
+    CHECK(bigCopy.size() == 3);
+    CHECK(bigCopy[2] == 3);
+
+    smallCopy = big;
+    CHECK(smallCopy.size() == 3);
+  }
+
+  SECTION("Moving a spilled array steals its buffer") {
+    array::SmallArray<int, 2> big{1, 2, 3};
+    const int* buffer = big.data();
+
+    array::SmallArray<int, 2> moved{std::move(big)};
+    CHECK(moved.data() == buffer);
+    CHECK(big.empty()); // NOLINT(bugprone-use-after-move)
+    CHECK(big.isInline());
+  }
+
+  SECTION("Moving an inline array moves its elements") {
+    array::SmallArray<std::unique_ptr<int>, 2> arr;
+    arr.emplaceBack(std::make_unique<int>(7));
+
+    array::SmallArray<std::unique_ptr<int>, 2> moved{std::move(arr)};
+    REQUIRE(moved.size() == 1);
+    CHECK(*moved[0] == 7);
+  }
+
+  SECTION("Swap between inline and spilled arrays") {
+    array::SmallArray<int, 2> a{1};
+    array::SmallArray<int, 2> b{1, 2, 3};
+    swap(a, b);
+    CHECK(a.size() == 3);
+    CHECK(b.size() == 1);
+    CHECK(b.isInline());
+  }
+}
+
+TEST_CASE("SmallArray modifiers", "[array][SmallArray]") {
+  array::SmallArray<int, 4> arr{1, 2, 3};
+
+  SECTION("emplace and erase") {
+    arr.emplace(arr.begin() + 1, 9);
+    CHECK(arr[1] == 9);
+    arr.erase(arr.begin(), arr.begin() + 2);
+    REQUIRE(arr.size() == 2);
+    CHECK(arr[0] == 2);
+  }
+
+  SECTION("resize and popBack") {
+    arr.resize(6);
+    CHECK(arr.size() == 6);
+    CHECK(arr[5] == 0);
+    arr.popBack();
+    CHECK(arr.size() == 5);
+  }
+
+  SECTION("at throws when out of range") { REQUIRE_THROWS_AS(arr.at(3), std::out_of_range); }
+}
+
+TEST_CASE("SmallArray shares DynamicArray iterators", "[array][SmallArray]") {
+  array::SmallArray<int, 4> arr{3, 1, 2};
+  array::DynamicArray<int>::const_iterator first = arr.cbegin();
+  array::DynamicArray<int>::iterator last = arr.end();
+  CHECK(array::DynamicArray<int>::const_iterator{last} - first == 3);
+
+  std::ostringstream oss;
+  oss << arr;
+  CHECK(oss.str() == "[3, 1, 2]");
+}
@@ -0,0 +1,538 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/*
+ * SoAArray<Fields...> is a structure-of-arrays sequence: element i is the tuple (column0[i], column1[i],
+ * ...), but every field lives in its own contiguous, cache-line aligned column.
+ *
+ *   - Scanning one field only streams that column through the cache, and `column<I>()` exposes it as a
+ *     std::span so the scan can be written as a plain loop the compiler vectorizes.
+ *   - Iterators are random access and yield a proxy (`SoAReference`) instead of a real reference. The proxy
+ *     reads/writes through to the columns, converts to `value_type` (a std::tuple), swaps element-wise and
+ *     compares like a tuple, which is what the `sort::` algorithms need. `iter_move` moves the fields out
+ *     of the columns, so sorting moves strings instead of copying them.
+ *   - `array::byColumn<I>(compare)` builds a comparator over a single field that works on both the proxy and
+ *     the tuple, e.g. `sort::quickSort(soa.begin(), soa.end(), array::byColumn<1>())`.
+ * */
+
+namespace array {
+
+template <typename... Fields> class SoAArray;
+
+namespace detail {
+
+template <bool IsConst, typename... Fields> class SoAReference {
+  template <bool, typename...> friend class SoAReference;
+
+public:
+  using value_type = std::tuple<Fields...>;
+
+private:
+  template <typename F> using Ref = std::conditional_t<IsConst, const F&, F&>;
+  std::tuple<Ref<Fields>...> m_refs;
+
+  template <typename Tuple, size_t... I> void assign(Tuple&& t, std::index_sequence<I...>) const {
+    ((std::get<I>(m_refs) = std::get<I>(std::forward<Tuple>(t))), ...);
+  }
+
+  [[nodiscard]] std::tuple<const Fields&...> crefs() const noexcept { return m_refs; }
+
+public:
+  explicit SoAReference(Ref<Fields>... fields) noexcept : m_refs(fields...) {}
+
+  // mutable proxy to const proxy, a template so it never competes with the copy constructor
+  template <bool OtherConst>
+    requires(IsConst && !OtherConst)
+  SoAReference(const SoAReference<OtherConst, Fields...>& other) noexcept : m_refs(other.m_refs) {} // NOLINT
+
+  SoAReference(const SoAReference&) noexcept = default;
+  ~SoAReference() noexcept = default;
+
+  // proxies are assigned through, they never rebind, hence the const-qualified assignments
+  const SoAReference& operator=(const SoAReference& other) const
+    requires(!IsConst)
+  {
+    assign(other.crefs(), std::index_sequence_for<Fields...>{});
+    return *this;
+  }
+
+  const SoAReference& operator=(const value_type& value) const
+    requires(!IsConst)
+  {
+    assign(value, std::index_sequence_for<Fields...>{});
+    return *this;
+  }
+
+  const SoAReference& operator=(value_type&& value) const // NOLINT
+    requires(!IsConst)
+  {
+    assign(std::move(value), std::index_sequence_for<Fields...>{});
+    return *this;
+  }
+
+  SoAReference(SoAReference&&) noexcept = default;
+
+  template <size_t I> [[nodiscard]] decltype(auto) get() const noexcept { return std::get<I>(m_refs); }
+
+  operator value_type() const { return std::make_from_tuple<value_type>(crefs()); } // NOLINT
+
+  friend void swap(SoAReference a, SoAReference b) noexcept((std::is_nothrow_swappable_v<Fields> && ...))
+    requires(!IsConst)
+  {
+    using std::swap;
+    [&]<size_t... I>(std::index_sequence<I...>) {
+      (swap(std::get<I>(a.m_refs), std::get<I>(b.m_refs)), ...);
+    }(std::index_sequence_for<Fields...>{});
+  }
+
+  template <bool OtherConst> bool operator==(const SoAReference<OtherConst, Fields...>& other) const {
+    return crefs() == other.crefs();
+  }
+  bool operator==(const value_type& value) const { return crefs() == value; }
+
+  template <bool OtherConst> auto operator<=>(const SoAReference<OtherConst, Fields...>& other) const {
+    return crefs() <=> other.crefs();
+  }
+  auto operator<=>(const value_type& value) const { return crefs() <=> value; }
+};
+
+template <size_t I, bool IsConst, typename... Fields>
+decltype(auto) get(const SoAReference<IsConst, Fields...>& ref) noexcept {
+  return ref.template get<I>();
+}
+
+template <bool IsConst, typename... Fields> class SoAIterator {
+  template <bool, typename...> friend class SoAIterator;
+  template <typename...> friend class array::SoAArray;
+
+private:
+  template <typename F> using Ptr = std::conditional_t<IsConst, const F*, F*>;
+  std::tuple<Ptr<Fields>...> m_columns;
+  std::ptrdiff_t m_index = 0;
+
+  SoAIterator(std::tuple<Ptr<Fields>...> columns, std::ptrdiff_t index)
+      : m_columns(columns), m_index(index) {}
+
+public:
+  using value_type = std::tuple<Fields...>;
+  using reference = SoAReference<IsConst, Fields...>;
+  using pointer = void;
+  using difference_type = std::ptrdiff_t;
+  // the reference is a proxy, so as a legacy iterator this is only an input iterator,
+  // C++20 algorithms (and sort::) go by iterator_concept
+  using iterator_category = std::input_iterator_tag;
+  using iterator_concept = std::random_access_iterator_tag;
+
+  SoAIterator() = default;
+
+  // mutable iterator to const iterator, a template so it never competes with the copy constructor
+  template <bool OtherConst>
+    requires(IsConst && !OtherConst)
+  SoAIterator(const SoAIterator<OtherConst, Fields...>& other) // NOLINT
+      : m_columns(other.m_columns), m_index(other.m_index) {}
+
+  reference operator*() const {
+    return std::apply([this](auto*... column) { return reference{column[m_index]...}; }, m_columns);
+  }
+
+  reference operator[](difference_type n) const { return *(*this + n); }
+
+  // moves the fields out of the columns, std::move(*it) would convert the proxy and copy every field
+  friend value_type iter_move(const SoAIterator& it)
+    requires(!IsConst)
+  {
+    auto moveOut = [&](auto*... column) { return value_type{std::move(column[it.m_index])...}; };
+    return std::apply(moveOut, it.m_columns);
+  }
+
+  SoAIterator& operator++() {
+    ++m_index;
+    return *this;
+  }
+
+  SoAIterator operator++(int) {
+    SoAIterator snapshot = *this;
+    ++m_index;
+    return snapshot;
+  }
+
+  SoAIterator& operator--() {
+    --m_index;
+    return *this;
+  }
+
+  SoAIterator operator--(int) {
+    SoAIterator snapshot = *this;
+    --m_index;
+    return snapshot;
+  }
+
+  SoAIterator& operator+=(difference_type n) {
+    m_index += n;
+    return *this;
+  }
+
+  SoAIterator& operator-=(difference_type n) {
+    m_index -= n;
+    return *this;
+  }
+
+  SoAIterator operator+(difference_type n) const { return {m_columns, m_index + n}; }
+  friend SoAIterator operator+(difference_type n, const SoAIterator& it) { return it + n; }
+  SoAIterator operator-(difference_type n) const { return {m_columns, m_index - n}; }
+  difference_type operator-(const SoAIterator& other) const { return m_index - other.m_index; }
+
+  bool operator==(const SoAIterator& other) const { return m_index == other.m_index; }
+  auto operator<=>(const SoAIterator& other) const { return m_index <=> other.m_index; }
+};
+
+} // namespace detail
+
+template <typename... Fields> class SoAArray {
+  static_assert(sizeof...(Fields) > 0, "SoAArray needs at least one field");
+
+public:
+  // columns start on their own cache line, which keeps vector loads of a column aligned
+  static constexpr size_t columnAlignment = 64;
+
+  using value_type = std::tuple<Fields...>;
+  using size_type = size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = detail::SoAReference<false, Fields...>;
+  using const_reference = detail::SoAReference<true, Fields...>;
+  using iterator = detail::SoAIterator<false, Fields...>;
+  using const_iterator = detail::SoAIterator<true, Fields...>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  template <size_t I> using column_type = std::tuple_element_t<I, value_type>;
+
+private:
+  std::tuple<Fields*...> m_columns{};
+  size_t m_length = 0;
+  size_t m_capacity = 0;
+
+  static constexpr auto indices = std::index_sequence_for<Fields...>{};
+
+  template <typename F> static constexpr std::align_val_t alignmentOf() {
+    return std::align_val_t{std::max(columnAlignment, alignof(F))};
+  }
+
+  template <typename F> static F* allocateColumn(size_t capacity) {
+    if (capacity == 0) return nullptr;
+    return static_cast<F*>(::operator new(capacity * sizeof(F), alignmentOf<F>()));
+  }
+
+  template <typename F> static void deallocateColumn(F* column) noexcept {
+    if (column == nullptr) return;
+    ::operator delete(column, alignmentOf<F>());
+  }
+
+  constexpr void checkBound(size_t index) const {
+    if (index >= m_length)
+      throw std::out_of_range(
+          "Index out of bounds, index: " + std::to_string(index) + ", size: " + std::to_string(m_length)
+      );
+  }
+
+  constexpr void assertBound(size_t index) const noexcept {
+    assert(index < m_length && "Index out of bounds");
+  }
+
+  void destroyAt(size_t index) noexcept {
+    std::apply([index](auto*... column) { (std::destroy_at(column + index), ...); }, m_columns);
+  }
+
+  void destroyRange(size_t first, size_t last) noexcept {
+    for (size_t i = first; i < last; ++i) destroyAt(i);
+  }
+
+  // constructs field I.. of element `index`; if a field throws, the fields already built are destroyed
+  template <size_t I = 0, typename... Args> void constructAt(size_t index, Args&&... args) {
+    if constexpr (I < sizeof...(Fields)) {
+      auto* column = std::get<I>(m_columns);
+      std::construct_at(column + index, std::get<I>(std::forward_as_tuple(std::forward<Args>(args)...)));
+      try {
+        constructAt<I + 1>(index, std::forward<Args>(args)...);
+      } catch (...) {
+        std::destroy_at(column + index);
+        throw;
+      }
+    }
+  }
+
+  template <typename Tuple, size_t... I>
+  void constructFromTuple(size_t index, Tuple&& t, std::index_sequence<I...>) {
+    constructAt(index, std::get<I>(std::forward<Tuple>(t))...);
+  }
+
+  void release() noexcept {
+    clear();
+    std::apply([](auto*... column) { (deallocateColumn(column), ...); }, m_columns);
+    m_columns = {};
+    m_capacity = 0;
+  }
+
+  template <typename F> F* growColumn(F* column, size_t newCapacity) {
+    F* grown = allocateColumn<F>(newCapacity);
+    constexpr bool preferMove = std::is_nothrow_move_constructible_v<F> || !std::is_copy_constructible_v<F>;
+    size_t i = 0;
+    try {
+      for (; i < m_length; ++i) {
+        if constexpr (preferMove) {
+          std::construct_at(grown + i, std::move(column[i]));
+        } else {
+          std::construct_at(grown + i, column[i]);
+        }
+      }
+    } catch (...) {
+      std::destroy_n(grown, i);
+      deallocateColumn(grown);
+      throw;
+    }
+    return grown;
+  }
+
+public:
+  SoAArray() = default;
+
+  explicit SoAArray(size_t size)
+    requires(std::default_initializable<Fields> && ...)
+  {
+    resize(size);
+  }
+
+  SoAArray(std::initializer_list<value_type> init) {
+    reserve(init.size());
+    for (const value_type& value : init) pushBack(value);
+  }
+
+  template <std::input_iterator InputIt>
+    requires std::constructible_from<value_type, std::iter_value_t<InputIt>>
+  SoAArray(InputIt first, InputIt last) {
+    if constexpr (std::forward_iterator<InputIt>) reserve(static_cast<size_t>(std::distance(first, last)));
+    for (; first != last; ++first) pushBack(value_type(*first));
+  }
+
+  SoAArray(const SoAArray& other) {
+    reserve(other.m_length);
+    for (size_t i = 0; i < other.m_length; ++i) pushBack(value_type(other[i]));
+  }
+
+  SoAArray(SoAArray&& other) noexcept
+      : m_columns(std::exchange(other.m_columns, {})), m_length(std::exchange(other.m_length, 0)),
+        m_capacity(std::exchange(other.m_capacity, 0)) {}
+
+  SoAArray& operator=(const SoAArray& other) {
+    if (&other == this) return *this;
+    SoAArray copy(other);
+    swap(copy);
+    return *this;
+  }
+
+  SoAArray& operator=(SoAArray&& other) noexcept {
+    if (&other == this) return *this;
+    release();
+    swap(other);
+    return *this;
+  }
+
+  ~SoAArray() noexcept { release(); }
+
+  void clear() noexcept {
+    destroyRange(0, m_length);
+    m_length = 0;
+  }
+
+  void reserve(size_t newCapacity) {
+    if (newCapacity <= m_capacity) return;
+
+    // grow every column before committing any, so a throwing move leaves the array untouched
+    std::tuple<Fields*...> grown{};
+    size_t done = 0;
+    try {
+      [&]<size_t... I>(std::index_sequence<I...>) {
+        ((std::get<I>(grown) = growColumn(std::get<I>(m_columns), newCapacity), ++done), ...);
+      }(indices);
+    } catch (...) {
+      [&]<size_t... I>(std::index_sequence<I...>) {
+        ((I < done ? (std::destroy_n(std::get<I>(grown), m_length), deallocateColumn(std::get<I>(grown)))
+                   : void()),
+         ...);
+      }(indices);
+      throw;
+    }
+
+    size_t length = m_length;
+    release();
+    m_columns = grown;
+    m_length = length;
+    m_capacity = newCapacity;
+  }
+
+  void resize(size_t newSize)
+    requires(std::default_initializable<Fields> && ...)
+  {
+    if (newSize > m_length) {
+      if (newSize > m_capacity) reserve(std::max(newSize, m_capacity * 2));
+      for (size_t i = m_length; i < newSize; ++i) {
+        constructAt(i, Fields{}...);
+        ++m_length;
+      }
+    } else {
+      destroyRange(newSize, m_length);
+      m_length = newSize;
+    }
+  }
+
+  // one argument per field, each column element is constructed from its argument
+  template <typename... Args>
+    requires(sizeof...(Args) == sizeof...(Fields))
+  reference emplaceBack(Args&&... args) {
+    if (m_length == m_capacity) reserve(m_capacity == 0 ? 2 : m_capacity * 2);
+    constructAt(m_length, std::forward<Args>(args)...);
+    ++m_length;
+    return back();
+  }
+
+  void pushBack(const value_type& value) {
+    if (m_length == m_capacity) reserve(m_capacity == 0 ? 2 : m_capacity * 2);
+    constructFromTuple(m_length, value, indices);
+    ++m_length;
+  }
+
+  void pushBack(value_type&& value) {
+    if (m_length == m_capacity) reserve(m_capacity == 0 ? 2 : m_capacity * 2);
+    constructFromTuple(m_length, std::move(value), indices);
+    ++m_length;
+  }
+
+  void popBack() noexcept {
+    assertBound(0);
+    destroyAt(--m_length);
+  }
+
+  reference operator[](size_t index) noexcept {
+    assertBound(index);
+    return *(begin() + static_cast<difference_type>(index));
+  }
+
+  const_reference operator[](size_t index) const noexcept {
+    assertBound(index);
+    return *(begin() + static_cast<difference_type>(index));
+  }
+
+  reference at(size_t index) {
+    checkBound(index);
+    return (*this)[index];
+  }
+
+  const_reference at(size_t index) const {
+    checkBound(index);
+    return (*this)[index];
+  }
+
+  reference front() noexcept { return (*this)[0]; }
+  const_reference front() const noexcept { return (*this)[0]; }
+  reference back() noexcept { return (*this)[m_length - 1]; }
+  const_reference back() const noexcept { return (*this)[m_length - 1]; }
+
+  /**
+   * @brief A contiguous view of one field, e.g. every priority of a SoAArray<std::string, int>.
+   * @note The span is invalidated by anything that reallocates (reserve, pushBack past capacity, ...).
+   */
+  template <size_t I> std::span<column_type<I>> column() noexcept {
+    return {std::get<I>(m_columns), m_length};
+  }
+
+  template <size_t I> std::span<const column_type<I>> column() const noexcept {
+    return {std::get<I>(m_columns), m_length};
+  }
+
+  void swap(SoAArray& other) noexcept {
+    using std::swap;
+    swap(m_columns, other.m_columns);
+    swap(m_length, other.m_length);
+    swap(m_capacity, other.m_capacity);
+  }
+
+  friend void swap(SoAArray& a, SoAArray& b) noexcept { a.swap(b); }
+
+  [[nodiscard]] size_t size() const noexcept { return m_length; }
+  [[nodiscard]] size_t capacity() const noexcept { return m_capacity; }
+  [[nodiscard]] bool empty() const noexcept { return m_length == 0; }
+
+  iterator begin() noexcept { return {m_columns, 0}; }
+  const_iterator begin() const noexcept { return {m_columns, 0}; }
+  const_iterator cbegin() const noexcept { return begin(); }
+
+  iterator end() noexcept { return {m_columns, static_cast<difference_type>(m_length)}; }
+  const_iterator end() const noexcept { return {m_columns, static_cast<difference_type>(m_length)}; }
+  const_iterator cend() const noexcept { return end(); }
+
+  reverse_iterator rbegin() noexcept { return reverse_iterator{end()}; }
+  const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator{end()}; }
+  reverse_iterator rend() noexcept { return reverse_iterator{begin()}; }
+  const_reverse_iterator rend() const noexcept { return const_reverse_iterator{begin()}; }
+};
+
+/**
+ * @brief Orders elements by a single field, usable on SoAArray proxies and on plain tuples alike.
+ * @tparam I The field (column) index.
+ */
+template <size_t I, typename Compare = std::less<>> struct ByColumn {
+  [[no_unique_address]] Compare compare; // NOLINT(misc-non-private-member-variables-in-classes)
+
+  template <typename A, typename B> bool operator()(const A& a, const B& b) const {
+    using std::get;
+    return compare(get<I>(a), get<I>(b));
+  }
+};
+
+template <size_t I, typename Compare = std::less<>> ByColumn<I, Compare> byColumn(Compare compare = {}) {
+  return {std::move(compare)};
+}
+
+} // namespace array
+
+// tuple protocol for the proxy, enables structured bindings: `auto [name, priority] = soa[0];`
+template <bool IsConst, typename... Fields>
+struct std::tuple_size<array::detail::SoAReference<IsConst, Fields...>>
+    : std::integral_constant<size_t, sizeof...(Fields)> {};
+
+template <size_t I, bool IsConst, typename... Fields>
+struct std::tuple_element<I, array::detail::SoAReference<IsConst, Fields...>> {
+  using field = std::tuple_element_t<I, std::tuple<Fields...>>;
+  using type = std::conditional_t<IsConst, const field&, field&>;
+};
+
+// the proxy and its value type share the value type as common reference, which makes the iterators
+// std::indirectly_readable (and therefore usable with the sort:: algorithms and std::ranges)
+template <
+    bool IsConst, typename... Fields, template <typename> typename TQual, template <typename> typename UQual>
+struct std::basic_common_reference<
+    array::detail::SoAReference<IsConst, Fields...>, std::tuple<Fields...>, TQual, UQual> {
+  using type = std::tuple<Fields...>;
+};
+
+template <
+    bool IsConst, typename... Fields, template <typename> typename TQual, template <typename> typename UQual>
+struct std::basic_common_reference<
+    std::tuple<Fields...>, array::detail::SoAReference<IsConst, Fields...>, TQual, UQual> {
+  using type = std::tuple<Fields...>;
+};
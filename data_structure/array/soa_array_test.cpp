@@ -0,0 +1,164 @@
+#include "./soa_array.hpp"
+#include "../../algorithm/sort/sort.hpp"
+#include "./dynamic_array.hpp"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <string>
+
+namespace {
+using Tasks = array::SoAArray<std::string, int>;
+
+Tasks makeTasks() { return Tasks{{"write", 3}, {"read", 1}, {"sync", 4}, {"idle", 0}, {"flush", 2}}; }
+
+// counts its copies, sorting should only ever move it
+// counts copies of non-empty payloads, mergeSort's buffer starts out as copies of an empty one
+struct Payload {
+  static inline size_t copies = 0;
+  std::string text;
+
+  Payload() = default;
+  explicit Payload(std::string s) : text(std::move(s)) {}
+  Payload(const Payload& other) : text(other.text) { copies += !text.empty(); }
+  Payload(Payload&&) noexcept = default;
+  Payload& operator=(const Payload& other) {
+    text = other.text;
+    copies += !text.empty();
+    return *this;
+  }
+  Payload& operator=(Payload&&) noexcept = default;
+  ~Payload() = default;
+  auto operator<=>(const Payload&) const = default;
+};
+
+bool priorityIsSorted(const Tasks& tasks) {
+  auto priorities = tasks.column<1>();
+  return std::is_sorted(priorities.begin(), priorities.end());
+}
+} // namespace
+
+TEST_CASE("SoAArray basic operations", "[array][SoAArray]") {
+  SECTION("pushBack and emplaceBack fill every column") {
+    Tasks tasks;
+    tasks.pushBack({"a", 1});
+    tasks.emplaceBack("b", 2);
+    REQUIRE(tasks.size() == 2);
+    CHECK(tasks[0].get<0>() == "a");
+    CHECK(tasks.back().get<1>() == 2);
+    CHECK(tasks[1] == std::tuple<std::string, int>{"b", 2});
+  }
+
+  SECTION("Columns are contiguous and cache line aligned") {
+    array::SoAArray<uint64_t, float> arr;
+    for (uint64_t i = 0; i < 100; ++i) arr.emplaceBack(i, 0.5F);
+    auto ids = arr.column<0>();
+    REQUIRE(ids.size() == 100);
+    CHECK(std::accumulate(ids.begin(), ids.end(), uint64_t{0}) == 4950);
+    CHECK(reinterpret_cast<uintptr_t>(ids.data()) % Tasks::columnAlignment == 0);
+    CHECK(reinterpret_cast<uintptr_t>(arr.column<1>().data()) % Tasks::columnAlignment == 0);
+  }
+
+  SECTION("Writes through the proxy reach the columns") {
+    Tasks tasks = makeTasks();
+    tasks[0] = std::tuple<std::string, int>{"rewrite", 9};
+    tasks[1].get<1>() = 7;
+    CHECK(tasks.column<0>()[0] == "rewrite");
+    CHECK(tasks.column<1>()[1] == 7);
+
+    auto [name, priority] = tasks[2];
+    priority = 10;
+    CHECK(name == "sync");
+    CHECK(tasks[2].get<1>() == 10);
+  }
+
+  SECTION("Copy, move, resize and popBack") {
+    Tasks tasks = makeTasks();
+    Tasks copy{tasks};
+    CHECK(copy[4] == tasks[4]);
+
+    Tasks moved{std::move(copy)};
+    CHECK(moved.size() == 5);
+    CHECK(copy.empty()); // NOLINT(bugprone-use-after-move)
+
+    moved.resize(7);
+    CHECK(moved[6] == std::tuple<std::string, int>{});
+    moved.popBack();
+    CHECK(moved.size() == 6);
+    REQUIRE_THROWS_AS(moved.at(6), std::out_of_range);
+  }
+}
+
+TEST_CASE("SoAArray with sort algorithms", "[array][SoAArray][sort]") {
+  STATIC_REQUIRE(std::random_access_iterator<Tasks::iterator>);
+  STATIC_REQUIRE(std::random_access_iterator<Tasks::const_iterator>);
+  STATIC_REQUIRE(std::sortable<Tasks::iterator, std::ranges::less>);
+
+  Tasks tasks = makeTasks();
+  std::mt19937 gen{42};
+
+  SECTION("quickSort") { sort::quickSort(tasks.begin(), tasks.end(), array::byColumn<1>(), &gen); }
+  SECTION("mergeSort") { sort::mergeSort(tasks.begin(), tasks.end(), array::byColumn<1>()); }
+  SECTION("heapSort") { sort::heapSort(tasks.begin(), tasks.end(), array::byColumn<1>()); }
+  SECTION("insertionSort") { sort::insertionSort(tasks.begin(), tasks.end(), array::byColumn<1>()); }
+  SECTION("std::ranges::sort") {
+    std::ranges::sort(tasks.begin(), tasks.end(), array::byColumn<1>());
+  }
+
+  CHECK(priorityIsSorted(tasks));
+  // rows are moved as a whole
+  CHECK(tasks[0] == std::tuple<std::string, int>{"idle", 0});
+  CHECK(tasks[4] == std::tuple<std::string, int>{"sync", 4});
+}
+
+TEST_CASE("Sorting an SoAArray moves its fields", "[array][SoAArray][sort]") {
+  array::SoAArray<Payload, int> rows;
+  for (int i = 0; i < 64; ++i) rows.emplaceBack(Payload{std::to_string(i)}, (i * 37) % 64);
+  Payload::copies = 0;
+  std::mt19937 gen{7};
+
+  SECTION("quickSort") { sort::quickSort(rows.begin(), rows.end(), array::byColumn<1>(), &gen); }
+  SECTION("mergeSort") { sort::mergeSort(rows.begin(), rows.end(), array::byColumn<1>()); }
+  SECTION("heapSort") { sort::heapSort(rows.begin(), rows.end(), array::byColumn<1>()); }
+  SECTION("insertionSort") { sort::insertionSort(rows.begin(), rows.end(), array::byColumn<1>()); }
+
+  CHECK(Payload::copies == 0);
+  // 45 is the inverse of 37 mod 64, row i came from the payload pushed as (i * 45) % 64
+  for (int i = 0; i < 64; ++i) {
+    REQUIRE(rows[i].get<1>() == i);
+    CHECK(rows[i].get<0>().text == std::to_string((i * 45) % 64));
+  }
+}
+
+TEST_CASE("SoAArray column scan vs array of structs", "[array][SoAArray][.benchmark]") {
+  struct Task {
+    std::string name;
+    uint64_t id;
+    int priority;
+  };
+
+  constexpr size_t n = size_t{1} << 22;
+  std::mt19937 gen{7};
+  std::uniform_int_distribution<int> dist(0, 100);
+
+  array::DynamicArray<Task> aos;
+  array::SoAArray<std::string, uint64_t, int> soa;
+  soa.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    int priority = dist(gen);
+    aos.pushBack({"task", i, priority});
+    soa.emplaceBack("task", i, priority);
+  }
+
+  BENCHMARK("AoS: sum of priorities") {
+    int64_t sum = 0;
+    for (const Task& task : aos) sum += task.priority;
+    return sum;
+  };
+
+  BENCHMARK("SoA: sum of priorities") {
+    auto priorities = soa.column<2>();
+    return std::accumulate(priorities.begin(), priorities.end(), int64_t{0});
+  };
+}
@@ -1,25 +1,31 @@
 module;
+#include "../array/small_array.hpp"
 #include "../hash_map/hash_map.hpp"
 #include "../hash_set/hash_set.hpp"
 #include "../queue/deque.hpp"
+#include <algorithm>
 #include <functional>
 #include <initializer_list>
 #include <iostream>
+#include <memory>
 #include <ranges>
 #include <stdexcept>
 
 export module graph;
 export import :utils;
 export import :detail;
+export import :csr;
+export import :bfs;
+export import :paths;
+export import :apsp;
+export import :mst;
+export import :scc;
+export import :executor;
+export import :incremental;
 
 // TODO:
 // have src/ folder
 // graph iterator
-/* implement graph
-- Floyd-Warshall vs dijkstra
-- prim's algo
-- spanning tree
-- minimum spanning tree */
 // should consider whether graph can have self-loop
 // get edges
 // find by value
@@ -27,6 +33,8 @@ export import :detail;
 
 export namespace graph {
 
+template <typename T> class DirectedGraph;
+
 template <typename T> class Node {
 public:
   using value_type = T;
@@ -34,6 +42,11 @@ public:
 private:
   value_type m_val;
   hashset::HashSet<Node<value_type>*> m_neighbors;
+  // the nodes with an edge to this one, kept by a DirectedGraph with its predecessor index enabled; null
+  // until the first one arrives, so graphs without the index pay a pointer per node and no allocation
+  std::unique_ptr<hashset::HashSet<Node<value_type>*>> m_predecessors;
+
+  friend class DirectedGraph<T>;
 
 public:
   Node(const T& val) : m_val(val) {}
@@ -46,6 +59,11 @@ public:
   constexpr hashset::HashSet<Node<value_type>*>& neighbors() noexcept { return m_neighbors; }
   constexpr const hashset::HashSet<Node<value_type>*>& neighbors() const noexcept { return m_neighbors; }
   constexpr value_type val() const noexcept { return m_val; }
+
+  // null if the owning graph keeps no predecessor index or nothing points here yet
+  constexpr const hashset::HashSet<Node<value_type>*>* predecessors() const noexcept {
+    return m_predecessors.get();
+  }
 };
 
 template <typename T> class Graph {
@@ -101,7 +119,8 @@ public:
     return newNode;
   }
 
-  bool removeVertex(Node<T>* vertex) {
+  // O(V): every other vertex may have an edge to vertex
+  virtual bool removeVertex(Node<T>* vertex) {
     size_t targetIdx = m_nodes.size();
     for (size_t i = 0; i < m_nodes.size(); ++i) {
       Node<T>* node = m_nodes[i];
@@ -151,9 +170,10 @@ public:
     return src->neighbors().contains(dest);
   }
 
-  array::DynamicArray<Node<T>*> getNeighbors(const Node<T>* vertex) const {
+  // most vertices have a handful of neighbors, those are returned without touching the heap
+  array::SmallArray<Node<T>*, 8> getNeighbors(const Node<T>* vertex) const {
     if (vertex == nullptr) throw std::invalid_argument("vertex can not be nullptr");
-    array::DynamicArray<Node<T>*> neighbors;
+    array::SmallArray<Node<T>*, 8> neighbors;
     neighbors.reserve(vertex->neighbors().size());
     for (Node<T>* nei : vertex->neighbors()) neighbors.pushBack(nei);
     return neighbors;
@@ -198,27 +218,112 @@ public:
  * @details This graph models relationships using the **Flow Direction** convention:
  * - An edge from node A to node B (`src -> dest`) means **A must happen BEFORE B**.
  * - Therefore, calling `node->neighbors()` returns the **downstream tasks** that depend on this node.
- * - To find prerequisites instead, you can inspect the incoming degrees (`inDegree`).
+ * - To find prerequisites instead, you can inspect the incoming degrees (`inDegree`) or `getPredecessors`.
  *
  * @note This structure is perfectly optimized for post-order DFS topological sorting.
+ *
+ * Without an index, the incoming edges of a vertex are only found by scanning every vertex, which makes
+ * `inDegree`, `totalDegree`, `getPredecessors` and `removeVertex` O(V). `enablePredecessorIndex()` keeps a
+ * reverse adjacency set in every node, maintained by `addEdge` and `removeEdge`, and those operations become
+ * proportional to the vertex's degree, at the cost of a second hash set entry per edge. Edges must then only
+ * change through the graph, not through `node->neighbors()`.
  */
 template <typename T> class DirectedGraph : public Graph<T> {
+private:
+  bool m_predecessorIndex = false;
+
+  static hashset::HashSet<Node<T>*>& predecessorsOf(Node<T>* vertex) {
+    if (!vertex->m_predecessors) vertex->m_predecessors = std::make_unique<hashset::HashSet<Node<T>*>>();
+    return *vertex->m_predecessors;
+  }
+
 public:
   using Graph<T>::Graph;
   DirectedGraph(std::initializer_list<std::pair<T, T>> edges) { this->fromEdges(edges); }
+  DirectedGraph(const DirectedGraph& other) : Graph<T>(other) {
+    if (other.m_predecessorIndex) enablePredecessorIndex();
+  }
+  DirectedGraph(DirectedGraph&& other) noexcept
+      : Graph<T>(std::move(other)), m_predecessorIndex(other.m_predecessorIndex) {}
   DirectedGraph& operator=(DirectedGraph other) {
     this->swap(other);
     return *this;
   }
 
+  /**
+   * @brief Builds the reverse adjacency index in O(V + E) and keeps it up to date from now on.
+   */
+  void enablePredecessorIndex() {
+    if (m_predecessorIndex) return;
+    try {
+      for (Node<T>* node : this->m_nodes) {
+        for (Node<T>* nei : node->neighbors()) predecessorsOf(nei).insert(node);
+      }
+    } catch (...) {
+      disablePredecessorIndex();
+      throw;
+    }
+    m_predecessorIndex = true;
+  }
+
+  void disablePredecessorIndex() noexcept {
+    for (Node<T>* node : this->m_nodes) node->m_predecessors.reset();
+    m_predecessorIndex = false;
+  }
+
+  [[nodiscard]] bool hasPredecessorIndex() const noexcept { return m_predecessorIndex; }
+
   void addEdge(Node<T>* src, Node<T>* dest) override {
     if (src == nullptr || dest == nullptr) return;
     src->neighbors().insert(dest);
+    if (!m_predecessorIndex) return;
+    try {
+      predecessorsOf(dest).insert(src);
+    } catch (...) {
+      src->neighbors().erase(dest);
+      throw;
+    }
   }
 
   void removeEdge(Node<T>* src, Node<T>* dest) override {
     if (src == nullptr || dest == nullptr) return;
     src->neighbors().erase(dest);
+    if (m_predecessorIndex && dest->m_predecessors) dest->m_predecessors->erase(src);
+  }
+
+  // with the predecessor index, O(in-degree + out-degree) to detach vertex, plus a scan of the node array
+  bool removeVertex(Node<T>* vertex) override {
+    if (!m_predecessorIndex) return Graph<T>::removeVertex(vertex);
+    auto position = std::ranges::find(this->m_nodes, vertex);
+    if (position == this->m_nodes.end()) return false;
+
+    if (vertex->m_predecessors) {
+      for (Node<T>* pred : *vertex->m_predecessors) pred->neighbors().erase(vertex);
+    }
+    for (Node<T>* succ : vertex->neighbors()) {
+      if (succ != vertex && succ->m_predecessors) succ->m_predecessors->erase(vertex);
+    }
+    // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+    delete vertex;
+    this->m_nodes.erase(position);
+    return true;
+  }
+
+  // like getNeighbors, for the incoming edges
+  array::SmallArray<Node<T>*, 8> getPredecessors(const Node<T>* vertex) const {
+    if (vertex == nullptr) throw std::invalid_argument("vertex can not be nullptr");
+    array::SmallArray<Node<T>*, 8> predecessors;
+    if (m_predecessorIndex) {
+      if (!vertex->m_predecessors) return predecessors;
+      predecessors.reserve(vertex->m_predecessors->size());
+      for (Node<T>* pred : *vertex->m_predecessors) predecessors.pushBack(pred);
+      return predecessors;
+    }
+    auto* key = const_cast<Node<T>*>(vertex); // NOLINT(cppcoreguidelines-pro-type-const-cast), lookup only
+    for (Node<T>* node : this->m_nodes) {
+      if (node->neighbors().contains(key)) predecessors.pushBack(node);
+    }
+    return predecessors;
   }
 
   [[nodiscard]] constexpr bool directed() const noexcept override { return true; }
@@ -231,9 +336,11 @@ public:
 
   constexpr size_t inDegree(const Node<T>* vertex) const noexcept {
     if (vertex == nullptr) return 0;
+    if (m_predecessorIndex) return vertex->m_predecessors ? vertex->m_predecessors->size() : 0;
+    auto* key = const_cast<Node<T>*>(vertex); // NOLINT(cppcoreguidelines-pro-type-const-cast), lookup only
     size_t count = 0;
     for (const Node<T>* node : this->m_nodes) {
-      if (node->neighbors().contains(vertex)) ++count;
+      if (node->neighbors().contains(key)) ++count;
     }
     return count;
   }
@@ -248,14 +355,12 @@ public:
     return inDegree(vertex) + outDegree(vertex);
   }
 
-  [[nodiscard]] constexpr bool hasCycle() const noexcept override {
-    auto [valid, _] = graph::utils::topologicalSort(*this);
-    return !valid;
-  }
+  [[nodiscard]] constexpr bool hasCycle() const noexcept override { return graph::utils::hasCycle(*this); }
 
   constexpr void swap(DirectedGraph& other) noexcept {
     using std::swap;
     swap(this->m_nodes, other.m_nodes);
+    swap(m_predecessorIndex, other.m_predecessorIndex);
   }
 
   friend void swap(DirectedGraph& a, DirectedGraph& b) noexcept { a.swap(b); }
@@ -283,6 +388,19 @@ public:
     if (src != dest) dest->neighbors().erase(src);
   }
 
+  // O(degree) to detach vertex as every edge is in the neighbor sets of both ends, plus a scan of the nodes
+  bool removeVertex(Node<T>* vertex) override {
+    auto position = std::ranges::find(this->m_nodes, vertex);
+    if (position == this->m_nodes.end()) return false;
+    for (Node<T>* nei : vertex->neighbors()) {
+      if (nei != vertex) nei->neighbors().erase(vertex);
+    }
+    // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+    delete vertex;
+    this->m_nodes.erase(position);
+    return true;
+  }
+
   [[nodiscard]] constexpr bool directed() const noexcept override { return false; }
 
   [[nodiscard]] constexpr size_t edgeCount() const noexcept override {
@@ -0,0 +1,288 @@
+module;
+#include "../array/dynamic_array.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+export module graph:apsp;
+import :csr;
+import thread_pool;
+
+/*
+ * All-pairs shortest paths over a dense distance matrix with a blocked Floyd–Warshall.
+ *
+ * The matrix is row-major, its row stride padded to a multiple of 64 and cut into 64 x 64 tiles (16 KiB of
+ * distances, they stay in L1/L2 while a tile is relaxed). Round b relaxes every pair through the vertices of
+ * tile row b, in three phases:
+ *   1. the diagonal tile (b, b) on its own,
+ *   2. the rest of tile row b and tile column b, each tile only needing itself and the diagonal tile,
+ *   3. all the other tiles, tile (i, j) needing (i, b) and (b, j) which phase 2 finished.
+ * The tiles of phase 2 and of phase 3 are independent of each other and run in parallel on the thread pool.
+ * The innermost min-plus loop, row[j] = min(row[j], a + kRow[j]), uses AVX2 when the build targets it,
+ * SSE2 on any other x86-64 build, and a plain loop elsewhere.
+ *
+ * Distances are 32-bit: unreachable is 2^31 - 1, so adding two distances never overflows, and a path
+ * longer than that counts as unreachable. Paths are kept as the intermediate vertex of the last improvement
+ * of each pair: path(i, j) expands (i, via, j) recursively until only direct edges are left.
+ * */
+
+export namespace graph::utils {
+
+class DistanceMatrix {
+public:
+  using vertex_type = CsrGraph::vertex_type;
+  using distance_type = uint32_t;
+  static constexpr distance_type unreachable = std::numeric_limits<distance_type>::max() / 2;
+  static constexpr size_t tileSize = 64;
+
+private:
+  // the via entry of a pair whose distance is a direct edge (or 0 on the diagonal)
+  static constexpr vertex_type direct = std::numeric_limits<vertex_type>::max();
+
+  size_t m_size = 0;
+  size_t m_stride = 0;
+  array::DynamicArray<distance_type> m_distances;
+  array::DynamicArray<vertex_type> m_via; // stride x stride when paths are tracked, empty otherwise
+
+  void checkPair(size_t from, size_t to) const {
+    if (from >= m_size || to >= m_size) {
+      throw std::out_of_range(
+          "DistanceMatrix: pair out of range, (" + std::to_string(from) + ", " + std::to_string(to) + ")"
+      );
+    }
+  }
+
+  // row[j] = min(row[j], a + kRow[j]) over one tile row, recording k where it improves when via is given
+  static void minPlusRow(
+      distance_type* row, const distance_type* kRow, distance_type a, vertex_type* via, vertex_type k
+  ) noexcept {
+#if defined(__AVX2__)
+    __m256i broadcast = _mm256_set1_epi32(static_cast<int>(a));
+    __m256i through = _mm256_set1_epi32(static_cast<int>(k));
+    for (size_t j = 0; j < tileSize; j += 8) {
+      auto* target = reinterpret_cast<__m256i*>(row + j); // NOLINT
+      __m256i current = _mm256_loadu_si256(target);
+      __m256i distances = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(kRow + j)); // NOLINT
+      __m256i candidate = _mm256_add_epi32(broadcast, distances);
+      __m256i best = _mm256_min_epu32(current, candidate);
+      _mm256_storeu_si256(target, best);
+      if (via != nullptr) {
+        __m256i unchanged = _mm256_cmpeq_epi32(best, current);
+        auto* viaTarget = reinterpret_cast<__m256i*>(via + j); // NOLINT
+        _mm256_storeu_si256(viaTarget, _mm256_blendv_epi8(through, _mm256_loadu_si256(viaTarget), unchanged));
+      }
+    }
+#elif defined(__SSE2__)
+    // SSE2 has no unsigned 32-bit min or compare, flipping the sign bits makes the signed compare unsigned
+    __m128i bias = _mm_set1_epi32(std::numeric_limits<int32_t>::min());
+    __m128i broadcast = _mm_set1_epi32(static_cast<int>(a));
+    __m128i through = _mm_set1_epi32(static_cast<int>(k));
+    for (size_t j = 0; j < tileSize; j += 4) {
+      auto* target = reinterpret_cast<__m128i*>(row + j); // NOLINT
+      __m128i current = _mm_loadu_si128(target);
+      __m128i distances = _mm_loadu_si128(reinterpret_cast<const __m128i*>(kRow + j)); // NOLINT
+      __m128i candidate = _mm_add_epi32(broadcast, distances);
+      __m128i better = _mm_cmpgt_epi32(_mm_xor_si128(current, bias), _mm_xor_si128(candidate, bias));
+      __m128i best = _mm_or_si128(_mm_and_si128(better, candidate), _mm_andnot_si128(better, current));
+      _mm_storeu_si128(target, best);
+      if (via != nullptr) {
+        auto* viaTarget = reinterpret_cast<__m128i*>(via + j); // NOLINT
+        __m128i old = _mm_loadu_si128(viaTarget);
+        __m128i updatedVia = _mm_or_si128(_mm_and_si128(better, through), _mm_andnot_si128(better, old));
+        _mm_storeu_si128(viaTarget, updatedVia);
+      }
+    }
+#else
+    if (via == nullptr) {
+      for (size_t j = 0; j < tileSize; ++j) row[j] = std::min(row[j], a + kRow[j]);
+      return;
+    }
+    for (size_t j = 0; j < tileSize; ++j) {
+      distance_type candidate = a + kRow[j];
+      if (candidate >= row[j]) continue;
+      row[j] = candidate;
+      via[j] = k;
+    }
+#endif
+  }
+
+  // relaxes tile c through the vertices of its tile round, a = (row of c, round), b = (round, column of c)
+  void relaxTile(size_t row, size_t column, size_t round, bool trackPaths) noexcept {
+    size_t first = round * tileSize;
+    distance_type* c = m_distances.data() + (row * tileSize * m_stride) + (column * tileSize);
+    const distance_type* a = m_distances.data() + (row * tileSize * m_stride) + first;
+    const distance_type* b = m_distances.data() + (first * m_stride) + (column * tileSize);
+    vertex_type* via = nullptr;
+    if (trackPaths) via = m_via.data() + (row * tileSize * m_stride) + (column * tileSize);
+
+    // a, b and c alias in phases 1 and 2, which is fine: the row and column k don't change in step k
+    for (size_t k = 0; k < tileSize; ++k) {
+      const distance_type* kRow = b + (k * m_stride);
+      for (size_t i = 0; i < tileSize; ++i) {
+        distance_type aik = a[(i * m_stride) + k];
+        if (aik == unreachable) continue;
+        minPlusRow(
+            c + (i * m_stride), kRow, aik, via != nullptr ? via + (i * m_stride) : nullptr,
+            static_cast<vertex_type>(first + k)
+        );
+      }
+    }
+  }
+
+public:
+  /**
+   * @brief vertexCount x vertexCount distances, 0 on the diagonal and unreachable everywhere else.
+   */
+  explicit DistanceMatrix(size_t vertexCount = 0)
+      : m_size(vertexCount), m_stride((vertexCount + tileSize - 1) / tileSize * tileSize),
+        m_distances(m_stride * m_stride, unreachable) {
+    for (size_t v = 0; v < m_size; ++v) m_distances[(v * m_stride) + v] = 0;
+  }
+
+  /**
+   * @brief The direct distances of graph: the lightest edge between two vertices, 1 on unweighted graphs.
+   * @throw std::invalid_argument if a weight is not below unreachable.
+   */
+  static DistanceMatrix fromGraph(const CsrGraph& graph) {
+    DistanceMatrix matrix(graph.vertexCount());
+    for (vertex_type u : graph.vertices()) {
+      auto neighbors = graph.neighbors(u);
+      auto weights = graph.weights(u);
+      for (size_t e = 0; e < neighbors.size(); ++e) {
+        distance_type weight = graph.weighted() ? weights[e] : 1;
+        if (weight >= unreachable) {
+          throw std::invalid_argument("DistanceMatrix: edge weight too large, " + std::to_string(weight));
+        }
+        if (neighbors[e] != u) matrix.m_distances[(u * matrix.m_stride) + neighbors[e]] = weight;
+      }
+    }
+    return matrix;
+  }
+
+  friend void floydWarshall(DistanceMatrix& matrix, bool trackPaths, concurrency::ThreadPool& pool);
+
+  /**
+   * @brief The vertices of a shortest path from `from` to `to`, both included, empty if `to` is unreachable.
+   * @throw std::logic_error if floydWarshall didn't track paths, std::out_of_range for a bad pair.
+   */
+  [[nodiscard]] array::DynamicArray<vertex_type> path(vertex_type from, vertex_type to) const {
+    checkPair(from, to);
+    if (!tracksPaths()) throw std::logic_error("DistanceMatrix: paths were not tracked");
+    array::DynamicArray<vertex_type> result;
+    if ((*this)(from, to) == unreachable) return result;
+
+    // every via splits a pair in two with strictly shorter distances, the expansion always ends
+    result.pushBack(from);
+    array::DynamicArray<std::pair<vertex_type, vertex_type>> pending{{from, to}};
+    while (!pending.empty()) {
+      auto [start, end] = pending.back();
+      pending.popBack();
+      if (start == end) continue;
+      vertex_type via = m_via[(start * m_stride) + end];
+      if (via == direct) {
+        result.pushBack(end);
+        continue;
+      }
+      pending.pushBack({via, end});
+      pending.pushBack({start, via});
+    }
+    return result;
+  }
+
+  [[nodiscard]] distance_type operator()(size_t from, size_t to) const noexcept {
+    return m_distances[(from * m_stride) + to];
+  }
+
+  [[nodiscard]] distance_type& operator()(size_t from, size_t to) noexcept {
+    return m_distances[(from * m_stride) + to];
+  }
+
+  [[nodiscard]] distance_type at(size_t from, size_t to) const {
+    checkPair(from, to);
+    return (*this)(from, to);
+  }
+
+  [[nodiscard]] bool tracksPaths() const noexcept { return !m_via.empty(); }
+  [[nodiscard]] size_t size() const noexcept { return m_size; }
+  // the distance from i to j is at data()[i * stride() + j]
+  [[nodiscard]] size_t stride() const noexcept { return m_stride; }
+  [[nodiscard]] const distance_type* data() const noexcept { return m_distances.data(); }
+};
+
+/**
+ * @brief Replaces every distance by the shortest path distance, in place. Distances must be below
+ *        unreachable or equal to it, and the diagonal 0 (no negative weights).
+ * @param trackPaths Keep what path() needs, one more vertex per pair.
+ */
+inline void floydWarshall(
+    DistanceMatrix& matrix, bool trackPaths = false,
+    concurrency::ThreadPool& pool = concurrency::ThreadPool::shared()
+) {
+  size_t tiles = matrix.m_stride / DistanceMatrix::tileSize;
+  if (trackPaths) {
+    matrix.m_via = array::DynamicArray<DistanceMatrix::vertex_type>(
+        matrix.m_stride * matrix.m_stride, DistanceMatrix::direct
+    );
+  } else {
+    matrix.m_via = {};
+  }
+
+  for (size_t round = 0; round < tiles; ++round) {
+    matrix.relaxTile(round, round, round, trackPaths);
+    if (tiles == 1) break;
+
+    // tile row `round` and tile column `round`, the diagonal skipped
+    pool.parallelFor(
+        0, 2 * (tiles - 1),
+        [&](size_t begin, size_t end) {
+          for (size_t t = begin; t < end; ++t) {
+            size_t other = t % (tiles - 1);
+            other += other >= round ? 1 : 0;
+            if (t < tiles - 1) {
+              matrix.relaxTile(round, other, round, trackPaths);
+            } else {
+              matrix.relaxTile(other, round, round, trackPaths);
+            }
+          }
+        },
+        1
+    );
+
+    pool.parallelFor(
+        0, (tiles - 1) * (tiles - 1),
+        [&](size_t begin, size_t end) {
+          for (size_t t = begin; t < end; ++t) {
+            size_t row = t / (tiles - 1);
+            size_t column = t % (tiles - 1);
+            matrix.relaxTile(
+                row + (row >= round ? 1 : 0), column + (column >= round ? 1 : 0), round, trackPaths
+            );
+          }
+        },
+        1
+    );
+  }
+}
+
+/**
+ * @brief All-pairs shortest path distances of graph, see DistanceMatrix.
+ * @throw std::invalid_argument if a weight is not below DistanceMatrix::unreachable.
+ */
+inline DistanceMatrix floydWarshall(
+    const CsrGraph& graph, bool trackPaths = false,
+    concurrency::ThreadPool& pool = concurrency::ThreadPool::shared()
+) {
+  DistanceMatrix matrix = DistanceMatrix::fromGraph(graph);
+  floydWarshall(matrix, trackPaths, pool);
+  return matrix;
+}
+
+} // namespace graph::utils
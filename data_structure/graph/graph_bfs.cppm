@@ -0,0 +1,293 @@
+module;
+#include "../array/dynamic_array.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+export module graph:bfs;
+import :csr;
+import thread_pool;
+
+/*
+ * A parallel, direction-optimizing breadth-first search over a CsrGraph (Beamer, Asanović, Patterson).
+ *
+ *   - Top-down step: every frontier vertex claims its unvisited neighbors. The work is the out-edges of the
+ *     frontier, which is little while the frontier is small.
+ *   - Bottom-up step: every unvisited vertex scans its in-neighbors and stops at the first one in the
+ *     frontier. Once the frontier holds a big part of the graph most vertices stop after a few edges, far
+ *     fewer than the top-down step would examine.
+ *   - The search starts top-down, switches to bottom-up once the out-edges of the frontier exceed
+ *     1 / alpha of the edges left unexplored, and back once the frontier shrinks below vertexCount / beta.
+ *
+ * The top-down frontier is an array of vertices, the bottom-up frontier a bitmap. Visited vertices are a
+ * bitmap too: top-down steps claim a vertex with an atomic fetch_or, so exactly one parent wins it.
+ * Bottom-up steps hand out whole 64-bit words to the workers, a word is only ever written by one of them.
+ * Directed graphs need their in-neighbors for bottom-up steps, ParallelBfs keeps a transpose around.
+ * */
+
+export namespace graph::utils {
+
+enum class BfsDirection : uint8_t { Optimizing, TopDown, BottomUp };
+
+struct BfsOptions {
+  BfsDirection direction = BfsDirection::Optimizing;
+  size_t alpha = 14;
+  size_t beta = 24;
+};
+
+struct BfsResult {
+  static constexpr uint32_t unreachable = std::numeric_limits<uint32_t>::max();
+  static constexpr CsrGraph::vertex_type noParent = std::numeric_limits<CsrGraph::vertex_type>::max();
+
+  array::DynamicArray<uint32_t> distances;            // hops from the root, unreachable if never reached
+  array::DynamicArray<CsrGraph::vertex_type> parents; // the root is its own parent, noParent if unreached
+  size_t reached = 0;                                 // reached vertices, the root included
+  size_t topDownSteps = 0;
+  size_t bottomUpSteps = 0;
+};
+
+class ParallelBfs {
+public:
+  using vertex_type = CsrGraph::vertex_type;
+
+private:
+  static constexpr size_t wordBits = 64;
+  using Bitmap = array::DynamicArray<uint64_t>;
+
+  const CsrGraph& m_graph;
+  CsrGraph m_incoming; // the transpose of a directed graph, unused for undirected ones
+  concurrency::ThreadPool& m_pool;
+  BfsOptions m_options;
+
+  // vertices newly reached by a step, and the sum of their out-degrees
+  struct StepCount {
+    size_t vertices = 0;
+    size_t edges = 0;
+  };
+
+  struct State {
+    BfsResult result;
+    Bitmap visited;
+    uint32_t depth = 0;
+  };
+
+  [[nodiscard]] const CsrGraph& incoming() const noexcept {
+    return m_graph.directed() ? m_incoming : m_graph;
+  }
+
+  [[nodiscard]] size_t grain(size_t count, size_t minimum) const noexcept {
+    return std::max(minimum, count / (m_pool.size() * 8));
+  }
+
+  static bool test(const Bitmap& bits, vertex_type v) noexcept {
+    return ((bits[v / wordBits] >> (v % wordBits)) & 1) != 0;
+  }
+
+  // sets the bit of v, true if this call was the one to set it
+  static bool claim(Bitmap& bits, vertex_type v) noexcept {
+    std::atomic_ref<uint64_t> word(bits[v / wordBits]);
+    uint64_t mask = uint64_t{1} << (v % wordBits);
+    if ((word.load(std::memory_order_relaxed) & mask) != 0) return false; // skip the RMW when it's taken
+    return (word.fetch_or(mask, std::memory_order_relaxed) & mask) == 0;
+  }
+
+  StepCount topDownStep(
+      State& state, const array::DynamicArray<vertex_type>& frontier, size_t frontierSize,
+      array::DynamicArray<vertex_type>& next
+  ) const {
+    std::atomic<size_t> cursor{0};
+    std::atomic<size_t> edges{0};
+    m_pool.parallelFor(
+        0, frontierSize,
+        [&](size_t begin, size_t end) {
+          array::DynamicArray<vertex_type> found;
+          size_t foundEdges = 0;
+          for (size_t i = begin; i < end; ++i) {
+            vertex_type u = frontier[i];
+            for (vertex_type v : m_graph.neighbors(u)) {
+              if (!claim(state.visited, v)) continue;
+              state.result.parents[v] = u;
+              state.result.distances[v] = state.depth;
+              found.pushBack(v);
+              foundEdges += m_graph.outDegree(v);
+            }
+          }
+          size_t at = cursor.fetch_add(found.size(), std::memory_order_relaxed);
+          std::copy(found.begin(), found.end(), next.data() + at);
+          edges.fetch_add(foundEdges, std::memory_order_relaxed);
+        },
+        grain(frontierSize, 256)
+    );
+    return {cursor.load(), edges.load()};
+  }
+
+  StepCount bottomUpStep(State& state, const Bitmap& frontier, Bitmap& next) const {
+    const CsrGraph& in = incoming();
+    std::atomic<size_t> vertices{0};
+    std::atomic<size_t> edges{0};
+    m_pool.parallelFor(
+        0, state.visited.size(),
+        [&](size_t begin, size_t end) {
+          size_t foundVertices = 0;
+          size_t foundEdges = 0;
+          for (size_t w = begin; w < end; ++w) {
+            uint64_t found = 0;
+            for (uint64_t unvisited = ~state.visited[w]; unvisited != 0; unvisited &= unvisited - 1) {
+              auto bit = static_cast<size_t>(std::countr_zero(unvisited));
+              auto v = static_cast<vertex_type>((w * wordBits) + bit);
+              for (vertex_type u : in.neighbors(v)) {
+                if (!test(frontier, u)) continue;
+                state.result.parents[v] = u;
+                state.result.distances[v] = state.depth;
+                found |= uint64_t{1} << bit;
+                ++foundVertices;
+                foundEdges += m_graph.outDegree(v);
+                break;
+              }
+            }
+            state.visited[w] |= found;
+            next[w] = found;
+          }
+          vertices.fetch_add(foundVertices, std::memory_order_relaxed);
+          edges.fetch_add(foundEdges, std::memory_order_relaxed);
+        },
+        grain(state.visited.size(), 16)
+    );
+    return {vertices.load(), edges.load()};
+  }
+
+  void toBitmap(const array::DynamicArray<vertex_type>& frontier, size_t frontierSize, Bitmap& bits) const {
+    std::fill(bits.begin(), bits.end(), 0);
+    m_pool.parallelFor(
+        0, frontierSize,
+        [&](size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) claim(bits, frontier[i]);
+        },
+        grain(frontierSize, 1024)
+    );
+  }
+
+  size_t toQueue(const Bitmap& bits, array::DynamicArray<vertex_type>& frontier) const {
+    std::atomic<size_t> cursor{0};
+    m_pool.parallelFor(
+        0, bits.size(),
+        [&](size_t begin, size_t end) {
+          array::DynamicArray<vertex_type> found;
+          for (size_t w = begin; w < end; ++w) {
+            for (uint64_t word = bits[w]; word != 0; word &= word - 1) {
+              found.pushBack(static_cast<vertex_type>((w * wordBits) + std::countr_zero(word)));
+            }
+          }
+          size_t at = cursor.fetch_add(found.size(), std::memory_order_relaxed);
+          std::copy(found.begin(), found.end(), frontier.data() + at);
+        },
+        grain(bits.size(), 16)
+    );
+    return cursor.load();
+  }
+
+public:
+  /**
+   * @brief Prepares searches over graph, which must outlive this object. A directed graph is transposed
+   *        here, once for all the searches, unless options only allow top-down steps.
+   */
+  explicit ParallelBfs(
+      const CsrGraph& graph, BfsOptions options = {},
+      concurrency::ThreadPool& pool = concurrency::ThreadPool::shared()
+  )
+      : m_graph(graph), m_pool(pool), m_options(options) {
+    if (m_options.alpha == 0 || m_options.beta == 0) {
+      throw std::invalid_argument("ParallelBfs: alpha and beta must be positive");
+    }
+    if (graph.directed() && options.direction != BfsDirection::TopDown) m_incoming = graph.transpose();
+  }
+
+  ParallelBfs(CsrGraph&&, BfsOptions = {}, concurrency::ThreadPool& = concurrency::ThreadPool::shared()) =
+      delete;
+
+  /**
+   * @brief Searches from root. Distances are exact, parents form a BFS tree, though which of several
+   *        equally near parents a vertex gets depends on the schedule.
+   * @throw std::out_of_range if root is not a vertex of the graph.
+   */
+  [[nodiscard]] BfsResult run(vertex_type root) const {
+    size_t n = m_graph.vertexCount();
+    if (root >= n) throw std::out_of_range("ParallelBfs: root out of range, " + std::to_string(root));
+
+    size_t words = (n + wordBits - 1) / wordBits;
+    State state;
+    state.result.distances = array::DynamicArray<uint32_t>(n, BfsResult::unreachable);
+    state.result.parents = array::DynamicArray<vertex_type>(n, BfsResult::noParent);
+    state.visited = Bitmap(words, 0);
+    // the bits past the last vertex count as visited, bottom-up steps never look at them
+    if (n % wordBits != 0) state.visited[words - 1] = ~uint64_t{0} << (n % wordBits);
+
+    array::DynamicArray<vertex_type> frontier(n, 0);
+    array::DynamicArray<vertex_type> nextFrontier(n, 0);
+    Bitmap frontierBits(words, 0);
+    Bitmap nextBits(words, 0);
+
+    claim(state.visited, root);
+    state.result.parents[root] = root;
+    state.result.distances[root] = 0;
+    state.result.reached = 1;
+    frontier[0] = root;
+
+    StepCount current{1, m_graph.outDegree(root)};
+    size_t unexploredEdges = m_graph.arcCount() - current.edges;
+    bool bottomUp = m_options.direction == BfsDirection::BottomUp;
+    bool bitmapFrontier = false;
+    if (bottomUp) {
+      toBitmap(frontier, 1, frontierBits);
+      bitmapFrontier = true;
+    }
+
+    size_t previousVertices = 0;
+    while (current.vertices != 0) {
+      if (m_options.direction == BfsDirection::Optimizing) {
+        if (!bottomUp) {
+          bottomUp = current.edges > unexploredEdges / m_options.alpha;
+        } else {
+          bottomUp = current.vertices >= n / m_options.beta || current.vertices > previousVertices;
+        }
+      }
+      ++state.depth;
+      previousVertices = current.vertices;
+
+      if (bottomUp) {
+        if (!bitmapFrontier) toBitmap(frontier, current.vertices, frontierBits);
+        current = bottomUpStep(state, frontierBits, nextBits);
+        std::swap(frontierBits, nextBits);
+        bitmapFrontier = true;
+        ++state.result.bottomUpSteps;
+      } else {
+        size_t frontierSize = bitmapFrontier ? toQueue(frontierBits, frontier) : current.vertices;
+        current = topDownStep(state, frontier, frontierSize, nextFrontier);
+        std::swap(frontier, nextFrontier);
+        bitmapFrontier = false;
+        ++state.result.topDownSteps;
+      }
+      state.result.reached += current.vertices;
+      unexploredEdges -= current.edges;
+    }
+    return std::move(state.result);
+  }
+};
+
+/**
+ * @brief A direction-optimizing parallel BFS from root, see ParallelBfs. Searching the same directed graph
+ *        from several roots is cheaper with one ParallelBfs, it transposes the graph only once.
+ */
+inline BfsResult parallelBfs(
+    const CsrGraph& graph, CsrGraph::vertex_type root, BfsOptions options = {},
+    concurrency::ThreadPool& pool = concurrency::ThreadPool::shared()
+) {
+  return ParallelBfs(graph, options, pool).run(root);
+}
+
+} // namespace graph::utils
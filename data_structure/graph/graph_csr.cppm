@@ -0,0 +1,253 @@
+module;
+#include "../array/dynamic_array.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+export module graph:csr;
+import :detail;
+
+/*
+ * CsrGraph is an immutable graph in compressed sparse row form: vertices are dense ids 0 .. n - 1, and the
+ * out-neighbors of v are targets[offsets[v] .. offsets[v + 1]), sorted, in one contiguous array.
+ *
+ *   offsets: [0, 2, 3, 3]          vertex 0 -> {1, 2}
+ *   targets: [1, 2, 2]             vertex 1 -> {2}, vertex 2 -> {}
+ *
+ * A traversal reads two flat arrays instead of chasing a Node and a hash table per vertex, and an edge costs
+ * 4 bytes instead of a heap allocated bucket entry. Like Graph, a CsrGraph holds no parallel edges.
+ * Undirected graphs store every edge in both rows (a self-loop once), so neighbors() is the same for both.
+ *
+ * A weighted CsrGraph keeps one more array parallel to targets, weights(v) lines up with neighbors(v). Of
+ * repeated edges the lightest one is kept. Unweighted graphs leave it empty, algorithms taking weights
+ * treat their edges as weight 1.
+ * */
+
+export namespace graph {
+template <typename T> class Graph; // Forward declaration
+template <typename T> class Node;  // Forward declaration
+
+class CsrGraph {
+public:
+  using vertex_type = uint32_t;
+  using edge_index = uint64_t;
+  using weight_type = uint32_t;
+
+private:
+  // vertexCount + 1 entries, the row of v is [m_offsets[v], m_offsets[v + 1])
+  array::DynamicArray<edge_index> m_offsets = array::DynamicArray<edge_index>(1, 0);
+  array::DynamicArray<vertex_type> m_targets;
+  array::DynamicArray<weight_type> m_weights; // parallel to m_targets, empty for an unweighted graph
+  size_t m_selfLoops = 0;
+  bool m_directed = true;
+
+  static void checkVertexCount(size_t vertexCount) {
+    if (vertexCount >= std::numeric_limits<vertex_type>::max()) {
+      throw std::length_error("CsrGraph: too many vertices, " + std::to_string(vertexCount));
+    }
+  }
+
+  // one row per vertex, rows left to be filled
+  CsrGraph(size_t vertexCount, bool directed) : m_offsets(vertexCount + 1, 0), m_directed(directed) {}
+
+  // sorts every row and drops repeated targets, compacting the rows to the front of m_targets. Weighted rows
+  // are sorted as (target, weight) pairs, so the first of equal targets is the lightest edge.
+  void normalizeRows() {
+    size_t n = vertexCount();
+    bool hasWeights = weighted();
+    edge_index write = 0;
+    edge_index rowBegin = 0;
+    m_selfLoops = 0;
+    auto keep = [&](size_t v, vertex_type target, weight_type weight) {
+      if (target == v) ++m_selfLoops;
+      m_targets[write] = target;
+      if (hasWeights) m_weights[write] = weight;
+      ++write;
+    };
+
+    array::DynamicArray<std::pair<vertex_type, weight_type>> row;
+    for (size_t v = 0; v < n; ++v) {
+      edge_index rowEnd = m_offsets[v + 1];
+      m_offsets[v] = write;
+      if (hasWeights) {
+        row.clear();
+        for (edge_index e = rowBegin; e < rowEnd; ++e) row.pushBack({m_targets[e], m_weights[e]});
+        std::sort(row.begin(), row.end());
+        for (size_t i = 0; i < row.size(); ++i) {
+          if (i == 0 || row[i].first != row[i - 1].first) keep(v, row[i].first, row[i].second);
+        }
+      } else {
+        vertex_type* first = m_targets.data() + rowBegin;
+        vertex_type* last = m_targets.data() + rowEnd;
+        std::sort(first, last);
+        last = std::unique(first, last);
+        for (const vertex_type* it = first; it != last; ++it) keep(v, *it, 0);
+      }
+      rowBegin = rowEnd;
+    }
+    m_offsets[n] = write;
+    m_targets.resize(write);
+    if (hasWeights) m_weights.resize(write);
+  }
+
+  // fromEdges and fromWeightedEdges, with a counting pass and a fill pass over the edges. Weighted edges
+  // carry their weight as the third element.
+  template <bool Weighted, typename Seq>
+  static CsrGraph build(size_t vertexCount, const Seq& edges, bool directed) {
+    checkVertexCount(vertexCount);
+    CsrGraph graph(vertexCount, directed);
+    auto checked = [&](vertex_type id) {
+      if (id >= vertexCount) {
+        throw std::out_of_range("CsrGraph: vertex id out of range, " + std::to_string(id));
+      }
+      return id;
+    };
+
+    // the degree of v is counted into offsets[v + 1], the prefix sum then turns degrees into row starts
+    for (const auto& edge : edges) {
+      vertex_type src = checked(std::get<0>(edge));
+      vertex_type dest = checked(std::get<1>(edge));
+      ++graph.m_offsets[src + 1];
+      if (!directed && src != dest) ++graph.m_offsets[dest + 1];
+    }
+    for (size_t v = 0; v < vertexCount; ++v) graph.m_offsets[v + 1] += graph.m_offsets[v];
+
+    edge_index edgeCount = graph.m_offsets[vertexCount];
+    graph.m_targets = array::DynamicArray<vertex_type>(edgeCount, 0);
+    if constexpr (Weighted) graph.m_weights = array::DynamicArray<weight_type>(edgeCount, 0);
+    array::DynamicArray<edge_index> cursor(graph.m_offsets);
+    for (const auto& edge : edges) {
+      auto place = [&](vertex_type from, vertex_type to) {
+        edge_index at = cursor[from]++;
+        graph.m_targets[at] = to;
+        if constexpr (Weighted) graph.m_weights[at] = std::get<2>(edge);
+      };
+      vertex_type src = std::get<0>(edge);
+      vertex_type dest = std::get<1>(edge);
+      place(src, dest);
+      if (!directed && src != dest) place(dest, src);
+    }
+    graph.normalizeRows();
+    return graph;
+  }
+
+public:
+  CsrGraph() = default;
+
+  /**
+   * @brief Builds a CsrGraph from (src, dest) pairs of vertex ids below vertexCount, with a counting pass
+   *        and a fill pass over the edges. Repeated edges are kept once.
+   * @throw std::out_of_range if an id is not below vertexCount.
+   */
+  template <std::ranges::forward_range Seq>
+    requires detail::PairLikeForwardRange<Seq, vertex_type>
+  static CsrGraph fromEdges(size_t vertexCount, const Seq& edges, bool directed = true) {
+    return build<false>(vertexCount, edges, directed);
+  }
+
+  /**
+   * @brief fromEdges for (src, dest, weight) triples. Of repeated edges the lightest is kept.
+   * @throw std::out_of_range if an id is not below vertexCount.
+   */
+  template <std::ranges::forward_range Seq>
+    requires detail::WeightedEdgeForwardRange<Seq, vertex_type, weight_type>
+  static CsrGraph fromWeightedEdges(size_t vertexCount, const Seq& edges, bool directed = true) {
+    return build<true>(vertexCount, edges, directed);
+  }
+
+  /**
+   * @brief Snapshots a DirectedGraph or UndirectedGraph. Vertex i is graph.nodes()[i].
+   */
+  template <typename T> static CsrGraph fromGraph(const Graph<T>& graph) {
+    auto nodes = graph.nodes();
+    size_t n = nodes.size();
+    checkVertexCount(n);
+
+    detail::PointerIndex<const Node<T>*> ids(nodes);
+
+    CsrGraph csr(n, graph.directed());
+    for (size_t i = 0; i < n; ++i) csr.m_offsets[i + 1] = csr.m_offsets[i] + nodes[i]->neighbors().size();
+    csr.m_targets = array::DynamicArray<vertex_type>(csr.m_offsets[n], 0);
+    edge_index next = 0;
+    for (const Node<T>* node : nodes) {
+      for (const Node<T>* nei : node->neighbors()) {
+        csr.m_targets[next++] = static_cast<vertex_type>(ids.find(nei));
+      }
+    }
+    csr.normalizeRows();
+    return csr;
+  }
+
+  /**
+   * @brief The graph with every edge reversed, the in-neighbors of v become its neighbors. Rows come out
+   *        sorted without sorting, targets are placed in increasing source order.
+   */
+  [[nodiscard]] CsrGraph transpose() const {
+    size_t n = vertexCount();
+    CsrGraph reversed(n, m_directed);
+    for (vertex_type dest : m_targets) ++reversed.m_offsets[dest + 1];
+    for (size_t v = 0; v < n; ++v) reversed.m_offsets[v + 1] += reversed.m_offsets[v];
+
+    reversed.m_targets = array::DynamicArray<vertex_type>(m_targets.size(), 0);
+    if (weighted()) reversed.m_weights = array::DynamicArray<weight_type>(m_weights.size(), 0);
+    array::DynamicArray<edge_index> cursor(reversed.m_offsets);
+    for (size_t src = 0; src < n; ++src) {
+      for (edge_index e = m_offsets[src]; e < m_offsets[src + 1]; ++e) {
+        edge_index at = cursor[m_targets[e]]++;
+        reversed.m_targets[at] = static_cast<vertex_type>(src);
+        if (weighted()) reversed.m_weights[at] = m_weights[e];
+      }
+    }
+    reversed.m_selfLoops = m_selfLoops;
+    return reversed;
+  }
+
+  // v must be below vertexCount()
+  [[nodiscard]] std::span<const vertex_type> neighbors(vertex_type v) const noexcept {
+    return {m_targets.data() + m_offsets[v], m_targets.data() + m_offsets[v + 1]};
+  }
+
+  // the weights of the edges in neighbors(v), empty for an unweighted graph
+  [[nodiscard]] std::span<const weight_type> weights(vertex_type v) const noexcept {
+    if (!weighted()) return {};
+    return {m_weights.data() + m_offsets[v], m_weights.data() + m_offsets[v + 1]};
+  }
+
+  [[nodiscard]] size_t outDegree(vertex_type v) const noexcept { return m_offsets[v + 1] - m_offsets[v]; }
+
+  // a binary search in the row of src
+  [[nodiscard]] bool hasEdge(vertex_type src, vertex_type dest) const noexcept {
+    if (src >= vertexCount() || dest >= vertexCount()) return false;
+    return std::ranges::binary_search(neighbors(src), dest);
+  }
+
+  [[nodiscard]] auto vertices() const noexcept {
+    return std::views::iota(vertex_type{0}, static_cast<vertex_type>(vertexCount()));
+  }
+
+  [[nodiscard]] const array::DynamicArray<edge_index>& offsets() const noexcept { return m_offsets; }
+  [[nodiscard]] const array::DynamicArray<vertex_type>& targets() const noexcept { return m_targets; }
+  [[nodiscard]] const array::DynamicArray<weight_type>& weights() const noexcept { return m_weights; }
+
+  [[nodiscard]] bool directed() const noexcept { return m_directed; }
+  // false for a graph without edges, there's nothing to weigh
+  [[nodiscard]] bool weighted() const noexcept { return !m_weights.empty(); }
+  [[nodiscard]] size_t vertexCount() const noexcept { return m_offsets.size() - 1; }
+  [[nodiscard]] bool empty() const noexcept { return vertexCount() == 0; }
+
+  // stored row entries, an undirected edge between two vertices counts twice
+  [[nodiscard]] size_t arcCount() const noexcept { return m_targets.size(); }
+
+  // edges as Graph::edgeCount counts them
+  [[nodiscard]] size_t edgeCount() const noexcept {
+    if (m_directed) return m_targets.size();
+    return ((m_targets.size() - m_selfLoops) / 2) + m_selfLoops;
+  }
+};
+
+} // namespace graph
@@ -1,6 +1,10 @@
 module;
+#include "../array/dynamic_array.hpp"
+#include <algorithm>
+#include <bit>
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
 #include <ranges>
 export module graph:detail;
 
@@ -20,4 +24,58 @@ concept PairLike = requires(const Pair& pair) {
 template <typename Seq, typename T>
 concept PairLikeForwardRange =
     std::ranges::forward_range<Seq> && PairLike<std::ranges::range_value_t<Seq>, T>;
+
+template <typename Edge, typename T, typename W>
+concept WeightedEdgeLike = PairLike<Edge, T> && requires(const Edge& edge) {
+  { std::get<2>(edge) } -> std::convertible_to<W>;
+};
+
+template <typename Seq, typename T, typename W>
+concept WeightedEdgeForwardRange =
+    std::ranges::forward_range<Seq> && WeightedEdgeLike<std::ranges::range_value_t<Seq>, T, W>;
+
+// the position of every pointer in a range of distinct, non-null pointers (like Graph::nodes()), in a flat
+// linear probing table at most half full: one hash and usually one probe per lookup, no node allocations
+template <typename Pointer> class PointerIndex {
+private:
+  struct Slot {
+    Pointer key = nullptr;
+    size_t index = 0;
+  };
+
+  array::DynamicArray<Slot> m_slots;
+  size_t m_mask = 0;
+
+  // allocations are aligned, the low bits carry nothing: mix all of them into the ones the mask keeps
+  static size_t hash(Pointer pointer) noexcept {
+    auto bits = static_cast<uint64_t>(reinterpret_cast<std::uintptr_t>(pointer)); // NOLINT
+    bits ^= bits >> 33;
+    bits *= 0xff51afd7ed558ccdULL;
+    bits ^= bits >> 33;
+    return static_cast<size_t>(bits);
+  }
+
+public:
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  template <std::ranges::sized_range Range> explicit PointerIndex(const Range& pointers) {
+    size_t capacity = std::bit_ceil(std::max<size_t>(2, std::ranges::size(pointers) * 2));
+    m_slots = array::DynamicArray<Slot>(capacity, Slot{});
+    m_mask = capacity - 1;
+    size_t index = 0;
+    for (Pointer pointer : pointers) {
+      size_t slot = hash(pointer) & m_mask;
+      while (m_slots[slot].key != nullptr) slot = (slot + 1) & m_mask;
+      m_slots[slot] = Slot{pointer, index++};
+    }
+  }
+
+  // the position of pointer in the range, npos if it isn't in it
+  [[nodiscard]] size_t find(Pointer pointer) const noexcept {
+    for (size_t slot = hash(pointer) & m_mask;; slot = (slot + 1) & m_mask) {
+      if (m_slots[slot].key == pointer) return m_slots[slot].index;
+      if (m_slots[slot].key == nullptr) return npos;
+    }
+  }
+};
 } // namespace graph::detail
@@ -0,0 +1,210 @@
+module;
+#include "../array/dynamic_array.hpp"
+#include "../queue/priority_queue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
+#include <utility>
+export module graph:executor;
+import :csr;
+import :utils;
+import thread_pool;
+
+/*
+ * DagExecutor runs a callable for every vertex of a DAG on a thread pool, a vertex as soon as all of its
+ * predecessors finished. It's Kahn's algorithm with the queue drained by many threads at once:
+ *
+ *   - every vertex has an atomic counter of unfinished predecessors, the thread that finishes the last
+ *     predecessor of a vertex releases it;
+ *   - released vertices wait in one ready heap, and every release submits one pool task that runs the best
+ *     ready vertex at that moment, so whichever thread gets to work next picks by the scheduling order
+ *     rather than by release order. CriticalPath prefers the vertex with the longest (cost weighted) path
+ *     to a sink, the classic list-scheduling heuristic that keeps the makespan near the critical path;
+ *   - a std::stop_token or a throwing callable cancels the run: running vertices finish, nothing new
+ *     starts, and the vertices that didn't run are reported as cancelled.
+ *
+ * Every run returns a trace with the start and finish of each vertex, the makespan and the utilization of
+ * the threads.
+ * */
+
+export namespace graph {
+template <typename T> class DirectedGraph; // Forward declaration
+template <typename T> class Node;          // Forward declaration
+
+namespace utils {
+
+enum class SchedulingOrder : uint8_t { CriticalPath, Fifo };
+
+struct ExecutorOptions {
+  SchedulingOrder order = SchedulingOrder::CriticalPath;
+  std::span<const uint64_t> costs = {}; // estimated cost of every vertex, empty: 1 each. Read on construction
+};
+
+enum class TaskState : uint8_t { Cancelled, Completed, Failed };
+
+struct TaskTrace {
+  std::chrono::nanoseconds start{0}; // since the run started
+  std::chrono::nanoseconds finish{0};
+  TaskState state = TaskState::Cancelled; // a cancelled vertex never ran, its times are 0
+};
+
+struct ExecutionTrace {
+  array::DynamicArray<TaskTrace> tasks; // by vertex
+  std::chrono::nanoseconds makespan{0}; // from the start of the run until the last vertex finished
+  std::chrono::nanoseconds busy{0};     // the time spent in the callable, summed over the vertices
+  size_t threads = 0;                   // the pool's workers and the calling thread
+  size_t completed = 0;
+  size_t cancelled = 0;
+
+  // the share of the threads' time spent running vertices
+  [[nodiscard]] double utilization() const noexcept {
+    if (makespan.count() == 0 || threads == 0) return 0;
+    return static_cast<double>(busy.count()) / (static_cast<double>(makespan.count()) * threads);
+  }
+};
+
+class DagExecutor {
+public:
+  using vertex_type = CsrGraph::vertex_type;
+
+private:
+  const CsrGraph& m_graph;
+  concurrency::ThreadPool& m_pool;
+  SchedulingOrder m_order;
+  array::DynamicArray<uint32_t> m_inDegree;
+  array::DynamicArray<uint64_t> m_rank; // the cost of the heaviest path from a vertex to a sink
+
+public:
+  /**
+   * @throw std::invalid_argument if the graph is undirected or has a cycle, or the costs don't have one
+   *        entry per vertex.
+   */
+  explicit DagExecutor(
+      const CsrGraph& graph, ExecutorOptions options = {},
+      concurrency::ThreadPool& pool = concurrency::ThreadPool::shared()
+  )
+      : m_graph(graph), m_pool(pool), m_order(options.order), m_inDegree(graph.vertexCount(), 0),
+        m_rank(graph.vertexCount(), 0) {
+    if (!graph.directed()) throw std::invalid_argument("DagExecutor: the graph must be directed");
+    if (!options.costs.empty() && options.costs.size() != graph.vertexCount()) {
+      throw std::invalid_argument("DagExecutor: costs must have one entry per vertex");
+    }
+    auto [acyclic, order] = kahn(graph);
+    if (!acyclic) throw std::invalid_argument("DagExecutor: the graph has a cycle");
+
+    for (vertex_type dest : graph.targets()) ++m_inDegree[dest];
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+      vertex_type v = *it;
+      uint64_t tail = 0;
+      for (vertex_type next : graph.neighbors(v)) tail = std::max(tail, m_rank[next]);
+      m_rank[v] = tail + (options.costs.empty() ? 1 : options.costs[v]);
+    }
+  }
+  DagExecutor(
+      CsrGraph&&, ExecutorOptions = {}, concurrency::ThreadPool& = concurrency::ThreadPool::shared()
+  ) = delete;
+
+  /**
+   * @brief Calls fn(v) for every vertex v, each after fn returned for all of its predecessors, and returns
+   *        once no more vertices can run. Several runs may be made one after another.
+   * @param stop  Once stop is requested no further vertex starts.
+   * @throw Rethrows the first exception thrown by fn, after the running vertices finished.
+   */
+  template <typename Fn> ExecutionTrace run(Fn&& fn, std::stop_token stop = {}) {
+    using Clock = std::chrono::steady_clock;
+    size_t n = m_graph.vertexCount();
+    array::DynamicArray<uint32_t> waiting(m_inDegree); // only accessed through std::atomic_ref
+    ExecutionTrace trace{array::DynamicArray<TaskTrace>(n, TaskTrace{}), {}, {}, m_pool.size() + 1};
+
+    // the heap holds (priority, vertex), the largest priority comes out first
+    queue::PriorityQueue<std::pair<uint64_t, vertex_type>> ready;
+    std::mutex readyMutex;
+    uint64_t released = 0;
+    std::atomic<bool> failed{false};
+    concurrency::TaskGroup group(m_pool);
+    Clock::time_point begin = Clock::now();
+
+    // runBest and release schedule each other, runBest is passed along to break the cycle
+    auto release = [&](auto& runBest, vertex_type v) {
+      {
+        std::lock_guard lock(readyMutex);
+        uint64_t priority = m_order == SchedulingOrder::CriticalPath
+                                ? m_rank[v]
+                                : std::numeric_limits<uint64_t>::max() - released;
+        ++released;
+        ready.push({priority, v});
+      }
+      group.run([&runBest] { runBest(runBest); });
+    };
+    auto runBest = [&](auto& self) -> void {
+      vertex_type v = 0;
+      {
+        std::lock_guard lock(readyMutex);
+        v = ready.top().second;
+        ready.pop();
+      }
+      if (stop.stop_requested() || failed.load(std::memory_order_relaxed)) return;
+      TaskTrace& task = trace.tasks[v];
+      task.start = Clock::now() - begin;
+      try {
+        fn(v);
+      } catch (...) {
+        task.finish = Clock::now() - begin;
+        task.state = TaskState::Failed;
+        failed.store(true, std::memory_order_relaxed);
+        throw;
+      }
+      task.finish = Clock::now() - begin;
+      task.state = TaskState::Completed;
+      for (vertex_type next : m_graph.neighbors(v)) {
+        if (std::atomic_ref<uint32_t>(waiting[next]).fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          release(self, next);
+        }
+      }
+    };
+
+    for (vertex_type v : m_graph.vertices()) {
+      if (m_inDegree[v] == 0) release(runBest, v);
+    }
+    group.wait();
+
+    for (const TaskTrace& task : trace.tasks) {
+      trace.makespan = std::max(trace.makespan, task.finish);
+      trace.busy += task.finish - task.start;
+      if (task.state == TaskState::Completed) ++trace.completed;
+      if (task.state == TaskState::Cancelled) ++trace.cancelled;
+    }
+    return trace;
+  }
+
+  // the cost of the heaviest path from v to a sink, v's own cost included
+  [[nodiscard]] uint64_t criticalPath(vertex_type v) const noexcept { return m_rank[v]; }
+};
+
+/**
+ *  @tparam T  The underlying data type stored within the graph nodes.
+ *  @brief Runs fn(node) for every node of a DAG with a DagExecutor over a CsrGraph snapshot of it. Vertex i
+ *         of the trace is graph.nodes()[i].
+ *  @throw std::invalid_argument if the graph has a cycle.
+ */
+template <typename T, typename Fn>
+ExecutionTrace executeDag(
+    const DirectedGraph<T>& graph, Fn&& fn, ExecutorOptions options = {}, std::stop_token stop = {},
+    concurrency::ThreadPool& pool = concurrency::ThreadPool::shared()
+) {
+  auto nodes = graph.nodes();
+  CsrGraph snapshot = CsrGraph::fromGraph(graph);
+  DagExecutor executor(snapshot, options, pool);
+  return executor.run([&](CsrGraph::vertex_type v) { fn(nodes[v]); }, std::move(stop));
+}
+
+} // namespace utils
+} // namespace graph
@@ -0,0 +1,192 @@
+module;
+#include "../array/dynamic_array.hpp"
+#include "../hash_map/hash_map.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+export module graph:incremental;
+import :utils;
+
+/*
+ * DynamicTopologicalOrder keeps a topological order of a DirectedGraph valid while edges are added, with
+ * the algorithm of Pearce and Kelly. Every vertex has a position in the order; an edge src -> dest with
+ * src already before dest changes nothing. Otherwise only the vertices between the two positions can be
+ * out of place:
+ *
+ *   - a forward DFS from dest collects the vertices it reaches that sit before src. Reaching src means the
+ *     edge would close a cycle, and it's rejected before anything changed;
+ *   - a backward DFS from src over the predecessor index collects the vertices reaching src that sit after
+ *     dest;
+ *   - the two sets swap places among the positions they occupy, the backward set first, each keeping its
+ *     relative order.
+ *
+ * The work is proportional to the edges of the affected region instead of O(V + E) for sorting again, and
+ * most insertions in a dependency graph touch a handful of vertices or none.
+ * */
+
+export namespace graph {
+template <typename T> class DirectedGraph; // Forward declaration
+template <typename T> class Node;          // Forward declaration
+
+namespace utils {
+
+/**
+ * @tparam T  The underlying data type stored within the graph nodes.
+ * @brief A DirectedGraph that stays acyclic and always knows a topological order of its vertices. It owns
+ *        the graph, with the predecessor index enabled, and only hands it out as const, vertices and edges
+ *        are added through it.
+ */
+template <typename T> class DynamicTopologicalOrder {
+private:
+  DirectedGraph<T> m_graph;
+  struct Entry {
+    size_t position = 0; // the index of the vertex in m_order
+    uint64_t mark = 0;   // the vertex was visited by the searches of addEdge iff it equals m_epoch
+  };
+
+  array::DynamicArray<const Node<T>*> m_order;
+  hashmap::HashMap<const Node<T>*, Entry> m_entries;
+  uint64_t m_epoch = 0; // advanced by every addEdge that searches, clears all marks at once
+
+  // the arrays addEdge works in, cleared but not freed between calls
+  array::DynamicArray<const Node<T>*> m_forward;
+  array::DynamicArray<const Node<T>*> m_backward;
+  array::DynamicArray<const Node<T>*> m_stack;
+  array::DynamicArray<size_t> m_slots;
+
+  size_t positionOf(const Node<T>* vertex) const {
+    auto it = m_entries.find(vertex);
+    if (it == m_entries.end()) throw std::invalid_argument("DynamicTopologicalOrder: unknown vertex");
+    return (*it).second.position;
+  }
+
+  // collects into found the vertices reachable from start through next(vertex) whose position passes
+  // inRange, false as soon as one equals stop
+  template <typename Next, typename InRange>
+  bool collect(
+      const Node<T>* start, const Node<T>* stop, array::DynamicArray<const Node<T>*>& found, Next next,
+      InRange inRange
+  ) {
+    m_stack.pushBack(start);
+    m_entries.at(start).mark = m_epoch;
+    while (!m_stack.empty()) {
+      const Node<T>* vertex = m_stack.back();
+      m_stack.popBack();
+      found.pushBack(vertex);
+      bool cycle = false;
+      next(vertex, [&](const Node<T>* other) {
+        if (other == stop) cycle = true;
+        if (cycle) return;
+        Entry& entry = m_entries.at(other);
+        if (entry.mark == m_epoch || !inRange(entry.position)) return;
+        entry.mark = m_epoch;
+        m_stack.pushBack(other);
+      });
+      if (cycle) return false;
+    }
+    return true;
+  }
+
+  void resetScratch() {
+    m_forward.clear();
+    m_backward.clear();
+    m_stack.clear();
+    m_slots.clear();
+  }
+
+public:
+  DynamicTopologicalOrder() { m_graph.enablePredecessorIndex(); }
+
+  // the order points into the graph, a copy would have to translate every node
+  DynamicTopologicalOrder(const DynamicTopologicalOrder&) = delete;
+  DynamicTopologicalOrder& operator=(const DynamicTopologicalOrder&) = delete;
+  DynamicTopologicalOrder(DynamicTopologicalOrder&&) = default;
+  DynamicTopologicalOrder& operator=(DynamicTopologicalOrder&&) = default;
+  ~DynamicTopologicalOrder() noexcept = default;
+
+  /**
+   * @brief Takes over graph and orders it once from scratch.
+   * @throw std::invalid_argument if graph has a cycle.
+   */
+  explicit DynamicTopologicalOrder(DirectedGraph<T> graph) : m_graph(std::move(graph)) {
+    auto [acyclic, order] = topologicalSort(m_graph);
+    if (!acyclic) throw std::invalid_argument("DynamicTopologicalOrder: the graph has a cycle");
+    m_graph.enablePredecessorIndex();
+    m_order = std::move(order);
+    m_entries.reserve(m_order.size());
+    for (size_t i = 0; i < m_order.size(); ++i) m_entries[m_order[i]].position = i;
+  }
+
+  // a new vertex has no edges, it goes last
+  Node<T>* addVertex(const T& value) {
+    Node<T>* vertex = m_graph.addVertex(value);
+    m_entries[vertex].position = m_order.size();
+    m_order.pushBack(vertex);
+    return vertex;
+  }
+
+  /**
+   * @brief Adds src -> dest and repairs the order around it.
+   * @return false, leaving graph and order as they were, if the edge would close a cycle (a self-loop
+   *         included).
+   * @throw std::invalid_argument if src or dest is not a vertex of the graph.
+   */
+  bool addEdge(Node<T>* src, Node<T>* dest) {
+    size_t upper = positionOf(src);
+    size_t lower = positionOf(dest);
+    if (src == dest) return false;
+    if (upper < lower) {
+      m_graph.addEdge(src, dest);
+      return true;
+    }
+
+    ++m_epoch;
+    auto successors = [](const Node<T>* vertex, auto visit) {
+      for (const Node<T>* next : vertex->neighbors()) visit(next);
+    };
+    auto predecessors = [](const Node<T>* vertex, auto visit) {
+      if (vertex->predecessors() == nullptr) return;
+      for (const Node<T>* prev : *vertex->predecessors()) visit(prev);
+    };
+    if (!collect(dest, src, m_forward, successors, [&](size_t position) { return position < upper; })) {
+      resetScratch();
+      return false;
+    }
+    collect(src, nullptr, m_backward, predecessors, [&](size_t position) { return position > lower; });
+
+    auto byPosition = [&](const Node<T>* a, const Node<T>* b) {
+      return m_entries.at(a).position < m_entries.at(b).position;
+    };
+    std::ranges::sort(m_backward, byPosition);
+    std::ranges::sort(m_forward, byPosition);
+    for (const Node<T>* vertex : m_backward) m_slots.pushBack(m_entries.at(vertex).position);
+    for (const Node<T>* vertex : m_forward) m_slots.pushBack(m_entries.at(vertex).position);
+    std::ranges::sort(m_slots);
+
+    size_t next = 0;
+    for (const auto* part : {&m_backward, &m_forward}) {
+      for (const Node<T>* vertex : *part) {
+        m_order[m_slots[next]] = vertex;
+        m_entries.at(vertex).position = m_slots[next++];
+      }
+    }
+    resetScratch();
+    m_graph.addEdge(src, dest);
+    return true;
+  }
+
+  // removing an edge never invalidates the order
+  void removeEdge(Node<T>* src, Node<T>* dest) { m_graph.removeEdge(src, dest); }
+
+  [[nodiscard]] const DirectedGraph<T>& graph() const noexcept { return m_graph; }
+  [[nodiscard]] const array::DynamicArray<const Node<T>*>& order() const noexcept { return m_order; }
+
+  // the index of vertex in order()
+  [[nodiscard]] size_t position(const Node<T>* vertex) const { return positionOf(vertex); }
+  [[nodiscard]] size_t size() const noexcept { return m_order.size(); }
+};
+
+} // namespace utils
+} // namespace graph
@@ -0,0 +1,235 @@
+module;
+#include "../array/dynamic_array.hpp"
+#include "../queue/indexed_heap.hpp"
+#include "../union_find/union_find.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+export module graph:mst;
+import :csr;
+import :paths;
+import parallel;
+import thread_pool;
+
+/*
+ * Minimum spanning forests of an undirected CsrGraph, unweighted graphs count every edge as 1. All three
+ * return a forest of the same total weight, one tree per connected component.
+ *
+ *   - kruskal: sorts the edges by weight with parallel::sort and keeps every edge joining two trees of a
+ *     unionfind::UnionFind, O(m log m) and the sort dominates.
+ *   - prim: grows one tree at a time from its lightest outgoing edge, with an indexed heap holding the
+ *     cheapest known edge into every vertex, O(m log n). Reads the graph in CSR order, the best choice for
+ *     a single thread on dense graphs.
+ *   - boruvka: in every round each tree picks its lightest outgoing edge, all trees at once on the thread
+ *     pool, and the picked edges are merged into a unionfind::ConcurrentUnionFind. Every round at least
+ *     halves the number of trees and drops the edges that turned internal, O(m log n) work in O(log n)
+ *     rounds. Ties are broken by edge index, so the picked edges never close a cycle.
+ * */
+
+export namespace graph::utils {
+
+struct SpanningEdge {
+  CsrGraph::vertex_type u;
+  CsrGraph::vertex_type v;
+  CsrGraph::weight_type weight;
+
+  bool operator==(const SpanningEdge&) const noexcept = default;
+};
+
+struct SpanningForest {
+  array::DynamicArray<SpanningEdge> edges; // vertexCount - components edges, in no particular order
+  uint64_t totalWeight = 0;
+  size_t components = 0; // connected components, the trees of the forest
+};
+
+namespace detail {
+
+inline void checkUndirected(const CsrGraph& graph, const char* caller) {
+  if (graph.directed()) throw std::invalid_argument(std::string(caller) + ": the graph must be undirected.");
+}
+
+// every edge once, as u < v, self-loops left out; filled in parallel from the rows of the graph
+inline array::DynamicArray<SpanningEdge> canonicalEdges(
+    const CsrGraph& graph, concurrency::ThreadPool& pool
+) {
+  using Vertex = CsrGraph::vertex_type;
+  size_t n = graph.vertexCount();
+  const auto& offsets = graph.offsets();
+  const auto& targets = graph.targets();
+  EdgeWeights weights(graph);
+
+  // rows are sorted, the neighbors above u are a suffix of its row
+  auto firstAbove = [&](Vertex u) -> size_t {
+    auto row = targets.begin();
+    return std::upper_bound(row + offsets[u], row + offsets[u + 1], u) - row;
+  };
+  array::DynamicArray<size_t> starts(n + 1, 0);
+  pool.parallelFor(0, n, [&](size_t begin, size_t end) {
+    for (size_t u = begin; u < end; ++u) starts[u] = offsets[u + 1] - firstAbove(static_cast<Vertex>(u));
+  });
+  parallel::Policy policy{.pool = &pool};
+  parallel::exclusiveScan(policy, starts.begin(), starts.end(), starts.begin(), size_t{0});
+
+  array::DynamicArray<SpanningEdge> edges(starts[n], SpanningEdge{});
+  pool.parallelFor(0, n, [&](size_t begin, size_t end) {
+    for (size_t u = begin; u < end; ++u) {
+      size_t at = starts[u];
+      for (size_t e = firstAbove(static_cast<Vertex>(u)); e < offsets[u + 1]; ++e) {
+        edges[at++] = {static_cast<Vertex>(u), targets[e], static_cast<CsrGraph::weight_type>(weights[e])};
+      }
+    }
+  });
+  return edges;
+}
+
+inline void addEdge(SpanningForest& forest, const SpanningEdge& edge) {
+  forest.edges.pushBack(edge);
+  forest.totalWeight += edge.weight;
+}
+
+} // namespace detail
+
+/**
+ * @brief Kruskal's algorithm over the edges sorted in parallel.
+ * @throw std::invalid_argument if the graph is directed.
+ */
+inline SpanningForest kruskal(
+    const CsrGraph& graph, concurrency::ThreadPool& pool = concurrency::ThreadPool::shared()
+) {
+  detail::checkUndirected(graph, "kruskal");
+  array::DynamicArray<SpanningEdge> edges = detail::canonicalEdges(graph, pool);
+  auto lighter = [](const SpanningEdge& a, const SpanningEdge& b) {
+    return std::tie(a.weight, a.u, a.v) < std::tie(b.weight, b.u, b.v);
+  };
+  parallel::sort(parallel::Policy{.pool = &pool}, edges.begin(), edges.end(), lighter);
+
+  unionfind::UnionFind trees(graph.vertexCount());
+  SpanningForest forest;
+  for (const SpanningEdge& edge : edges) {
+    if (trees.setCount() == 1) break;
+    if (trees.unite(edge.u, edge.v)) detail::addEdge(forest, edge);
+  }
+  forest.components = trees.setCount();
+  return forest;
+}
+
+/**
+ * @brief Prim's algorithm, restarted from every vertex no earlier tree reached.
+ * @throw std::invalid_argument if the graph is directed.
+ */
+inline SpanningForest prim(const CsrGraph& graph) {
+  using Vertex = CsrGraph::vertex_type;
+  detail::checkUndirected(graph, "prim");
+  size_t n = graph.vertexCount();
+  const auto& offsets = graph.offsets();
+  const auto& targets = graph.targets();
+  detail::EdgeWeights weights(graph);
+
+  queue::IndexedHeap<uint64_t> frontier(n); // the lightest known edge into every vertex next to the tree
+  array::DynamicArray<Vertex> via(n, 0);    // the tree end of that edge
+  array::DynamicArray<bool> inTree(n, false);
+  SpanningForest forest;
+  for (size_t root = 0; root < n; ++root) {
+    if (inTree[root]) continue;
+    ++forest.components;
+    frontier.push(0, root);
+    via[root] = static_cast<Vertex>(root);
+    while (!frontier.empty()) {
+      auto [weight, u] = frontier.top();
+      frontier.pop();
+      inTree[u] = true;
+      if (via[u] != u) {
+        detail::addEdge(forest, {via[u], static_cast<Vertex>(u), static_cast<CsrGraph::weight_type>(weight)});
+      }
+      for (CsrGraph::edge_index e = offsets[u]; e < offsets[u + 1]; ++e) {
+        Vertex v = targets[e];
+        if (!inTree[v] && frontier.pushOrDecrease(weights[e], v)) via[v] = static_cast<Vertex>(u);
+      }
+    }
+  }
+  return forest;
+}
+
+/**
+ * @brief Parallel Borůvka's algorithm.
+ * @throw std::invalid_argument if the graph is directed, std::length_error if it has 2^32 - 1 edges or more.
+ */
+inline SpanningForest boruvka(
+    const CsrGraph& graph, concurrency::ThreadPool& pool = concurrency::ThreadPool::shared()
+) {
+  detail::checkUndirected(graph, "boruvka");
+  // a tree's choice is packed as weight << 32 | edge index, so one atomic min picks the lightest edge and
+  // breaks ties by index
+  constexpr uint64_t none = std::numeric_limits<uint64_t>::max();
+  constexpr uint64_t indexMask = std::numeric_limits<uint32_t>::max();
+  size_t n = graph.vertexCount();
+  array::DynamicArray<SpanningEdge> edges = detail::canonicalEdges(graph, pool);
+  if (edges.size() >= indexMask) throw std::length_error("boruvka: too many edges.");
+
+  parallel::Policy policy{.pool = &pool};
+  unionfind::ConcurrentUnionFind trees(n);
+  array::DynamicArray<uint64_t> lightest(n, none); // the choice of every tree, by root
+  array::DynamicArray<uint64_t> picked(n, 0);
+  array::DynamicArray<uint32_t> active(edges.size(), 0); // the edges between two trees
+  array::DynamicArray<uint32_t> remaining(edges.size(), 0);
+  std::iota(active.begin(), active.end(), uint32_t{0});
+  size_t activeCount = active.size();
+
+  auto claim = [](uint64_t& slot, uint64_t choice) {
+    std::atomic_ref<uint64_t> best(slot);
+    uint64_t current = best.load(std::memory_order_relaxed);
+    while (choice < current && !best.compare_exchange_weak(current, choice, std::memory_order_relaxed)) {}
+  };
+
+  SpanningForest forest;
+  while (activeCount > 0) {
+    // no tree merges during this phase, every find returns a stable root
+    pool.parallelFor(0, activeCount, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        const SpanningEdge& edge = edges[active[i]];
+        uint64_t choice = (uint64_t{edge.weight} << 32) | active[i];
+        claim(lightest[trees.find(edge.u)], choice);
+        claim(lightest[trees.find(edge.v)], choice);
+      }
+    });
+
+    // two trees may pick the same edge, only the unite that merges them keeps it
+    pool.parallelFor(0, n, [&](size_t begin, size_t end) {
+      for (size_t root = begin; root < end; ++root) {
+        uint64_t choice = std::exchange(lightest[root], none);
+        if (choice != none) {
+          const SpanningEdge& edge = edges[choice & indexMask];
+          if (!trees.unite(edge.u, edge.v)) choice = none;
+        }
+        picked[root] = choice;
+      }
+    });
+    // lightest is all none again, it doubles as the buffer for the merged edges
+    auto pickedEnd = parallel::copyIf(policy, picked.begin(), picked.end(), lightest.begin(), [](uint64_t c) {
+      return c != none;
+    });
+    for (auto it = lightest.begin(); it != pickedEnd; ++it) {
+      detail::addEdge(forest, edges[*it & indexMask]);
+      *it = none;
+    }
+
+    auto remainingEnd = parallel::copyIf(
+        policy, active.begin(), active.begin() + activeCount, remaining.begin(), [&](uint32_t e) {
+          return trees.find(edges[e].u) != trees.find(edges[e].v);
+        }
+    );
+    activeCount = remainingEnd - remaining.begin();
+    std::swap(active, remaining);
+  }
+  forest.components = trees.setCount();
+  return forest;
+}
+
+} // namespace graph::utils
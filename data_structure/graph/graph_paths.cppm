@@ -0,0 +1,358 @@
+module;
+#include "../array/dynamic_array.hpp"
+#include "../queue/indexed_heap.hpp"
+#include "../queue/radix_heap.hpp"
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+export module graph:paths;
+import :csr;
+import thread_pool;
+
+/*
+ * Single-source and point-to-point shortest paths over a CsrGraph with non-negative integer weights,
+ * unweighted graphs count every edge as 1.
+ *
+ *   - dijkstra: the whole shortest path tree, with a radix heap (the default, keys only grow and an entry
+ *     is moved at most 64 times) or an addressable 4-ary heap (decrease-key, one entry per vertex).
+ *   - deltaStepping: distances only, in parallel. Vertices are kept in buckets of width delta and a whole
+ *     bucket is relaxed at once on the thread pool, repeating it while relaxations land in the same bucket.
+ *   - aStar: a point-to-point search guided by a lower bound on the remaining distance.
+ *   - bidirectionalDijkstra: a point-to-point search growing from both ends, it stops once the two
+ *     frontiers can't improve on the best meeting point, having settled about two balls of half the radius.
+ * */
+
+export namespace graph::utils {
+
+struct ShortestPaths {
+  using vertex_type = CsrGraph::vertex_type;
+  static constexpr uint64_t unreachable = std::numeric_limits<uint64_t>::max();
+  static constexpr vertex_type noParent = std::numeric_limits<vertex_type>::max();
+
+  array::DynamicArray<uint64_t> distances;  // unreachable if there's no path
+  array::DynamicArray<vertex_type> parents; // the source is its own parent, noParent if unreached
+
+  // the vertices from the source to target, empty if target wasn't reached
+  [[nodiscard]] array::DynamicArray<vertex_type> pathTo(vertex_type target) const {
+    array::DynamicArray<vertex_type> path;
+    if (target >= parents.size() || parents[target] == noParent) return path;
+    vertex_type v = target;
+    for (; parents[v] != v; v = parents[v]) path.pushBack(v);
+    path.pushBack(v);
+    std::ranges::reverse(path);
+    return path;
+  }
+};
+
+struct PointToPointPath {
+  uint64_t distance = ShortestPaths::unreachable;
+  array::DynamicArray<CsrGraph::vertex_type> path; // source .. target, empty if target is unreachable
+  size_t settled = 0;                              // vertices taken off a heap, the work the search did
+};
+
+enum class DijkstraHeap : uint8_t { Radix, Indexed };
+
+namespace detail {
+
+// the weight of edge e, 1 on an unweighted graph
+class EdgeWeights {
+private:
+  const CsrGraph::weight_type* m_weights;
+
+public:
+  explicit EdgeWeights(const CsrGraph& graph) noexcept
+      : m_weights(graph.weighted() ? graph.weights().data() : nullptr) {}
+
+  uint64_t operator[](CsrGraph::edge_index e) const noexcept {
+    return m_weights != nullptr ? m_weights[e] : 1;
+  }
+};
+
+inline void checkVertex(const CsrGraph& graph, CsrGraph::vertex_type v, const char* caller) {
+  if (v >= graph.vertexCount()) {
+    throw std::out_of_range(std::string(caller) + ": vertex out of range, " + std::to_string(v));
+  }
+}
+
+inline ShortestPaths initialPaths(size_t n, CsrGraph::vertex_type source) {
+  ShortestPaths paths{
+      array::DynamicArray<uint64_t>(n, ShortestPaths::unreachable),
+      array::DynamicArray<CsrGraph::vertex_type>(n, ShortestPaths::noParent)
+  };
+  paths.distances[source] = 0;
+  paths.parents[source] = source;
+  return paths;
+}
+
+} // namespace detail
+
+/**
+ * @brief Shortest paths from source to every vertex.
+ * @param heap Radix is the faster one, the indexed heap keeps the heap down to one entry per vertex.
+ * @throw std::out_of_range if source is not a vertex of the graph.
+ */
+inline ShortestPaths dijkstra(const CsrGraph& graph, CsrGraph::vertex_type source, DijkstraHeap heap = {}) {
+  using Vertex = CsrGraph::vertex_type;
+  detail::checkVertex(graph, source, "dijkstra");
+  const auto& offsets = graph.offsets();
+  const auto& targets = graph.targets();
+  detail::EdgeWeights weights(graph);
+  ShortestPaths paths = detail::initialPaths(graph.vertexCount(), source);
+
+  if (heap == DijkstraHeap::Radix) {
+    // stale entries stay in the heap and are skipped, decrease-key would cost more than it saves
+    queue::RadixHeap<Vertex> frontier;
+    frontier.push(0, source);
+    while (!frontier.empty()) {
+      auto [distance, u] = frontier.top();
+      frontier.pop();
+      if (distance > paths.distances[u]) continue;
+      for (CsrGraph::edge_index e = offsets[u]; e < offsets[u + 1]; ++e) {
+        uint64_t candidate = distance + weights[e];
+        Vertex v = targets[e];
+        if (candidate >= paths.distances[v]) continue;
+        paths.distances[v] = candidate;
+        paths.parents[v] = u;
+        frontier.push(candidate, v);
+      }
+    }
+    return paths;
+  }
+
+  queue::IndexedHeap<uint64_t> frontier(graph.vertexCount());
+  frontier.push(0, source);
+  while (!frontier.empty()) {
+    auto [distance, u] = frontier.top();
+    frontier.pop();
+    for (CsrGraph::edge_index e = offsets[u]; e < offsets[u + 1]; ++e) {
+      uint64_t candidate = distance + weights[e];
+      Vertex v = targets[e];
+      if (candidate >= paths.distances[v]) continue;
+      paths.distances[v] = candidate;
+      paths.parents[v] = static_cast<Vertex>(u);
+      frontier.pushOrDecrease(candidate, v);
+    }
+  }
+  return paths;
+}
+
+/**
+ * @brief Parallel delta-stepping, the distances from source to every vertex (unreachable if there's no
+ *        path). Smaller deltas do less redundant work, larger ones give every phase more to do in parallel.
+ * @param delta The bucket width, 0 picks the average edge weight.
+ * @throw std::out_of_range if source is not a vertex of the graph.
+ */
+inline array::DynamicArray<uint64_t> deltaStepping(
+    const CsrGraph& graph, CsrGraph::vertex_type source, uint64_t delta = 0,
+    concurrency::ThreadPool& pool = concurrency::ThreadPool::shared()
+) {
+  using Vertex = CsrGraph::vertex_type;
+  detail::checkVertex(graph, source, "deltaStepping");
+  const auto& offsets = graph.offsets();
+  const auto& targets = graph.targets();
+  detail::EdgeWeights weights(graph);
+  if (delta == 0) {
+    uint64_t total = 0;
+    for (CsrGraph::edge_index e = 0; e < graph.arcCount(); ++e) total += weights[e];
+    delta = std::max<uint64_t>(1, graph.arcCount() == 0 ? 1 : total / graph.arcCount());
+  }
+
+  array::DynamicArray<uint64_t> distances(graph.vertexCount(), ShortestPaths::unreachable);
+  distances[source] = 0;
+  // buckets[i] holds the vertices whose distance dropped into [i * delta, (i + 1) * delta)
+  array::DynamicArray<array::DynamicArray<Vertex>> buckets;
+  array::DynamicArray<Vertex> frontier{source};
+  size_t bucket = 0;
+  std::mutex bucketsMutex;
+
+  while (true) {
+    pool.parallelFor(
+        0, frontier.size(),
+        [&](size_t begin, size_t end) {
+          array::DynamicArray<std::pair<size_t, Vertex>> moved;
+          for (size_t i = begin; i < end; ++i) {
+            Vertex u = frontier[i];
+            uint64_t distance = std::atomic_ref(distances[u]).load(std::memory_order_relaxed);
+            // u has been relaxed from an earlier bucket already
+            if (distance / delta < bucket) continue;
+            for (CsrGraph::edge_index e = offsets[u]; e < offsets[u + 1]; ++e) {
+              uint64_t candidate = distance + weights[e];
+              std::atomic_ref target(distances[targets[e]]);
+              uint64_t current = target.load(std::memory_order_relaxed);
+              while (candidate < current && !target.compare_exchange_weak(current, candidate)) {}
+              if (candidate < current) moved.pushBack({candidate / delta, targets[e]});
+            }
+          }
+          if (moved.empty()) return;
+          std::lock_guard lock(bucketsMutex);
+          for (auto [index, v] : moved) {
+            if (index >= buckets.size()) buckets.resize(index + 1);
+            buckets[index].pushBack(v);
+          }
+        },
+        std::max<size_t>(64, frontier.size() / (pool.size() * 8))
+    );
+
+    while (bucket < buckets.size() && buckets[bucket].empty()) ++bucket;
+    if (bucket == buckets.size()) break;
+    frontier.clear();
+    swap(frontier, buckets[bucket]);
+  }
+  return distances;
+}
+
+/**
+ * @brief A* from source to target.
+ * @param heuristic heuristic(v) is a lower bound on the distance from v to target. With a consistent one
+ *        (heuristic(u) <= weight(u, v) + heuristic(v)) every vertex is settled at most once, a merely
+ *        admissible one stays correct but may settle vertices again.
+ * @throw std::out_of_range if source or target is not a vertex of the graph.
+ */
+template <typename Heuristic>
+  requires std::invocable<Heuristic&, CsrGraph::vertex_type> &&
+           std::convertible_to<std::invoke_result_t<Heuristic&, CsrGraph::vertex_type>, uint64_t>
+PointToPointPath aStar(
+    const CsrGraph& graph, CsrGraph::vertex_type source, CsrGraph::vertex_type target, Heuristic heuristic
+) {
+  using Vertex = CsrGraph::vertex_type;
+  detail::checkVertex(graph, source, "aStar");
+  detail::checkVertex(graph, target, "aStar");
+  const auto& offsets = graph.offsets();
+  const auto& targets = graph.targets();
+  detail::EdgeWeights weights(graph);
+  ShortestPaths paths = detail::initialPaths(graph.vertexCount(), source);
+
+  PointToPointPath result;
+  // keyed by the distance so far plus the estimate of the rest
+  queue::IndexedHeap<uint64_t> frontier(graph.vertexCount());
+  frontier.push(heuristic(source), source);
+  while (!frontier.empty()) {
+    auto u = static_cast<Vertex>(frontier.top().second);
+    frontier.pop();
+    ++result.settled;
+    if (u == target) {
+      result.distance = paths.distances[target];
+      result.path = paths.pathTo(target);
+      break;
+    }
+    for (CsrGraph::edge_index e = offsets[u]; e < offsets[u + 1]; ++e) {
+      uint64_t candidate = paths.distances[u] + weights[e];
+      Vertex v = targets[e];
+      if (candidate >= paths.distances[v]) continue;
+      paths.distances[v] = candidate;
+      paths.parents[v] = u;
+      frontier.pushOrDecrease(candidate + static_cast<uint64_t>(heuristic(v)), v);
+    }
+  }
+  return result;
+}
+
+class BidirectionalDijkstra {
+public:
+  using vertex_type = CsrGraph::vertex_type;
+
+private:
+  const CsrGraph& m_graph;
+  CsrGraph m_reversed; // the transpose of a directed graph, unused for undirected ones
+
+  // one of the two searches, the backward one walks the reversed graph
+  struct Search {
+    const CsrGraph& graph;
+    detail::EdgeWeights weights;
+    ShortestPaths paths;
+    queue::IndexedHeap<uint64_t> frontier;
+
+    Search(const CsrGraph& graph, vertex_type source)
+        : graph(graph), weights(graph), paths(detail::initialPaths(graph.vertexCount(), source)),
+          frontier(graph.vertexCount()) {
+      frontier.push(0, source);
+    }
+  };
+
+  [[nodiscard]] const CsrGraph& reversed() const noexcept {
+    return m_graph.directed() ? m_reversed : m_graph;
+  }
+
+public:
+  /**
+   * @brief Prepares queries over graph, which must outlive this object. A directed graph is transposed
+   *        here, once for all the queries.
+   */
+  explicit BidirectionalDijkstra(const CsrGraph& graph) : m_graph(graph) {
+    if (graph.directed()) m_reversed = graph.transpose();
+  }
+
+  BidirectionalDijkstra(CsrGraph&&) = delete;
+
+  /**
+   * @throw std::out_of_range if source or target is not a vertex of the graph.
+   */
+  [[nodiscard]] PointToPointPath run(vertex_type source, vertex_type target) const {
+    detail::checkVertex(m_graph, source, "bidirectionalDijkstra");
+    detail::checkVertex(m_graph, target, "bidirectionalDijkstra");
+    PointToPointPath result;
+    Search forward(m_graph, source);
+    Search backward(reversed(), target);
+    uint64_t best = ShortestPaths::unreachable;
+    vertex_type meeting = ShortestPaths::noParent;
+    if (source == target) {
+      best = 0;
+      meeting = source;
+    }
+
+    // every path through an unsettled vertex is at least as long as the two smallest keys together
+    while (!forward.frontier.empty() && !backward.frontier.empty() &&
+           forward.frontier.top().first + backward.frontier.top().first < best) {
+      bool forwardTurn = forward.frontier.top().first <= backward.frontier.top().first;
+      Search& search = forwardTurn ? forward : backward;
+      const Search& other = forwardTurn ? backward : forward;
+      auto [distance, u] = search.frontier.top();
+      search.frontier.pop();
+      ++result.settled;
+
+      const auto& offsets = search.graph.offsets();
+      const auto& targets = search.graph.targets();
+      for (CsrGraph::edge_index e = offsets[u]; e < offsets[u + 1]; ++e) {
+        uint64_t candidate = distance + search.weights[e];
+        vertex_type v = targets[e];
+        if (candidate < search.paths.distances[v]) {
+          search.paths.distances[v] = candidate;
+          search.paths.parents[v] = static_cast<vertex_type>(u);
+          search.frontier.pushOrDecrease(candidate, v);
+        }
+        uint64_t rest = other.paths.distances[v];
+        if (rest != ShortestPaths::unreachable && search.paths.distances[v] + rest < best) {
+          best = search.paths.distances[v] + rest;
+          meeting = v;
+        }
+      }
+    }
+    if (best == ShortestPaths::unreachable) return result;
+
+    result.distance = best;
+    result.path = forward.paths.pathTo(meeting);
+    for (vertex_type v = meeting; v != target;) {
+      v = backward.paths.parents[v];
+      result.path.pushBack(v);
+    }
+    return result;
+  }
+};
+
+/**
+ * @brief A bidirectional Dijkstra query from source to target, see BidirectionalDijkstra. Many queries on
+ *        one directed graph are cheaper with one BidirectionalDijkstra, it transposes the graph only once.
+ */
+inline PointToPointPath
+bidirectionalDijkstra(const CsrGraph& graph, CsrGraph::vertex_type source, CsrGraph::vertex_type target) {
+  return BidirectionalDijkstra(graph).run(source, target);
+}
+
+} // namespace graph::utils
@@ -0,0 +1,162 @@
+module;
+#include "../array/dynamic_array.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+export module graph:scc;
+import :csr;
+
+/*
+ * Strongly connected components by Tarjan's algorithm, with the DFS on an explicit stack so a dependency
+ * chain of any length runs in O(n + m) without recursion. Components are numbered in topological order of
+ * the condensation: every edge between two components goes from a lower to a higher id. Collapsing every
+ * component into a vertex gives the condensation DAG, which lets callers order the dependencies of a
+ * cyclic graph, the vertices of a cycle end up side by side in one component.
+ * */
+
+export namespace graph {
+template <typename T> class DirectedGraph; // Forward declaration
+template <typename T> class Node;          // Forward declaration
+
+namespace utils {
+
+struct StronglyConnectedComponents {
+  using vertex_type = CsrGraph::vertex_type;
+
+  array::DynamicArray<vertex_type> component; // the component id of every vertex
+  array::DynamicArray<size_t> offsets;        // the members of c are vertices[offsets[c] .. offsets[c + 1])
+  array::DynamicArray<vertex_type> vertices;  // grouped by component, ascending within a component
+
+  [[nodiscard]] size_t count() const noexcept { return offsets.size() - 1; }
+
+  // c must be below count()
+  [[nodiscard]] std::span<const vertex_type> members(size_t c) const noexcept {
+    return {vertices.data() + offsets[c], vertices.data() + offsets[c + 1]};
+  }
+};
+
+/**
+ *  @brief Tarjan's strongly connected components, iteratively. On an undirected graph these are its
+ *         connected components.
+ */
+inline StronglyConnectedComponents stronglyConnectedComponents(const CsrGraph& graph) {
+  using Vertex = CsrGraph::vertex_type;
+  constexpr Vertex unvisited = std::numeric_limits<Vertex>::max();
+  size_t n = graph.vertexCount();
+  const auto& offsets = graph.offsets();
+  const auto& targets = graph.targets();
+
+  // index is the DFS discovery order, low the smallest index reachable through the DFS subtree and at most
+  // one edge back; a vertex roots a component when its low is its own index
+  array::DynamicArray<Vertex> index(n, unvisited);
+  array::DynamicArray<Vertex> low(n, 0);
+  array::DynamicArray<bool> onStack(n, false);
+  array::DynamicArray<Vertex> open; // visited vertices whose component isn't complete yet
+  array::DynamicArray<std::pair<Vertex, CsrGraph::edge_index>> frames; // a vertex and its next edge
+  array::DynamicArray<Vertex> found(n, 0); // components in the order Tarjan completes them, sinks first
+  Vertex counter = 0;
+  Vertex components = 0;
+
+  auto discover = [&](Vertex v) {
+    index[v] = low[v] = counter++;
+    open.pushBack(v);
+    onStack[v] = true;
+    frames.pushBack({v, offsets[v]});
+  };
+
+  for (Vertex root : graph.vertices()) {
+    if (index[root] != unvisited) continue;
+    discover(root);
+    while (!frames.empty()) {
+      auto& [v, next] = frames.back();
+      if (next < offsets[v + 1]) {
+        Vertex w = targets[next++];
+        if (index[w] == unvisited) {
+          discover(w); // invalidates v and next
+        } else if (onStack[w]) {
+          low[v] = std::min(low[v], index[w]);
+        }
+        continue;
+      }
+
+      Vertex done = v;
+      frames.popBack();
+      if (low[done] == index[done]) {
+        Vertex member = 0;
+        do {
+          member = open.back();
+          open.popBack();
+          onStack[member] = false;
+          found[member] = components;
+        } while (member != done);
+        ++components;
+      }
+      if (!frames.empty()) {
+        Vertex parent = frames.back().first;
+        low[parent] = std::min(low[parent], low[done]);
+      }
+    }
+  }
+
+  // Tarjan completes a component after every component it reaches, reversing the ids orders them
+  StronglyConnectedComponents result{
+      std::move(found),
+      array::DynamicArray<size_t>(size_t{components} + 1, 0),
+      array::DynamicArray<Vertex>(n, 0),
+  };
+  for (Vertex& c : result.component) {
+    c = components - 1 - c;
+    ++result.offsets[c + 1];
+  }
+  for (size_t c = 0; c < components; ++c) result.offsets[c + 1] += result.offsets[c];
+  array::DynamicArray<size_t> cursor(result.offsets);
+  for (Vertex v : graph.vertices()) result.vertices[cursor[result.component[v]]++] = v;
+  return result;
+}
+
+/**
+ *  @brief The condensation DAG: vertex c stands for component c of scc and has an edge to every component
+ *         that an edge of the graph leads to. 0, 1, .., count - 1 is a topological order of it.
+ *  @param scc  The strongly connected components of graph.
+ */
+inline CsrGraph condensation(const CsrGraph& graph, const StronglyConnectedComponents& scc) {
+  array::DynamicArray<std::pair<CsrGraph::vertex_type, CsrGraph::vertex_type>> edges;
+  for (CsrGraph::vertex_type u : graph.vertices()) {
+    for (CsrGraph::vertex_type v : graph.neighbors(u)) {
+      if (scc.component[u] != scc.component[v]) edges.pushBack({scc.component[u], scc.component[v]});
+    }
+  }
+  return CsrGraph::fromEdges(scc.count(), edges);
+}
+
+inline CsrGraph condensation(const CsrGraph& graph) {
+  return condensation(graph, stronglyConnectedComponents(graph));
+}
+
+/**
+ *  @tparam T  The underlying data type stored within the graph nodes.
+ *  @brief The strongly connected components of a DirectedGraph, over a CsrGraph snapshot.
+ *  @return The nodes of every component, the components in topological order of the condensation.
+ */
+template <typename T>
+array::DynamicArray<array::DynamicArray<const Node<T>*>> stronglyConnectedComponents(
+    const DirectedGraph<T>& graph
+) {
+  auto nodes = graph.nodes();
+  StronglyConnectedComponents scc = stronglyConnectedComponents(CsrGraph::fromGraph(graph));
+  array::DynamicArray<array::DynamicArray<const Node<T>*>> components;
+  components.reserve(scc.count());
+  for (size_t c = 0; c < scc.count(); ++c) {
+    array::DynamicArray<const Node<T>*> members;
+    members.reserve(scc.members(c).size());
+    for (CsrGraph::vertex_type v : scc.members(c)) members.pushBack(nodes[v]);
+    components.pushBack(std::move(members));
+  }
+  return components;
+}
+
+} // namespace utils
+} // namespace graph
@@ -1,2 +1,1231 @@
+#include "../array/dynamic_array.hpp"
+#include "../queue/deque.hpp"
+#include "../union_find/union_find.hpp"
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 import graph;
+
+namespace {
+using Vertex = graph::CsrGraph::vertex_type;
+
+bool isTopologicalOrder(const graph::CsrGraph& g, const array::DynamicArray<Vertex>& order) {
+  if (order.size() != g.vertexCount()) return false;
+  array::DynamicArray<size_t> position(g.vertexCount(), 0);
+  for (size_t i = 0; i < order.size(); ++i) position[order[i]] = i;
+  for (Vertex v : g.vertices()) {
+    for (Vertex nei : g.neighbors(v)) {
+      if (position[nei] <= position[v]) return false;
+    }
+  }
+  return true;
+}
+
+// a random DAG: every edge goes from a smaller to a larger id
+std::vector<std::pair<Vertex, Vertex>> randomDag(size_t vertexCount, size_t edgeCount, uint32_t seed) {
+  std::mt19937 gen{seed};
+  std::uniform_int_distribution<Vertex> pick(0, static_cast<Vertex>(vertexCount - 1));
+  std::vector<std::pair<Vertex, Vertex>> edges;
+  edges.reserve(edgeCount);
+  while (edges.size() < edgeCount) {
+    Vertex a = pick(gen);
+    Vertex b = pick(gen);
+    if (a != b) edges.emplace_back(std::min(a, b), std::max(a, b));
+  }
+  return edges;
+}
+
+std::vector<std::pair<Vertex, Vertex>> randomEdges(size_t vertexCount, size_t edgeCount, uint32_t seed) {
+  std::mt19937 gen{seed};
+  std::uniform_int_distribution<Vertex> pick(0, static_cast<Vertex>(vertexCount - 1));
+  std::vector<std::pair<Vertex, Vertex>> edges;
+  edges.reserve(edgeCount);
+  for (size_t i = 0; i < edgeCount; ++i) edges.emplace_back(pick(gen), pick(gen));
+  return edges;
+}
+
+array::DynamicArray<uint32_t> sequentialDistances(const graph::CsrGraph& g, Vertex root) {
+  array::DynamicArray<uint32_t> distances(g.vertexCount(), graph::utils::BfsResult::unreachable);
+  queue::Deque<Vertex> q;
+  distances[root] = 0;
+  q.pushBack(root);
+  while (!q.empty()) {
+    Vertex v = q.front();
+    q.popFront();
+    for (Vertex nei : g.neighbors(v)) {
+      if (distances[nei] != graph::utils::BfsResult::unreachable) continue;
+      distances[nei] = distances[v] + 1;
+      q.pushBack(nei);
+    }
+  }
+  return distances;
+}
+
+// exact distances, and every parent is one hop closer to the root over an existing edge
+void checkBfs(const graph::CsrGraph& g, Vertex root, const graph::utils::BfsResult& result) {
+  using graph::utils::BfsResult;
+  auto expected = sequentialDistances(g, root);
+  size_t reached = 0;
+  bool valid = result.parents[root] == root;
+  for (Vertex v : g.vertices()) {
+    valid = valid && result.distances[v] == expected[v];
+    if (expected[v] == BfsResult::unreachable) {
+      valid = valid && result.parents[v] == BfsResult::noParent;
+      continue;
+    }
+    ++reached;
+    if (v == root) continue;
+    Vertex parent = result.parents[v];
+    valid = valid && parent != BfsResult::noParent && g.hasEdge(parent, v) &&
+            result.distances[parent] + 1 == result.distances[v];
+  }
+  CHECK(valid);
+  CHECK(result.reached == reached);
+}
+
+using WeightedEdge = std::tuple<Vertex, Vertex, graph::CsrGraph::weight_type>;
+
+std::vector<WeightedEdge>
+randomWeightedEdges(size_t vertexCount, size_t edgeCount, uint32_t maxWeight, uint32_t seed) {
+  std::mt19937 gen{seed};
+  std::uniform_int_distribution<Vertex> pick(0, static_cast<Vertex>(vertexCount - 1));
+  std::uniform_int_distribution<graph::CsrGraph::weight_type> weight(0, maxWeight);
+  std::vector<WeightedEdge> edges;
+  edges.reserve(edgeCount);
+  for (size_t i = 0; i < edgeCount; ++i) edges.emplace_back(pick(gen), pick(gen), weight(gen));
+  return edges;
+}
+
+// a width x height grid of roads, vertex (x, y) is y * width + x, every road segment is 10 to 99 long
+std::vector<WeightedEdge> roadGrid(size_t width, size_t height, uint32_t seed) {
+  std::mt19937 gen{seed};
+  std::uniform_int_distribution<graph::CsrGraph::weight_type> length(10, 99);
+  std::vector<WeightedEdge> edges;
+  edges.reserve(2 * width * height);
+  for (size_t y = 0; y < height; ++y) {
+    for (size_t x = 0; x < width; ++x) {
+      auto v = static_cast<Vertex>((y * width) + x);
+      if (x + 1 < width) edges.emplace_back(v, v + 1, length(gen));
+      if (y + 1 < height) edges.emplace_back(v, v + width, length(gen));
+    }
+  }
+  return edges;
+}
+
+// the weight of the edge from src to dest, which must exist
+uint64_t edgeWeight(const graph::CsrGraph& g, Vertex src, Vertex dest) {
+  auto row = g.neighbors(src);
+  size_t at = std::ranges::lower_bound(row, dest) - row.begin();
+  return g.weighted() ? g.weights(src)[at] : 1;
+}
+
+array::DynamicArray<uint64_t> bellmanFord(const graph::CsrGraph& g, Vertex source) {
+  using graph::utils::ShortestPaths;
+  array::DynamicArray<uint64_t> distances(g.vertexCount(), ShortestPaths::unreachable);
+  distances[source] = 0;
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (Vertex u : g.vertices()) {
+      if (distances[u] == ShortestPaths::unreachable) continue;
+      for (Vertex v : g.neighbors(u)) {
+        if (distances[u] + edgeWeight(g, u, v) < distances[v]) {
+          distances[v] = distances[u] + edgeWeight(g, u, v);
+          changed = true;
+        }
+      }
+    }
+  }
+  return distances;
+}
+
+// forest has the right size and weight, uses edges of g only, has no cycle and leaves components trees
+bool isSpanningForest(const graph::CsrGraph& g, const graph::utils::SpanningForest& forest) {
+  unionfind::UnionFind trees(g.vertexCount());
+  uint64_t total = 0;
+  for (const graph::utils::SpanningEdge& edge : forest.edges) {
+    if (!g.hasEdge(edge.u, edge.v) || edgeWeight(g, edge.u, edge.v) != edge.weight) return false;
+    if (!trees.unite(edge.u, edge.v)) return false;
+    total += edge.weight;
+  }
+  unionfind::UnionFind components(g.vertexCount());
+  for (Vertex u : g.vertices()) {
+    for (Vertex v : g.neighbors(u)) components.unite(u, v);
+  }
+  return total == forest.totalWeight && trees.setCount() == components.setCount() &&
+         forest.components == components.setCount();
+}
+
+// the lightest spanning forest by trying every subset of the edges
+uint64_t bruteForceForestWeight(size_t vertexCount, const std::vector<WeightedEdge>& edges) {
+  unionfind::UnionFind all(vertexCount);
+  for (const auto& [u, v, w] : edges) all.unite(u, v);
+  uint64_t best = std::numeric_limits<uint64_t>::max();
+  for (uint32_t subset = 0; subset < (uint32_t{1} << edges.size()); ++subset) {
+    unionfind::UnionFind trees(vertexCount);
+    uint64_t total = 0;
+    bool forest = true;
+    for (size_t i = 0; i < edges.size() && forest; ++i) {
+      if ((subset >> i & 1) == 0) continue;
+      auto [u, v, w] = edges[i];
+      forest = trees.unite(u, v);
+      total += w;
+    }
+    if (forest && trees.setCount() == all.setCount()) best = std::min(best, total);
+  }
+  return best;
+}
+
+// result.path leads from source to target along existing edges and is result.distance long
+bool isPath(const graph::CsrGraph& g, const graph::utils::PointToPointPath& result, Vertex source,
+            Vertex target) {
+  if (result.path.empty() || result.path.front() != source || result.path.back() != target) return false;
+  uint64_t length = 0;
+  for (size_t i = 0; i + 1 < result.path.size(); ++i) {
+    if (!g.hasEdge(result.path[i], result.path[i + 1])) return false;
+    length += edgeWeight(g, result.path[i], result.path[i + 1]);
+  }
+  return length == result.distance;
+}
+} // namespace
+
+TEST_CASE("DirectedGraph predecessor index", "[graph][directed]") {
+  using NodePtr = graph::Node<Vertex>*;
+  auto sorted = [](auto range) {
+    std::vector<Vertex> values;
+    for (const auto* node : range) values.push_back(node->val());
+    std::ranges::sort(values);
+    return values;
+  };
+
+  SECTION("Degrees and predecessors match the scan through every vertex") {
+    graph::DirectedGraph<Vertex> scanned;
+    scanned.fromEdges(randomEdges(300, 2000, 11));
+    graph::DirectedGraph<Vertex> indexed;
+    indexed.enablePredecessorIndex();
+    indexed.fromEdges(randomEdges(300, 2000, 11));
+    REQUIRE(indexed.hasPredecessorIndex());
+
+    auto nodes = scanned.nodes();
+    auto indexedNodes = indexed.nodes();
+    REQUIRE(nodes.size() == indexedNodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      REQUIRE(indexed.inDegree(indexedNodes[i]) == scanned.inDegree(nodes[i]));
+      REQUIRE(indexed.totalDegree(indexedNodes[i]) == scanned.totalDegree(nodes[i]));
+      REQUIRE(sorted(indexed.getPredecessors(indexedNodes[i])) == sorted(scanned.getPredecessors(nodes[i])));
+    }
+  }
+
+  SECTION("Edge and vertex removal keep the index up to date") {
+    graph::DirectedGraph<Vertex> g{{0, 1}, {1, 2}, {2, 0}, {3, 1}, {1, 1}};
+    auto node = [&](Vertex v) { return const_cast<NodePtr>(g.nodes()[v]); }; // NOLINT
+    g.enablePredecessorIndex();
+    CHECK(g.inDegree(node(1)) == 3);
+    CHECK(sorted(g.getPredecessors(node(1))) == std::vector<Vertex>{0, 1, 3});
+
+    g.removeEdge(node(3), node(1));
+    CHECK(g.inDegree(node(1)) == 2);
+    CHECK(g.inDegree(node(3)) == 0);
+
+    NodePtr one = node(1);
+    CHECK(g.removeVertex(one));
+    CHECK(g.size() == 3);
+    CHECK(g.edgeCount() == 1); // 2 -> 0
+    CHECK(g.inDegree(node(0)) == 1);
+    CHECK(g.inDegree(node(1)) == 0); // 2 moved up to index 1
+    CHECK(g.outDegree(node(0)) == 0);
+    CHECK_FALSE(g.removeVertex(one));
+
+    graph::DirectedGraph<Vertex> copy = g;
+    CHECK(copy.hasPredecessorIndex());
+    auto copied = copy.nodes();
+    CHECK(copy.inDegree(copied[0]) == 1);
+    g.disablePredecessorIndex();
+    CHECK(g.nodes()[0]->predecessors() == nullptr);
+    CHECK(g.inDegree(g.nodes()[0]) == 1);
+  }
+
+  SECTION("Removing a vertex of an UndirectedGraph only visits its neighbors") {
+    graph::UndirectedGraph<Vertex> g{{0, 1}, {1, 2}, {2, 2}, {2, 3}};
+    auto nodes = g.nodes();
+    CHECK(g.removeVertex(const_cast<NodePtr>(nodes[2]))); // NOLINT
+    CHECK(g.edgeCount() == 1);
+    CHECK(g.degree(nodes[1]) == 1);
+    CHECK(g.degree(nodes[3]) == 0);
+  }
+}
+
+TEST_CASE("DirectedGraph in-degree by scan vs predecessor index", "[graph][directed][.benchmark]") {
+  auto edges = randomEdges(200'000, 1'000'000, 12);
+  graph::DirectedGraph<Vertex> scanned;
+  scanned.fromEdges(edges);
+  graph::DirectedGraph<Vertex> indexed;
+  indexed.enablePredecessorIndex();
+  indexed.fromEdges(edges);
+  auto scannedNodes = scanned.nodes();
+  auto indexedNodes = indexed.nodes();
+
+  BENCHMARK("inDegree of 20 vertices, scan") {
+    size_t total = 0;
+    for (size_t i = 0; i < 20; ++i) total += scanned.inDegree(scannedNodes[i * 997]);
+    return total;
+  };
+  BENCHMARK("inDegree of 20 vertices, index") {
+    size_t total = 0;
+    for (size_t i = 0; i < 20; ++i) total += indexed.inDegree(indexedNodes[i * 997]);
+    return total;
+  };
+  BENCHMARK("fromEdges, scan") {
+    graph::DirectedGraph<Vertex> g;
+    g.fromEdges(edges);
+    return g.size();
+  };
+  BENCHMARK("fromEdges, index") {
+    graph::DirectedGraph<Vertex> g;
+    g.enablePredecessorIndex();
+    g.fromEdges(edges);
+    return g.size();
+  };
+}
+
+TEST_CASE("Dynamic topological order", "[graph][directed][topological]") {
+  using NodePtr = graph::Node<Vertex>*;
+
+  SECTION("Insertions keep the order valid and edges closing a cycle are rejected") {
+    graph::utils::DynamicTopologicalOrder<Vertex> dynamic;
+    std::vector<NodePtr> nodes;
+    for (Vertex v = 0; v < 5; ++v) nodes.push_back(dynamic.addVertex(v));
+    CHECK(dynamic.addEdge(nodes[3], nodes[1]));
+    CHECK(dynamic.addEdge(nodes[4], nodes[3]));
+    CHECK(dynamic.addEdge(nodes[1], nodes[0]));
+    CHECK(graph::utils::isValidTopologicalOrder(dynamic.order()));
+    CHECK(dynamic.position(nodes[4]) < dynamic.position(nodes[0]));
+
+    auto before = dynamic.order();
+    CHECK_FALSE(dynamic.addEdge(nodes[0], nodes[4]));
+    CHECK_FALSE(dynamic.addEdge(nodes[2], nodes[2]));
+    CHECK_FALSE(dynamic.graph().hasEdge(nodes[0], nodes[4]));
+    CHECK(std::ranges::equal(dynamic.order(), before));
+    CHECK(dynamic.graph().edgeCount() == 3);
+
+    dynamic.removeEdge(nodes[4], nodes[3]);
+    CHECK(dynamic.addEdge(nodes[0], nodes[4]));
+    CHECK(graph::utils::isValidTopologicalOrder(dynamic.order()));
+    CHECK(dynamic.size() == 5);
+
+    graph::DirectedGraph<Vertex> other{{0, 1}};
+    auto stranger = const_cast<NodePtr>(other.nodes()[1]); // NOLINT
+    CHECK_THROWS_AS(dynamic.addEdge(nodes[0], stranger), std::invalid_argument);
+  }
+
+  SECTION("Starts from an existing DAG and refuses a cyclic one") {
+    graph::DirectedGraph<Vertex> g;
+    g.fromEdges(randomDag(100, 300, 5));
+    size_t vertices = g.size();
+    size_t edges = g.edgeCount();
+    graph::utils::DynamicTopologicalOrder<Vertex> dynamic(std::move(g));
+    CHECK(dynamic.size() == vertices);
+    CHECK(dynamic.graph().edgeCount() == edges);
+    CHECK(dynamic.graph().hasPredecessorIndex());
+    CHECK(graph::utils::isValidTopologicalOrder(dynamic.order()));
+
+    graph::DirectedGraph<Vertex> cyclic{{0, 1}, {1, 2}, {2, 0}};
+    CHECK_THROWS_AS(graph::utils::DynamicTopologicalOrder<Vertex>(std::move(cyclic)), std::invalid_argument);
+  }
+
+  SECTION("Random insertions are accepted exactly when they keep the graph acyclic") {
+    constexpr size_t n = 200;
+    graph::utils::DynamicTopologicalOrder<Vertex> dynamic;
+    std::vector<NodePtr> nodes;
+    for (Vertex v = 0; v < n; ++v) nodes.push_back(dynamic.addVertex(v));
+    std::vector<std::vector<Vertex>> adjacency(n);
+    auto reaches = [&](Vertex from, Vertex to) {
+      std::vector<bool> seen(n, false);
+      std::vector<Vertex> stack{from};
+      seen[from] = true;
+      while (!stack.empty()) {
+        Vertex v = stack.back();
+        stack.pop_back();
+        if (v == to) return true;
+        for (Vertex next : adjacency[v]) {
+          if (!seen[next]) {
+            seen[next] = true;
+            stack.push_back(next);
+          }
+        }
+      }
+      return false;
+    };
+
+    std::mt19937 gen{6};
+    std::uniform_int_distribution<Vertex> pick(0, n - 1);
+    size_t accepted = 0;
+    for (int i = 0; i < 3000; ++i) {
+      Vertex a = pick(gen);
+      Vertex b = pick(gen);
+      bool expected = !reaches(b, a);
+      REQUIRE(dynamic.addEdge(nodes[a], nodes[b]) == expected);
+      if (expected) {
+        adjacency[a].push_back(b);
+        ++accepted;
+      }
+      REQUIRE(dynamic.graph().hasEdge(nodes[a], nodes[b]) == expected);
+    }
+    CHECK(accepted > 300);
+    CHECK(graph::utils::isValidTopologicalOrder(dynamic.order()));
+    for (size_t i = 0; i < n; ++i) CHECK(dynamic.position(dynamic.order()[i]) == i);
+  }
+}
+
+TEST_CASE("Dynamic topological order vs sorting again", "[graph][directed][topological][.benchmark]") {
+  constexpr size_t n = 2000;
+  auto edges = randomEdges(n, 6000, 7);
+
+  BENCHMARK("6000 insertions, Pearce-Kelly") {
+    graph::utils::DynamicTopologicalOrder<Vertex> dynamic;
+    std::vector<graph::Node<Vertex>*> nodes;
+    for (Vertex v = 0; v < n; ++v) nodes.push_back(dynamic.addVertex(v));
+    size_t accepted = 0;
+    for (auto [a, b] : edges) accepted += dynamic.addEdge(nodes[a], nodes[b]) ? 1 : 0;
+    return accepted;
+  };
+  BENCHMARK("6000 insertions, topologicalSort after each") {
+    graph::DirectedGraph<Vertex> g;
+    std::vector<graph::Node<Vertex>*> nodes;
+    for (Vertex v = 0; v < n; ++v) nodes.push_back(g.addVertex(v));
+    size_t accepted = 0;
+    for (auto [a, b] : edges) {
+      if (a == b || g.hasEdge(nodes[a], nodes[b])) continue;
+      g.addEdge(nodes[a], nodes[b]);
+      if (graph::utils::topologicalSort(g).first) {
+        ++accepted;
+      } else {
+        g.removeEdge(nodes[a], nodes[b]);
+      }
+    }
+    return accepted;
+  };
+}
+
+TEST_CASE("CsrGraph from edge lists", "[graph][csr]") {
+  SECTION("Directed rows are sorted and hold every edge once") {
+    std::vector<std::pair<int, int>> edges{{0, 2}, {0, 1}, {1, 2}, {0, 2}, {3, 3}};
+    auto g = graph::CsrGraph::fromEdges(5, edges);
+    CHECK(g.vertexCount() == 5);
+    CHECK(g.edgeCount() == 4);
+    CHECK(g.neighbors(0).size() == 2);
+    CHECK(g.neighbors(0)[0] == 1);
+    CHECK(g.neighbors(0)[1] == 2);
+    CHECK(g.outDegree(2) == 0);
+    CHECK(g.outDegree(4) == 0);
+    CHECK(g.hasEdge(1, 2));
+    CHECK_FALSE(g.hasEdge(2, 1));
+    CHECK(g.hasEdge(3, 3));
+    CHECK_FALSE(g.hasEdge(0, 7));
+  }
+
+  SECTION("Undirected edges are stored in both rows, self-loops once") {
+    std::vector<std::pair<int, int>> edges{{0, 1}, {1, 2}, {2, 2}, {1, 0}};
+    auto g = graph::CsrGraph::fromEdges(3, edges, false);
+    CHECK_FALSE(g.directed());
+    CHECK(g.edgeCount() == 3);
+    CHECK(g.arcCount() == 5);
+    CHECK(g.hasEdge(1, 0));
+    CHECK(g.hasEdge(2, 1));
+    CHECK(g.outDegree(2) == 2);
+  }
+
+  SECTION("Transpose reverses every edge") {
+    auto edges = randomDag(200, 1000, 1);
+    auto g = graph::CsrGraph::fromEdges(200, edges);
+    auto reversed = g.transpose();
+    CHECK(reversed.edgeCount() == g.edgeCount());
+    for (Vertex v : g.vertices()) {
+      for (Vertex nei : g.neighbors(v)) CHECK(reversed.hasEdge(nei, v));
+    }
+    CHECK(std::ranges::equal(reversed.transpose().targets(), g.targets()));
+  }
+
+  SECTION("Empty graphs and bad ids") {
+    graph::CsrGraph empty;
+    CHECK(empty.empty());
+    CHECK(empty.edgeCount() == 0);
+    CHECK(graph::utils::kahn(empty).first);
+    std::vector<std::pair<int, int>> edges{{0, 3}};
+    CHECK_THROWS_AS(graph::CsrGraph::fromEdges(3, edges), std::out_of_range);
+  }
+}
+
+TEST_CASE("CsrGraph snapshots of Graph", "[graph][csr]") {
+  SECTION("DirectedGraph") {
+    graph::DirectedGraph<std::string> g{{"a", "b"}, {"b", "c"}, {"a", "c"}, {"d", "d"}};
+    auto csr = graph::CsrGraph::fromGraph(g);
+    auto nodes = g.nodes();
+    auto node = [&](Vertex v) { return const_cast<graph::Node<std::string>*>(nodes[v]); }; // NOLINT
+    REQUIRE(csr.vertexCount() == g.vertexCount());
+    CHECK(csr.edgeCount() == g.edgeCount());
+    for (Vertex v : csr.vertices()) {
+      CHECK(csr.outDegree(v) == g.outDegree(nodes[v]));
+      for (Vertex nei : csr.neighbors(v)) CHECK(g.hasEdge(node(v), node(nei)));
+    }
+  }
+
+  SECTION("UndirectedGraph") {
+    graph::UndirectedGraph<int> g{{1, 2}, {2, 3}, {3, 3}, {3, 1}};
+    auto csr = graph::CsrGraph::fromGraph(g);
+    CHECK_FALSE(csr.directed());
+    CHECK(csr.edgeCount() == g.edgeCount());
+    CHECK(csr.arcCount() == 7);
+  }
+}
+
+TEST_CASE("Topological sorts over CsrGraph", "[graph][csr][topological]") {
+  SECTION("Both sorts order a random DAG") {
+    auto edges = randomDag(2000, 10000, 2);
+    auto g = graph::CsrGraph::fromEdges(2000, edges);
+    auto [dfsValid, dfsOrder] = graph::utils::topologicalSort(g);
+    auto [kahnValid, kahnOrder] = graph::utils::kahn(g);
+    CHECK(dfsValid);
+    CHECK(kahnValid);
+    CHECK(isTopologicalOrder(g, dfsOrder));
+    CHECK(isTopologicalOrder(g, kahnOrder));
+  }
+
+  SECTION("Cycles are reported") {
+    std::vector<std::pair<int, int>> edges{{0, 1}, {1, 2}, {2, 3}, {3, 1}};
+    auto g = graph::CsrGraph::fromEdges(4, edges);
+    CHECK_FALSE(graph::utils::topologicalSort(g).first);
+    CHECK_FALSE(graph::utils::kahn(g).first);
+    std::vector<std::pair<int, int>> loop{{0, 0}};
+    CHECK_FALSE(graph::utils::kahn(graph::CsrGraph::fromEdges(1, loop)).first);
+  }
+
+  SECTION("A long path doesn't overflow the stack") {
+    constexpr size_t length = 1'000'000;
+    std::vector<std::pair<Vertex, Vertex>> edges;
+    for (Vertex v = 0; v + 1 < length; ++v) edges.emplace_back(v, v + 1);
+    auto [valid, order] = graph::utils::topologicalSort(graph::CsrGraph::fromEdges(length, edges));
+    CHECK(valid);
+    CHECK(order.front() == 0);
+    CHECK(order.back() == length - 1);
+  }
+
+  SECTION("Undirected graphs are rejected") {
+    std::vector<std::pair<int, int>> edges{{0, 1}};
+    CHECK_THROWS_AS(graph::utils::kahn(graph::CsrGraph::fromEdges(2, edges, false)), std::invalid_argument);
+  }
+}
+
+TEST_CASE("All topological orders", "[graph][csr][topological]") {
+  using Edges = std::vector<std::pair<Vertex, Vertex>>;
+  static_assert(std::ranges::input_range<graph::utils::TopologicalOrders>);
+  auto enumerate = [](const graph::CsrGraph& g) {
+    std::vector<std::vector<Vertex>> orders;
+    for (std::span<const Vertex> order : graph::utils::TopologicalOrders(g)) {
+      orders.emplace_back(order.begin(), order.end());
+    }
+    return orders;
+  };
+
+  SECTION("A diamond has two orders") {
+    Edges edges{{0, 1}, {0, 2}, {1, 3}, {2, 3}};
+    auto g = graph::CsrGraph::fromEdges(4, edges);
+    CHECK(enumerate(g) == std::vector<std::vector<Vertex>>{{0, 1, 2, 3}, {0, 2, 1, 3}});
+    CHECK(graph::utils::countTopologicalOrders(g) == 2);
+
+    graph::utils::TopologicalOrders orders(g);
+    REQUIRE(orders.next());
+    CHECK(orders.order().size() == 4);
+    REQUIRE(orders.next());
+    CHECK_FALSE(orders.next());
+    CHECK(orders.done());
+    CHECK_FALSE(orders.next());
+  }
+
+  SECTION("Cycles have none and the empty graph has one") {
+    Edges cycle{{0, 1}, {1, 2}, {2, 1}};
+    CHECK(enumerate(graph::CsrGraph::fromEdges(3, cycle)).empty());
+    CHECK(graph::utils::countTopologicalOrders(graph::CsrGraph::fromEdges(3, cycle)) == 0);
+    Edges loop{{0, 0}};
+    CHECK(enumerate(graph::CsrGraph::fromEdges(2, loop)).empty());
+    CHECK(graph::utils::countTopologicalOrders(graph::CsrGraph::fromEdges(2, loop)) == 0);
+
+    Edges none;
+    CHECK(enumerate(graph::CsrGraph::fromEdges(0, none)).size() == 1);
+    CHECK(graph::utils::countTopologicalOrders(graph::CsrGraph::fromEdges(0, none)) == 1);
+    CHECK(graph::utils::countTopologicalOrders(graph::CsrGraph::fromEdges(6, none)) == 720);
+    uint64_t factorial20 = 2'432'902'008'176'640'000;
+    CHECK(graph::utils::countTopologicalOrders(graph::CsrGraph::fromEdges(20, none)) == factorial20);
+  }
+
+  SECTION("Enumeration and counting agree on random DAGs") {
+    for (uint32_t seed = 0; seed < 20; ++seed) {
+      auto g = graph::CsrGraph::fromEdges(9, randomDag(9, 10, seed));
+      auto orders = enumerate(g);
+      CHECK(orders.size() == graph::utils::countTopologicalOrders(g));
+      CHECK(std::ranges::is_sorted(orders));
+      CHECK(std::ranges::adjacent_find(orders) == orders.end());
+      for (const auto& order : orders) {
+        REQUIRE(isTopologicalOrder(g, array::DynamicArray<Vertex>(order.begin(), order.end())));
+      }
+    }
+  }
+
+  SECTION("DirectedGraph orders are node pointers") {
+    graph::DirectedGraph<Vertex> g{{5, 7}, {5, 6}, {6, 8}, {7, 8}, {9, 8}};
+    auto all = graph::utils::allTopologicalOrders(g);
+    CHECK(all.size() == graph::utils::countTopologicalOrders(g));
+    CHECK(all.size() == 8);
+    size_t lazy = 0;
+    for (auto order : graph::utils::NodeTopologicalOrders<Vertex>(g)) {
+      REQUIRE(std::ranges::equal(order, all[lazy++]));
+      CHECK(graph::utils::isValidTopologicalOrder(order));
+    }
+    CHECK(lazy == all.size());
+    CHECK(graph::utils::allTopologicalOrders(graph::DirectedGraph<Vertex>{}).empty());
+
+    // iterating after next() continues from the order next() found, for both enumerators
+    graph::utils::NodeTopologicalOrders<Vertex> nodeOrders(g);
+    REQUIRE(nodeOrders.next());
+    size_t rest = 0;
+    for (auto order : nodeOrders) CHECK(std::ranges::equal(order, all[rest++]));
+    CHECK(rest == all.size());
+    graph::utils::TopologicalOrders idOrders(graph::CsrGraph::fromGraph(g));
+    REQUIRE(idOrders.next());
+    REQUIRE(idOrders.next());
+    rest = 1;
+    for ([[maybe_unused]] auto order : idOrders) ++rest;
+    CHECK(rest == all.size());
+  }
+
+  SECTION("Invalid graphs are rejected") {
+    Edges none;
+    auto large = graph::CsrGraph::fromEdges(21, none);
+    CHECK_THROWS_AS(graph::utils::countTopologicalOrders(large), std::length_error);
+    Edges edge{{0, 1}};
+    auto undirected = graph::CsrGraph::fromEdges(2, edge, false);
+    CHECK_THROWS_AS(graph::utils::countTopologicalOrders(undirected), std::invalid_argument);
+    CHECK_THROWS_AS(graph::utils::TopologicalOrders(undirected), std::invalid_argument);
+  }
+}
+
+TEST_CASE("Counting topological orders vs enumerating them", "[graph][csr][topological][.benchmark]") {
+  // two chains of 6 and an independent pair: C(12, 6) * 14 * 13 = 168168 orders
+  std::vector<std::pair<Vertex, Vertex>> edges;
+  for (Vertex v = 0; v < 5; ++v) {
+    edges.emplace_back(v, v + 1);
+    edges.emplace_back(v + 6, v + 7);
+  }
+  auto g = graph::CsrGraph::fromEdges(14, edges);
+
+  BENCHMARK("enumerate") {
+    size_t count = 0;
+    graph::utils::TopologicalOrders orders(g);
+    while (orders.next()) ++count;
+    return count;
+  };
+  BENCHMARK("count") { return graph::utils::countTopologicalOrders(g); };
+}
+
+TEST_CASE("Strongly connected components", "[graph][csr][scc]") {
+  SECTION("Components of a small graph, numbered in topological order") {
+    // {0, 1, 2} -> {3, 4} -> {5}, and 6 alone with a self-loop
+    std::vector<std::pair<Vertex, Vertex>> edges{{0, 1}, {1, 2}, {2, 0}, {2, 3}, {3, 4},
+                                                 {4, 3}, {4, 5}, {1, 5}, {6, 6}};
+    auto g = graph::CsrGraph::fromEdges(7, edges);
+    graph::utils::StronglyConnectedComponents scc = graph::utils::stronglyConnectedComponents(g);
+    REQUIRE(scc.count() == 4);
+    CHECK(std::ranges::equal(scc.members(scc.component[0]), std::array<Vertex, 3>{0, 1, 2}));
+    CHECK(std::ranges::equal(scc.members(scc.component[4]), std::array<Vertex, 2>{3, 4}));
+    CHECK(scc.component[0] < scc.component[3]);
+    CHECK(scc.component[3] < scc.component[5]);
+
+    graph::CsrGraph dag = graph::utils::condensation(g, scc);
+    CHECK(dag.vertexCount() == 4);
+    CHECK(dag.arcCount() == 3);
+    CHECK(dag.hasEdge(scc.component[0], scc.component[5]));
+    CHECK_FALSE(graph::utils::hasCycle(dag));
+    CHECK(graph::utils::hasCycle(g));
+  }
+
+  SECTION("Agrees with mutual reachability on random graphs") {
+    for (uint32_t seed = 0; seed < 10; ++seed) {
+      auto g = graph::CsrGraph::fromEdges(60, randomEdges(60, 90, seed));
+      graph::utils::StronglyConnectedComponents scc = graph::utils::stronglyConnectedComponents(g);
+      std::vector<array::DynamicArray<uint32_t>> reach;
+      for (Vertex v : g.vertices()) reach.push_back(sequentialDistances(g, v));
+      for (Vertex u : g.vertices()) {
+        for (Vertex v : g.vertices()) {
+          bool mutual = reach[u][v] != graph::utils::BfsResult::unreachable &&
+                        reach[v][u] != graph::utils::BfsResult::unreachable;
+          REQUIRE((scc.component[u] == scc.component[v]) == mutual);
+        }
+        for (Vertex v : g.neighbors(u)) REQUIRE(scc.component[u] <= scc.component[v]);
+      }
+      auto [valid, order] = graph::utils::topologicalSort(graph::utils::condensation(g));
+      CHECK(valid);
+      CHECK(order.size() == scc.count());
+    }
+  }
+
+  SECTION("Long chains don't overflow the stack") {
+    constexpr Vertex length = 150'000;
+    std::vector<std::pair<Vertex, Vertex>> edges;
+    for (Vertex v = 0; v + 1 < length; ++v) edges.emplace_back(v, v + 1);
+    edges.emplace_back(length - 1, 0);
+    auto ring = graph::CsrGraph::fromEdges(length, edges);
+    CHECK(graph::utils::stronglyConnectedComponents(ring).count() == 1);
+
+    edges.pop_back();
+    graph::DirectedGraph<Vertex> chain;
+    chain.fromEdges(edges);
+    CHECK_FALSE(chain.hasCycle());
+    auto [valid, order] = graph::utils::topologicalSort(chain);
+    CHECK(valid);
+    CHECK(order.front()->val() == 0);
+    CHECK(order.back()->val() == length - 1);
+    CHECK(graph::utils::stronglyConnectedComponents(chain).size() == length);
+    auto node = [&](Vertex v) { return const_cast<graph::Node<Vertex>*>(chain.nodes()[v]); }; // NOLINT
+    chain.addEdge(node(length - 1), node(0)); // nodes are in order of first appearance
+    CHECK(chain.hasCycle());
+    CHECK(graph::utils::stronglyConnectedComponents(chain).size() == 1);
+  }
+}
+
+TEST_CASE("Parallel DAG executor", "[graph][csr][executor]") {
+  using graph::utils::TaskState;
+
+  SECTION("Every vertex runs once, after all of its predecessors") {
+    auto g = graph::CsrGraph::fromEdges(500, randomDag(500, 3000, 5));
+    graph::CsrGraph predecessors = g.transpose();
+    for (auto order : {graph::utils::SchedulingOrder::CriticalPath, graph::utils::SchedulingOrder::Fifo}) {
+      std::vector<std::atomic<int>> runs(g.vertexCount());
+      std::atomic<size_t> early{0};
+      graph::utils::DagExecutor executor(g, {.order = order});
+      graph::utils::ExecutionTrace trace = executor.run([&](Vertex v) {
+        for (Vertex pred : predecessors.neighbors(v)) {
+          if (runs[pred].load() != 1) ++early;
+        }
+        ++runs[v];
+      });
+      CHECK(early == 0);
+      CHECK(std::ranges::all_of(runs, [](const std::atomic<int>& count) { return count.load() == 1; }));
+      CHECK(trace.completed == g.vertexCount());
+      CHECK(trace.cancelled == 0);
+      for (Vertex u : g.vertices()) {
+        for (Vertex v : g.neighbors(u)) REQUIRE(trace.tasks[u].finish <= trace.tasks[v].start);
+        REQUIRE(trace.tasks[u].finish <= trace.makespan);
+      }
+      CHECK(trace.utilization() > 0);
+      CHECK(trace.utilization() <= 1);
+    }
+  }
+
+  SECTION("Critical paths weigh the costs") {
+    // 0 -> 1 -> 2 and 3 -> 2, 3 costs 10
+    std::vector<std::pair<Vertex, Vertex>> edges{{0, 1}, {1, 2}, {3, 2}};
+    auto g = graph::CsrGraph::fromEdges(4, edges);
+    std::array<uint64_t, 4> costs{1, 1, 1, 10};
+    graph::utils::DagExecutor executor(g, {.costs = costs});
+    CHECK(executor.criticalPath(0) == 3);
+    CHECK(executor.criticalPath(2) == 1);
+    CHECK(executor.criticalPath(3) == 11);
+  }
+
+  SECTION("Stopping and failing cancel what hasn't started") {
+    std::vector<std::pair<Vertex, Vertex>> edges;
+    for (Vertex v = 0; v + 1 < 10; ++v) edges.emplace_back(v, v + 1);
+    auto chain = graph::CsrGraph::fromEdges(10, edges);
+    graph::utils::DagExecutor executor(chain);
+
+    std::stop_source stop;
+    graph::utils::ExecutionTrace trace = executor.run(
+        [&](Vertex v) {
+          if (v == 4) stop.request_stop();
+        },
+        stop.get_token()
+    );
+    CHECK(trace.completed == 5);
+    CHECK(trace.cancelled == 5);
+    CHECK(trace.tasks[5].state == TaskState::Cancelled);
+
+    std::atomic<Vertex> last{0};
+    auto failing = [&](Vertex v) {
+      last = v;
+      if (v == 2) throw std::runtime_error("task failed");
+    };
+    CHECK_THROWS_AS(executor.run(failing), std::runtime_error);
+    CHECK(last == 2);
+    CHECK(executor.run([](Vertex) {}).completed == 10); // the executor can run again
+  }
+
+  SECTION("DirectedGraph tasks") {
+    graph::DirectedGraph<std::string> build{
+        {"configure", "compile a"}, {"configure", "compile b"}, {"compile a", "link"}, {"compile b", "link"}
+    };
+    std::mutex mutex;
+    std::vector<std::string> log;
+    auto record = [&](const graph::Node<std::string>* task) {
+      std::lock_guard lock(mutex);
+      log.push_back(task->val());
+    };
+    graph::utils::ExecutionTrace trace = graph::utils::executeDag(build, record);
+    CHECK(trace.completed == 4);
+    REQUIRE(log.size() == 4);
+    CHECK(log.front() == "configure");
+    CHECK(log.back() == "link");
+  }
+
+  SECTION("Cycles and bad costs are rejected") {
+    std::vector<std::pair<Vertex, Vertex>> edges{{0, 1}, {1, 0}};
+    auto cyclic = graph::CsrGraph::fromEdges(2, edges);
+    CHECK_THROWS_AS(graph::utils::DagExecutor(cyclic), std::invalid_argument);
+    auto g = graph::CsrGraph::fromEdges(3, std::vector<std::pair<Vertex, Vertex>>{{0, 1}});
+    std::array<uint64_t, 2> costs{1, 1};
+    CHECK_THROWS_AS(graph::utils::DagExecutor(g, {.costs = costs}), std::invalid_argument);
+  }
+}
+
+TEST_CASE("Parallel DAG executor makespan", "[graph][csr][executor][.benchmark]") {
+  // a long chain next to many short independent tasks: running the chain first keeps the makespan down
+  constexpr Vertex chainLength = 200;
+  constexpr Vertex independent = 2000;
+  std::vector<std::pair<Vertex, Vertex>> edges;
+  for (Vertex v = 0; v + 1 < chainLength; ++v) edges.emplace_back(v, v + 1);
+  auto g = graph::CsrGraph::fromEdges(chainLength + independent, edges);
+  auto work = [](Vertex v) {
+    auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(20 + (v % 7));
+    while (std::chrono::steady_clock::now() < until) {}
+  };
+  for (auto order : {graph::utils::SchedulingOrder::CriticalPath, graph::utils::SchedulingOrder::Fifo}) {
+    graph::utils::DagExecutor executor(g, {.order = order});
+    std::string name = order == graph::utils::SchedulingOrder::CriticalPath ? "critical path" : "fifo";
+    graph::utils::ExecutionTrace trace = executor.run(work);
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(trace.makespan).count();
+    WARN(name << ": makespan " << micros << " us, utilization " << trace.utilization());
+    BENCHMARK(name) { return executor.run(work).makespan; };
+  }
+}
+
+TEST_CASE("Direction-optimizing parallel BFS", "[graph][csr][bfs]") {
+  using graph::utils::BfsDirection;
+  constexpr std::array directions{BfsDirection::Optimizing, BfsDirection::TopDown, BfsDirection::BottomUp};
+
+  SECTION("Undirected graph") {
+    auto g = graph::CsrGraph::fromEdges(5000, randomEdges(5000, 40'000, 4), false);
+    for (BfsDirection direction : directions) checkBfs(g, 17, graph::utils::parallelBfs(g, 17, {direction}));
+    auto result = graph::utils::parallelBfs(g, 17);
+    CHECK(result.topDownSteps > 0);
+    CHECK(result.bottomUpSteps > 0);
+  }
+
+  SECTION("Directed graph with unreachable vertices, several roots") {
+    // vertices past 3000 have no edges, and some below only have edges going out
+    auto g = graph::CsrGraph::fromEdges(3100, randomEdges(3000, 12'000, 5));
+    for (BfsDirection direction : directions) {
+      graph::utils::ParallelBfs bfs(g, {direction});
+      for (Vertex root : {0U, 1234U, 2999U, 3050U}) checkBfs(g, root, bfs.run(root));
+    }
+  }
+
+  SECTION("A long path") {
+    std::vector<std::pair<Vertex, Vertex>> edges;
+    for (Vertex v = 0; v + 1 < 1000; ++v) edges.emplace_back(v, v + 1);
+    auto g = graph::CsrGraph::fromEdges(1000, edges, false);
+    for (BfsDirection direction : directions) {
+      auto result = graph::utils::parallelBfs(g, 500, {direction});
+      checkBfs(g, 500, result);
+      CHECK(result.distances[0] == 500);
+      CHECK(result.distances[999] == 499);
+    }
+  }
+
+  SECTION("Bad arguments") {
+    auto g = graph::CsrGraph::fromEdges(3, std::vector<std::pair<int, int>>{{0, 1}});
+    CHECK_THROWS_AS(graph::utils::parallelBfs(g, 3), std::out_of_range);
+    CHECK_THROWS_AS(graph::utils::ParallelBfs(g, {.alpha = 0}), std::invalid_argument);
+  }
+}
+
+TEST_CASE("Parallel BFS traversed edges per second", "[graph][csr][bfs][.benchmark]") {
+  using graph::utils::BfsDirection;
+  constexpr size_t vertexCount = size_t{1} << 20;
+  constexpr size_t edgeCount = 16 * vertexCount;
+  auto g = graph::CsrGraph::fromEdges(vertexCount, randomEdges(vertexCount, edgeCount, 6), false);
+
+  for (auto [name, direction] : {std::pair{"direction-optimizing", BfsDirection::Optimizing},
+                                 std::pair{"top-down only", BfsDirection::TopDown}}) {
+    graph::utils::ParallelBfs bfs(g, {.direction = direction});
+    double seconds = 0;
+    size_t traversed = 0;
+    for (Vertex root = 0; root < 8; ++root) {
+      auto start = std::chrono::steady_clock::now();
+      auto result = bfs.run(root * 1000);
+      seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      // as Graph500 counts: the undirected edges of the searched component
+      for (Vertex v : g.vertices()) {
+        if (result.parents[v] != graph::utils::BfsResult::noParent) traversed += g.outDegree(v);
+      }
+    }
+    WARN(name << ": " << static_cast<double>(traversed / 2) / seconds / 1e9 << " GTEPS");
+  }
+
+  BENCHMARK("ParallelBfs::run, 1M vertices, 16M edges") {
+    return graph::utils::parallelBfs(g, 0).reached;
+  };
+}
+
+TEST_CASE("Weighted CsrGraph", "[graph][csr][paths]") {
+  SECTION("Of repeated edges the lightest is kept") {
+    std::vector<WeightedEdge> edges{{0, 2, 7}, {0, 1, 4}, {0, 2, 3}, {1, 2, 5}, {0, 2, 9}};
+    auto g = graph::CsrGraph::fromWeightedEdges(3, edges);
+    REQUIRE(g.weighted());
+    CHECK(g.edgeCount() == 3);
+    CHECK(g.weights(0).size() == 2);
+    CHECK(g.weights(0)[0] == 4);
+    CHECK(g.weights(0)[1] == 3);
+    CHECK(g.weights(2).empty());
+  }
+
+  SECTION("Undirected edges keep their weight both ways, transpose keeps it too") {
+    auto g = graph::CsrGraph::fromWeightedEdges(50, randomWeightedEdges(50, 300, 100, 7), false);
+    for (Vertex u : g.vertices()) {
+      for (Vertex v : g.neighbors(u)) CHECK(edgeWeight(g, u, v) == edgeWeight(g, v, u));
+    }
+    auto directed = graph::CsrGraph::fromWeightedEdges(50, randomWeightedEdges(50, 300, 100, 8));
+    auto reversed = directed.transpose();
+    REQUIRE(reversed.weighted());
+    for (Vertex u : directed.vertices()) {
+      for (Vertex v : directed.neighbors(u)) CHECK(edgeWeight(reversed, v, u) == edgeWeight(directed, u, v));
+    }
+  }
+
+  SECTION("Unweighted graphs have no weights") {
+    auto g = graph::CsrGraph::fromEdges(3, std::vector<std::pair<int, int>>{{0, 1}});
+    CHECK_FALSE(g.weighted());
+    CHECK(g.weights(0).empty());
+  }
+}
+
+TEST_CASE("Single-source shortest paths", "[graph][csr][paths]") {
+  using graph::utils::DijkstraHeap;
+  using graph::utils::ShortestPaths;
+
+  SECTION("A small graph") {
+    //  0 -1-> 1 -1-> 2, 0 -5-> 2, 2 -0-> 3, 4 is unreachable
+    std::vector<WeightedEdge> edges{{0, 1, 1}, {1, 2, 1}, {0, 2, 5}, {2, 3, 0}, {4, 0, 1}};
+    auto g = graph::CsrGraph::fromWeightedEdges(5, edges);
+    for (DijkstraHeap heap : {DijkstraHeap::Radix, DijkstraHeap::Indexed}) {
+      ShortestPaths paths = graph::utils::dijkstra(g, 0, heap);
+      CHECK(paths.distances[3] == 2);
+      CHECK(paths.distances[4] == ShortestPaths::unreachable);
+      CHECK(std::ranges::equal(paths.pathTo(3), std::array<Vertex, 4>{0, 1, 2, 3}));
+      CHECK(std::ranges::equal(paths.pathTo(0), std::array<Vertex, 1>{0}));
+      CHECK(paths.pathTo(4).empty());
+    }
+    CHECK(std::ranges::equal(graph::utils::deltaStepping(g, 0), graph::utils::dijkstra(g, 0).distances));
+  }
+
+  SECTION("Random directed graph, against Bellman-Ford") {
+    auto g = graph::CsrGraph::fromWeightedEdges(400, randomWeightedEdges(400, 2000, 1000, 9));
+    for (Vertex source : {0U, 123U, 399U}) {
+      auto expected = bellmanFord(g, source);
+      for (DijkstraHeap heap : {DijkstraHeap::Radix, DijkstraHeap::Indexed}) {
+        ShortestPaths paths = graph::utils::dijkstra(g, source, heap);
+        CHECK(std::ranges::equal(paths.distances, expected));
+        bool treeValid = true;
+        for (Vertex v : g.vertices()) {
+          if (v == source || paths.parents[v] == ShortestPaths::noParent) continue;
+          Vertex parent = paths.parents[v];
+          treeValid = treeValid && paths.distances[parent] + edgeWeight(g, parent, v) == paths.distances[v];
+        }
+        CHECK(treeValid);
+      }
+      for (uint64_t delta : {0, 1, 50, 100'000}) {
+        CHECK(std::ranges::equal(graph::utils::deltaStepping(g, source, delta), expected));
+      }
+    }
+  }
+
+  SECTION("Unweighted graphs count hops") {
+    auto g = graph::CsrGraph::fromEdges(1000, randomEdges(1000, 5000, 10));
+    auto hops = graph::utils::parallelBfs(g, 0);
+    auto paths = graph::utils::dijkstra(g, 0);
+    auto distances = graph::utils::deltaStepping(g, 0);
+    bool same = true;
+    for (Vertex v : g.vertices()) {
+      bool reached = hops.distances[v] != graph::utils::BfsResult::unreachable;
+      uint64_t expected = reached ? hops.distances[v] : ShortestPaths::unreachable;
+      same = same && paths.distances[v] == expected && distances[v] == expected;
+    }
+    CHECK(same);
+  }
+
+  SECTION("Bad sources") {
+    auto g = graph::CsrGraph::fromEdges(3, std::vector<std::pair<int, int>>{{0, 1}});
+    CHECK_THROWS_AS(graph::utils::dijkstra(g, 3), std::out_of_range);
+    CHECK_THROWS_AS(graph::utils::deltaStepping(g, 3), std::out_of_range);
+  }
+}
+
+TEST_CASE("Point-to-point shortest paths", "[graph][csr][paths]") {
+  using graph::utils::ShortestPaths;
+  constexpr size_t width = 60;
+  auto grid = graph::CsrGraph::fromWeightedEdges(width * width, roadGrid(width, width, 11), false);
+  auto manhattan = [&](Vertex target) {
+    return [target](Vertex v) -> uint64_t {
+      auto dx = static_cast<int64_t>(v % width) - static_cast<int64_t>(target % width);
+      auto dy = static_cast<int64_t>(v / width) - static_cast<int64_t>(target / width);
+      return 10 * static_cast<uint64_t>(std::abs(dx) + std::abs(dy)); // every segment is at least 10 long
+    };
+  };
+
+  SECTION("A* and bidirectional Dijkstra agree with Dijkstra") {
+    auto directed = graph::CsrGraph::fromWeightedEdges(500, randomWeightedEdges(500, 3000, 100, 12));
+    graph::utils::BidirectionalDijkstra gridQueries(grid);
+    graph::utils::BidirectionalDijkstra directedQueries(directed);
+    for (auto [source, target] : {std::pair<Vertex, Vertex>{0, 3599}, {1234, 77}, {1800, 1801}, {42, 42}}) {
+      uint64_t expected = graph::utils::dijkstra(grid, source).distances[target];
+      auto guided = graph::utils::aStar(grid, source, target, manhattan(target));
+      auto blind = graph::utils::aStar(grid, source, target, [](Vertex) { return 0; });
+      auto bidirectional = gridQueries.run(source, target);
+      CHECK(guided.distance == expected);
+      CHECK(blind.distance == expected);
+      CHECK(bidirectional.distance == expected);
+      CHECK(isPath(grid, guided, source, target));
+      CHECK(isPath(grid, bidirectional, source, target));
+      CHECK(guided.settled <= blind.settled);
+
+      Vertex from = source % 500;
+      Vertex to = target % 500;
+      auto reference = graph::utils::dijkstra(directed, from);
+      auto result = directedQueries.run(from, to);
+      CHECK(result.distance == reference.distances[to]);
+      if (result.distance != ShortestPaths::unreachable) CHECK(isPath(directed, result, from, to));
+    }
+  }
+
+  SECTION("Unreachable targets") {
+    std::vector<WeightedEdge> edges{{0, 1, 3}, {2, 1, 3}};
+    auto g = graph::CsrGraph::fromWeightedEdges(3, edges);
+    auto result = graph::utils::bidirectionalDijkstra(g, 0, 2);
+    CHECK(result.distance == ShortestPaths::unreachable);
+    CHECK(result.path.empty());
+    CHECK(graph::utils::aStar(g, 0, 2, [](Vertex) { return 0; }).path.empty());
+    CHECK_THROWS_AS(graph::utils::bidirectionalDijkstra(g, 0, 3), std::out_of_range);
+  }
+}
+
+TEST_CASE("Shortest paths on a road-sized grid", "[graph][csr][paths][.benchmark]") {
+  constexpr size_t width = 1000;
+  auto g = graph::CsrGraph::fromWeightedEdges(width * width, roadGrid(width, width, 13), false);
+  Vertex source = 0;
+  Vertex target = static_cast<Vertex>((width * width) - 1);
+  auto manhattan = [&](Vertex v) -> uint64_t {
+    return 10 * ((width - 1 - (v % width)) + (width - 1 - (v / width)));
+  };
+  graph::utils::BidirectionalDijkstra queries(g);
+
+  BENCHMARK("dijkstra, radix heap") { return graph::utils::dijkstra(g, source).distances[target]; };
+  BENCHMARK("dijkstra, indexed heap") {
+    return graph::utils::dijkstra(g, source, graph::utils::DijkstraHeap::Indexed).distances[target];
+  };
+  BENCHMARK("deltaStepping") { return graph::utils::deltaStepping(g, source)[target]; };
+  BENCHMARK("aStar, corner to corner") { return graph::utils::aStar(g, source, target, manhattan).distance; };
+  BENCHMARK("bidirectional, corner to corner") { return queries.run(source, target).distance; };
+  BENCHMARK("bidirectional, 20 blocks apart") { return queries.run(500'500, 510'510).distance; };
+}
+
+TEST_CASE("Blocked Floyd-Warshall", "[graph][csr][apsp]") {
+  using graph::utils::DistanceMatrix;
+  using graph::utils::ShortestPaths;
+
+  SECTION("Matches Dijkstra around the tile size, paths included") {
+    for (size_t n : {1, 63, 64, 65, 150}) {
+      auto edges = randomWeightedEdges(n, 4 * n, 50, static_cast<uint32_t>(n));
+      auto g = graph::CsrGraph::fromWeightedEdges(n, edges);
+      DistanceMatrix plain = graph::utils::floydWarshall(g);
+      DistanceMatrix tracked = graph::utils::floydWarshall(g, true);
+      REQUIRE(tracked.size() == n);
+      CHECK(tracked.tracksPaths());
+      CHECK_FALSE(plain.tracksPaths());
+      bool same = true;
+      bool pathsValid = true;
+      for (Vertex source : g.vertices()) {
+        auto expected = graph::utils::dijkstra(g, source).distances;
+        for (Vertex target : g.vertices()) {
+          uint64_t distance = tracked(source, target);
+          if (distance == DistanceMatrix::unreachable) distance = ShortestPaths::unreachable;
+          same = same && distance == expected[target] && plain(source, target) == tracked(source, target);
+          if (distance == ShortestPaths::unreachable) {
+            pathsValid = pathsValid && tracked.path(source, target).empty();
+            continue;
+          }
+          graph::utils::PointToPointPath path{distance, tracked.path(source, target)};
+          pathsValid = pathsValid && isPath(g, path, source, target);
+        }
+      }
+      CHECK(same);
+      CHECK(pathsValid);
+    }
+  }
+
+  SECTION("A hand-filled matrix, closed in place") {
+    DistanceMatrix matrix(3);
+    matrix(0, 1) = 4;
+    matrix(1, 2) = 0;
+    matrix(0, 2) = 9;
+    graph::utils::floydWarshall(matrix, true);
+    CHECK(matrix.at(0, 2) == 4);
+    CHECK(matrix.at(2, 0) == DistanceMatrix::unreachable);
+    CHECK(std::ranges::equal(matrix.path(0, 2), std::array<Vertex, 3>{0, 1, 2}));
+    CHECK(std::ranges::equal(matrix.path(1, 1), std::array<Vertex, 1>{1}));
+    CHECK_THROWS_AS(matrix.at(0, 3), std::out_of_range);
+  }
+
+  SECTION("Unweighted graphs count hops, misuse throws") {
+    auto g = graph::CsrGraph::fromEdges(200, randomEdges(200, 600, 14));
+    DistanceMatrix matrix = graph::utils::floydWarshall(g);
+    auto hops = graph::utils::parallelBfs(g, 7);
+    bool same = true;
+    for (Vertex v : g.vertices()) {
+      bool reached = hops.distances[v] != graph::utils::BfsResult::unreachable;
+      uint32_t expected = reached ? hops.distances[v] : DistanceMatrix::unreachable;
+      same = same && matrix(7, v) == expected;
+    }
+    CHECK(same);
+    CHECK_THROWS_AS(matrix.path(0, 1), std::logic_error);
+    std::vector<WeightedEdge> heavy{{0, 1, DistanceMatrix::unreachable}};
+    auto tooHeavy = graph::CsrGraph::fromWeightedEdges(2, heavy);
+    CHECK_THROWS_AS(graph::utils::floydWarshall(tooHeavy), std::invalid_argument);
+  }
+}
+
+TEST_CASE("Blocked Floyd-Warshall vs the textbook loop", "[graph][csr][apsp][.benchmark]") {
+  constexpr size_t n = 1024;
+  auto g = graph::CsrGraph::fromWeightedEdges(n, randomWeightedEdges(n, 16 * n, 1000, 15));
+  graph::utils::DistanceMatrix direct = graph::utils::DistanceMatrix::fromGraph(g);
+
+  BENCHMARK("textbook, 1024 vertices") {
+    graph::utils::DistanceMatrix matrix = direct;
+    for (size_t k = 0; k < n; ++k) {
+      for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) matrix(i, j) = std::min(matrix(i, j), matrix(i, k) + matrix(k, j));
+      }
+    }
+    return matrix(0, n - 1);
+  };
+  BENCHMARK("blocked, 1024 vertices") {
+    graph::utils::DistanceMatrix matrix = direct;
+    graph::utils::floydWarshall(matrix);
+    return matrix(0, n - 1);
+  };
+  BENCHMARK("blocked with paths, 1024 vertices") {
+    graph::utils::DistanceMatrix matrix = direct;
+    graph::utils::floydWarshall(matrix, true);
+    return matrix(0, n - 1);
+  };
+}
+
+TEST_CASE("Minimum spanning forests", "[graph][csr][mst]") {
+  using graph::utils::SpanningForest;
+
+  SECTION("Kruskal, Prim and Borůvka agree with brute force on small graphs") {
+    for (uint32_t seed = 0; seed < 20; ++seed) {
+      // with equal weights and self-loops, duplicates keep the lightest edge
+      std::vector<WeightedEdge> edges = randomWeightedEdges(7, 12, 5, seed);
+      auto g = graph::CsrGraph::fromWeightedEdges(7, edges, false);
+      std::vector<WeightedEdge> simple;
+      for (Vertex u : g.vertices()) {
+        for (Vertex v : g.neighbors(u)) {
+          if (u < v) simple.emplace_back(u, v, edgeWeight(g, u, v));
+        }
+      }
+      uint64_t expected = bruteForceForestWeight(7, simple);
+      for (const SpanningForest& forest :
+           {graph::utils::kruskal(g), graph::utils::prim(g), graph::utils::boruvka(g)}) {
+        CHECK(isSpanningForest(g, forest));
+        CHECK(forest.totalWeight == expected);
+      }
+    }
+  }
+
+  SECTION("Larger graphs with many equal weights and several components") {
+    for (uint32_t seed = 0; seed < 4; ++seed) {
+      auto g = graph::CsrGraph::fromWeightedEdges(5000, randomWeightedEdges(5000, 6000, 3, seed), false);
+      SpanningForest kruskal = graph::utils::kruskal(g);
+      SpanningForest prim = graph::utils::prim(g);
+      SpanningForest boruvka = graph::utils::boruvka(g);
+      CHECK(kruskal.components > 1);
+      CHECK(isSpanningForest(g, kruskal));
+      CHECK(isSpanningForest(g, prim));
+      CHECK(isSpanningForest(g, boruvka));
+      CHECK(prim.totalWeight == kruskal.totalWeight);
+      CHECK(boruvka.totalWeight == kruskal.totalWeight);
+    }
+  }
+
+  SECTION("Unweighted and degenerate graphs") {
+    std::vector<std::pair<Vertex, Vertex>> edges{{0, 1}, {1, 2}, {2, 2}};
+    auto path = graph::CsrGraph::fromEdges(4, edges, false);
+    SpanningForest forest = graph::utils::boruvka(path);
+    CHECK(forest.totalWeight == 2);
+    CHECK(forest.components == 2);
+    CHECK(isSpanningForest(path, forest));
+
+    auto empty = graph::CsrGraph::fromEdges(0, std::vector<std::pair<Vertex, Vertex>>{}, false);
+    CHECK(graph::utils::kruskal(empty).edges.empty());
+    CHECK(graph::utils::prim(empty).components == 0);
+    CHECK(graph::utils::boruvka(empty).totalWeight == 0);
+  }
+
+  SECTION("Directed graphs are rejected") {
+    auto directed = graph::CsrGraph::fromWeightedEdges(3, std::vector<WeightedEdge>{{0, 1, 1}});
+    CHECK_THROWS_AS(graph::utils::kruskal(directed), std::invalid_argument);
+    CHECK_THROWS_AS(graph::utils::prim(directed), std::invalid_argument);
+    CHECK_THROWS_AS(graph::utils::boruvka(directed), std::invalid_argument);
+  }
+}
+
+TEST_CASE("Minimum spanning forests of large graphs", "[graph][csr][mst][.benchmark]") {
+  constexpr size_t width = 1000;
+  auto road = graph::CsrGraph::fromWeightedEdges(width * width, roadGrid(width, width, 17), false);
+  constexpr size_t n = 1'000'000;
+  auto random = graph::CsrGraph::fromWeightedEdges(n, randomWeightedEdges(n, 8 * n, 1'000'000, 19), false);
+
+  BENCHMARK("kruskal, road grid") { return graph::utils::kruskal(road).totalWeight; };
+  BENCHMARK("prim, road grid") { return graph::utils::prim(road).totalWeight; };
+  BENCHMARK("boruvka, road grid") { return graph::utils::boruvka(road).totalWeight; };
+  BENCHMARK("kruskal, 8M random edges") { return graph::utils::kruskal(random).totalWeight; };
+  BENCHMARK("prim, 8M random edges") { return graph::utils::prim(random).totalWeight; };
+  BENCHMARK("boruvka, 8M random edges") { return graph::utils::boruvka(random).totalWeight; };
+}
+
+TEST_CASE("CsrGraph traversal vs Graph on 10M edges", "[graph][csr][.benchmark]") {
+  constexpr size_t vertexCount = 1'000'000;
+  constexpr size_t edgeCount = 10'000'000;
+  auto edges = randomDag(vertexCount, edgeCount, 3);
+  graph::DirectedGraph<Vertex> pointerGraph;
+  pointerGraph.fromEdges(edges);
+  auto csr = graph::CsrGraph::fromEdges(vertexCount, edges);
+
+  BENCHMARK("CsrGraph::fromEdges") { return graph::CsrGraph::fromEdges(vertexCount, edges).arcCount(); };
+  BENCHMARK("CsrGraph::fromGraph") { return graph::CsrGraph::fromGraph(pointerGraph).arcCount(); };
+  BENCHMARK("kahn, DirectedGraph") { return graph::utils::kahn(pointerGraph).second.size(); };
+  BENCHMARK("kahn, CsrGraph") { return graph::utils::kahn(csr).second.size(); };
+  BENCHMARK("topologicalSort, CsrGraph") { return graph::utils::topologicalSort(csr).second.size(); };
+}
@@ -2,10 +2,17 @@ module;
 #include "../array/dynamic_array.hpp"
 #include "../hash_set/hash_set.hpp"
 #include "../queue/deque.hpp"
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <ranges>
+#include <span>
+#include <stdexcept>
 #include <utility>
 export module graph:utils;
+import :csr;
+import :detail;
 
 export namespace graph {
 template <typename T> class DirectedGraph; // Forward declaration
@@ -15,9 +22,116 @@ namespace utils {
 
 enum class VisitState : uint8_t { Unvisited, Visiting, Visited };
 
+namespace detail {
+
+/**
+ *  @brief Iterative post-order DFS over every vertex of a directed CsrGraph, finish(v) is called once all
+ *         vertices reachable from v are finished. Stops at the first edge back into the DFS path.
+ *  @return Whether the graph is acyclic.
+ */
+template <typename Finish> bool postOrder(const CsrGraph& graph, Finish&& finish) {
+  using Vertex = CsrGraph::vertex_type;
+  const auto& offsets = graph.offsets();
+  const auto& targets = graph.targets();
+  array::DynamicArray<VisitState> visitState(graph.vertexCount(), VisitState::Unvisited);
+
+  // a frame is a vertex and the position of its next neighbor in targets
+  array::DynamicArray<std::pair<Vertex, CsrGraph::edge_index>> stack;
+  for (Vertex root : graph.vertices()) {
+    if (visitState[root] != VisitState::Unvisited) continue;
+    visitState[root] = VisitState::Visiting;
+    stack.pushBack({root, offsets[root]});
+
+    while (!stack.empty()) {
+      auto& [node, next] = stack.back();
+      if (next == offsets[node + 1]) {
+        visitState[node] = VisitState::Visited;
+        finish(node);
+        stack.popBack();
+        continue;
+      }
+      Vertex nei = targets[next++];
+      if (visitState[nei] == VisitState::Visiting) return false;
+      if (visitState[nei] == VisitState::Unvisited) {
+        visitState[nei] = VisitState::Visiting;
+        stack.pushBack({nei, offsets[nei]});
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ *  @brief postOrder over the nodes of a DirectedGraph, a node is identified by its position in nodes. The
+ *         frames keep iterators into the neighbor sets, nothing is copied into a CsrGraph first.
+ */
+template <typename T, typename Finish>
+bool postOrder(const array::DynamicArray<const Node<T>*>& nodes, Finish&& finish) {
+  using NeighborIterator = typename hashset::HashSet<Node<T>*>::const_iterator;
+  graph::detail::PointerIndex<const Node<T>*> positions(nodes);
+  array::DynamicArray<VisitState> visitState(nodes.size(), VisitState::Unvisited);
+
+  // a frame is the position of a node and its next neighbor
+  array::DynamicArray<std::pair<size_t, NeighborIterator>> stack;
+  for (size_t root = 0; root < nodes.size(); ++root) {
+    if (visitState[root] != VisitState::Unvisited) continue;
+    visitState[root] = VisitState::Visiting;
+    stack.pushBack({root, nodes[root]->neighbors().begin()});
+
+    while (!stack.empty()) {
+      auto& [node, next] = stack.back();
+      if (next == nodes[node]->neighbors().end()) {
+        visitState[node] = VisitState::Visited;
+        finish(node);
+        stack.popBack();
+        continue;
+      }
+      size_t nei = positions.find(*next++);
+      if (visitState[nei] == VisitState::Visiting) return false;
+      if (visitState[nei] == VisitState::Unvisited) {
+        visitState[nei] = VisitState::Visiting;
+        stack.pushBack({nei, nodes[nei]->neighbors().begin()});
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace detail
+
+/**
+ *  @brief topologicalSort over a CsrGraph. The DFS is iterative, deep graphs can't overflow the stack.
+ *  @param graph  A directed CsrGraph.
+ *  @return A std::pair of whether the graph is acyclic and the vertex ids in topological order, empty when a
+ *          cycle was detected.
+ *  @throw std::invalid_argument if the graph is undirected.
+ */
+inline std::pair<bool, array::DynamicArray<CsrGraph::vertex_type>> topologicalSort(const CsrGraph& graph) {
+  using Vertex = CsrGraph::vertex_type;
+  if (!graph.directed()) throw std::invalid_argument("topologicalSort: the graph must be directed");
+
+  array::DynamicArray<Vertex> topologicalOrder;
+  topologicalOrder.reserve(graph.vertexCount());
+  if (!detail::postOrder(graph, [&](Vertex node) { topologicalOrder.pushBack(node); })) return {false, {}};
+  std::ranges::reverse(topologicalOrder);
+  return {true, topologicalOrder};
+}
+
+/**
+ *  @brief Whether a directed CsrGraph has a cycle, by the DFS of topologicalSort without collecting the
+ *         order.
+ *  @throw std::invalid_argument if the graph is undirected.
+ */
+inline bool hasCycle(const CsrGraph& graph) {
+  if (!graph.directed()) throw std::invalid_argument("hasCycle: the graph must be directed");
+  return !detail::postOrder(graph, [](CsrGraph::vertex_type) {});
+}
+
 /**
  *  @tparam T  The underlying data type stored within the graph nodes.
  *  @brief Computes a linear topological ordering of vertices using a post-order Depth-First Search (DFS).
+ *         The DFS is iterative, so dependency chains of any length can't overflow the stack, and the visit
+ *         states live in a flat array indexed by the position of a node in graph.nodes().
  *  @param graph  A constant reference to the DirectedGraph container to be sorted.
  *  @return A std::pair where:
  *          - The first element (bool) is true if the sequence is a valid topological order (acyclic),
@@ -26,37 +140,23 @@ enum class VisitState : uint8_t { Unvisited, Visiting, Visited };
  */
 template <typename T>
 std::pair<bool, array::DynamicArray<const Node<T>*>> topologicalSort(const DirectedGraph<T>& graph) {
-  size_t n = graph.size();
-  hashmap::HashMap<const Node<T>*, VisitState> visitState;
-  visitState.reserve(n);
-  for (const Node<T>* node : graph.nodes()) visitState[node] = VisitState::Unvisited;
-
+  auto nodes = graph.nodes();
   array::DynamicArray<const Node<T>*> topologicalOrder;
-
-  std::function<bool(const Node<T>*)> detectCycle = [&](const Node<T>* node) -> bool {
-    if (visitState[node] == VisitState::Visited) return false;
-    if (visitState[node] == VisitState::Visiting) return true;
-    visitState[node] = VisitState::Visiting;
-    for (const Node<T>* nei : node->neighbors()) {
-      if (detectCycle(nei)) return true;
-    }
-    visitState[node] = VisitState::Visited;
-    topologicalOrder.pushBack(node);
-    return false;
-  };
-
-  topologicalOrder.reserve(n);
-  for (const Node<T>* node : graph.nodes()) {
-    if (visitState[node] == VisitState::Unvisited) {
-      if (detectCycle(node)) return {false, {}};
-    }
-  }
-
+  topologicalOrder.reserve(nodes.size());
+  auto finish = [&](size_t node) { topologicalOrder.pushBack(nodes[node]); };
+  if (!detail::postOrder<T>(nodes, finish)) return {false, {}};
   std::ranges::reverse(topologicalOrder);
-
   return {true, topologicalOrder};
 }
 
+/**
+ *  @tparam T  The underlying data type stored within the graph nodes.
+ *  @brief Whether the graph has a cycle, by the iterative DFS of topologicalSort without building the order.
+ */
+template <typename T> bool hasCycle(const DirectedGraph<T>& graph) {
+  return !detail::postOrder<T>(graph.nodes(), [](size_t) {});
+}
+
 /**
  *  @tparam T  The underlying data type stored within the graph nodes.
  *  @brief Computes a linear topological ordering of vertices using a post-order Breath-First Search (BFS).
@@ -96,6 +196,36 @@ std::pair<bool, array::DynamicArray<const Node<T>*>> kahn(const DirectedGraph<T>
   return {false, {}};
 }
 
+/**
+ *  @brief kahn over a CsrGraph. The order array doubles as the queue, vertices are appended once their
+ *         in-degree drops to 0 and read back from a moving head.
+ *  @param graph  A directed CsrGraph.
+ *  @return A std::pair of whether the graph is acyclic and the vertex ids in topological order, empty when a
+ *          cycle was detected.
+ *  @throw std::invalid_argument if the graph is undirected.
+ */
+inline std::pair<bool, array::DynamicArray<CsrGraph::vertex_type>> kahn(const CsrGraph& graph) {
+  using Vertex = CsrGraph::vertex_type;
+  if (!graph.directed()) throw std::invalid_argument("kahn: the graph must be directed");
+
+  size_t n = graph.vertexCount();
+  array::DynamicArray<Vertex> inDegree(n, 0);
+  for (Vertex dest : graph.targets()) ++inDegree[dest];
+
+  array::DynamicArray<Vertex> topologicalOrder;
+  topologicalOrder.reserve(n);
+  for (Vertex node : graph.vertices()) {
+    if (inDegree[node] == 0) topologicalOrder.pushBack(node);
+  }
+  for (size_t head = 0; head < topologicalOrder.size(); ++head) {
+    for (Vertex nei : graph.neighbors(topologicalOrder[head])) {
+      if (--inDegree[nei] == 0) topologicalOrder.pushBack(nei);
+    }
+  }
+  if (topologicalOrder.size() == n) return {true, topologicalOrder};
+  return {false, {}};
+}
+
 template <typename T> struct IsNodePointerSpecialization : std::false_type {};
 template <typename T> struct IsNodePointerSpecialization<Node<T>*> : std::true_type {
   using type = T;
@@ -126,49 +256,255 @@ bool isValidTopologicalOrder(const Seq& topologicalOrder) {
   return true;
 }
 
-template <typename T>
-array::DynamicArray<array::DynamicArray<const Node<T>*>> allTopologicalOrders(const DirectedGraph<T>& graph) {
-  size_t n = graph.size();
-  array::DynamicArray<array::DynamicArray<const Node<T>*>> allOrders;
-  if (n == 0) return allOrders;
+/**
+ *  @brief Enumerates every topological order of a directed CsrGraph lazily, one at a time, in lexicographic
+ *         order of the vertex ids. The backtracking runs on explicit arrays of O(V) size, in-degrees, the
+ *         current order and the next candidate at every depth, so only the order being looked at exists in
+ *         memory. A graph with a cycle has no orders, the empty graph has one empty order.
+ *
+ *  Use next() and order(), or iterate it as a single-pass range:
+ *
+ *      for (std::span<const CsrGraph::vertex_type> order : TopologicalOrders(graph)) { ... }
+ */
+class TopologicalOrders {
+public:
+  using vertex_type = CsrGraph::vertex_type;
+
+private:
+  enum class State : uint8_t { Fresh, Yielded, Exhausted };
+
+  CsrGraph m_graph;
+  array::DynamicArray<vertex_type> m_waiting; // the predecessors of every vertex not placed yet
+  array::DynamicArray<bool> m_placed;
+  array::DynamicArray<vertex_type> m_order;
+  array::DynamicArray<vertex_type> m_cursor; // the smallest vertex still to try at every depth
+  size_t m_depth = 0;
+  State m_state = State::Fresh;
 
-  hashmap::HashMap<const Node<T>*, size_t> indegree;
-  indegree.reserve(n);
-  for (size_t i = 0; i < n; ++i) indegree[graph.nodes()[i]] = 0;
-  for (size_t i = 0; i < n; ++i) {
-    const Node<T>* node = graph.nodes()[i];
-    for (const Node<T>* nei : node->neighbors()) ++indegree[nei];
+  void place(vertex_type v) {
+    m_order[m_depth] = v;
+    m_placed[v] = true;
+    m_cursor[m_depth] = v + 1;
+    for (vertex_type next : m_graph.neighbors(v)) --m_waiting[next];
+    if (++m_depth < m_cursor.size()) m_cursor[m_depth] = 0;
   }
 
-  array::DynamicArray<const Node<T>*> currentOrder;
-  currentOrder.reserve(n);
+  void unplace() {
+    vertex_type v = m_order[--m_depth];
+    m_placed[v] = false;
+    for (vertex_type next : m_graph.neighbors(v)) ++m_waiting[next];
+  }
+
+public:
+  class iterator {
+  private:
+    TopologicalOrders* m_orders = nullptr;
 
-  hashset::HashSet<const Node<T>*> visited;
-  visited.reserve(n);
+  public:
+    using value_type = std::span<const vertex_type>;
+    using difference_type = std::ptrdiff_t;
 
-  std::function<void()> findAllOrders = [&]() -> void {
-    if (currentOrder.size() == n) {
-      allOrders.pushBack(currentOrder);
-      return;
+    iterator() = default;
+    explicit iterator(TopologicalOrders* orders) noexcept : m_orders(orders) {}
+
+    value_type operator*() const noexcept { return m_orders->order(); }
+    iterator& operator++() {
+      m_orders->next();
+      return *this;
+    }
+    void operator++(int) { ++*this; }
+    friend bool operator==(const iterator& it, std::default_sentinel_t) noexcept {
+      return it.m_orders->done();
     }
+  };
 
-    for (const Node<T>* node : graph.nodes()) {
-      if (visited.contains(node) || indegree[node] != 0) continue;
-      for (const Node<T>* nei : node->neighbors()) --indegree[nei];
-      visited.insert(node);
-      currentOrder.pushBack(node);
+  /**
+   *  @param graph  A snapshot to enumerate, moved in to save the copy.
+   *  @throw std::invalid_argument if the graph is undirected.
+   */
+  explicit TopologicalOrders(CsrGraph graph)
+      : m_graph(std::move(graph)), m_waiting(m_graph.vertexCount(), 0),
+        m_placed(m_graph.vertexCount(), false), m_order(m_graph.vertexCount(), 0),
+        m_cursor(m_graph.vertexCount(), 0) {
+    if (!m_graph.directed()) throw std::invalid_argument("TopologicalOrders: the graph must be directed");
+    for (vertex_type dest : m_graph.targets()) ++m_waiting[dest];
+  }
 
-      findAllOrders();
-      visited.erase(node);
-      currentOrder.popBack();
-      for (const Node<T>* nei : node->neighbors()) ++indegree[nei];
+  /**
+   *  @brief Moves on to the next order.
+   *  @return false once every order was seen, order() is then meaningless.
+   */
+  bool next() {
+    if (m_state == State::Exhausted) return false;
+    size_t n = m_cursor.size();
+    if (m_state == State::Yielded) {
+      if (n == 0) {
+        m_state = State::Exhausted;
+        return false;
+      }
+      unplace(); // the last vertex of the previous order, its depth continues after it
+    }
+    while (m_depth < n) {
+      vertex_type v = m_cursor[m_depth];
+      while (v < n && (m_placed[v] || m_waiting[v] != 0)) ++v;
+      if (v < n) {
+        place(v);
+        continue;
+      }
+      if (m_depth == 0) {
+        m_state = State::Exhausted;
+        return false;
+      }
+      unplace();
+    }
+    m_state = State::Yielded;
+    return true;
+  }
+
+  // the current order, valid after next() returned true and until the next call
+  [[nodiscard]] std::span<const vertex_type> order() const noexcept {
+    return {m_order.data(), m_order.size()};
+  }
+  [[nodiscard]] bool done() const noexcept { return m_state == State::Exhausted; }
+  // whether next() was never called
+  [[nodiscard]] bool fresh() const noexcept { return m_state == State::Fresh; }
+
+  // single pass: begin() finds the first order on the first call and doesn't rewind afterwards
+  iterator begin() {
+    if (m_state == State::Fresh) next();
+    return iterator(this);
+  }
+  std::default_sentinel_t end() const noexcept { return {}; }
+};
+
+/**
+ *  @tparam T  The underlying data type stored within the graph nodes.
+ *  @brief TopologicalOrders over a CsrGraph snapshot of a DirectedGraph, yielding node pointers. Vertex i of
+ *         the snapshot is graph.nodes()[i], the orders come in lexicographic order of those indices. The
+ *         graph must outlive the enumeration and stay unchanged.
+ */
+template <typename T> class NodeTopologicalOrders {
+private:
+  array::DynamicArray<const Node<T>*> m_nodes;
+  TopologicalOrders m_ids;
+  array::DynamicArray<const Node<T>*> m_order;
+
+public:
+  class iterator {
+  private:
+    NodeTopologicalOrders* m_orders = nullptr;
+
+  public:
+    using value_type = std::span<const Node<T>* const>;
+    using difference_type = std::ptrdiff_t;
+
+    iterator() = default;
+    explicit iterator(NodeTopologicalOrders* orders) noexcept : m_orders(orders) {}
+
+    value_type operator*() const noexcept { return m_orders->order(); }
+    iterator& operator++() {
+      m_orders->next();
+      return *this;
+    }
+    void operator++(int) { ++*this; }
+    friend bool operator==(const iterator& it, std::default_sentinel_t) noexcept {
+      return it.m_orders->done();
     }
   };
-  findAllOrders();
 
+  explicit NodeTopologicalOrders(const DirectedGraph<T>& graph)
+      : m_nodes(graph.nodes()), m_ids(CsrGraph::fromGraph(graph)), m_order(m_nodes.size(), nullptr) {}
+
+  // see TopologicalOrders::next
+  bool next() {
+    if (!m_ids.next()) return false;
+    std::span<const CsrGraph::vertex_type> ids = m_ids.order();
+    for (size_t i = 0; i < ids.size(); ++i) m_order[i] = m_nodes[ids[i]];
+    return true;
+  }
+
+  [[nodiscard]] std::span<const Node<T>* const> order() const noexcept {
+    return {m_order.data(), m_order.size()};
+  }
+  [[nodiscard]] bool done() const noexcept { return m_ids.done(); }
+
+  // single pass like TopologicalOrders::begin, whose state it goes by
+  iterator begin() {
+    if (m_ids.fresh()) next();
+    return iterator(this);
+  }
+  std::default_sentinel_t end() const noexcept { return {}; }
+};
+
+/**
+ *  @tparam T  The underlying data type stored within the graph nodes.
+ *  @brief Every topological order of the graph, materialized. Their number grows factorially with the
+ *         independent vertices, iterate NodeTopologicalOrders instead to hold one order at a time and
+ *         countTopologicalOrders to only count them.
+ *  @return The orders in lexicographic order of the indices in graph.nodes(), none for an empty or cyclic
+ *          graph.
+ */
+template <typename T>
+array::DynamicArray<array::DynamicArray<const Node<T>*>> allTopologicalOrders(const DirectedGraph<T>& graph) {
+  array::DynamicArray<array::DynamicArray<const Node<T>*>> allOrders;
+  if (graph.size() == 0) return allOrders;
+
+  NodeTopologicalOrders<T> orders(graph);
+  while (orders.next()) {
+    std::span<const Node<T>* const> order = orders.order();
+    allOrders.pushBack(array::DynamicArray<const Node<T>*>(order.begin(), order.end()));
+  }
   return allOrders;
 }
 
+// the largest graph countTopologicalOrders accepts: 2^20 subsets, and 20! orders still fit into 64 bits
+inline constexpr size_t maxCountedVertices = 20;
+
+/**
+ *  @brief The number of topological orders of a directed CsrGraph, without enumerating them. A DP over the
+ *         subsets of vertices: the orders of a set that is closed under predecessors are summed over its
+ *         vertices that can come last, O(2^V * V) time and 2^V counters.
+ *  @return 0 if the graph has a cycle, 1 for the empty graph.
+ *  @throw std::invalid_argument if the graph is undirected, std::length_error if it has more than
+ *         maxCountedVertices vertices.
+ */
+inline uint64_t countTopologicalOrders(const CsrGraph& graph) {
+  using Vertex = CsrGraph::vertex_type;
+  if (!graph.directed()) throw std::invalid_argument("countTopologicalOrders: the graph must be directed");
+  size_t n = graph.vertexCount();
+  if (n > maxCountedVertices) throw std::length_error("countTopologicalOrders: the graph is too large");
+
+  // a self-loop puts a vertex among its own predecessors, it's never free and the count ends up 0
+  array::DynamicArray<uint32_t> predecessors(n, 0);
+  for (Vertex v : graph.vertices()) {
+    for (Vertex next : graph.neighbors(v)) predecessors[next] |= uint32_t{1} << v;
+  }
+  // ways[set] counts the orders of the vertices in set that start an order of the graph
+  uint32_t full = (uint32_t{1} << n) - 1;
+  array::DynamicArray<uint64_t> ways(size_t{full} + 1, 0);
+  ways[0] = 1;
+  for (uint32_t set = 0; set < full; ++set) {
+    if (ways[set] == 0) continue;
+    for (size_t v = 0; v < n; ++v) {
+      uint32_t bit = uint32_t{1} << v;
+      if ((set & bit) == 0 && (predecessors[v] & ~set) == 0) ways[set | bit] += ways[set];
+    }
+  }
+  return ways[full];
+}
+
+/**
+ *  @tparam T  The underlying data type stored within the graph nodes.
+ *  @brief countTopologicalOrders over a CsrGraph snapshot.
+ *  @throw std::length_error if the graph has more than maxCountedVertices vertices.
+ */
+template <typename T> uint64_t countTopologicalOrders(const DirectedGraph<T>& graph) {
+  if (graph.size() > maxCountedVertices) {
+    throw std::length_error("countTopologicalOrders: the graph is too large");
+  }
+  return countTopologicalOrders(CsrGraph::fromGraph(graph));
+}
+
 } // namespace utils
 
 } // namespace graph
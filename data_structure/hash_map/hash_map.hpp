@@ -1,6 +1,7 @@
 #pragma once
 #include "../array/dynamic_array.hpp"
 #include "../linked_list/singly_linked_list.hpp"
+#include "../memory_stats.hpp"
 #include <cmath>
 #include <concepts>
 #include <functional>
@@ -167,8 +168,10 @@ public:
 
   HashMap() : m_table(array::DynamicArray<BucketList>{2}) {}
 
+  // room for n entries before the first rehash, the bucket count stays a power of two
   HashMap(size_t n, Hasher hasher = {}, KeyEqual eq = {})
-      : m_table(array::DynamicArray<BucketList>{n}), m_hasher(std::move(hasher)), m_keyEqual(std::move(eq)) {}
+      : m_hasher(std::move(hasher)), m_keyEqual(std::move(eq)),
+        m_table(array::DynamicArray<BucketList>{calculateMinRequiredCapacity(n)}) {}
 
   template <std::input_iterator InputIt>
     requires std::constructible_from<HashMapKeyVal<K, V>, std::iter_value_t<InputIt>>
@@ -247,13 +250,7 @@ public:
     m_length = 0;
   }
 
-  V& operator[](const K& key) {
-    iterator it = find(key);
-    if (it != end()) return it->getValue();
-    BucketList& list = getList(key);
-    list.pushFront(HashMapKeyVal<K, V>{key, V{}});
-    return list.front().getValue();
-  }
+  V& operator[](const K& key) { return emplace(key).first->getValue(); }
 
   bool operator==(const HashMap& other) const noexcept {
     if (m_length != other.m_length) return false;
@@ -276,9 +273,39 @@ public:
   constexpr Hasher hashFunction() const noexcept { return m_hasher; }
   constexpr KeyEqual keyEq() const noexcept { return m_keyEqual; }
 
-  [[nodiscard]] constexpr float loadFactor() const noexcept { return m_length / m_table.capacity(); }
+  [[nodiscard]] constexpr float loadFactor() const noexcept {
+    return static_cast<float>(m_length) / static_cast<float>(m_table.capacity());
+  }
   [[nodiscard]] constexpr float maxLoadFactor() const noexcept { return maxLoadFactor_; }
 
+  [[nodiscard]] size_t bucketCount() const noexcept { return m_table.capacity(); }
+
+  // memoryStats().bytesAllocated in O(1): the bucket table and one node per entry
+  [[nodiscard]] size_t bytesAllocated() const noexcept {
+    using EntryNode = linkedlist::SinglyLinkNode<HashMapKeyVal<K, V>>;
+    return m_table.memoryStats().bytesAllocated + (m_length * sizeof(EntryNode));
+  }
+
+  // O(bucket count) for the chain length histogram, doesn't allocate
+  [[nodiscard]] stats::MemoryStats memoryStats() const noexcept {
+    using EntryNode = linkedlist::SinglyLinkNode<HashMapKeyVal<K, V>>;
+    stats::MemoryStats result;
+    size_t usedBuckets = 0;
+    for (size_t i = 0; i < m_table.capacity(); i++) {
+      auto length = static_cast<size_t>(m_table[i].size());
+      result.addChain(length);
+      if (length != 0) usedBuckets++;
+    }
+    size_t entryBytes = m_length * sizeof(EntryNode);
+    result.bytesAllocated = bytesAllocated();
+    result.bytesUsed = (usedBuckets * sizeof(BucketList)) + entryBytes;
+    result.elementCount = m_length;
+    result.capacity = m_table.capacity();
+    result.nodeCount = m_length;
+    result.loadFactor = loadFactor();
+    return result;
+  }
+
   iterator begin() noexcept {
     for (size_t i = 0; i < m_table.capacity(); i++) {
       typename BucketList::iterator it = m_table[i].begin();
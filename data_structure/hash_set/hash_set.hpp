@@ -99,6 +99,9 @@ public:
 
   constexpr void reserve(size_t n) { m_map.reserve(n); }
 
+  // see HashMap::memoryStats, the entries carry an empty value next to each key
+  [[nodiscard]] stats::MemoryStats memoryStats() const noexcept { return m_map.memoryStats(); }
+
   iterator begin() noexcept { return iterator{m_map.begin()}; }
   const_iterator begin() const noexcept { return const_iterator{m_map.begin()}; }
   const_iterator cbegin() const noexcept { return const_iterator{m_map.cbegin()}; }
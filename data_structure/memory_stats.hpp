@@ -0,0 +1,33 @@
+#pragma once
+#include <array>
+#include <cstddef>
+
+/*
+ * MemoryStats is what memoryStats() reports for every container, in one shape so a metrics exporter can
+ * treat them alike. Fields that don't apply to a container stay 0.
+ *
+ * Sizes are what the container itself asks its allocator for: allocator bookkeeping isn't included, and
+ * memory owned by the elements (a std::string's heap buffer, say) isn't followed.
+ * */
+
+namespace stats {
+
+struct MemoryStats {
+  // chainLengths[i] counts the buckets holding i entries, the last entry every longer chain
+  static constexpr size_t chainLengthBuckets = 8;
+
+  size_t bytesAllocated = 0; // everything held on to, spare capacity and empty buckets included
+  size_t bytesUsed = 0;      // the part of bytesAllocated taken by live elements and nodes
+  size_t elementCount = 0;   // entries, trie: stored sequences
+  size_t capacity = 0;       // element slots: array capacity, hash buckets, trie child slots
+  size_t nodeCount = 0;      // separately allocated nodes: hash entries, trie nodes, deque blocks
+  double averageFanOut = 0;  // trie only: children per node that has any
+  double loadFactor = 0;     // elements (trie: children) per slot of capacity
+  std::array<size_t, chainLengthBuckets> chainLengths{};
+
+  void addChain(size_t length) noexcept {
+    ++chainLengths[length < chainLengthBuckets ? length : chainLengthBuckets - 1];
+  }
+};
+
+} // namespace stats
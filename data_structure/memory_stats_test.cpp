@@ -0,0 +1,98 @@
+#include "./array/dynamic_array.hpp"
+#include "./hash_map/hash_map.hpp"
+#include "./hash_set/hash_set.hpp"
+#include "./memory_stats.hpp"
+#include "./queue/deque.hpp"
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <numeric>
+
+namespace {
+size_t chainTotal(const stats::MemoryStats& stats) {
+  return std::accumulate(stats.chainLengths.begin(), stats.chainLengths.end(), size_t{0});
+}
+} // namespace
+
+TEST_CASE("DynamicArray and Deque memory stats", "[memory_stats]") {
+  SECTION("DynamicArray reports its capacity as allocated, its elements as used") {
+    array::DynamicArray<uint64_t> arr;
+    CHECK(arr.memoryStats().bytesAllocated == arr.capacity() * sizeof(uint64_t));
+    for (uint64_t i = 0; i < 10; ++i) arr.pushBack(i);
+    arr.reserve(32);
+
+    stats::MemoryStats stats = arr.memoryStats();
+    CHECK(stats.bytesAllocated == 32 * sizeof(uint64_t));
+    CHECK(stats.bytesUsed == 10 * sizeof(uint64_t));
+    CHECK(stats.elementCount == 10);
+    CHECK(stats.capacity == 32);
+    CHECK(stats.loadFactor == Catch::Approx(10.0 / 32));
+  }
+
+  SECTION("Deque counts its blocks as nodes") {
+    queue::Deque<int> deque;
+    CHECK(deque.memoryStats().nodeCount == 0);
+    for (int i = 0; i < 100; ++i) deque.pushBack(i);
+    for (int i = 0; i < 100; ++i) deque.pushFront(i);
+
+    stats::MemoryStats stats = deque.memoryStats();
+    CHECK(stats.elementCount == 200);
+    CHECK(stats.nodeCount >= 200 / 32);
+    CHECK(stats.capacity == stats.nodeCount * 32);
+    CHECK(stats.bytesUsed <= stats.bytesAllocated);
+    CHECK(stats.bytesAllocated >= 200 * sizeof(int));
+    CHECK(stats.loadFactor > 0.5);
+  }
+}
+
+TEST_CASE("HashMap and HashSet memory stats", "[memory_stats][HashMap]") {
+  hashmap::HashMap<int, int> map;
+  for (int i = 0; i < 1000; ++i) map.insert(i, i);
+
+  SECTION("Every entry shows up in exactly one chain") {
+    stats::MemoryStats stats = map.memoryStats();
+    CHECK(stats.elementCount == 1000);
+    CHECK(stats.nodeCount == 1000);
+    CHECK(chainTotal(stats) == stats.capacity);
+    // the keys hash to themselves and are below the bucket count, each one gets a bucket of its own
+    REQUIRE(stats.capacity == 2048);
+    CHECK(stats.chainLengths[1] == 1000);
+    CHECK(stats.chainLengths[0] == 2048 - 1000);
+    CHECK(stats.bytesUsed <= stats.bytesAllocated);
+  }
+
+  SECTION("Colliding keys show up as longer chains") {
+    hashmap::HashMap<int, int> small(12);
+    // 0, 16 and 32 share bucket 0, 1 and 17 share bucket 1, 2 to 8 are alone
+    for (int key : {0, 16, 32, 1, 17, 2, 3, 4, 5, 6, 7, 8}) small.insert(key, key);
+    stats::MemoryStats stats = small.memoryStats();
+    REQUIRE(stats.capacity == 16);
+    CHECK(stats.elementCount == 12);
+    CHECK(stats.chainLengths[3] == 1);
+    CHECK(stats.chainLengths[2] == 1);
+    CHECK(stats.chainLengths[1] == 7);
+    CHECK(stats.chainLengths[0] == 7);
+    CHECK(chainTotal(stats) == 16);
+  }
+
+  SECTION("Load factor is fractional") {
+    CHECK(map.loadFactor() > 0.0F);
+    CHECK(map.loadFactor() <= map.maxLoadFactor());
+    CHECK(map.memoryStats().loadFactor == Catch::Approx(map.loadFactor()));
+  }
+
+  SECTION("operator[] counts the entries it creates") {
+    map[5000] = 1;
+    CHECK(map.size() == 1001);
+    CHECK(map.memoryStats().elementCount == 1001);
+  }
+
+  SECTION("Sized construction keeps a power of two bucket count") {
+    hashmap::HashMap<int, int> empty(0);
+    CHECK_FALSE(empty.contains(1));
+    CHECK(empty.memoryStats().capacity == 2);
+    hashset::HashSet<int> set{1, 2, 3};
+    CHECK(set.memoryStats().capacity == 4);
+    CHECK(set.memoryStats().elementCount == 3);
+  }
+}
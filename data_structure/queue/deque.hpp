@@ -1,11 +1,14 @@
 #pragma once
 #include "../array/dynamic_array.hpp"
 #include "../array/static_array.hpp"
+#include "../memory_stats.hpp"
+#include <algorithm>
 #include <cstddef>
 #include <gsl/gsl>
 #include <iostream>
 #include <iterator>
 #include <stdexcept>
+#include <vector>
 
 #ifndef NDEBUG
 inline constexpr int debugValue = 9999;
@@ -560,6 +563,15 @@ private:
       return Iterator{this, first.m_offsetFromHead};
     }
 
+    // `cond ? std::move(x) : x` would always copy, and not compile for move-only T
+    template <bool Move> static T moveOrCopy(T& element) {
+      if constexpr (Move) {
+        return std::move(element);
+      } else {
+        return element;
+      }
+    }
+
     template <typename... Args> Iterator emplace(ConstIterator pos, Args&&... args) {
       if (pos < cbegin() || pos > cend()) { throw std::out_of_range("Emplace position out of range"); }
 
@@ -582,7 +594,7 @@ private:
       if (fewerElementsOnLeft) {
         //  move left
         ConstIterator first = cbegin();
-        T head = preferMove ? std::move(*first) : *first;
+        T head = moveOrCopy<preferMove>(*slotAt(first.getPosition()));
 
         for (size_t i = 1; i < offset; ++i) {
           if constexpr (preferMove) {
@@ -595,14 +607,13 @@ private:
         size_t insertionPosition = first.getPosition(offset - 1);
         destroyAt(insertionPosition);
         constructAt(insertionPosition, std::forward<Args>(args)...);
-        constructAtHead(head);
+        constructAtHead(std::move(head));
 
       } else {
         // move right
         size_t elementsToShift = getElementSize() - offset;
 
-        T tail = preferMove ? std::move(*slotAt(pos.getPosition(elementsToShift - 1)))
-                            : *slotAt(pos.getPosition(elementsToShift - 1));
+        T tail = moveOrCopy<preferMove>(*slotAt(pos.getPosition(elementsToShift - 1)));
 
         for (size_t i = elementsToShift - 1; i > 0; --i) {
           if constexpr (preferMove) {
@@ -615,7 +626,7 @@ private:
         size_t insertionPosition = pos.getPosition();
         destroyAt(insertionPosition);
         constructAt(insertionPosition, std::forward<Args>(args)...);
-        constructAtTail(tail);
+        constructAtTail(std::move(tail));
       }
       return Iterator{this, offset};
     }
@@ -753,6 +764,21 @@ private:
 
     [[nodiscard]] size_t getBlockSize() const noexcept { return m_blockSize; }
     [[nodiscard]] size_t getBlockCapacity() const noexcept { return m_blocks.size(); }
+
+    // the allocated blocks plus the circular array of block pointers
+    [[nodiscard]] stats::MemoryStats memoryStats() const noexcept {
+      stats::MemoryStats result;
+      stats::MemoryStats map = m_blocks.memoryStats();
+      result.bytesAllocated = map.bytesAllocated + (getBlockSize() * sizeof(Block));
+      result.bytesUsed = (getBlockSize() * sizeof(Block*)) + (getElementSize() * sizeof(T));
+      result.elementCount = getElementSize();
+      result.capacity = getBlockSize() * getElementsPerBlock();
+      result.nodeCount = getBlockSize();
+      if (result.capacity != 0) {
+        result.loadFactor = static_cast<double>(result.elementCount) / static_cast<double>(result.capacity);
+      }
+      return result;
+    }
   };
 
   IndexMap m_indexMap;
@@ -864,6 +890,9 @@ public:
   [[nodiscard]] bool empty() const noexcept { return size() == 0; }
   [[nodiscard]] size_t size() const noexcept { return m_indexMap.getElementSize(); }
 
+  // O(1), capacity counts the slots of the allocated blocks
+  [[nodiscard]] stats::MemoryStats memoryStats() const noexcept { return m_indexMap.memoryStats(); }
+
   Iterator begin() noexcept { return m_indexMap.begin(); }
   ConstIterator begin() const noexcept { return m_indexMap.begin(); }
   ConstIterator cbegin() const noexcept { return m_indexMap.cbegin(); }
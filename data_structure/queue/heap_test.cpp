@@ -0,0 +1,96 @@
+#include "./indexed_heap.hpp"
+#include "./radix_heap.hpp"
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST_CASE("RadixHeap", "[queue][heap]") {
+  SECTION("Pops keys in order, equal keys included") {
+    queue::RadixHeap<std::string> heap;
+    heap.push(5, "five");
+    heap.push(1, "one");
+    heap.push(uint64_t{1} << 40, "big");
+    heap.push(5, "five again");
+    CHECK(heap.size() == 4);
+    CHECK(heap.top().first == 1);
+    CHECK(heap.top().second == "one");
+    heap.pop();
+    CHECK(heap.top().first == 5);
+    heap.pop();
+    CHECK(heap.top().first == 5);
+    heap.pop();
+    CHECK(heap.top().second == "big");
+    heap.pop();
+    CHECK(heap.empty());
+    CHECK_THROWS_AS(heap.pop(), std::out_of_range);
+  }
+
+  SECTION("Monotone pushes interleaved with pops, as Dijkstra does") {
+    std::mt19937_64 gen{1};
+    std::uniform_int_distribution<uint64_t> step(0, 1000);
+    queue::RadixHeap<int> heap;
+    std::vector<uint64_t> popped;
+    heap.push(0, 0);
+    for (int i = 0; i < 5000; ++i) {
+      uint64_t key = heap.top().first;
+      heap.pop();
+      popped.push_back(key);
+      heap.push(key + step(gen), i);
+      heap.push(key + step(gen), i);
+    }
+    CHECK(std::ranges::is_sorted(popped));
+    CHECK(heap.size() == 5001);
+    CHECK_THROWS_AS(heap.push(heap.lastKey() - 1, 0), std::invalid_argument);
+  }
+}
+
+TEST_CASE("IndexedHeap", "[queue][heap]") {
+  SECTION("Decreasing keys reorders the heap") {
+    queue::IndexedHeap<int> heap(10);
+    for (size_t id = 0; id < 10; ++id) heap.push(static_cast<int>(100 - id), id);
+    CHECK(heap.top().second == 9);
+    heap.decreaseKey(1, 3);
+    CHECK(heap.top() == std::pair<int, size_t>{1, 3});
+    CHECK_FALSE(heap.pushOrDecrease(50, 3));
+    CHECK(heap.pushOrDecrease(0, 4));
+    CHECK(heap.key(4) == 0);
+    heap.pop();
+    heap.pop();
+    CHECK_FALSE(heap.contains(4));
+    CHECK(heap.top().second == 9);
+    CHECK(heap.size() == 8);
+  }
+
+  SECTION("Pops every id in key order") {
+    std::mt19937 gen{2};
+    std::uniform_int_distribution<int> key(0, 1'000'000);
+    queue::IndexedHeap<int, std::greater<>> heap(1000);
+    for (size_t id = 0; id < 1000; ++id) heap.push(key(gen), id);
+    for (size_t id = 0; id < 1000; id += 3) heap.pushOrDecrease(key(gen), id);
+    std::vector<int> popped;
+    while (!heap.empty()) {
+      popped.push_back(heap.top().first);
+      heap.pop();
+    }
+    CHECK(popped.size() == 1000);
+    CHECK(std::ranges::is_sorted(popped, std::greater<>()));
+  }
+
+  SECTION("Misuse throws") {
+    queue::IndexedHeap<int> heap(2);
+    heap.push(5, 0);
+    CHECK_THROWS_AS(heap.push(1, 0), std::invalid_argument);
+    CHECK_THROWS_AS(heap.push(1, 2), std::out_of_range);
+    CHECK_THROWS_AS(heap.decreaseKey(1, 1), std::invalid_argument);
+    CHECK_THROWS_AS(heap.decreaseKey(9, 0), std::invalid_argument);
+    heap.clear();
+    CHECK(heap.empty());
+    CHECK_FALSE(heap.contains(0));
+    CHECK_THROWS_AS(heap.top(), std::out_of_range);
+  }
+}
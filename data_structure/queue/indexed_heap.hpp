@@ -0,0 +1,153 @@
+#pragma once
+#include "../array/dynamic_array.hpp"
+#include "./priority_queue.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+namespace queue {
+
+/**
+ *  @tparam Key  Type of the priorities.
+ *  @tparam Compare  Comparison function object type, defaults to std::less<Key>: the top is the smallest key.
+ *  @brief An addressable 4-ary heap over the ids 0 .. capacity - 1. Every id is in the heap at most once, and
+ *         its key can be lowered in place in O(log n), which keeps a Dijkstra-style search at one entry per
+ *         vertex instead of one per relaxed edge. An index array maps each id to its heap slot.
+ *         Like RadixHeap, every method takes the key first and the id second, as in value_type.
+ */
+template <typename Key, typename Compare = std::less<Key>>
+  requires detail::Comparator<Key, Compare>
+class IndexedHeap {
+public:
+  using value_type = std::pair<Key, size_t>; // the key and the id
+  using size_type = size_t;
+  using const_reference = const value_type&;
+
+private:
+  static constexpr size_t arity = 4;
+  static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+  array::DynamicArray<value_type> m_heap;
+  array::DynamicArray<size_t> m_position; // the heap slot of every id, npos when it's not in the heap
+  [[no_unique_address]] Compare m_compare;
+
+  void place(size_t slot, value_type&& entry) noexcept {
+    m_position[entry.second] = slot;
+    m_heap[slot] = std::move(entry);
+  }
+
+  // moves the entry at slot up, shifting the parents it beats down into the hole
+  void siftUp(size_t slot) {
+    value_type entry = std::move(m_heap[slot]);
+    while (slot > 0) {
+      size_t parent = (slot - 1) / arity;
+      if (!m_compare(entry.first, m_heap[parent].first)) break;
+      place(slot, std::move(m_heap[parent]));
+      slot = parent;
+    }
+    place(slot, std::move(entry));
+  }
+
+  void siftDown(size_t slot) {
+    size_t n = m_heap.size();
+    value_type entry = std::move(m_heap[slot]);
+    while (true) {
+      size_t first = (slot * arity) + 1;
+      if (first >= n) break;
+      size_t best = first;
+      for (size_t child = first + 1; child < std::min(first + arity, n); ++child) {
+        if (m_compare(m_heap[child].first, m_heap[best].first)) best = child;
+      }
+      if (!m_compare(m_heap[best].first, entry.first)) break;
+      place(slot, std::move(m_heap[best]));
+      slot = best;
+    }
+    place(slot, std::move(entry));
+  }
+
+  void checkId(size_t id) const {
+    if (id >= capacity()) throw std::out_of_range("IndexedHeap: id out of range.");
+  }
+
+public:
+  explicit IndexedHeap(size_t capacity, Compare compare = {})
+      : m_position(capacity, npos), m_compare(std::move(compare)) {}
+
+  /**
+   * @throw std::out_of_range if id is not below capacity(), std::invalid_argument if it's in the heap.
+   */
+  void push(Key key, size_t id) {
+    checkId(id);
+    if (contains(id)) throw std::invalid_argument("IndexedHeap: id is already in the heap.");
+    m_heap.emplaceBack(std::move(key), id);
+    siftUp(m_heap.size() - 1);
+  }
+
+  /**
+   * @brief Replaces the key of id by a key that compares before it.
+   * @throw std::invalid_argument if id is not in the heap or key doesn't improve on its key.
+   */
+  void decreaseKey(Key key, size_t id) {
+    checkId(id);
+    if (!contains(id)) throw std::invalid_argument("IndexedHeap: id is not in the heap.");
+    size_t slot = m_position[id];
+    if (m_compare(m_heap[slot].first, key)) throw std::invalid_argument("IndexedHeap: key doesn't decrease.");
+    m_heap[slot].first = std::move(key);
+    siftUp(slot);
+  }
+
+  /**
+   * @brief Pushes id, or lowers its key if it's in the heap and key compares before it.
+   * @return Whether the heap changed.
+   */
+  bool pushOrDecrease(Key key, size_t id) {
+    checkId(id);
+    size_t slot = m_position[id];
+    if (slot == npos) {
+      m_heap.emplaceBack(std::move(key), id);
+      siftUp(m_heap.size() - 1);
+      return true;
+    }
+    if (!m_compare(key, m_heap[slot].first)) return false;
+    m_heap[slot].first = std::move(key);
+    siftUp(slot);
+    return true;
+  }
+
+  void pop() {
+    if (empty()) throw std::out_of_range("IndexedHeap is empty.");
+    m_position[m_heap[0].second] = npos;
+    if (m_heap.size() > 1) {
+      m_heap[0] = std::move(m_heap.back());
+      m_heap.popBack();
+      siftDown(0);
+    } else {
+      m_heap.popBack();
+    }
+  }
+
+  [[nodiscard]] const_reference top() const {
+    if (empty()) throw std::out_of_range("IndexedHeap is empty.");
+    return m_heap[0];
+  }
+
+  [[nodiscard]] bool contains(size_t id) const noexcept {
+    return id < capacity() && m_position[id] != npos;
+  }
+
+  // the key of id, which must be in the heap
+  [[nodiscard]] const Key& key(size_t id) const noexcept { return m_heap[m_position[id]].first; }
+
+  void clear() noexcept {
+    for (const value_type& entry : m_heap) m_position[entry.second] = npos;
+    m_heap.clear();
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return m_heap.empty(); }
+  [[nodiscard]] size_type size() const noexcept { return m_heap.size(); }
+  [[nodiscard]] size_type capacity() const noexcept { return m_position.size(); }
+};
+
+} // namespace queue
@@ -114,7 +114,7 @@ public:
 
   constexpr PriorityQueue() = default;
 
-  constexpr PriorityQueue(S&& seq = S{}, Compare compare = {})
+  constexpr PriorityQueue(S&& seq, Compare compare = {})
       : m_data(std::move(seq)), m_compare(std::move(compare)) {}
 
   constexpr PriorityQueue(const S& seq, Compare compare = {}) : m_data(seq), m_compare(std::move(compare)) {}
@@ -0,0 +1,95 @@
+#pragma once
+#include "../array/dynamic_array.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+namespace queue {
+
+/**
+ *  @tparam T  Type of the value stored with every key.
+ *  @brief A monotone min-priority queue over 64-bit unsigned keys: a pushed key must not be smaller than the
+ *         last popped one, which holds for the tentative distances of Dijkstra's algorithm.
+ *
+ *         Entries live in 65 buckets by the highest bit in which their key differs from the last popped key,
+ *         bucket 0 holds the keys equal to it. pop() only scans a bucket when bucket 0 runs empty, it then
+ *         takes the smallest key of the first non-empty bucket as the new last key and spreads that bucket
+ *         over the buckets below. An entry only ever moves to lower buckets, so it's moved at most 64
+ *         times, and no comparisons between keys are needed otherwise.
+ */
+template <typename T> class RadixHeap {
+public:
+  using value_type = std::pair<uint64_t, T>;
+  using size_type = size_t;
+  using const_reference = const value_type&;
+
+private:
+  static constexpr size_t bucketCount = 65;
+
+  std::array<array::DynamicArray<value_type>, bucketCount> m_buckets;
+  uint64_t m_last = 0;
+  size_t m_size = 0;
+
+  static size_t bucketOf(uint64_t key, uint64_t last) noexcept {
+    return key == last ? 0 : 64 - std::countl_zero(key ^ last);
+  }
+
+  // moves the smallest keys to bucket 0, the heap must not be empty
+  void pull() {
+    if (!m_buckets[0].empty()) return;
+    size_t i = 1;
+    while (m_buckets[i].empty()) ++i;
+
+    array::DynamicArray<value_type>& bucket = m_buckets[i];
+    uint64_t min = bucket[0].first;
+    for (const value_type& entry : bucket) min = std::min(min, entry.first);
+    m_last = min;
+    for (value_type& entry : bucket) m_buckets[bucketOf(entry.first, m_last)].pushBack(std::move(entry));
+    bucket.clear();
+  }
+
+public:
+  RadixHeap() = default;
+
+  /**
+   * @throw std::invalid_argument if key is below the last popped key.
+   */
+  template <typename... Args> void emplace(uint64_t key, Args&&... args) {
+    if (key < m_last) throw std::invalid_argument("RadixHeap: key below the last popped key.");
+    m_buckets[bucketOf(key, m_last)].emplaceBack(key, T(std::forward<Args>(args)...));
+    ++m_size;
+  }
+
+  void push(uint64_t key, const T& value) { emplace(key, value); }
+  void push(uint64_t key, T&& value) { emplace(key, std::move(value)); }
+
+  void pop() {
+    if (empty()) throw std::out_of_range("RadixHeap is empty.");
+    pull();
+    m_buckets[0].popBack();
+    --m_size;
+  }
+
+  // not const, finding the smallest key may redistribute a bucket
+  [[nodiscard]] const_reference top() {
+    if (empty()) throw std::out_of_range("RadixHeap is empty.");
+    pull();
+    return m_buckets[0].back();
+  }
+
+  void clear() noexcept {
+    for (auto& bucket : m_buckets) bucket.clear();
+    m_last = 0;
+    m_size = 0;
+  }
+
+  // the last popped key, pushed keys must not be smaller
+  [[nodiscard]] uint64_t lastKey() const noexcept { return m_last; }
+  [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+  [[nodiscard]] size_type size() const noexcept { return m_size; }
+};
+
+} // namespace queue
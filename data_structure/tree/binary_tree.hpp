@@ -1,4 +1,5 @@
 #pragma once
+#include "../array/small_array.hpp"
 #include "../hash_map/hash_map.hpp"
 #include "../linked_list/doubly_linked_list.hpp"
 #include "../queue/deque.hpp"
@@ -216,7 +217,9 @@ private:
     // use a linked list for sub-sequence storage; unlike DynamicArray, it avoids iterator invalidation from
     // reallocation.
     // if we simply constructor the sub-sequence container inside for-loop, we risk dangling iterator.
-    linkedlist::DoublyLinkedList<array::DynamicArray<T>> subsequencesPool;
+    // level sub-sequences are usually short, SmallArray keeps those inline while sharing DynamicArray's
+    // iterator type, so they still fit in Frame.
+    linkedlist::DoublyLinkedList<array::SmallArray<T, 8>> subsequencesPool;
 
     while (!st.empty()) {
       Frame f = st.top();
@@ -241,8 +244,8 @@ private:
       ConstIter rightInBegin = std::next(inRoot);
       ConstIter rightInEnd = f.inEnd;
 
-      array::DynamicArray<T>& leftLevel = subsequencesPool.emplaceBack();
-      array::DynamicArray<T>& rightLevel = subsequencesPool.emplaceBack();
+      array::SmallArray<T, 8>& leftLevel = subsequencesPool.emplaceBack();
+      array::SmallArray<T, 8>& rightLevel = subsequencesPool.emplaceBack();
 
       for (ConstIter it = std::next(f.seqBegin); it != f.seqEnd; ++it) {
         auto& candidate = inorderPos[*it].front();
@@ -1,6 +1,9 @@
 #pragma once
+#include <cstddef>
+#include <limits>
 #include <optional>
 #include <ranges>
+#include <utility>
 
 namespace tree {
 
@@ -39,4 +42,35 @@ struct Frame {
 template <typename T, typename Compare>
 concept Comparator = std::strict_weak_order<Compare&, T, T>;
 
+// per node data every trie node type maintains for its subtree: the score of the word ending at the node and
+// the best score below it, the bound Trie::topKWithPrefix searches by, and the number of words below it,
+// which Trie::countWithPrefix returns
+class NodeAggregates {
+public:
+  using score_type = double;
+  static constexpr score_type noScore = -std::numeric_limits<score_type>::infinity();
+
+private:
+  score_type m_score = noScore;
+  score_type m_bestScore = noScore;
+  size_t m_wordCount = 0; // the node's own word included
+
+public:
+  [[nodiscard]] constexpr score_type score() const noexcept { return m_score; }
+  constexpr void setScore(score_type score) noexcept { m_score = score; }
+
+  [[nodiscard]] constexpr score_type bestScore() const noexcept { return m_bestScore; }
+  constexpr void setBestScore(score_type score) noexcept { m_bestScore = score; }
+
+  [[nodiscard]] constexpr size_t wordCount() const noexcept { return m_wordCount; }
+  constexpr void addWords(size_t count) noexcept { m_wordCount += count; }
+
+protected:
+  constexpr void swapAggregates(NodeAggregates& other) noexcept {
+    std::swap(m_score, other.m_score);
+    std::swap(m_bestScore, other.m_bestScore);
+    std::swap(m_wordCount, other.m_wordCount);
+  }
+};
+
 } // namespace tree::detail
@@ -1,16 +1,30 @@
 module;
 
+#include "../array/pmr_storage.hpp"
+#include "../array/small_array.hpp"
 #include "../hash_map/hash_map.hpp"
-#include "../queue/deque.hpp"
+#include "../memory_stats.hpp"
+#include "../queue/priority_queue.hpp"
 #include "./detail.hpp"
+#include <algorithm>
+#include <atomic>
 #include <concepts>
 #include <cstddef>
 #include <iterator>
+#include <optional>
 #include <ranges>
+#include <stdexcept>
 #include <type_traits>
 #include <utility>
 
 export module trie;
+import :art;
+export import :radix;
+export import :frozen;
+export import :aho_corasick;
+export import :concurrent;
+import thread_pool;
+
 namespace tree::detail {
 template <typename T> using ValT = std::ranges::range_value_t<T>;
 
@@ -19,12 +33,20 @@ concept ReconstructibleSeq =
     std::ranges::forward_range<Seq> &&
     (std::constructible_from<Seq, array::DynamicArray<Elem>> ||
      requires(array::DynamicArray<Elem>& seq) { Seq(std::ranges::begin(seq), std::ranges::end(seq)); });
+
+// what bulk loads take: indexable keys of indexable elements
+template <typename Keys, typename Elem>
+concept SortedKeys =
+    std::ranges::random_access_range<Keys> && std::ranges::sized_range<Keys> &&
+    std::ranges::random_access_range<std::ranges::range_reference_t<Keys>> &&
+    std::ranges::sized_range<std::ranges::range_reference_t<Keys>> &&
+    std::convertible_to<std::ranges::range_reference_t<std::ranges::range_reference_t<Keys>>, Elem>;
 } // namespace tree::detail
 
 namespace tree {
 
 // forward declaration
-export template <typename Seq, typename Hasher, typename KeyEqual>
+export template <typename Seq, typename Hasher, typename KeyEqual, typename NodePolicy>
   requires detail::ReconstructibleSeq<Seq, detail::ValT<Seq>> && detail::Hasher<detail::ValT<Seq>, Hasher> &&
            detail::KeyEqual<detail::ValT<Seq>, KeyEqual>
 class Trie;
@@ -32,7 +54,8 @@ class Trie;
 namespace detail {
 
 template <typename T> struct IsTrieSpecialization : std::false_type {};
-template <typename T, typename U, typename V> struct IsTrieSpecialization<Trie<T, U, V>> : std::true_type {};
+template <typename T, typename U, typename V, typename W>
+struct IsTrieSpecialization<Trie<T, U, V, W>> : std::true_type {};
 
 template <typename T>
 concept IsTrie = IsTrieSpecialization<T>::value;
@@ -66,29 +89,33 @@ private:
     }
   };
 
-  queue::Deque<StackFrame> m_stack;
-  array::DynamicArray<Element> m_path;
+  // the traversal state comes from the trie's allocator, like its nodes
+  array::DynamicArray<StackFrame, array::PmrStorage> m_stack;
+  array::DynamicArray<Element, array::PmrStorage> m_path;
 
 public:
+  // the end iterator, allocates nothing
   TrieIterator(allocator_type alloc)
-  // TODO: make then pmr-aware
-  // : m_stack(alloc), m_path(alloc)
-  {};
+      : m_stack(array::PmrStorage{alloc.resource()}), m_path(array::PmrStorage{alloc.resource()}) {}
+
+  // iterates the words in the subtree of nodePtr, prefix being the path from the root to it
+  TrieIterator(const NodePtr nodePtr, const value_type& prefix, allocator_type alloc) : TrieIterator(alloc) {
+    if (nodePtr == nullptr) return;
+    for (const Element& e : prefix) m_path.pushBack(e);
+    m_stack.emplaceBack(nodePtr, nodePtr->children().begin());
+    if (!nodePtr->endOfWord()) ++(*this);
+  }
 
   TrieIterator(const NodePtr nodePtr, allocator_type alloc = {})
-  // TODO: make then pmr-aware
-  // : m_stack(alloc), m_path(alloc)
-  {
-    if (nodePtr != nullptr) {
-      m_stack.emplaceBack(nodePtr, nodePtr->children().begin());
-      if (!nodePtr->endOfWord()) ++(*this);
-    }
-  }
+      : TrieIterator(nodePtr, value_type{}, alloc) {}
 
   // conversion constructor
   TrieIterator(const TrieIterator<false, ParentTrie>& other)
     requires IsConst
-      : m_stack(other.m_stack), m_path(other.m_path) {}
+      : m_stack(other.m_stack.storage()), m_path(other.m_path) {
+    m_stack.reserve(other.m_stack.size());
+    for (const auto& [node, iter] : other.m_stack) m_stack.emplaceBack(node, iter);
+  }
 
   reference operator*() const { return reference{m_path.data(), m_path.size()}; }
 
@@ -97,7 +124,9 @@ public:
       auto& [nodePtr, iter] = m_stack.back();
 
       if (iter != nodePtr->children().end()) {
-        auto const& [key, nextNode] = *iter;
+        auto const& [key, childPtr] = *iter;
+        // a const iterator must walk const nodes, whatever the map stores
+        NodePtr nextNode = childPtr;
         ++iter;
 
         m_stack.emplaceBack(nextNode, nextNode->children().begin());
@@ -130,7 +159,7 @@ public:
 
 template <typename T, typename Hasher = std::hash<T>, typename KeyEqual = std::equal_to<T>>
   requires detail::Hasher<T, Hasher> && detail::KeyEqual<T, KeyEqual>
-class TrieNode {
+class TrieNode : public detail::NodeAggregates {
 public:
   using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
 
@@ -142,12 +171,12 @@ private:
 
 public:
   TrieNode(Hasher hasher = {}, KeyEqual eq = {}, allocator_type alloc = {})
-      : m_alloc(alloc), m_children({2, std::move(hasher), std::move(eq)}) {};
+      : m_alloc(alloc), m_children({0, std::move(hasher), std::move(eq)}) {};
 
   TrieNode(allocator_type alloc) : TrieNode({}, {}, alloc) {}
 
   TrieNode(const TrieNode& other, allocator_type alloc)
-      : m_alloc(alloc),
+      : detail::NodeAggregates(other), m_alloc(alloc),
         m_children({other.m_children.size(), other.m_children.hashFunction(), other.m_children.keyEq()}),
         m_endOfWord(other.m_endOfWord) {
     try {
@@ -164,11 +193,12 @@ public:
   TrieNode(const TrieNode& other) : TrieNode(other, other.m_alloc) {}
 
   TrieNode(TrieNode&& other) noexcept
-      : m_alloc(other.m_alloc), m_children(std::move(other.m_children)),
+      : detail::NodeAggregates(std::exchange<detail::NodeAggregates>(other, {})), m_alloc(other.m_alloc),
+        m_children(std::move(other.m_children)),
         m_endOfWord(std::exchange(other.m_endOfWord, false)) {}
 
   TrieNode(TrieNode&& other, allocator_type alloc)
-      : m_alloc(alloc),
+      : detail::NodeAggregates(std::exchange<detail::NodeAggregates>(other, {})), m_alloc(alloc),
         m_children(
             m_alloc == other.m_alloc
                 ? std::move(other.m_children)
@@ -223,18 +253,45 @@ public:
 
   constexpr bool contains(const T& key) const noexcept { return m_children.contains(key); }
 
+  // the child for key, or nullptr, in a single lookup
+  [[nodiscard]] TrieNode* child(const T& key) const {
+    auto it = m_children.find(key);
+    return it == m_children.end() ? nullptr : it->getValue();
+  }
+
   [[nodiscard]] constexpr bool endOfWord() const noexcept { return m_endOfWord; }
 
+  // this node and its child table, O(1) unlike memoryStats()
+  [[nodiscard]] size_t bytesAllocated() const noexcept {
+    return sizeof(TrieNode) + m_children.bytesAllocated();
+  }
+
+  [[nodiscard]] size_t childCapacity() const noexcept { return m_children.bucketCount(); }
+
+  // this node and its child table, not the subtree; elementCount is the number of children
+  [[nodiscard]] stats::MemoryStats memoryStats() const noexcept {
+    stats::MemoryStats result = m_children.memoryStats();
+    result.bytesAllocated += sizeof(TrieNode);
+    result.bytesUsed += sizeof(TrieNode);
+    result.nodeCount = 1;
+    return result;
+  }
+
   constexpr hashmap::HashMap<T, TrieNode*, Hasher, KeyEqual>& children() { return m_children; }
   constexpr const hashmap::HashMap<T, TrieNode*, Hasher, KeyEqual>& children() const { return m_children; }
 
-  void insert(const T& key) {
-    if (m_children.contains(key)) return;
+  // the child for key, created if it is missing
+  TrieNode* insert(const T& key) {
+    if (TrieNode* existing = child(key)) return existing;
     // m_alloc is auto injected
     TrieNode* newNode = m_alloc.new_object<TrieNode>(m_children.hashFunction(), m_children.keyEq());
     m_children.insert(key, newNode);
+    return newNode;
   }
 
+  // sizes the child table for childCount children at once, bulk loads know the exact count up front
+  void reserve(size_t childCount) { m_children.reserve(childCount); }
+
   constexpr TrieNode* operator[](const T& key) { return m_children[key]; }
   constexpr const TrieNode* operator[](const T& key) const { return m_children[key]; }
 
@@ -245,15 +302,30 @@ public:
     // don't swap allocators
     swap(m_children, other.m_children);
     swap(m_endOfWord, other.m_endOfWord);
+    swapAggregates(other);
   }
 
   // for ADL
   friend void swap(TrieNode& a, TrieNode& b) noexcept { a.swap(b); }
 };
 
+/*
+ * Node policies pick the node type of a Trie:
+ *   - HashNodes: every node keeps its children in a HashMap, works for any hashable element type.
+ *   - ArtNodes: adaptive radix tree nodes (see trie_art.cppm), for byte-sized integral elements only. Much
+ *     smaller nodes, no hashing, and iteration in lexicographic order.
+ * */
+export struct HashNodes {
+  template <typename T, typename Hasher, typename KeyEqual> using node = TrieNode<T, Hasher, KeyEqual>;
+};
+
+export struct ArtNodes {
+  template <typename T, typename Hasher, typename KeyEqual> using node = ArtNode<T, Hasher, KeyEqual>;
+};
+
 export template <
     typename Seq, typename Hasher = std::hash<detail::ValT<Seq>>,
-    typename KeyEqual = std::equal_to<detail::ValT<Seq>>>
+    typename KeyEqual = std::equal_to<detail::ValT<Seq>>, typename NodePolicy = HashNodes>
   requires detail::ReconstructibleSeq<Seq, detail::ValT<Seq>> && detail::Hasher<detail::ValT<Seq>, Hasher> &&
            detail::KeyEqual<detail::ValT<Seq>, KeyEqual>
 class Trie {
@@ -269,31 +341,285 @@ public:
   using const_pointer = void;
   using iterator = detail::TrieIterator<false, Trie>;
   using const_iterator = detail::TrieIterator<true, Trie>;
+  using score_type = detail::NodeAggregates::score_type;
   using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
   using view_type = std::conditional_t<
       std::is_same_v<Seq, std::string>, std::string_view, std::span<const detail::ValT<Seq>>>;
+  // path buffers (iterators, prefix collection) stay off the heap for sequences up to this length
+  static constexpr size_t inlinePathLength = 32;
+
+  // returned by prefixRange
+  class PrefixRange {
+    const_iterator m_begin;
+    const_iterator m_end;
+
+  public:
+    PrefixRange(const_iterator begin, const_iterator end)
+        : m_begin(std::move(begin)), m_end(std::move(end)) {}
+
+    [[nodiscard]] const_iterator begin() const { return m_begin; }
+    [[nodiscard]] const_iterator end() const { return m_end; }
+    [[nodiscard]] bool empty() const noexcept { return m_begin == m_end; }
+  };
 
 private:
   allocator_type m_alloc;
   [[no_unique_address]] Hasher m_hasher;
   [[no_unique_address]] KeyEqual m_keyEqual;
   using Element = detail::ValT<value_type>;
-  using NodeType = TrieNode<Element, Hasher, KeyEqual>;
+  using NodeType = typename NodePolicy::template node<Element, Hasher, KeyEqual>;
   NodeType* m_root = nullptr;
   size_type m_size = 0;
 
-  constexpr void collectSeq(
-      const NodeType* node, array::DynamicArray<Element>& path, array::DynamicArray<value_type>& sequences
-  ) const {
-    using PathType = std::remove_cvref_t<decltype(path)>;
+  // running totals behind memoryStats(), booked wherever a node is created or its child table grows
+  struct Footprint {
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    size_t nodes = 0;
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    size_t innerNodes = 0; // nodes with at least one child
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    size_t capacity = 0; // child slots over every node
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    size_t bytesAllocated = 0;
+  };
 
-    if (node->endOfWord()) {
-      if constexpr (std::constructible_from<value_type, PathType>) {
-        sequences.emplaceBack(path);
-      } else {
-        sequences.emplaceBack(path.begin(), path.end());
+  Footprint m_footprint;
+
+  using PathBuffer = array::SmallArray<Element, inlinePathLength>;
+
+  // the nodes along a sequence, root first
+  using NodePath = array::SmallArray<NodeType*, inlinePathLength + 1>;
+
+  // a node's own share of the footprint: itself and its child table
+  static Footprint footprintOf(const NodeType* node) noexcept {
+    return {1, node->children().size() != 0 ? size_t{1} : 0, node->childCapacity(), node->bytesAllocated()};
+  }
+
+  // footprint += after - before, for a node changed in place (or created, from an empty before)
+  static void rebook(Footprint& footprint, const Footprint& before, const Footprint& after) noexcept {
+    footprint.nodes += after.nodes - before.nodes;
+    footprint.innerNodes += after.innerNodes - before.innerNodes;
+    footprint.capacity += after.capacity - before.capacity;
+    footprint.bytesAllocated += after.bytesAllocated - before.bytesAllocated;
+  }
+
+  // the footprint of a whole subtree, for nodes that weren't built here (copies, moves across allocators)
+  static Footprint measure(const NodeType* node) noexcept {
+    Footprint total = footprintOf(node);
+    for (auto const& [key, childNodePtr] : node->children()) rebook(total, {}, measure(childNodePtr));
+    return total;
+  }
+
+  // the child of node for e, created if it is missing, with the new node and any table growth booked
+  static NodeType* insertChild(NodeType* node, const Element& e, Footprint& footprint) {
+    if (NodeType* existing = node->child(e)) return existing;
+    Footprint before = footprintOf(node);
+    NodeType* child = node->insert(e);
+    rebook(footprint, before, footprintOf(node));
+    rebook(footprint, {}, footprintOf(child));
+    return child;
+  }
+
+  NodePath insertPath(const value_type& seq) {
+    NodePath path;
+    NodeType* node = m_root;
+    path.emplaceBack(node);
+    for (const Element& e : seq) {
+      node = insertChild(node, e, m_footprint);
+      path.emplaceBack(node);
+    }
+    return path;
+  }
+
+  // marks the end of path as a new word, every node on the way gains it in its subtree count
+  void addWord(const NodePath& path) {
+    path.back()->setEndOfWord(true);
+    for (NodeType* node : path) node->addWords(1);
+    ++m_size;
+  }
+
+  // the node at the end of seq, nullptr if no stored sequence starts with it
+  NodeType* nodeAt(const value_type& seq) const {
+    NodeType* node = m_root;
+    for (const Element& e : seq) {
+      node = node->child(e);
+      if (node == nullptr) return nullptr;
+    }
+    return node;
+  }
+
+  // a child laid out by a bulk load, with the keys [first, last) that continue below it
+  struct SortedGroup {
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    Element key;
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    size_t first;
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    size_t last;
+  };
+
+  using SortedGroups = array::SmallArray<SortedGroup, 16>;
+
+  /*
+   * Lays out node for the sorted keys [first, last), which all share their first depth elements: the keys
+   * ending right here come first and make it a word, the rest are split into runs of equal element at depth.
+   * All runs are found before any child is created, so the child table is sized once for its exact count.
+   * The children themselves are created by the caller, right before their subtrees, so nodes are allocated
+   * in depth-first order like sorted inserts would.
+   * */
+  template <typename Keys>
+  SortedGroups layoutSorted(
+      NodeType* node, const Keys& keys, size_t first, size_t last, size_t depth, Footprint& footprint
+  ) {
+    auto key = [&](size_t i) -> decltype(auto) { return std::ranges::begin(keys)[i]; };
+    auto at = [&](size_t i) -> Element { return std::ranges::begin(key(i))[depth]; };
+
+    // duplicates of the word are skipped
+    if (first < last && std::ranges::size(key(first)) == depth) node->setEndOfWord(true);
+    while (first < last && std::ranges::size(key(first)) == depth) ++first;
+
+    SortedGroups groups;
+    for (size_t i = first; i < last;) {
+      if (std::ranges::size(key(i)) <= depth) {
+        throw std::invalid_argument("Trie::fromSorted: keys not sorted");
+      }
+      Element element = at(i);
+      size_t end = i + 1;
+      while (end < last && std::ranges::size(key(end)) > depth && m_keyEqual(at(end), element)) ++end;
+      groups.emplaceBack(element, i, end);
+      i = end;
+    }
+
+    Footprint before = footprintOf(node);
+    node->reserve(groups.size());
+    rebook(footprint, before, footprintOf(node));
+    return groups;
+  }
+
+  // fewer children than runs: a run was split by other keys in between
+  static void checkGrouped(const NodeType* node, const SortedGroups& groups) {
+    if (node->children().size() != groups.size()) {
+      throw std::invalid_argument("Trie::fromSorted: keys not sorted");
+    }
+  }
+
+  // sets the aggregates of a bulk loaded node once its subtree is complete, unranked words score 0
+  static size_t sealSorted(NodeType* node, size_t childWords) noexcept {
+    size_t words = childWords + (node->endOfWord() ? 1 : 0);
+    node->addWords(words);
+    if (node->endOfWord()) node->setScore(0);
+    if (words != 0) node->setBestScore(0);
+    return words;
+  }
+
+  // bulk loads the subtree of node, returns the number of words in it
+  template <typename Keys>
+  size_t buildSorted(
+      NodeType* node, const Keys& keys, size_t first, size_t last, size_t depth, Footprint& footprint
+  ) {
+    size_t childWords = 0;
+    SortedGroups groups = layoutSorted(node, keys, first, last, depth, footprint);
+    for (const SortedGroup& group : groups) {
+      NodeType* child = insertChild(node, group.key, footprint);
+      childWords += buildSorted(child, keys, group.first, group.last, depth + 1, footprint);
+    }
+    checkGrouped(node, groups);
+    return sealSorted(node, childWords);
+  }
+
+  // sums the stats of every node below node into total, innerNodes counts the ones with children.
+  // TrieNode::memoryStats walks every bucket of the child table for the chain length histogram
+  void collectMemoryStats(
+      const NodeType* node, stats::MemoryStats& total, size_t& innerNodes
+  ) const noexcept {
+    stats::MemoryStats own = node->memoryStats();
+    total.bytesAllocated += own.bytesAllocated;
+    total.bytesUsed += own.bytesUsed;
+    total.elementCount += own.elementCount;
+    total.capacity += own.capacity;
+    total.nodeCount += own.nodeCount;
+    for (size_t i = 0; i < total.chainLengths.size(); ++i) total.chainLengths[i] += own.chainLengths[i];
+    if (own.elementCount != 0) ++innerNodes;
+
+    for (auto const& [key, childNodePtr] : node->children()) {
+      collectMemoryStats(childNodePtr, total, innerNodes);
+    }
+  }
+
+  // restores "bestScore is the best score in the subtree" along path, after the score of its last node
+  // changed from previous
+  void updateBestScores(const NodePath& path, score_type previous) {
+    score_type score = path.back()->score();
+    if (score >= previous) {
+      // a raised score only ever raises the bounds above it
+      for (size_t i = path.size(); i-- > 0;) {
+        if (path[i]->bestScore() >= score) break;
+        path[i]->setBestScore(score);
+      }
+      return;
+    }
+    // a lowered score: recompute bottom up until a bound doesn't change
+    for (size_t i = path.size(); i-- > 0;) {
+      NodeType* node = path[i];
+      score_type best = node->endOfWord() ? node->score() : detail::NodeAggregates::noScore;
+      for (auto const& [key, childNodePtr] : node->children()) {
+        best = std::max(best, childNodePtr->bestScore());
       }
+      if (best == node->bestScore()) break;
+      node->setBestScore(best);
+    }
+  }
+
+  // a node reached by topKWithPrefix, below the prefix node (npos)
+  struct RankedVisit {
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    const NodeType* node;
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    size_t parent;
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    Element key;
+  };
+
+  struct RankedCandidate {
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    score_type bound;
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    size_t visit;
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    bool word; // the word ending at the visited node, rather than its whole subtree
+  };
+
+  // max-heap on the bound, ties go to the earlier visit so results are deterministic
+  struct ByBound {
+    bool operator()(const RankedCandidate& a, const RankedCandidate& b) const noexcept {
+      return a.bound < b.bound || (a.bound == b.bound && a.visit > b.visit);
     }
+  };
+
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  value_type rankedSeq(
+      const value_type& prefix, const array::DynamicArray<RankedVisit>& visits, size_t visit
+  ) const {
+    PathBuffer suffix;
+    for (size_t i = visit; i != npos; i = visits[i].parent) suffix.emplaceBack(visits[i].key);
+    PathBuffer path(std::ranges::begin(prefix), std::ranges::end(prefix));
+    for (size_t i = suffix.size(); i-- > 0;) path.emplaceBack(suffix[i]);
+    return makeSeq(path);
+  }
+
+  static value_type makeSeq(const PathBuffer& path) {
+    if constexpr (std::constructible_from<value_type, PathBuffer>) {
+      return value_type(path);
+    } else {
+      return value_type(path.begin(), path.end());
+    }
+  }
+
+  constexpr void collectSeq(
+      const NodeType* node, PathBuffer& path, array::DynamicArray<value_type>& sequences
+  ) const {
+    if (node->endOfWord()) sequences.emplaceBack(makeSeq(path));
 
     for (auto const& [key, childNodePtr] : node->children()) {
       path.emplaceBack(key);
@@ -302,10 +628,46 @@ private:
     }
   }
 
+  /*
+   * One Levenshtein DP row per trie depth, all in the flat `rows` buffer: row d holds the distances between
+   * the path to the current node at depth d and every prefix of the query. A child's row only depends on its
+   * parent's, and a subtree is pruned as soon as the smallest entry of its row exceeds maxDistance, since
+   * distances along a path never decrease below that minimum.
+   * */
+  void collectWithinDistance(
+      const NodeType* node, const Element& key, size_t depth, const PathBuffer& query, size_t maxDistance,
+      array::DynamicArray<size_t>& rows, PathBuffer& path,
+      array::DynamicArray<std::pair<value_type, size_t>>& matches
+  ) const {
+    const size_t width = query.size() + 1;
+    if (rows.size() < (depth + 1) * width) rows.resize((depth + 1) * width);
+    const size_t* previous = rows.data() + ((depth - 1) * width);
+    size_t* row = rows.data() + (depth * width);
+
+    row[0] = previous[0] + 1;
+    size_t rowMin = row[0];
+    for (size_t j = 1; j < width; ++j) {
+      size_t substitution = previous[j - 1] + (m_keyEqual(query[j - 1], key) ? 0 : 1);
+      row[j] = std::min({previous[j] + 1, row[j - 1] + 1, substitution});
+      rowMin = std::min(rowMin, row[j]);
+    }
+
+    if (node->endOfWord() && row[width - 1] <= maxDistance) {
+      matches.emplaceBack(makeSeq(path), row[width - 1]);
+    }
+    if (rowMin > maxDistance) return;
+
+    for (auto const& [childKey, childNodePtr] : node->children()) {
+      path.emplaceBack(childKey);
+      collectWithinDistance(childNodePtr, childKey, depth + 1, query, maxDistance, rows, path, matches);
+      path.popBack();
+    }
+  }
+
 public:
   Trie(Hasher hasher = {}, KeyEqual eq = {}, allocator_type alloc = {})
       : m_alloc(alloc), m_hasher(std::move(hasher)), m_keyEqual(std::move(eq)),
-        m_root(m_alloc.new_object<NodeType>(m_hasher, m_keyEqual)) {}
+        m_root(m_alloc.new_object<NodeType>(m_hasher, m_keyEqual)), m_footprint(footprintOf(m_root)) {}
 
   Trie(allocator_type alloc) : Trie({}, {}, alloc) {}
 
@@ -314,6 +676,8 @@ public:
         m_size(other.m_size) {
     if (other.m_root == nullptr) return;
     m_root = m_alloc.new_object<NodeType>(*other.m_root);
+    // copied child tables are sized for their children, not like the originals
+    m_footprint = measure(m_root);
   }
 
   Trie(const Trie& other) : Trie(other, other.m_alloc) {}
@@ -323,15 +687,74 @@ public:
         m_root(nullptr), m_size(std::exchange(other.m_size, 0)) {
     if (m_alloc == other.m_alloc) {
       m_root = std::exchange(other.m_root, nullptr);
+      m_footprint = std::exchange(other.m_footprint, {});
     } else {
       if (other.m_root == nullptr) return;
       m_root = m_alloc.new_object<NodeType>(std::move(*other.m_root));
+      m_footprint = measure(m_root);
     }
   }
 
   Trie(Trie&& other) noexcept
       : m_alloc(other.m_alloc), m_hasher(std::move(other.m_hasher)), m_keyEqual(std::move(other.m_keyEqual)),
-        m_root(std::exchange(other.m_root, nullptr)), m_size(std::exchange(other.m_size, 0)) {}
+        m_root(std::exchange(other.m_root, nullptr)), m_size(std::exchange(other.m_size, 0)),
+        m_footprint(std::exchange(other.m_footprint, {})) {}
+
+  /**
+   * @brief Builds a trie from sorted keys in one pass, bottom up. Each node's children are counted before
+   *        they are created, so child tables are sized once and never rehash or grow.
+   *
+   * Duplicates are fine. Keys out of order are only required to stay grouped by prefix, std::invalid_argument
+   * is thrown when they aren't. Every word scores 0, like after insert(seq).
+   */
+  template <typename Keys>
+    requires detail::SortedKeys<const Keys&, Element>
+  static Trie fromSorted(const Keys& keys, allocator_type alloc = {}) {
+    Trie trie(alloc);
+    trie.m_size = trie.buildSorted(trie.m_root, keys, 0, std::ranges::size(keys), 0, trie.m_footprint);
+    return trie;
+  }
+
+  /**
+   * @brief fromSorted, with the subtrees of the root's children built in parallel on pool.
+   *
+   * The input is split by first element, so the speed-up is bounded by how evenly the keys spread over the
+   * first elements. Nodes are allocated from several threads at once, alloc's resource must be thread safe.
+   */
+  template <typename Keys>
+    requires detail::SortedKeys<const Keys&, Element>
+  static Trie fromSortedParallel(
+      const Keys& keys, concurrency::ThreadPool& pool = concurrency::ThreadPool::shared(),
+      allocator_type alloc = {}
+  ) {
+    Trie trie(alloc);
+    SortedGroups groups =
+        trie.layoutSorted(trie.m_root, keys, 0, std::ranges::size(keys), 0, trie.m_footprint);
+    // the root's children all exist before any task starts, tasks never touch the root
+    array::SmallArray<NodeType*, 16> children;
+    for (const SortedGroup& group : groups) {
+      children.emplaceBack(insertChild(trie.m_root, group.key, trie.m_footprint));
+    }
+    checkGrouped(trie.m_root, groups);
+
+    std::atomic<size_t> childWords{0};
+    // every task books its own subtree, they are summed up once all are done
+    array::DynamicArray<Footprint> footprints(groups.size(), Footprint{});
+    {
+      concurrency::TaskGroup tasks(pool);
+      for (size_t i = 0; i < groups.size(); ++i) {
+        Footprint& footprint = footprints[i];
+        tasks.run([&trie, &keys, &childWords, &footprint, group = groups[i], child = children[i]] {
+          size_t words = trie.buildSorted(child, keys, group.first, group.last, 1, footprint);
+          childWords.fetch_add(words, std::memory_order_relaxed);
+        });
+      }
+      tasks.wait();
+    }
+    for (const Footprint& footprint : footprints) rebook(trie.m_footprint, {}, footprint);
+    trie.m_size = sealSorted(trie.m_root, childWords.load());
+    return trie;
+  }
 
   Trie& operator=(const Trie& other) {
     if (this == &other) return *this;
@@ -362,55 +785,190 @@ public:
     m_alloc.delete_object(m_root);
     m_root = nullptr;
     m_size = 0;
+    m_footprint = {};
   }
 
   constexpr void insert(const value_type& seq) {
-    NodeType* node = m_root;
-    for (const Element& e : seq) {
-      if (!node->contains(e)) node->insert(e);
-      node = (*node)[e];
-    }
-    node->setEndOfWord(true);
-    ++m_size;
+    NodePath path = insertPath(seq);
+    NodeType* node = path.back();
+    if (node->endOfWord()) return;
+    addWord(path);
+    // unranked words score 0
+    node->setScore(0);
+    updateBestScores(path, detail::NodeAggregates::noScore);
+  }
+
+  // inserts seq, or updates its score if it is already there
+  void insert(const value_type& seq, score_type score) {
+    NodePath path = insertPath(seq);
+    NodeType* node = path.back();
+    score_type previous = node->endOfWord() ? node->score() : detail::NodeAggregates::noScore;
+    if (!node->endOfWord()) addWord(path);
+    node->setScore(score);
+    updateBestScores(path, previous);
+  }
+
+  [[nodiscard]] std::optional<score_type> score(const value_type& seq) const {
+    const NodeType* node = nodeAt(seq);
+    if (node == nullptr || !node->endOfWord()) return std::nullopt;
+    return node->score();
   }
 
   [[nodiscard]] constexpr bool search(const value_type& seq) const {
-    NodeType* node = m_root;
-    for (const Element& e : seq) {
-      if (!node->contains(e)) return false;
-      node = (*node)[e];
-    }
-    return node->endOfWord();
+    const NodeType* node = nodeAt(seq);
+    return node != nullptr && node->endOfWord();
   }
 
-  [[nodiscard]] constexpr bool startsWith(const value_type& seq) const {
-    NodeType* node = m_root;
-    for (const Element& e : seq) {
-      if (!node->contains(e)) return false;
-      node = (*node)[e];
-    }
-    return true;
+  [[nodiscard]] constexpr bool startsWith(const value_type& seq) const { return nodeAt(seq) != nullptr; }
+
+  // number of stored sequences starting with prefix, in O(prefix length)
+  [[nodiscard]] size_type countWithPrefix(const value_type& prefix) const {
+    const NodeType* node = nodeAt(prefix);
+    return node == nullptr ? 0 : node->wordCount();
   }
 
   [[nodiscard]] constexpr size_type size() const noexcept { return m_size; }
 
   [[nodiscard]] constexpr bool empty() const noexcept { return m_size == 0; }
 
-  constexpr array::DynamicArray<value_type> getAllWithPrefix(const value_type& prefix) const {
-    NodeType* node = m_root;
-    array::DynamicArray<value_type> sequences;
+  /**
+   * @brief Memory held by the nodes and their child tables, in O(1) from running totals. elementCount is the
+   *        number of stored sequences, averageFanOut and loadFactor are over the child tables.
+   *
+   * bytesUsed and chainLengths stay 0, they need every bucket looked at: see detailedMemoryStats().
+   */
+  [[nodiscard]] stats::MemoryStats memoryStats() const noexcept {
+    stats::MemoryStats result;
+    result.bytesAllocated = m_footprint.bytesAllocated;
+    result.elementCount = m_size;
+    result.capacity = m_footprint.capacity;
+    result.nodeCount = m_footprint.nodes;
+    // every node but the root is a child of another
+    size_t children = m_footprint.nodes == 0 ? 0 : m_footprint.nodes - 1;
+    if (m_footprint.innerNodes != 0) {
+      result.averageFanOut = static_cast<double>(children) / static_cast<double>(m_footprint.innerNodes);
+    }
+    if (result.capacity != 0) {
+      result.loadFactor = static_cast<double>(children) / static_cast<double>(result.capacity);
+    }
+    return result;
+  }
 
-    for (const Element& e : prefix) {
-      if (!node->contains(e)) return sequences;
-      node = (*node)[e];
+  /**
+   * @brief memoryStats(), plus bytesUsed and the chain length histogram of the child tables.
+   *
+   * Walks every node and every bucket of its child table without allocating: fine for a periodic metrics
+   * export, not for a hot path.
+   */
+  [[nodiscard]] stats::MemoryStats detailedMemoryStats() const noexcept {
+    stats::MemoryStats result;
+    if (m_root == nullptr) return result;
+
+    size_t innerNodes = 0;
+    collectMemoryStats(m_root, result, innerNodes);
+    size_t children = result.elementCount;
+    if (innerNodes != 0) {
+      result.averageFanOut = static_cast<double>(children) / static_cast<double>(innerNodes);
     }
+    if (result.capacity != 0) {
+      result.loadFactor = static_cast<double>(children) / static_cast<double>(result.capacity);
+    }
+    result.elementCount = m_size;
+    return result;
+  }
 
-    array::DynamicArray<Element> path(std::ranges::begin(prefix), std::ranges::end(prefix));
+  /**
+   * @brief The sequences starting with prefix, lazily, in iteration order.
+   *
+   * Nothing is materialized: the range yields view_type views of the iterator's path buffer, valid until the
+   * iterator is advanced, and the traversal state is allocated from the trie's allocator.
+   *   for (std::string_view word : trie.prefixRange("pre")) ...
+   */
+  [[nodiscard]] PrefixRange prefixRange(const value_type& prefix) const {
+    return PrefixRange{const_iterator{nodeAt(prefix), prefix, m_alloc}, const_iterator{m_alloc}};
+  }
+
+  constexpr array::DynamicArray<value_type> getAllWithPrefix(const value_type& prefix) const {
+    array::DynamicArray<value_type> sequences;
+    const NodeType* node = nodeAt(prefix);
+    if (node == nullptr) return sequences;
+    sequences.reserve(node->wordCount());
+
+    PathBuffer path(std::ranges::begin(prefix), std::ranges::end(prefix));
 
     collectSeq(node, path, sequences);
     return sequences;
   }
 
+  /**
+   * @brief Fuzzy lookup: every stored sequence within Levenshtein distance maxDistance of query.
+   * @return The matches paired with their distance, in no particular order.
+   */
+  array::DynamicArray<std::pair<value_type, size_t>> searchWithinDistance(
+      const value_type& query, size_t maxDistance
+  ) const {
+    array::DynamicArray<std::pair<value_type, size_t>> matches;
+    if (m_root == nullptr) return matches;
+
+    PathBuffer queryElements(std::ranges::begin(query), std::ranges::end(query));
+    const size_t width = queryElements.size() + 1;
+    // row 0, the empty path: i insertions to reach each query prefix of length i
+    array::DynamicArray<size_t> rows(width, 0);
+    for (size_t j = 0; j < width; ++j) rows[j] = j;
+
+    PathBuffer path;
+    if (m_root->endOfWord() && queryElements.size() <= maxDistance) {
+      matches.emplaceBack(makeSeq(path), queryElements.size());
+    }
+    for (auto const& [key, childNodePtr] : m_root->children()) {
+      path.emplaceBack(key);
+      collectWithinDistance(childNodePtr, key, 1, queryElements, maxDistance, rows, path, matches);
+      path.popBack();
+    }
+    return matches;
+  }
+
+  /**
+   * @brief The k best scored sequences starting with prefix, best first.
+   *
+   * Walks best first: every node carries the best score in its subtree, so the frontier is ordered by an
+   * exact upper bound and the first k words popped are the answer. Only the k results are materialized,
+   * the work is bounded by k times the depth and fan-out of the paths to them rather than by the number
+   * of matches.
+   */
+  array::DynamicArray<std::pair<value_type, score_type>> topKWithPrefix(
+      const value_type& prefix, size_t k
+  ) const {
+    array::DynamicArray<std::pair<value_type, score_type>> results;
+    if (k == 0 || m_root == nullptr) return results;
+
+    const NodeType* start = nodeAt(prefix);
+    if (start == nullptr) return results;
+
+    array::DynamicArray<RankedVisit> visits;
+    queue::PriorityQueue<RankedCandidate, array::DynamicArray<RankedCandidate>, ByBound> frontier;
+    auto expand = [&](const NodeType* node, size_t self) {
+      if (node->endOfWord()) frontier.push({node->score(), self, true});
+      for (auto const& [key, childNodePtr] : node->children()) {
+        if (childNodePtr->bestScore() == detail::NodeAggregates::noScore) continue;
+        visits.emplaceBack(childNodePtr, self, key);
+        frontier.push({childNodePtr->bestScore(), visits.size() - 1, false});
+      }
+    };
+
+    expand(start, npos);
+    while (!frontier.empty() && results.size() < k) {
+      RankedCandidate candidate = frontier.top();
+      frontier.pop();
+      if (candidate.word) {
+        results.emplaceBack(rankedSeq(prefix, visits, candidate.visit), candidate.bound);
+      } else {
+        expand(visits[candidate.visit].node, candidate.visit);
+      }
+    }
+    return results;
+  }
+
   [[nodiscard]] allocator_type getAllocator() const noexcept { return m_alloc; }
 
   iterator begin() { return {m_root, m_alloc}; }
@@ -429,10 +987,15 @@ public:
     swap(m_hasher, other.m_hasher);
     swap(m_keyEqual, other.m_keyEqual);
     swap(m_size, other.m_size);
+    swap(m_footprint, other.m_footprint);
   }
 
   // for ADL
   constexpr friend void swap(Trie& a, Trie& b) noexcept { a.swap(b); }
 };
 
+// a Trie with adaptive radix tree nodes, e.g. tree::ArtTrie<std::string>
+export template <typename Seq>
+using ArtTrie = Trie<Seq, std::hash<detail::ValT<Seq>>, std::equal_to<detail::ValT<Seq>>, ArtNodes>;
+
 } // namespace tree
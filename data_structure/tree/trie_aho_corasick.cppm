@@ -0,0 +1,239 @@
+module;
+#include "../array/dynamic_array.hpp"
+#include "../queue/deque.hpp"
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+export module trie:aho_corasick;
+import :frozen;
+
+/*
+ * AhoCorasick finds every occurrence of a set of byte patterns (typically the keys of a Trie) in one pass
+ * over the text, O(text + matches) instead of a trie walk from every offset:
+ *   auto automaton = tree::AhoCorasick::build(keywords);
+ *   auto scanner = automaton.scanner();
+ *   while (read(chunk)) scanner.scan(chunk, [](tree::AhoCorasick::Match m) { ... });
+ *
+ * The goto, failure and output links are flattened into a dense DFA, one row per trie state:
+ *   - Bytes are first mapped to byte classes. Bytes that appear in no pattern share class 0, so a row only
+ *     has (distinct pattern bytes + 1) columns and the table stays small and dense.
+ *   - Missing goto transitions are resolved through the failure links at build time, so scanning a byte
+ *     is exactly one class lookup and one table lookup, with no failure chasing.
+ *   - The top bit of a transition marks target states that end a pattern or have one as a suffix, the
+ *     scan loop only leaves its fast path on those. Matches are then reported along the output links.
+ * Empty patterns are ignored, they would match at every offset.
+ * */
+
+namespace tree {
+
+export class AhoCorasick {
+public:
+  // pattern indexes into patterns(), begin and end are offsets into the scanned stream
+  struct Match {
+    size_t pattern;
+    size_t begin;
+    size_t end;
+    bool operator==(const Match&) const = default;
+  };
+
+  class Scanner;
+
+private:
+  static constexpr uint32_t outputBit = uint32_t{1} << 31;
+  static constexpr uint32_t noState = ~uint32_t{0};
+  static constexpr uint32_t noPattern = ~uint32_t{0};
+
+  array::DynamicArray<std::string> m_patterns;
+  std::array<uint16_t, 256> m_classOf{};
+  size_t m_stride = 1;
+  array::DynamicArray<uint32_t> m_next;      // m_stride transitions per state
+  array::DynamicArray<uint32_t> m_pattern;    // the pattern ending at each state, or noPattern
+  array::DynamicArray<uint32_t> m_outputLink; // nearest proper suffix state ending a pattern, 0 if none
+
+  uint32_t addState() {
+    for (size_t i = 0; i < m_stride; ++i) m_next.pushBack(noState);
+    m_pattern.pushBack(noPattern);
+    m_outputLink.pushBack(0);
+    return static_cast<uint32_t>(m_pattern.size() - 1);
+  }
+
+  uint32_t& transition(uint32_t state, size_t byteClass) noexcept {
+    return m_next[(state * m_stride) + byteClass];
+  }
+
+  template <typename Fn> void report(uint32_t state, size_t end, Fn& onMatch) const {
+    if (m_pattern[state] == noPattern) state = m_outputLink[state];
+    while (state != 0) {
+      size_t pattern = m_pattern[state];
+      onMatch(Match{pattern, end - m_patterns[pattern].size(), end});
+      state = m_outputLink[state];
+    }
+  }
+
+  explicit AhoCorasick(array::DynamicArray<std::string> patterns) : m_patterns(std::move(patterns)) {
+    // byte classes, in byte order
+    std::array<bool, 256> used{};
+    for (const std::string& pattern : m_patterns) {
+      for (char c : pattern) used[static_cast<unsigned char>(c)] = true;
+    }
+    for (size_t b = 0; b < used.size(); ++b) {
+      if (used[b]) m_classOf[b] = static_cast<uint16_t>(m_stride++);
+    }
+
+    // goto trie
+    addState();
+    for (uint32_t id = 0; id < m_patterns.size(); ++id) {
+      uint32_t state = 0;
+      for (char c : m_patterns[id]) {
+        uint16_t byteClass = m_classOf[static_cast<unsigned char>(c)];
+        if (transition(state, byteClass) == noState) {
+          uint32_t child = addState();
+          transition(state, byteClass) = child;
+        }
+        state = transition(state, byteClass);
+      }
+      m_pattern[state] = id;
+    }
+
+    // failure links in breadth first order, so a state's failure target is always complete before it
+    array::DynamicArray<uint32_t> failure(m_pattern.size(), 0);
+    array::DynamicArray<uint32_t> order;
+    order.reserve(m_pattern.size());
+    order.pushBack(0);
+    queue::Deque<uint32_t> frontier;
+    for (size_t byteClass = 0; byteClass < m_stride; ++byteClass) {
+      uint32_t& next = transition(0, byteClass);
+      if (next == noState) {
+        next = 0;
+      } else {
+        frontier.pushBack(next);
+      }
+    }
+    while (!frontier.empty()) {
+      uint32_t state = frontier.front();
+      frontier.popFront();
+      order.pushBack(state);
+      uint32_t fail = failure[state];
+      for (size_t byteClass = 0; byteClass < m_stride; ++byteClass) {
+        uint32_t& next = transition(state, byteClass);
+        uint32_t fallback = transition(fail, byteClass) & ~outputBit;
+        if (next == noState) {
+          next = fallback;
+          continue;
+        }
+        failure[next] = fallback;
+        m_outputLink[next] = m_pattern[fallback] != noPattern ? fallback : m_outputLink[fallback];
+        frontier.pushBack(next);
+      }
+    }
+
+    renumber(order);
+    for (uint32_t& next : m_next) {
+      if (m_pattern[next] != noPattern || m_outputLink[next] != 0) next |= outputBit;
+    }
+  }
+
+  // renumbers the states in breadth first order. Scans spend nearly all their time in the few shallow
+  // states, this packs their rows together at the front of the table instead of scattering them
+  void renumber(const array::DynamicArray<uint32_t>& order) {
+    array::DynamicArray<uint32_t> newId(order.size(), 0);
+    for (uint32_t i = 0; i < order.size(); ++i) newId[order[i]] = i;
+
+    array::DynamicArray<uint32_t> next(m_next.size(), 0);
+    array::DynamicArray<uint32_t> pattern(order.size(), 0);
+    array::DynamicArray<uint32_t> outputLink(order.size(), 0);
+    for (uint32_t i = 0; i < order.size(); ++i) {
+      uint32_t old = order[i];
+      for (size_t byteClass = 0; byteClass < m_stride; ++byteClass) {
+        next[(i * m_stride) + byteClass] = newId[transition(old, byteClass)];
+      }
+      pattern[i] = m_pattern[old];
+      outputLink[i] = newId[m_outputLink[old]];
+    }
+    m_next = std::move(next);
+    m_pattern = std::move(pattern);
+    m_outputLink = std::move(outputLink);
+  }
+
+public:
+  AhoCorasick() : AhoCorasick(array::DynamicArray<std::string>{}) {}
+
+  /**
+   * @brief Builds the automaton for a key set, typically a built Trie.
+   *        Duplicates and empty keys are ignored.
+   * @param keys Any range whose elements convert to std::string_view, e.g. a Trie<std::string>.
+   */
+  template <detail::ByteKeys Keys> static AhoCorasick build(const Keys& keys) {
+    array::DynamicArray<std::string> patterns = detail::sortedUniqueKeys(keys);
+    // sorted, so an empty key comes first
+    if (!patterns.empty() && patterns[0].empty()) patterns.erase(patterns.begin());
+    return AhoCorasick(std::move(patterns));
+  }
+
+  // the patterns Match::pattern refers to, sorted
+  [[nodiscard]] const array::DynamicArray<std::string>& patterns() const noexcept { return m_patterns; }
+
+  [[nodiscard]] size_t stateCount() const noexcept { return m_pattern.size(); }
+
+  // number of distinct byte classes, the width of a table row
+  [[nodiscard]] size_t classCount() const noexcept { return m_stride; }
+
+  [[nodiscard]] Scanner scanner() const noexcept;
+
+  // calls onMatch(Match) for every occurrence in text, ordered by end offset
+  template <std::invocable<Match> Fn> void findAll(std::string_view text, Fn onMatch) const;
+
+  [[nodiscard]] array::DynamicArray<Match> findAll(std::string_view text) const {
+    array::DynamicArray<Match> matches;
+    findAll(text, [&](Match m) { matches.pushBack(m); });
+    return matches;
+  }
+};
+
+// streaming state: matches that straddle chunk boundaries are found, offsets count from the first chunk
+class AhoCorasick::Scanner {
+  const AhoCorasick* m_automaton;
+  uint32_t m_state = 0;
+  size_t m_offset = 0;
+
+public:
+  explicit Scanner(const AhoCorasick& automaton) noexcept : m_automaton(&automaton) {}
+
+  template <std::invocable<Match> Fn> void scan(std::string_view chunk, Fn onMatch) {
+    const uint32_t* table = m_automaton->m_next.data();
+    const uint16_t* classOf = m_automaton->m_classOf.data();
+    const size_t stride = m_automaton->m_stride;
+    uint32_t state = m_state;
+
+    for (size_t i = 0; i < chunk.size(); ++i) {
+      uint32_t next = table[(state * stride) + classOf[static_cast<unsigned char>(chunk[i])]];
+      state = next & ~outputBit;
+      if ((next & outputBit) != 0) m_automaton->report(state, m_offset + i + 1, onMatch);
+    }
+
+    m_state = state;
+    m_offset += chunk.size();
+  }
+
+  // bytes scanned so far
+  [[nodiscard]] size_t offset() const noexcept { return m_offset; }
+
+  void reset() noexcept {
+    m_state = 0;
+    m_offset = 0;
+  }
+};
+
+inline AhoCorasick::Scanner AhoCorasick::scanner() const noexcept { return Scanner{*this}; }
+
+template <std::invocable<AhoCorasick::Match> Fn>
+void AhoCorasick::findAll(std::string_view text, Fn onMatch) const {
+  Scanner scan = scanner();
+  scan.scan(text, std::move(onMatch));
+}
+
+} // namespace tree
@@ -0,0 +1,434 @@
+module;
+#include "../memory_stats.hpp"
+#include "./detail.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory_resource>
+#include <utility>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+export module trie:art;
+
+/*
+ * ArtNode is an adaptive radix tree node for tries over byte-sized elements (char, uint8_t, ...), used
+ * through `tree::ArtTrie<Seq>`.
+ *
+ * The node object itself never moves once its parent points to it. What adapts is its child table (the
+ * "body"), which is reallocated through the node's pmr allocator as the fan-out grows:
+ *   - Node4:   up to 4 sorted keys + 4 child pointers, searched linearly.
+ *   - Node16:  up to 16 sorted keys + 16 child pointers, searched with one SSE2 compare of all 16 keys.
+ *   - Node48:  a 256-entry byte index into 48 child pointers.
+ *   - Node256: 256 child pointers indexed directly by the key.
+ * A leaf has no body at all. Children are always visited in ascending (unsigned) byte order, so iterating
+ * an ArtTrie yields its sequences in lexicographic order.
+ * */
+
+namespace tree {
+
+template <typename T, typename Hasher = std::hash<T>, typename KeyEqual = std::equal_to<T>>
+  requires std::integral<T> && (sizeof(T) == 1)
+class ArtNode : public detail::NodeAggregates {
+public:
+  using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+  enum class Kind : uint8_t { Leaf, Node4, Node16, Node48, Node256 };
+
+private:
+  struct Body4 {
+    std::array<uint8_t, 4> keys{};
+    std::array<ArtNode*, 4> children{};
+  };
+
+  struct Body16 {
+    alignas(16) std::array<uint8_t, 16> keys{};
+    std::array<ArtNode*, 16> children{};
+  };
+
+  struct Body48 {
+    std::array<uint8_t, 256> slots{}; // 0: no child, otherwise index into children + 1
+    std::array<ArtNode*, 48> children{};
+  };
+
+  struct Body256 {
+    std::array<ArtNode*, 256> children{};
+  };
+
+  allocator_type m_alloc;
+  void* m_body = nullptr;
+  uint16_t m_count = 0;
+  Kind m_kind = Kind::Leaf;
+  bool m_endOfWord = false;
+
+  static constexpr uint8_t toByte(T key) noexcept { return static_cast<uint8_t>(key); }
+
+  template <typename Body> Body& body() const noexcept { return *static_cast<Body*>(m_body); }
+
+  [[nodiscard]] static constexpr size_t capacityOf(Kind kind) noexcept {
+    switch (kind) {
+    case Kind::Leaf: return 0;
+    case Kind::Node4: return 4;
+    case Kind::Node16: return 16;
+    case Kind::Node48: return 48;
+    case Kind::Node256: return 256;
+    }
+    return 0;
+  }
+
+  [[nodiscard]] static constexpr size_t bodyBytes(Kind kind) noexcept {
+    switch (kind) {
+    case Kind::Leaf: return 0;
+    case Kind::Node4: return sizeof(Body4);
+    case Kind::Node16: return sizeof(Body16);
+    case Kind::Node48: return sizeof(Body48);
+    case Kind::Node256: return sizeof(Body256);
+    }
+    return 0;
+  }
+
+  void* allocateBody(Kind kind) {
+    switch (kind) {
+    case Kind::Leaf: return nullptr;
+    case Kind::Node4: return m_alloc.new_object<Body4>();
+    case Kind::Node16: return m_alloc.new_object<Body16>();
+    case Kind::Node48: return m_alloc.new_object<Body48>();
+    case Kind::Node256: return m_alloc.new_object<Body256>();
+    }
+    return nullptr;
+  }
+
+  void deallocateBody(void* body, Kind kind) noexcept {
+    switch (kind) {
+    case Kind::Leaf: break;
+    case Kind::Node4: m_alloc.delete_object(static_cast<Body4*>(body)); break;
+    case Kind::Node16: m_alloc.delete_object(static_cast<Body16*>(body)); break;
+    case Kind::Node48: m_alloc.delete_object(static_cast<Body48*>(body)); break;
+    case Kind::Node256: m_alloc.delete_object(static_cast<Body256*>(body)); break;
+    }
+  }
+
+  [[nodiscard]] ArtNode* find(uint8_t key) const noexcept {
+    switch (m_kind) {
+    case Kind::Leaf: return nullptr;
+    case Kind::Node4: {
+      const Body4& b = body<Body4>();
+      for (uint16_t i = 0; i < m_count; ++i) {
+        if (b.keys[i] == key) return b.children[i];
+      }
+      return nullptr;
+    }
+    case Kind::Node16: {
+      const Body16& b = body<Body16>();
+#if defined(__SSE2__)
+      __m128i needle = _mm_set1_epi8(static_cast<char>(key));
+      __m128i keys = _mm_load_si128(reinterpret_cast<const __m128i*>(b.keys.data())); // NOLINT
+      auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(needle, keys)));
+      mask &= (1U << m_count) - 1;
+      return mask != 0 ? b.children[std::countr_zero(mask)] : nullptr;
+#else
+      for (uint16_t i = 0; i < m_count; ++i) {
+        if (b.keys[i] == key) return b.children[i];
+      }
+      return nullptr;
+#endif
+    }
+    case Kind::Node48: {
+      const Body48& b = body<Body48>();
+      return b.slots[key] != 0 ? b.children[b.slots[key] - 1] : nullptr;
+    }
+    case Kind::Node256: return body<Body256>().children[key];
+    }
+    return nullptr;
+  }
+
+  // keeps keys sorted, the caller guarantees there is room and that key is new
+  template <typename Body> void insertSorted(Body& b, uint8_t key, ArtNode* child) noexcept {
+    auto keys = b.keys.begin();
+    auto children = b.children.begin();
+    auto pos = static_cast<uint16_t>(std::lower_bound(keys, keys + m_count, key) - keys);
+    std::copy_backward(keys + pos, keys + m_count, keys + m_count + 1);
+    std::copy_backward(children + pos, children + m_count, children + m_count + 1);
+    b.keys[pos] = key;
+    b.children[pos] = child;
+  }
+
+  void placeChild(uint8_t key, ArtNode* child) noexcept {
+    switch (m_kind) {
+    case Kind::Leaf: break;
+    case Kind::Node4: insertSorted(body<Body4>(), key, child); break;
+    case Kind::Node16: insertSorted(body<Body16>(), key, child); break;
+    case Kind::Node48: {
+      Body48& b = body<Body48>();
+      b.children[m_count] = child;
+      b.slots[key] = static_cast<uint8_t>(m_count + 1);
+      break;
+    }
+    case Kind::Node256: body<Body256>().children[key] = child; break;
+    }
+    ++m_count;
+  }
+
+  // moves the children into the body of the next bigger kind, the node itself stays where it is
+  void grow() {
+    Kind next = m_kind == Kind::Leaf     ? Kind::Node4
+                : m_kind == Kind::Node4  ? Kind::Node16
+                : m_kind == Kind::Node16 ? Kind::Node48
+                                         : Kind::Node256;
+    void* oldBody = m_body;
+    Kind oldKind = m_kind;
+    uint16_t count = m_count;
+
+    m_body = allocateBody(next);
+    m_kind = next;
+    m_count = 0;
+    if (oldBody == nullptr) return;
+
+    switch (oldKind) {
+    case Kind::Node4: {
+      const auto& b = *static_cast<Body4*>(oldBody);
+      for (uint16_t i = 0; i < count; ++i) placeChild(b.keys[i], b.children[i]);
+      break;
+    }
+    case Kind::Node16: {
+      const auto& b = *static_cast<Body16*>(oldBody);
+      for (uint16_t i = 0; i < count; ++i) placeChild(b.keys[i], b.children[i]);
+      break;
+    }
+    case Kind::Node48: {
+      const auto& b = *static_cast<Body48*>(oldBody);
+      for (size_t key = 0; key < 256; ++key) {
+        if (b.slots[key] != 0) placeChild(static_cast<uint8_t>(key), b.children[b.slots[key] - 1]);
+      }
+      break;
+    }
+    default: break;
+    }
+    deallocateBody(oldBody, oldKind);
+  }
+
+  // positions: the slot index for Node4/16, the key byte for Node48/256
+  [[nodiscard]] uint16_t endPosition() const noexcept {
+    return m_kind == Kind::Node48 || m_kind == Kind::Node256 ? 256 : m_count;
+  }
+
+  [[nodiscard]] uint16_t nextPosition(uint16_t pos) const noexcept {
+    if (m_kind == Kind::Node48) {
+      const Body48& b = body<Body48>();
+      while (pos < 256 && b.slots[pos] == 0) ++pos;
+    } else if (m_kind == Kind::Node256) {
+      const Body256& b = body<Body256>();
+      while (pos < 256 && b.children[pos] == nullptr) ++pos;
+    }
+    return pos;
+  }
+
+  [[nodiscard]] std::pair<T, ArtNode*> entryAt(uint16_t pos) const noexcept {
+    switch (m_kind) {
+    case Kind::Node4: return {static_cast<T>(body<Body4>().keys[pos]), body<Body4>().children[pos]};
+    case Kind::Node16: return {static_cast<T>(body<Body16>().keys[pos]), body<Body16>().children[pos]};
+    case Kind::Node48: {
+      const Body48& b = body<Body48>();
+      return {static_cast<T>(pos), b.children[b.slots[pos] - 1]};
+    }
+    case Kind::Node256: return {static_cast<T>(pos), body<Body256>().children[pos]};
+    default: return {T{}, nullptr};
+    }
+  }
+
+  // copies (or moves) other's children into this node, with a body of the same kind
+  template <typename NodeRef> void adoptChildrenOf(NodeRef&& other) {
+    m_body = allocateBody(other.m_kind);
+    m_kind = other.m_kind;
+    try {
+      for (auto [key, child] : other.children()) {
+        ArtNode* copy = m_alloc.new_object<ArtNode>(std::forward<NodeRef>(other).forwardChild(*child));
+        placeChild(toByte(key), copy);
+      }
+    } catch (...) {
+      clear();
+      throw;
+    }
+  }
+
+  const ArtNode& forwardChild(ArtNode& child) const& noexcept { return child; }
+  ArtNode&& forwardChild(ArtNode& child) && noexcept { return std::move(child); }
+
+public:
+  class ChildIterator {
+    const ArtNode* m_node = nullptr;
+    uint16_t m_pos = 0;
+
+  public:
+    using value_type = std::pair<T, ArtNode*>;
+    using reference = value_type;
+    using pointer = void;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::forward_iterator_tag;
+
+    ChildIterator() = default;
+    ChildIterator(const ArtNode* node, uint16_t pos) : m_node(node), m_pos(pos) {}
+
+    reference operator*() const noexcept { return m_node->entryAt(m_pos); }
+
+    ChildIterator& operator++() noexcept {
+      m_pos = m_node->nextPosition(m_pos + 1);
+      return *this;
+    }
+
+    ChildIterator operator++(int) noexcept {
+      ChildIterator snapshot = *this;
+      ++(*this);
+      return snapshot;
+    }
+
+    bool operator==(const ChildIterator& other) const noexcept {
+      return m_node == other.m_node && m_pos == other.m_pos;
+    }
+  };
+
+  class Children {
+    const ArtNode* m_node;
+
+  public:
+    explicit Children(const ArtNode* node) : m_node(node) {}
+    [[nodiscard]] ChildIterator begin() const noexcept { return {m_node, m_node->nextPosition(0)}; }
+    [[nodiscard]] ChildIterator end() const noexcept { return {m_node, m_node->endPosition()}; }
+    [[nodiscard]] size_t size() const noexcept { return m_node->m_count; }
+  };
+
+  ArtNode(Hasher = {}, KeyEqual = {}, allocator_type alloc = {}) : m_alloc(alloc) {}
+
+  ArtNode(allocator_type alloc) : m_alloc(alloc) {}
+
+  ArtNode(const ArtNode& other, allocator_type alloc)
+      : detail::NodeAggregates(other), m_alloc(alloc), m_endOfWord(other.m_endOfWord) {
+    adoptChildrenOf(other);
+  }
+
+  ArtNode(const ArtNode& other) : ArtNode(other, other.m_alloc) {}
+
+  ArtNode(ArtNode&& other) noexcept
+      : detail::NodeAggregates(std::exchange<detail::NodeAggregates>(other, {})), m_alloc(other.m_alloc),
+        m_body(std::exchange(other.m_body, nullptr)),
+        m_count(std::exchange(other.m_count, 0)), m_kind(std::exchange(other.m_kind, Kind::Leaf)),
+        m_endOfWord(std::exchange(other.m_endOfWord, false)) {}
+
+  ArtNode(ArtNode&& other, allocator_type alloc)
+      : detail::NodeAggregates(std::exchange<detail::NodeAggregates>(other, {})), m_alloc(alloc),
+        m_endOfWord(other.m_endOfWord) {
+    if (m_alloc == other.m_alloc) {
+      m_body = std::exchange(other.m_body, nullptr);
+      m_count = std::exchange(other.m_count, 0);
+      m_kind = std::exchange(other.m_kind, Kind::Leaf);
+    } else {
+      adoptChildrenOf(std::move(other));
+    }
+    other.m_endOfWord = false;
+  }
+
+  ArtNode& operator=(const ArtNode& other) {
+    if (this == &other) return *this;
+    ArtNode copy(other, m_alloc);
+    swap(copy);
+    return *this;
+  }
+
+  ArtNode& operator=(ArtNode&& other) {
+    if (this == &other) return *this;
+    ArtNode moved(std::move(other), m_alloc);
+    swap(moved);
+    return *this;
+  }
+
+  ~ArtNode() noexcept { clear(); }
+
+  void clear() noexcept {
+    if (m_body == nullptr) return;
+    for (auto [key, child] : children()) m_alloc.delete_object(child);
+    deallocateBody(m_body, m_kind);
+    m_body = nullptr;
+    m_count = 0;
+    m_kind = Kind::Leaf;
+  }
+
+  [[nodiscard]] bool contains(const T& key) const noexcept { return find(toByte(key)) != nullptr; }
+
+  [[nodiscard]] ArtNode* child(const T& key) const noexcept { return find(toByte(key)); }
+
+  ArtNode* operator[](const T& key) const noexcept { return find(toByte(key)); }
+
+  // the child for key, created if it is missing
+  ArtNode* insert(const T& key) {
+    if (ArtNode* existing = find(toByte(key))) return existing;
+    if (m_count == capacityOf(m_kind)) grow();
+    // m_alloc is auto injected
+    ArtNode* newNode = m_alloc.new_object<ArtNode>();
+    placeChild(toByte(key), newNode);
+    return newNode;
+  }
+
+  // sizes the body for childCount children at once, instead of growing through every smaller kind
+  void reserve(size_t childCount) {
+    childCount = std::min<size_t>(childCount, 256);
+    if (childCount <= capacityOf(m_kind)) return;
+    if (m_count != 0) {
+      while (capacityOf(m_kind) < childCount) grow();
+      return;
+    }
+    Kind kind = childCount <= 4    ? Kind::Node4
+                : childCount <= 16 ? Kind::Node16
+                : childCount <= 48 ? Kind::Node48
+                                   : Kind::Node256;
+    void* body = allocateBody(kind);
+    deallocateBody(m_body, m_kind);
+    m_body = body;
+    m_kind = kind;
+  }
+
+  [[nodiscard]] Children children() const noexcept { return Children{this}; }
+
+  // this node and its body, O(1)
+  [[nodiscard]] size_t bytesAllocated() const noexcept { return sizeof(ArtNode) + bodyBytes(m_kind); }
+
+  [[nodiscard]] size_t childCapacity() const noexcept { return capacityOf(m_kind); }
+
+  // this node and its body, not the subtree; elementCount is the number of children
+  [[nodiscard]] stats::MemoryStats memoryStats() const noexcept {
+    stats::MemoryStats result;
+    result.bytesAllocated = bytesAllocated();
+    // a key byte and a child pointer per child
+    result.bytesUsed = sizeof(ArtNode) + (m_count * (sizeof(uint8_t) + sizeof(ArtNode*)));
+    result.elementCount = m_count;
+    result.capacity = childCapacity();
+    result.nodeCount = 1;
+    if (result.capacity != 0) {
+      result.loadFactor = static_cast<double>(m_count) / static_cast<double>(result.capacity);
+    }
+    return result;
+  }
+
+  [[nodiscard]] constexpr bool endOfWord() const noexcept { return m_endOfWord; }
+  constexpr void setEndOfWord(bool isEnd) noexcept { m_endOfWord = isEnd; }
+
+  [[nodiscard]] Kind kind() const noexcept { return m_kind; }
+
+  void swap(ArtNode& other) noexcept {
+    using std::swap;
+    // don't swap allocators
+    swap(m_body, other.m_body);
+    swap(m_count, other.m_count);
+    swap(m_kind, other.m_kind);
+    swap(m_endOfWord, other.m_endOfWord);
+    swapAggregates(other);
+  }
+
+  // for ADL
+  friend void swap(ArtNode& a, ArtNode& b) noexcept { a.swap(b); }
+};
+
+} // namespace tree
@@ -0,0 +1,572 @@
+module;
+#include "../array/dynamic_array.hpp"
+#include "../array/small_array.hpp"
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+export module trie:concurrent;
+import :radix;
+import epoch;
+
+/*
+ * ConcurrentTrie is a Trie for read-mostly dictionaries shared between threads: lookups and iteration never
+ * block and never wait for writers, writers apply batches of inserts and erases one batch at a time.
+ *
+ *   tree::ConcurrentTrie<std::string> words;
+ *   words.apply(tree::ConcurrentTrie<std::string>::Batch{}.insert("car").erase("cat"));   // writer
+ *   bool found = words.search("car");                                                     // any thread
+ *   for (std::string_view word : words.snapshot()) ...                                    // any thread
+ *
+ *   - Published nodes are immutable. A batch copies the nodes along the paths it touches (copy-on-write),
+ *     nodes created by the same batch are modified in place, and the new root is published with one atomic
+ *     store. Readers see either the whole batch or none of it.
+ *   - Replaced nodes are retired to an epoch domain (concurrency::EpochDomain) and freed by a later writer
+ *     once no reader can still be walking the old version.
+ *   - A Snapshot pins one version for as long as it lives: repeated lookups and iteration through it are
+ *     consistent with each other. Long lived snapshots delay reclamation, they never block writers.
+ *   - A node stores its children's keys and pointers in one block right after its header, sorted by key,
+ *     and the number of words in its subtree, so size() and countWithPrefix are O(1) and O(prefix).
+ *
+ * All nodes are allocated and freed by writers, under the write lock, so the allocator's memory resource
+ * doesn't have to be thread safe. Readers never allocate from it.
+ * */
+
+namespace tree::detail {
+
+template <typename ParentTrie> class ConcurrentTrieIterator {
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = ParentTrie::value_type;
+  using difference_type = ptrdiff_t;
+  using pointer = void;
+  using view_type = ParentTrie::view_type;
+  using reference = view_type;
+
+private:
+  using Node = ParentTrie::Node;
+  using Element = ParentTrie::Element;
+
+  struct StackFrame {
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    const Node* node;
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    uint32_t next; // index of the next child to visit
+    constexpr bool operator==(const StackFrame& other) const noexcept = default;
+  };
+
+  // readers may not allocate from the trie's memory resource, the state lives inline as far as possible
+  array::SmallArray<StackFrame, ParentTrie::inlinePathLength + 1> m_stack;
+  array::SmallArray<Element, ParentTrie::inlinePathLength> m_path;
+
+public:
+  ConcurrentTrieIterator() = default;
+
+  ConcurrentTrieIterator(const Node* node, std::span<const Element> prefix) {
+    if (node == nullptr) return;
+    for (const Element& e : prefix) m_path.emplaceBack(e);
+    m_stack.emplaceBack(node, 0);
+    if (!node->endOfWord) ++(*this);
+  }
+
+  reference operator*() const { return reference{m_path.data(), m_path.size()}; }
+
+  ConcurrentTrieIterator& operator++() {
+    while (!m_stack.empty()) {
+      auto& [node, next] = m_stack.back();
+
+      if (next < node->childCount) {
+        uint32_t idx = next++;
+        const Node* child = ParentTrie::children(node)[idx];
+        m_path.emplaceBack(ParentTrie::keys(node)[idx]);
+        m_stack.emplaceBack(child, 0);
+        if (child->endOfWord) return *this;
+      } else {
+        m_stack.popBack();
+        if (!m_path.empty()) m_path.popBack();
+      }
+    }
+    return *this;
+  }
+
+  ConcurrentTrieIterator operator++(int) {
+    ConcurrentTrieIterator snapshot = *this;
+    ++(*this);
+    return snapshot;
+  }
+
+  bool operator==(const ConcurrentTrieIterator& other) const noexcept {
+    if (m_stack.empty() || other.m_stack.empty()) return m_stack.empty() == other.m_stack.empty();
+
+    // the path to any specific node is unique
+    return m_stack.back() == other.m_stack.back();
+  };
+  bool operator!=(const ConcurrentTrieIterator& other) const noexcept { return !(*this == other); }
+};
+} // namespace tree::detail
+
+namespace tree {
+
+export template <typename Seq>
+  requires detail::RadixSequence<Seq>
+class ConcurrentTrie {
+  template <typename> friend class detail::ConcurrentTrieIterator;
+
+public:
+  using value_type = Seq;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using const_iterator = detail::ConcurrentTrieIterator<ConcurrentTrie>;
+  using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+  using view_type = std::conditional_t<
+      std::is_same_v<Seq, std::string>, std::string_view, std::span<const std::ranges::range_value_t<Seq>>>;
+  // path buffers (iterators, writers' paths, non-contiguous keys) stay off the heap up to this length
+  static constexpr size_t inlinePathLength = 32;
+
+  class Batch;
+  class Snapshot;
+
+private:
+  using Element = std::ranges::range_value_t<Seq>;
+  using Key = std::span<const Element>;
+  using PathBuffer = array::SmallArray<Element, inlinePathLength>;
+
+  // followed by Node* children[childCapacity] and Element keys[childCapacity]
+  struct Node {
+    size_t wordCount = 0; // words in the subtree, the node's own included
+    uint64_t version = 0; // the batch that created the node, only writers look at it
+    uint32_t childCount = 0;
+    uint32_t childCapacity = 0;
+    bool endOfWord = false;
+  };
+
+  static constexpr size_t alignUp(size_t n, size_t alignment) noexcept {
+    return (n + alignment - 1) / alignment * alignment;
+  }
+  static constexpr size_t childrenOffset = alignUp(sizeof(Node), alignof(Node*));
+  static constexpr size_t nodeAlignment = std::max({alignof(Node), alignof(Node*), alignof(Element)});
+
+  static constexpr size_t keysOffset(size_t capacity) noexcept {
+    return alignUp(childrenOffset + (capacity * sizeof(Node*)), alignof(Element));
+  }
+  static constexpr size_t nodeBytes(size_t capacity) noexcept {
+    return keysOffset(capacity) + (capacity * sizeof(Element));
+  }
+
+  // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+  static Node** children(Node* node) noexcept {
+    return reinterpret_cast<Node**>(reinterpret_cast<std::byte*>(node) + childrenOffset);
+  }
+  static const Node* const* children(const Node* node) noexcept {
+    return reinterpret_cast<const Node* const*>(reinterpret_cast<const std::byte*>(node) + childrenOffset);
+  }
+  static Element* keys(Node* node) noexcept {
+    return reinterpret_cast<Element*>(reinterpret_cast<std::byte*>(node) + keysOffset(node->childCapacity));
+  }
+  static const Element* keys(const Node* node) noexcept {
+    return reinterpret_cast<const Element*>(
+        reinterpret_cast<const std::byte*>(node) + keysOffset(node->childCapacity)
+    );
+  }
+  // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+
+  // index of the child under e, or where it would be inserted
+  static uint32_t childIndex(const Node* node, const Element& e) noexcept {
+    const Element* first = keys(node);
+    return static_cast<uint32_t>(std::lower_bound(first, first + node->childCount, e) - first);
+  }
+
+  static const Node* findChild(const Node* node, const Element& e) noexcept {
+    uint32_t idx = childIndex(node, e);
+    if (idx == node->childCount || !(keys(node)[idx] == e)) return nullptr;
+    return children(node)[idx];
+  }
+
+  static const Node* descend(const Node* node, Key key) noexcept {
+    for (const Element& e : key) {
+      node = findChild(node, e);
+      if (node == nullptr) return nullptr;
+    }
+    return node;
+  }
+
+  template <typename Fn> static decltype(auto) withKey(const value_type& seq, Fn&& fn) {
+    if constexpr (std::ranges::contiguous_range<const value_type>) {
+      return std::forward<Fn>(fn)(Key{std::ranges::data(seq), std::ranges::size(seq)});
+    } else {
+      PathBuffer buffer(std::ranges::begin(seq), std::ranges::end(seq));
+      return std::forward<Fn>(fn)(Key{buffer.data(), buffer.size()});
+    }
+  }
+
+  static void collectSeq(const Node* node, PathBuffer& path, array::DynamicArray<value_type>& sequences) {
+    if (node->endOfWord) sequences.emplaceBack(path.data(), path.data() + path.size());
+
+    for (uint32_t i = 0; i < node->childCount; ++i) {
+      path.emplaceBack(keys(node)[i]);
+      collectSeq(children(node)[i], path, sequences);
+      path.popBack();
+    }
+  }
+
+  // m_alloc must outlive m_epochs, whose destructor frees the nodes still retired
+  allocator_type m_alloc;
+  mutable concurrency::EpochDomain m_epochs;
+  std::atomic<Node*> m_root;
+
+  // writer state, guarded by m_writeMutex
+  std::mutex m_writeMutex;
+  uint64_t m_version = 0;
+  Node* m_pending = nullptr;            // root of the version the current batch builds
+  array::DynamicArray<Node*> m_replaced; // published nodes the current batch copied
+
+  Node* makeNode(uint32_t capacity) {
+    void* bytes = m_alloc.allocate_bytes(nodeBytes(capacity), nodeAlignment);
+    Node* node = ::new (bytes) Node{};
+    node->version = m_version;
+    node->childCapacity = capacity;
+    return node;
+  }
+
+  void freeNode(Node* node) noexcept {
+    size_t bytes = nodeBytes(node->childCapacity);
+    node->~Node();
+    m_alloc.deallocate_bytes(node, bytes, nodeAlignment);
+  }
+
+  void destroy(Node* node) noexcept {
+    for (uint32_t i = 0; i < node->childCount; ++i) destroy(children(node)[i]);
+    freeNode(node);
+  }
+
+  // a copy of node with room for capacity children, the copy belongs to the current batch
+  Node* copyNode(Node* node, uint32_t capacity) {
+    Node* copy = makeNode(capacity);
+    copy->wordCount = node->wordCount;
+    copy->childCount = node->childCount;
+    copy->endOfWord = node->endOfWord;
+    std::copy_n(children(node), node->childCount, children(copy));
+    std::copy_n(keys(node), node->childCount, keys(copy));
+    return copy;
+  }
+
+  // the node at *link, copied first unless the current batch created it
+  Node* writable(Node** link) {
+    Node* node = *link;
+    if (node->version == m_version) return node;
+    m_replaced.pushBack(node);
+    Node* copy = copyNode(node, node->childCount);
+    *link = copy;
+    return copy;
+  }
+
+  // the node at *link with room for one more child
+  Node* withRoom(Node** link) {
+    Node* node = *link;
+    if (node->childCount < node->childCapacity) return node;
+    Node* grown = copyNode(node, node->childCapacity == 0 ? 2 : node->childCapacity * 2);
+    // node belongs to the current batch, no reader has seen it
+    freeNode(node);
+    *link = grown;
+    return grown;
+  }
+
+  bool insertPending(Key key) {
+    const Node* existing = descend(m_pending, key);
+    if (existing != nullptr && existing->endOfWord) return false;
+
+    Node** link = &m_pending;
+    Node* node = writable(link);
+    ++node->wordCount;
+    for (const Element& e : key) {
+      uint32_t idx = childIndex(node, e);
+      if (idx == node->childCount || !(keys(node)[idx] == e)) {
+        node = withRoom(link);
+        Node* child = makeNode(0);
+        Node** nodeChildren = children(node);
+        Element* nodeKeys = keys(node);
+        uint32_t count = node->childCount;
+        std::copy_backward(nodeChildren + idx, nodeChildren + count, nodeChildren + count + 1);
+        std::copy_backward(nodeKeys + idx, nodeKeys + count, nodeKeys + count + 1);
+        nodeChildren[idx] = child;
+        nodeKeys[idx] = e;
+        ++node->childCount;
+      }
+      link = &children(node)[idx];
+      node = writable(link);
+      ++node->wordCount;
+    }
+    node->endOfWord = true;
+    return true;
+  }
+
+  bool erasePending(Key key) {
+    const Node* existing = descend(m_pending, key);
+    if (existing == nullptr || !existing->endOfWord) return false;
+
+    array::SmallArray<Node**, inlinePathLength + 1> links;
+    links.emplaceBack(&m_pending);
+    Node* node = writable(&m_pending);
+    --node->wordCount;
+    for (const Element& e : key) {
+      Node** link = &children(node)[childIndex(node, e)];
+      links.emplaceBack(link);
+      node = writable(link);
+      --node->wordCount;
+    }
+    node->endOfWord = false;
+
+    // nodes left without words have no children either, unlink them bottom up
+    for (size_t i = links.size() - 1; i > 0 && (*links[i])->wordCount == 0; --i) {
+      Node* parent = *links[i - 1];
+      Node** parentChildren = children(parent);
+      Element* parentKeys = keys(parent);
+      size_t idx = static_cast<size_t>(links[i] - parentChildren);
+      freeNode(*links[i]);
+      std::copy(parentChildren + idx + 1, parentChildren + parent->childCount, parentChildren + idx);
+      std::copy(parentKeys + idx + 1, parentKeys + parent->childCount, parentKeys + idx);
+      --parent->childCount;
+    }
+    return true;
+  }
+
+  // frees the nodes an abandoned batch created, the published nodes below them stay
+  void discard(Node* node) noexcept {
+    if (node->version != m_version) return;
+    for (uint32_t i = 0; i < node->childCount; ++i) discard(children(node)[i]);
+    freeNode(node);
+  }
+
+  // runs fn on a new version under the write lock and publishes it, or publishes nothing if fn throws
+  template <typename Fn> auto write(Fn&& fn) {
+    std::lock_guard lock(m_writeMutex);
+    ++m_version;
+    m_pending = m_root.load(std::memory_order_relaxed);
+    std::function<void()> retirement;
+    auto result = [&] {
+      try {
+        auto result = std::forward<Fn>(fn)();
+        // everything publish() allocates is allocated here, once the new root is out nothing may fail
+        if (!m_replaced.empty()) {
+          m_epochs.reserve(1);
+          retirement = [this, nodes = std::move(m_replaced)] {
+            for (Node* node : nodes) freeNode(node);
+          };
+        }
+        return result;
+      } catch (...) {
+        discard(m_pending);
+        m_replaced.clear();
+        throw;
+      }
+    }();
+    publish(std::move(retirement));
+    return result;
+  }
+
+  void publish(std::function<void()> retirement) noexcept {
+    m_root.store(m_pending, std::memory_order_release);
+    // can't throw, write() reserved the slot
+    if (retirement) m_epochs.retire(std::move(retirement));
+    try {
+      m_epochs.reclaim();
+    } catch (const std::bad_alloc&) {
+      // the batch is published, the retired nodes are reclaimed by a later write or the destructor
+    }
+  }
+
+public:
+  ConcurrentTrie(allocator_type alloc = {}) : m_alloc(alloc) { m_root.store(makeNode(0)); }
+
+  ConcurrentTrie(const ConcurrentTrie&) = delete;
+  ConcurrentTrie& operator=(const ConcurrentTrie&) = delete;
+  ConcurrentTrie(ConcurrentTrie&&) = delete;
+  ConcurrentTrie& operator=(ConcurrentTrie&&) = delete;
+
+  // no reader or writer may be left
+  ~ConcurrentTrie() noexcept { destroy(m_root.load()); }
+
+  // inserts seq, returns whether it was new
+  bool insert(const value_type& seq) {
+    return withKey(seq, [&](Key key) { return write([&] { return insertPending(key); }); });
+  }
+
+  // removes seq, returns whether it was there
+  bool erase(const value_type& seq) {
+    return withKey(seq, [&](Key key) { return write([&] { return erasePending(key); }); });
+  }
+
+  /**
+   * @brief Applies a batch in order as one new version, readers see all of it or none of it.
+   * @return The number of inserts and erases that changed the trie.
+   */
+  size_t apply(const Batch& batch);
+
+  // pins the current version, lookups through the snapshot don't see later batches
+  [[nodiscard]] Snapshot snapshot() const;
+
+  [[nodiscard]] bool search(const value_type& seq) const;
+  [[nodiscard]] bool startsWith(const value_type& seq) const;
+  [[nodiscard]] size_type countWithPrefix(const value_type& prefix) const;
+  [[nodiscard]] size_type size() const;
+  [[nodiscard]] bool empty() const;
+  [[nodiscard]] array::DynamicArray<value_type> getAllWithPrefix(const value_type& prefix) const;
+
+  [[nodiscard]] allocator_type getAllocator() const noexcept { return m_alloc; }
+};
+
+// inserts and erases, applied in the order they were added
+template <typename Seq>
+  requires detail::RadixSequence<Seq>
+class ConcurrentTrie<Seq>::Batch {
+  friend class ConcurrentTrie;
+
+  struct Operation {
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    value_type seq;
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    bool erase;
+  };
+
+  array::DynamicArray<Operation> m_operations;
+
+public:
+  Batch& insert(value_type seq) & {
+    m_operations.emplaceBack(std::move(seq), false);
+    return *this;
+  }
+  Batch&& insert(value_type seq) && { return std::move(insert(std::move(seq))); }
+
+  Batch& erase(value_type seq) & {
+    m_operations.emplaceBack(std::move(seq), true);
+    return *this;
+  }
+  Batch&& erase(value_type seq) && { return std::move(erase(std::move(seq))); }
+
+  [[nodiscard]] size_t size() const noexcept { return m_operations.size(); }
+  [[nodiscard]] bool empty() const noexcept { return m_operations.empty(); }
+  void clear() noexcept { m_operations.clear(); }
+};
+
+// one published version, kept alive (not locked) for as long as the snapshot lives
+template <typename Seq>
+  requires detail::RadixSequence<Seq>
+class ConcurrentTrie<Seq>::Snapshot {
+  concurrency::EpochDomain::Guard m_guard;
+  const Node* m_root;
+
+public:
+  Snapshot(concurrency::EpochDomain::Guard guard, const Node* root) noexcept
+      : m_guard(std::move(guard)), m_root(root) {}
+
+  [[nodiscard]] bool search(const value_type& seq) const {
+    return withKey(seq, [&](Key key) {
+      const Node* node = descend(m_root, key);
+      return node != nullptr && node->endOfWord;
+    });
+  }
+
+  [[nodiscard]] bool startsWith(const value_type& seq) const {
+    return withKey(seq, [&](Key key) { return descend(m_root, key) != nullptr; });
+  }
+
+  [[nodiscard]] size_type countWithPrefix(const value_type& prefix) const {
+    return withKey(prefix, [&](Key key) {
+      const Node* node = descend(m_root, key);
+      return node == nullptr ? 0 : node->wordCount;
+    });
+  }
+
+  [[nodiscard]] size_type size() const noexcept { return m_root->wordCount; }
+
+  [[nodiscard]] bool empty() const noexcept { return m_root->wordCount == 0; }
+
+  [[nodiscard]] array::DynamicArray<value_type> getAllWithPrefix(const value_type& prefix) const {
+    array::DynamicArray<value_type> sequences;
+    withKey(prefix, [&](Key key) {
+      const Node* node = descend(m_root, key);
+      if (node == nullptr) return;
+      sequences.reserve(node->wordCount);
+      PathBuffer path(key.begin(), key.end());
+      collectSeq(node, path, sequences);
+    });
+    return sequences;
+  }
+
+  [[nodiscard]] const_iterator begin() const { return {m_root, {}}; }
+  [[nodiscard]] const_iterator end() const noexcept { return {}; }
+};
+
+template <typename Seq>
+  requires detail::RadixSequence<Seq>
+size_t ConcurrentTrie<Seq>::apply(const Batch& batch) {
+  if (batch.empty()) return 0;
+  return write([&] {
+    size_t changed = 0;
+    for (const auto& [seq, erase] : batch.m_operations) {
+      bool done = withKey(seq, [&](Key key) { return erase ? erasePending(key) : insertPending(key); });
+      changed += done ? 1 : 0;
+    }
+    return changed;
+  });
+}
+
+template <typename Seq>
+  requires detail::RadixSequence<Seq>
+typename ConcurrentTrie<Seq>::Snapshot ConcurrentTrie<Seq>::snapshot() const {
+  concurrency::EpochDomain::Guard guard = m_epochs.pin();
+  // the load must come after pinning, or the version could be retired before the pin is visible
+  const Node* root = m_root.load(std::memory_order_acquire);
+  return Snapshot{std::move(guard), root};
+}
+
+template <typename Seq>
+  requires detail::RadixSequence<Seq>
+bool ConcurrentTrie<Seq>::search(const value_type& seq) const {
+  return snapshot().search(seq);
+}
+
+template <typename Seq>
+  requires detail::RadixSequence<Seq>
+bool ConcurrentTrie<Seq>::startsWith(const value_type& seq) const {
+  return snapshot().startsWith(seq);
+}
+
+template <typename Seq>
+  requires detail::RadixSequence<Seq>
+size_t ConcurrentTrie<Seq>::countWithPrefix(const value_type& prefix) const {
+  return snapshot().countWithPrefix(prefix);
+}
+
+template <typename Seq>
+  requires detail::RadixSequence<Seq>
+size_t ConcurrentTrie<Seq>::size() const {
+  return snapshot().size();
+}
+
+template <typename Seq>
+  requires detail::RadixSequence<Seq>
+bool ConcurrentTrie<Seq>::empty() const {
+  return snapshot().empty();
+}
+
+template <typename Seq>
+  requires detail::RadixSequence<Seq>
+array::DynamicArray<Seq> ConcurrentTrie<Seq>::getAllWithPrefix(const value_type& prefix) const {
+  return snapshot().getAllWithPrefix(prefix);
+}
+
+} // namespace tree
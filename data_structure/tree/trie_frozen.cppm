@@ -0,0 +1,419 @@
+module;
+#include "../array/dynamic_array.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifndef DSA_HAS_MMAP
+#define DSA_HAS_MMAP 1
+#endif
+#endif
+export module trie:frozen;
+
+/*
+ * FrozenTrie is an immutable snapshot of a byte-keyed trie (Trie<std::string>, ArtTrie, RadixTrie, or any
+ * range of strings) stored as a double array, so it can be written to disk once and queried straight from
+ * an mmap with no deserialization:
+ *   auto frozen = tree::FrozenTrie::build(trie);
+ *   frozen.save("words.dat");
+ *   ...
+ *   auto words = tree::FrozenTrie::open("words.dat"); // read-only shared mapping, no parsing
+ *
+ * Image layout, native byte order (checked on open):
+ *   Header { magic "DSATRIE1", byte order mark, unit count, key count }
+ *   Unit[unitCount] { base, check }
+ * State 0 is the root. The child of state s for byte c is t = base(s) + c + 1, and it exists iff
+ * check[t] == s + 1 (so a check of 0 marks a free unit). The top bit of base marks the end of a word, and
+ * a base of 0 marks a state without children. Children are scanned in byte order, so prefix iteration
+ * yields keys in lexicographic (unsigned) order.
+ * */
+
+namespace tree::detail {
+// a key set over bytes: a Trie<std::string>, ArtTrie, RadixTrie, a range of strings, ...
+template <typename Keys>
+concept ByteKeys = requires(const Keys& keys) {
+  { *std::begin(keys) } -> std::convertible_to<std::string_view>;
+  std::end(keys);
+};
+
+template <ByteKeys Keys> array::DynamicArray<std::string> sortedUniqueKeys(const Keys& keys) {
+  array::DynamicArray<std::string> sorted;
+  for (std::string_view key : keys) sorted.emplaceBack(key);
+  std::sort(sorted.begin(), sorted.end());
+  auto last = std::unique(sorted.begin(), sorted.end());
+  sorted.erase(last, sorted.end());
+  return sorted;
+}
+} // namespace tree::detail
+
+namespace tree {
+
+export class FrozenTrie {
+public:
+  using size_type = size_t;
+
+private:
+  struct Header {
+    std::array<char, 8> magic;
+    uint32_t byteOrder;
+    uint32_t unitCount;
+    uint64_t keyCount;
+  };
+
+  struct Unit {
+    uint32_t base;
+    uint32_t check;
+  };
+
+  static constexpr std::array<char, 8> magic{'D', 'S', 'A', 'T', 'R', 'I', 'E', '1'};
+  static constexpr uint32_t byteOrderMark = 0x01020304;
+  static constexpr uint32_t terminalBit = uint32_t{1} << 31;
+  static constexpr uint32_t npos = ~uint32_t{0};
+  static constexpr size_t alphabetSize = 256;
+
+  static_assert(sizeof(Header) % alignof(Unit) == 0);
+
+  // exactly one of these owns the image, or neither if it is borrowed
+  std::unique_ptr<std::byte[]> m_buffer;
+  void* m_mapping = nullptr;
+  size_t m_mappingLength = 0;
+
+  std::span<const std::byte> m_image;
+  const Unit* m_units = nullptr;
+  uint32_t m_unitCount = 0;
+  size_type m_size = 0;
+
+  // double array under construction
+  class Builder {
+    array::DynamicArray<Unit> m_units;
+    size_t m_firstFree = 1; // where the search for free units starts
+
+    void ensure(size_t count) {
+      if (count > terminalBit) throw std::length_error("FrozenTrie image is too large");
+      if (m_units.size() < count) m_units.resize(count);
+    }
+
+    [[nodiscard]] bool isFree(size_t unit) const noexcept {
+      return unit >= m_units.size() || m_units[unit].check == 0;
+    }
+
+    // the first base from m_firstFree on that puts every child code on a free unit
+    size_t findBase(std::span<const uint32_t> codes) {
+      size_t occupied = 0;
+      for (size_t pos = m_firstFree;; ++pos) {
+        if (!isFree(pos)) {
+          ++occupied;
+          continue;
+        }
+        // base 0 is reserved for states without children
+        if (pos <= codes.front()) continue;
+        size_t base = pos - codes.front();
+        if (std::all_of(codes.begin() + 1, codes.end(), [&](uint32_t code) { return isFree(base + code); })) {
+          // the holes left behind in an almost full stretch are given up on, otherwise every wide node
+          // rescans them and building gets quadratic
+          if (occupied * 20 >= (pos - m_firstFree + 1) * 19) m_firstFree = pos;
+          return base;
+        }
+      }
+    }
+
+    // keys[first, last) are sorted, unique and share their first `depth` bytes, which spell the path to state
+    struct Pending {
+      size_t first;
+      size_t last;
+      size_t depth;
+      uint32_t state;
+    };
+
+    // depth first with an explicit stack, keys can be far longer than the call stack is deep
+    void insert(std::span<const std::string> keys) {
+      std::array<uint32_t, alphabetSize> codes{};
+      std::array<size_t, alphabetSize + 1> groups{};
+      array::DynamicArray<Pending> pending;
+      pending.pushBack({0, keys.size(), 0, 0});
+      while (!pending.empty()) {
+        auto [first, last, depth, state] = pending.back();
+        pending.popBack();
+        if (keys[first].size() == depth) {
+          // sorted, so the key ending here comes first
+          m_units[state].base |= terminalBit;
+          ++first;
+        }
+        if (first == last) continue;
+
+        size_t count = 0;
+        for (size_t i = first; i < last; ++i) {
+          uint32_t code = static_cast<unsigned char>(keys[i][depth]) + 1U;
+          if (count == 0 || codes[count - 1] != code) {
+            codes[count] = code;
+            groups[count++] = i;
+          }
+        }
+        groups[count] = last;
+
+        std::span<const uint32_t> childCodes(codes.data(), count);
+        size_t base = findBase(childCodes);
+        ensure(base + childCodes.back() + 1);
+        m_units[state].base |= static_cast<uint32_t>(base);
+        for (uint32_t code : childCodes) m_units[base + code].check = state + 1;
+        while (!isFree(m_firstFree)) ++m_firstFree;
+
+        // pushed in reverse, so the children are laid out in byte order like a recursive build would
+        for (size_t i = count; i-- > 0;) {
+          pending.pushBack({groups[i], groups[i + 1], depth + 1, static_cast<uint32_t>(base + codes[i])});
+        }
+      }
+    }
+
+  public:
+    std::unique_ptr<std::byte[]> build(std::span<const std::string> keys, size_t& imageSize) {
+      ensure(1);
+      m_units[0].check = 0;
+      if (!keys.empty()) insert(keys);
+
+      Header header{magic, byteOrderMark, static_cast<uint32_t>(m_units.size()), keys.size()};
+      imageSize = sizeof(Header) + (m_units.size() * sizeof(Unit));
+      auto image = std::make_unique_for_overwrite<std::byte[]>(imageSize);
+      std::memcpy(image.get(), &header, sizeof(Header));
+      std::memcpy(image.get() + sizeof(Header), m_units.data(), m_units.size() * sizeof(Unit));
+      return image;
+    }
+  };
+
+  void attach(std::span<const std::byte> image) {
+    Header header{};
+    if (image.size() < sizeof(Header)) throw std::invalid_argument("FrozenTrie image is truncated");
+    std::memcpy(&header, image.data(), sizeof(Header));
+    if (header.magic != magic) throw std::invalid_argument("Not a FrozenTrie image");
+    if (header.byteOrder != byteOrderMark) {
+      throw std::invalid_argument("FrozenTrie image has another byte order");
+    }
+    if (header.unitCount == 0 || image.size() < sizeof(Header) + (size_t{header.unitCount} * sizeof(Unit))) {
+      throw std::invalid_argument("FrozenTrie image is truncated");
+    }
+    if (reinterpret_cast<uintptr_t>(image.data()) % alignof(Unit) != 0) {
+      throw std::invalid_argument("FrozenTrie image is misaligned");
+    }
+
+    m_image = image;
+    m_units = reinterpret_cast<const Unit*>(image.data() + sizeof(Header));
+    m_unitCount = header.unitCount;
+    m_size = header.keyCount;
+  }
+
+  void release() noexcept {
+#ifdef DSA_HAS_MMAP
+    if (m_mapping != nullptr) ::munmap(m_mapping, m_mappingLength);
+#endif
+    m_mapping = nullptr;
+    m_mappingLength = 0;
+    m_buffer.reset();
+    m_image = {};
+    m_units = nullptr;
+    m_unitCount = 0;
+    m_size = 0;
+  }
+
+  [[nodiscard]] uint32_t child(uint32_t state, unsigned char c) const noexcept {
+    size_t next = size_t{m_units[state].base & ~terminalBit} + c + 1;
+    if (next >= m_unitCount || m_units[next].check != state + 1) return npos;
+    return static_cast<uint32_t>(next);
+  }
+
+  [[nodiscard]] bool isTerminal(uint32_t state) const noexcept {
+    return (m_units[state].base & terminalBit) != 0;
+  }
+
+  [[nodiscard]] uint32_t walk(std::string_view seq) const noexcept {
+    if (m_units == nullptr) return npos;
+    uint32_t state = 0;
+    for (char c : seq) {
+      state = child(state, static_cast<unsigned char>(c));
+      if (state == npos) return npos;
+    }
+    return state;
+  }
+
+  // the units state's children can occupy, a state without children gets an empty range
+  struct Siblings {
+    uint32_t state;
+    size_t first; // the unit of byte 0
+    size_t next;
+    size_t end;
+  };
+
+  [[nodiscard]] Siblings siblings(uint32_t state) const noexcept {
+    size_t base = m_units[state].base & ~terminalBit;
+    if (base == 0) return {state, 1, 1, 1};
+    return {state, base + 1, base + 1, std::min<size_t>(base + 1 + alphabetSize, m_unitCount)};
+  }
+
+  // depth first with an explicit stack, only the units owned by a state are looked at for its children
+  template <typename Fn> void visit(uint32_t state, std::string& path, Fn& fn) const {
+    if (isTerminal(state)) fn(std::string_view{path});
+    array::DynamicArray<Siblings> stack;
+    stack.pushBack(siblings(state));
+    while (!stack.empty()) {
+      Siblings& top = stack.back();
+      uint32_t owner = top.state + 1;
+      while (top.next < top.end && m_units[top.next].check != owner) ++top.next;
+      if (top.next == top.end) {
+        stack.popBack();
+        if (!stack.empty()) path.pop_back();
+        continue;
+      }
+      auto next = static_cast<uint32_t>(top.next++);
+      path.push_back(static_cast<char>(next - top.first));
+      if (isTerminal(next)) fn(std::string_view{path});
+      stack.pushBack(siblings(next));
+    }
+  }
+
+public:
+  FrozenTrie() = default;
+
+  /**
+   * @brief Freezes a key set, typically a built Trie. Duplicates are ignored.
+   * @param keys Any range whose elements convert to std::string_view, e.g. a Trie<std::string>.
+   */
+  template <detail::ByteKeys Keys> static FrozenTrie build(const Keys& keys) {
+    array::DynamicArray<std::string> sorted = detail::sortedUniqueKeys(keys);
+
+    FrozenTrie frozen;
+    size_t imageSize = 0;
+    frozen.m_buffer = Builder{}.build({sorted.data(), sorted.size()}, imageSize);
+    frozen.attach({frozen.m_buffer.get(), imageSize});
+    return frozen;
+  }
+
+  // queries an image owned by someone else (a mapping, a section of a larger file, ...), no copy is made
+  static FrozenTrie view(std::span<const std::byte> image) {
+    FrozenTrie frozen;
+    frozen.attach(image);
+    return frozen;
+  }
+
+  // maps an image written by save(). The mapping is read-only and shared, so the page cache backs every
+  // process that opens the same file
+  static FrozenTrie open(const std::string& path) {
+    FrozenTrie frozen;
+#ifdef DSA_HAS_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw std::system_error(errno, std::generic_category(), "Can't open " + path);
+
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+      int error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::generic_category(), "Can't stat " + path);
+    }
+    auto length = static_cast<size_t>(info.st_size);
+    void* mapping = length == 0 ? MAP_FAILED : ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    int error = errno;
+    ::close(fd);
+    if (length == 0) throw std::invalid_argument("FrozenTrie image is truncated");
+    if (mapping == MAP_FAILED) throw std::system_error(error, std::generic_category(), "Can't map " + path);
+
+    frozen.m_mapping = mapping;
+    frozen.m_mappingLength = length;
+    frozen.attach({static_cast<const std::byte*>(mapping), length});
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) throw std::runtime_error("Can't open " + path);
+    auto length = static_cast<size_t>(in.tellg());
+    frozen.m_buffer = std::make_unique_for_overwrite<std::byte[]>(length);
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(frozen.m_buffer.get()), static_cast<std::streamsize>(length));
+    frozen.attach({frozen.m_buffer.get(), length});
+#endif
+    return frozen;
+  }
+
+  FrozenTrie(const FrozenTrie&) = delete;
+  FrozenTrie& operator=(const FrozenTrie&) = delete;
+
+  FrozenTrie(FrozenTrie&& other) noexcept
+      : m_buffer(std::move(other.m_buffer)), m_mapping(std::exchange(other.m_mapping, nullptr)),
+        m_mappingLength(std::exchange(other.m_mappingLength, 0)), m_image(std::exchange(other.m_image, {})),
+        m_units(std::exchange(other.m_units, nullptr)), m_unitCount(std::exchange(other.m_unitCount, 0)),
+        m_size(std::exchange(other.m_size, 0)) {}
+
+  FrozenTrie& operator=(FrozenTrie&& other) noexcept {
+    if (this == &other) return *this;
+    FrozenTrie moved(std::move(other));
+    swap(moved);
+    return *this;
+  }
+
+  ~FrozenTrie() noexcept { release(); }
+
+  void save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(m_image.data()), static_cast<std::streamsize>(m_image.size()));
+    if (!out) throw std::runtime_error("Can't write " + path);
+  }
+
+  // the raw image, what save() writes
+  [[nodiscard]] std::span<const std::byte> image() const noexcept { return m_image; }
+
+  [[nodiscard]] bool search(std::string_view seq) const noexcept {
+    uint32_t state = walk(seq);
+    return state != npos && isTerminal(state);
+  }
+
+  [[nodiscard]] bool startsWith(std::string_view prefix) const noexcept { return walk(prefix) != npos; }
+
+  [[nodiscard]] size_type size() const noexcept { return m_size; }
+
+  [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+
+  // calls fn(std::string_view) for every key starting with prefix, in lexicographic order
+  template <std::invocable<std::string_view> Fn>
+  void forEachWithPrefix(std::string_view prefix, Fn fn) const {
+    uint32_t state = walk(prefix);
+    if (state == npos) return;
+    std::string path(prefix);
+    visit(state, path, fn);
+  }
+
+  [[nodiscard]] array::DynamicArray<std::string> getAllWithPrefix(std::string_view prefix) const {
+    array::DynamicArray<std::string> sequences;
+    forEachWithPrefix(prefix, [&](std::string_view seq) { sequences.emplaceBack(seq); });
+    return sequences;
+  }
+
+  void swap(FrozenTrie& other) noexcept {
+    using std::swap;
+    swap(m_buffer, other.m_buffer);
+    swap(m_mapping, other.m_mapping);
+    swap(m_mappingLength, other.m_mappingLength);
+    swap(m_image, other.m_image);
+    swap(m_units, other.m_units);
+    swap(m_unitCount, other.m_unitCount);
+    swap(m_size, other.m_size);
+  }
+
+  // for ADL
+  friend void swap(FrozenTrie& a, FrozenTrie& b) noexcept { a.swap(b); }
+};
+
+} // namespace tree
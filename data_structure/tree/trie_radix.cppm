@@ -0,0 +1,531 @@
+module;
+#include "../array/dynamic_array.hpp"
+#include "../array/small_array.hpp"
+#include "../queue/deque.hpp"
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory_resource>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+export module trie:radix;
+
+/*
+ * RadixTrie is a path-compressed (Patricia / radix) trie. A chain of nodes with a single child collapses
+ * into one edge whose label is a span of elements, so a key set like URLs or file paths, with long shared
+ * prefixes and long unique suffixes, needs roughly one node per key instead of one per element.
+ *
+ *   - Every node stores the label of the edge leading into it; the root's label is empty.
+ *   - Children are kept sorted by the first element of their label, which is unique among siblings.
+ *   - insert splits an edge where the key diverges from its label, erase merges a node that is left with
+ *     a single child and no word ending into that child, so the tree stays fully compressed.
+ *   - Labels are compared with memcmp when the element type has unique object representations (char,
+ *     integers, ...), and with std::equal otherwise.
+ *
+ * Labels, child tables and nodes all come from the trie's pmr allocator. Elements are copied in and out
+ * of labels bytewise, so they must be trivially copyable.
+ * */
+
+namespace tree::detail {
+template <typename Seq>
+concept RadixSequence =
+    std::ranges::forward_range<Seq> && std::ranges::sized_range<Seq> &&
+    std::is_trivially_copyable_v<std::ranges::range_value_t<Seq>> &&
+    std::totally_ordered<std::ranges::range_value_t<Seq>> &&
+    std::constructible_from<
+        Seq, const std::ranges::range_value_t<Seq>*, const std::ranges::range_value_t<Seq>*>;
+
+template <bool IsConst, typename ParentTrie> class RadixTrieIterator {
+  // for conversion constructor
+  template <bool, typename> friend class RadixTrieIterator;
+
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = ParentTrie::value_type;
+  using difference_type = ParentTrie::difference_type;
+  using pointer = void;
+  using view_type = ParentTrie::view_type;
+  using reference = view_type;
+
+private:
+  using Node = ParentTrie::Node;
+  using Element = ParentTrie::Element;
+
+  struct StackFrame {
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    const Node* node;
+    // NOLINTNEXTLINE(misc-non-private-member-variables-in-classes)
+    size_t next; // index of the next child to visit
+    constexpr bool operator==(const StackFrame& other) const noexcept = default;
+  };
+
+  queue::Deque<StackFrame> m_stack;
+  array::SmallArray<Element, ParentTrie::inlinePathLength> m_path;
+
+public:
+  RadixTrieIterator() = default;
+
+  RadixTrieIterator(const Node* root) {
+    if (root != nullptr) {
+      m_stack.emplaceBack(root, 0);
+      if (!root->endOfWord) ++(*this);
+    }
+  }
+
+  // conversion constructor
+  RadixTrieIterator(const RadixTrieIterator<false, ParentTrie>& other)
+    requires IsConst
+      : m_stack(other.m_stack), m_path(other.m_path) {}
+
+  reference operator*() const { return reference{m_path.data(), m_path.size()}; }
+
+  RadixTrieIterator& operator++() {
+    while (!m_stack.empty()) {
+      auto& [node, next] = m_stack.back();
+
+      if (next < node->childCount) {
+        const Node* child = node->children[next++];
+        m_stack.emplaceBack(child, 0);
+        for (size_t i = 0; i < child->labelLength; ++i) m_path.emplaceBack(child->label[i]);
+        if (child->endOfWord) return *this;
+      } else {
+        m_path.resize(m_path.size() - node->labelLength);
+        m_stack.popBack();
+      }
+    }
+    return *this;
+  }
+
+  RadixTrieIterator operator++(int) {
+    RadixTrieIterator snapshot = *this;
+    ++(*this);
+    return snapshot;
+  }
+
+  bool operator==(const RadixTrieIterator& other) const noexcept {
+    if (m_stack.empty() || other.m_stack.empty()) return m_stack.empty() == other.m_stack.empty();
+
+    // the path to any specific node is unique
+    return m_stack.back() == other.m_stack.back();
+  };
+  bool operator!=(const RadixTrieIterator& other) const noexcept { return !(*this == other); }
+};
+} // namespace tree::detail
+
+namespace tree {
+
+export template <typename Seq>
+  requires detail::RadixSequence<Seq>
+class RadixTrie {
+  template <bool, typename> friend class detail::RadixTrieIterator;
+
+public:
+  using value_type = Seq;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using reference = value_type;
+  using const_reference = value_type;
+  using pointer = void;
+  using const_pointer = void;
+  using iterator = detail::RadixTrieIterator<false, RadixTrie>;
+  using const_iterator = detail::RadixTrieIterator<true, RadixTrie>;
+  using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+  using view_type = std::conditional_t<
+      std::is_same_v<Seq, std::string>, std::string_view, std::span<const std::ranges::range_value_t<Seq>>>;
+  // path buffers (iterators, prefix collection, non-contiguous keys) stay off the heap up to this length
+  static constexpr size_t inlinePathLength = 32;
+
+private:
+  using Element = std::ranges::range_value_t<Seq>;
+  using Key = std::span<const Element>;
+  using PathBuffer = array::SmallArray<Element, inlinePathLength>;
+
+  struct Node {
+    Element* label = nullptr;
+    Node** children = nullptr;
+    uint32_t labelLength = 0;
+    uint32_t childCount = 0;
+    uint32_t childCapacity = 0;
+    bool endOfWord = false;
+  };
+
+  allocator_type m_alloc;
+  Node* m_root = nullptr;
+  size_type m_size = 0;
+
+  static bool labelEquals(const Element* label, const Element* key, size_t length) noexcept {
+    if constexpr (std::has_unique_object_representations_v<Element>) {
+      return length == 0 || std::memcmp(label, key, length * sizeof(Element)) == 0;
+    } else {
+      return std::equal(label, label + length, key);
+    }
+  }
+
+  // length of the common prefix of node's label and key
+  static size_t commonPrefix(const Node* node, Key key) noexcept {
+    size_t limit = std::min<size_t>(node->labelLength, key.size());
+    // most keys match the whole label, which a single memcmp confirms
+    if (labelEquals(node->label, key.data(), limit)) return limit;
+    const Element* diverge = std::mismatch(node->label, node->label + limit, key.data()).first;
+    return static_cast<size_t>(diverge - node->label);
+  }
+
+  // index of the child whose label starts with e, or where it would be inserted
+  static size_t childIndex(const Node* node, const Element& e) noexcept {
+    const Node* const* first = node->children;
+    const Node* const* last = node->children + node->childCount;
+    auto it = std::lower_bound(first, last, e, [](const Node* child, const Element& value) {
+      return child->label[0] < value;
+    });
+    return static_cast<size_t>(it - first);
+  }
+
+  static Node* findChild(const Node* node, const Element& e) noexcept {
+    size_t idx = childIndex(node, e);
+    if (idx == node->childCount || !(node->children[idx]->label[0] == e)) return nullptr;
+    return node->children[idx];
+  }
+
+  template <typename Fn> static decltype(auto) withKey(const value_type& seq, Fn&& fn) {
+    if constexpr (std::ranges::contiguous_range<const value_type>) {
+      return std::forward<Fn>(fn)(Key{std::ranges::data(seq), std::ranges::size(seq)});
+    } else {
+      PathBuffer buffer(std::ranges::begin(seq), std::ranges::end(seq));
+      return std::forward<Fn>(fn)(Key{buffer.data(), buffer.size()});
+    }
+  }
+
+  Node* makeNode(Key label) {
+    Node* node = m_alloc.new_object<Node>();
+    if (label.empty()) return node;
+    try {
+      node->label = m_alloc.allocate_object<Element>(label.size());
+    } catch (...) {
+      m_alloc.delete_object(node);
+      throw;
+    }
+    std::memcpy(node->label, label.data(), label.size() * sizeof(Element));
+    node->labelLength = static_cast<uint32_t>(label.size());
+    return node;
+  }
+
+  void replaceLabel(Node* node, Element* label, size_t length) noexcept {
+    if (node->label != nullptr) m_alloc.deallocate_object(node->label, node->labelLength);
+    node->label = label;
+    node->labelLength = static_cast<uint32_t>(length);
+  }
+
+  void insertChild(Node* node, size_t idx, Node* child) {
+    if (node->childCount == node->childCapacity) {
+      uint32_t capacity = node->childCapacity == 0 ? 2 : node->childCapacity * 2;
+      Node** children = m_alloc.allocate_object<Node*>(capacity);
+      std::copy_n(node->children, node->childCount, children);
+      if (node->children != nullptr) m_alloc.deallocate_object(node->children, node->childCapacity);
+      node->children = children;
+      node->childCapacity = capacity;
+    }
+    std::copy_backward(
+        node->children + idx, node->children + node->childCount, node->children + node->childCount + 1
+    );
+    node->children[idx] = child;
+    ++node->childCount;
+  }
+
+  static void removeChild(Node* node, const Node* child) noexcept {
+    size_t idx = childIndex(node, child->label[0]);
+    std::copy(node->children + idx + 1, node->children + node->childCount, node->children + idx);
+    --node->childCount;
+  }
+
+  void destroy(Node* node) noexcept {
+    for (uint32_t i = 0; i < node->childCount; ++i) destroy(node->children[i]);
+    if (node->children != nullptr) m_alloc.deallocate_object(node->children, node->childCapacity);
+    if (node->label != nullptr) m_alloc.deallocate_object(node->label, node->labelLength);
+    m_alloc.delete_object(node);
+  }
+
+  Node* clone(const Node* other) {
+    Node* node = makeNode({other->label, other->labelLength});
+    node->endOfWord = other->endOfWord;
+    try {
+      for (uint32_t i = 0; i < other->childCount; ++i) insertChild(node, i, clone(other->children[i]));
+    } catch (...) {
+      destroy(node);
+      throw;
+    }
+    return node;
+  }
+
+  // splits the edge into parent->children[idx] after `length` elements, returns the new middle node
+  Node* split(Node* parent, size_t idx, size_t length) {
+    Node* child = parent->children[idx];
+    Node* middle = makeNode({child->label, length});
+    Element* suffix = nullptr;
+    try {
+      suffix = m_alloc.allocate_object<Element>(child->labelLength - length);
+      insertChild(middle, 0, child);
+    } catch (...) {
+      if (suffix != nullptr) m_alloc.deallocate_object(suffix, child->labelLength - length);
+      destroy(middle);
+      throw;
+    }
+    std::memcpy(suffix, child->label + length, (child->labelLength - length) * sizeof(Element));
+    replaceLabel(child, suffix, child->labelLength - length);
+    parent->children[idx] = middle;
+    return middle;
+  }
+
+  // folds the only child of node into it, node's label grows by the child's label
+  void mergeWithChild(Node* node) {
+    Node* child = node->children[0];
+    size_t length = node->labelLength + child->labelLength;
+    Element* label = m_alloc.allocate_object<Element>(length);
+    std::memcpy(label, node->label, node->labelLength * sizeof(Element));
+    std::memcpy(label + node->labelLength, child->label, child->labelLength * sizeof(Element));
+    replaceLabel(node, label, length);
+
+    m_alloc.deallocate_object(node->children, node->childCapacity);
+    node->children = std::exchange(child->children, nullptr);
+    node->childCount = std::exchange(child->childCount, 0);
+    node->childCapacity = std::exchange(child->childCapacity, 0);
+    node->endOfWord = child->endOfWord;
+    destroy(child);
+  }
+
+  // the deepest node whose path is a prefix of key, and how much of key that path covers
+  std::pair<Node*, size_t> descend(Key key) const noexcept {
+    Node* node = m_root;
+    size_t matched = 0;
+    while (matched < key.size()) {
+      Node* child = findChild(node, key[matched]);
+      if (child == nullptr || key.size() - matched < child->labelLength ||
+          !labelEquals(child->label, key.data() + matched, child->labelLength))
+        break;
+      matched += child->labelLength;
+      node = child;
+    }
+    return {node, matched};
+  }
+
+  void collectSeq(const Node* node, PathBuffer& path, array::DynamicArray<value_type>& sequences) const {
+    if (node->endOfWord) sequences.emplaceBack(path.data(), path.data() + path.size());
+
+    for (uint32_t i = 0; i < node->childCount; ++i) {
+      const Node* child = node->children[i];
+      for (uint32_t j = 0; j < child->labelLength; ++j) path.emplaceBack(child->label[j]);
+      collectSeq(child, path, sequences);
+      path.resize(path.size() - child->labelLength);
+    }
+  }
+
+  static size_type countNodes(const Node* node) noexcept {
+    size_type count = 1;
+    for (uint32_t i = 0; i < node->childCount; ++i) count += countNodes(node->children[i]);
+    return count;
+  }
+
+public:
+  RadixTrie(allocator_type alloc = {}) : m_alloc(alloc), m_root(m_alloc.new_object<Node>()) {}
+
+  RadixTrie(const RadixTrie& other, allocator_type alloc)
+      : m_alloc(alloc), m_root(nullptr), m_size(other.m_size) {
+    if (other.m_root == nullptr) return;
+    m_root = clone(other.m_root);
+  }
+
+  RadixTrie(const RadixTrie& other) : RadixTrie(other, other.m_alloc) {}
+
+  RadixTrie(RadixTrie&& other, allocator_type alloc) : m_alloc(alloc), m_root(nullptr), m_size(0) {
+    if (m_alloc == other.m_alloc) {
+      m_root = std::exchange(other.m_root, nullptr);
+      m_size = std::exchange(other.m_size, 0);
+    } else {
+      // elements are trivially copyable, moving across allocators is a copy
+      RadixTrie copy(other, m_alloc);
+      swap(copy);
+      other.clear();
+    }
+  }
+
+  RadixTrie(RadixTrie&& other) noexcept
+      : m_alloc(other.m_alloc), m_root(std::exchange(other.m_root, nullptr)),
+        m_size(std::exchange(other.m_size, 0)) {}
+
+  RadixTrie& operator=(const RadixTrie& other) {
+    if (this == &other) return *this;
+
+    RadixTrie copy(other, m_alloc);
+    swap(copy);
+    return *this;
+  }
+
+  RadixTrie& operator=(RadixTrie&& other) {
+    if (this == &other) return *this;
+
+    if (m_alloc == other.m_alloc) {
+      swap(other);
+    } else {
+      // reallocation then swap
+      RadixTrie copy(std::move(other), m_alloc);
+      swap(copy);
+    }
+    return *this;
+  }
+
+  ~RadixTrie() noexcept { clear(); }
+
+  void clear() noexcept {
+    if (m_root == nullptr) return;
+    destroy(m_root);
+    m_root = nullptr;
+    m_size = 0;
+  }
+
+  void insert(const value_type& seq) {
+    if (m_root == nullptr) m_root = m_alloc.new_object<Node>();
+
+    withKey(seq, [&](Key key) {
+      Node* node = m_root;
+      while (!key.empty()) {
+        size_t idx = childIndex(node, key.front());
+        if (idx == node->childCount || !(node->children[idx]->label[0] == key.front())) {
+          Node* leaf = makeNode(key);
+          leaf->endOfWord = true;
+          try {
+            insertChild(node, idx, leaf);
+          } catch (...) {
+            destroy(leaf);
+            throw;
+          }
+          ++m_size;
+          return;
+        }
+
+        Node* child = node->children[idx];
+        size_t common = commonPrefix(child, key);
+        if (common < child->labelLength) child = split(node, idx, common);
+        key = key.subspan(common);
+        node = child;
+      }
+      if (!node->endOfWord) {
+        node->endOfWord = true;
+        ++m_size;
+      }
+    });
+  }
+
+  // removes seq, returns whether it was there
+  bool erase(const value_type& seq) {
+    if (m_root == nullptr) return false;
+
+    return withKey(seq, [&](Key key) {
+      Node* parent = nullptr;
+      Node* node = m_root;
+      while (!key.empty()) {
+        Node* child = findChild(node, key.front());
+        if (child == nullptr || key.size() < child->labelLength ||
+            !labelEquals(child->label, key.data(), child->labelLength))
+          return false;
+        key = key.subspan(child->labelLength);
+        parent = node;
+        node = child;
+      }
+      if (!node->endOfWord) return false;
+
+      node->endOfWord = false;
+      --m_size;
+      if (node == m_root) return true;
+
+      if (node->childCount == 0) {
+        removeChild(parent, node);
+        destroy(node);
+        // the parent may be left as a pass-through node
+        if (parent != m_root && !parent->endOfWord && parent->childCount == 1) mergeWithChild(parent);
+      } else if (node->childCount == 1) {
+        mergeWithChild(node);
+      }
+      return true;
+    });
+  }
+
+  [[nodiscard]] bool search(const value_type& seq) const {
+    if (m_root == nullptr) return false;
+
+    return withKey(seq, [&](Key key) {
+      auto [node, matched] = descend(key);
+      return matched == key.size() && node->endOfWord;
+    });
+  }
+
+  [[nodiscard]] bool startsWith(const value_type& seq) const {
+    if (m_root == nullptr) return std::ranges::empty(seq);
+
+    return withKey(seq, [&](Key key) {
+      auto [node, matched] = descend(key);
+      if (matched == key.size()) return true;
+      // the prefix may end inside an edge
+      const Node* child = findChild(node, key[matched]);
+      return child != nullptr && key.size() - matched < child->labelLength &&
+             labelEquals(child->label, key.data() + matched, key.size() - matched);
+    });
+  }
+
+  [[nodiscard]] constexpr size_type size() const noexcept { return m_size; }
+
+  [[nodiscard]] constexpr bool empty() const noexcept { return m_size == 0; }
+
+  // number of nodes including the root, a measure of how well the key set compresses
+  [[nodiscard]] size_type nodeCount() const noexcept { return m_root == nullptr ? 0 : countNodes(m_root); }
+
+  array::DynamicArray<value_type> getAllWithPrefix(const value_type& prefix) const {
+    array::DynamicArray<value_type> sequences;
+    if (m_root == nullptr) return sequences;
+
+    withKey(prefix, [&](Key key) {
+      auto [node, matched] = descend(key);
+      PathBuffer path(key.begin(), key.end());
+      if (matched < key.size()) {
+        // the prefix ends inside an edge, complete the path with the rest of its label
+        Node* child = findChild(node, key[matched]);
+        size_t rest = key.size() - matched;
+        if (child == nullptr || rest >= child->labelLength ||
+            !labelEquals(child->label, key.data() + matched, rest))
+          return;
+        for (size_t i = rest; i < child->labelLength; ++i) path.emplaceBack(child->label[i]);
+        node = child;
+      }
+      collectSeq(node, path, sequences);
+    });
+    return sequences;
+  }
+
+  [[nodiscard]] allocator_type getAllocator() const noexcept { return m_alloc; }
+
+  iterator begin() { return {m_root}; }
+  iterator end() noexcept { return {}; }
+
+  const_iterator begin() const { return {m_root}; }
+  const_iterator end() const noexcept { return {}; }
+
+  const_iterator cbegin() const { return {m_root}; }
+  const_iterator cend() const noexcept { return {}; }
+
+  constexpr void swap(RadixTrie& other) noexcept {
+    using std::swap;
+    // don't swap allocators
+    swap(m_root, other.m_root);
+    swap(m_size, other.m_size);
+  }
+
+  // for ADL
+  constexpr friend void swap(RadixTrie& a, RadixTrie& b) noexcept { a.swap(b); }
+};
+
+} // namespace tree
@@ -1,10 +1,78 @@
 #include "../array/dynamic_array.hpp"
+#include "../memory_stats.hpp"
+#include <algorithm>
+#include <atomic>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_range_equals.hpp>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
 #include <memory_resource>
+#include <random>
+#include <set>
+#include <shared_mutex>
+#include <stdexcept>
+#include <span>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
 import trie;
 import test;
 
+namespace {
+// bytes currently allocated from the heap, 0 where that can't be queried
+size_t heapInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+  return mallinfo2().uordblks;
+#else
+  return 0;
+#endif
+}
+
+// plain two-row Levenshtein distance, the reference for searchWithinDistance
+size_t levenshtein(std::string_view a, std::string_view b) {
+  array::DynamicArray<size_t> previous(b.size() + 1, 0);
+  array::DynamicArray<size_t> current(b.size() + 1, 0);
+  for (size_t j = 0; j <= b.size(); ++j) previous[j] = j;
+  for (size_t i = 1; i <= a.size(); ++i) {
+    current[0] = i;
+    for (size_t j = 1; j <= b.size(); ++j) {
+      size_t substitution = previous[j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1);
+      current[j] = std::min({previous[j] + 1, current[j - 1] + 1, substitution});
+    }
+    std::swap(previous, current);
+  }
+  return previous[b.size()];
+}
+
+// scribbles over every block before freeing it, a reader still walking a reclaimed node reads garbage
+class PoisoningResource : public std::pmr::memory_resource {
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+    std::memset(p, 0xdd, bytes);
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+
+  [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+} // namespace
+
 TEST_CASE("Trie basic operations", "[trie]") {
   tree::Trie<std::string> t;
 
@@ -254,3 +322,1116 @@ TEST_CASE("Trie uses PMR allocator without global escapes", "[trie][pmr]") {
     REQUIRE_FALSE(t2.search(b));
   }
 }
+
+TEST_CASE("ArtTrie basic operations", "[trie][art]") {
+  tree::ArtTrie<std::string> t;
+  t.insert("hello");
+  t.insert("help");
+  t.insert("world");
+
+  REQUIRE(t.size() == 3);
+  REQUIRE(t.search("hello"));
+  REQUIRE(t.search("help"));
+  REQUIRE_FALSE(t.search("hel"));
+  REQUIRE(t.startsWith("hel"));
+  REQUIRE_FALSE(t.startsWith("hex"));
+  REQUIRE(t.getAllWithPrefix("he").size() == 2);
+}
+
+TEST_CASE("ArtTrie nodes grow through every node size", "[trie][art]") {
+  tree::ArtTrie<std::string> t;
+  // 256 distinct first bytes: the root goes Node4 -> Node16 -> Node48 -> Node256
+  for (int b = 255; b >= 0; --b) {
+    t.insert(std::string{static_cast<char>(b), 'x'});
+    std::string key{static_cast<char>(b), 'x'};
+    REQUIRE(t.search(key));
+  }
+  for (int b = 0; b < 256; ++b) CHECK(t.search(std::string{static_cast<char>(b), 'x'}));
+  CHECK_FALSE(t.search(std::string{'a', 'y'}));
+
+  SECTION("Iteration is in lexicographic (unsigned byte) order") {
+    std::string previous;
+    size_t count = 0;
+    for (std::string_view word : t) {
+      if (count > 0) CHECK(static_cast<unsigned char>(previous[0]) < static_cast<unsigned char>(word[0]));
+      previous = word;
+      ++count;
+    }
+    CHECK(count == 256);
+  }
+
+  SECTION("Copies with another allocator are deep") {
+    std::pmr::monotonic_buffer_resource pool;
+    std::pmr::polymorphic_allocator<std::byte> alloc(&pool);
+    tree::ArtTrie<std::string> copy(t, alloc);
+    t.clear();
+    CHECK(copy.search(std::string{static_cast<char>(200), 'x'}));
+  }
+}
+
+TEST_CASE("ArtTrie allocates nodes and child tables through the allocator", "[trie][art][pmr]") {
+  test::FallbackTracker fallbackTracker;
+  test::DefaultResourceGuard defaultResourceGuard(&fallbackTracker);
+
+  std::pmr::monotonic_buffer_resource pool{4096};
+  test::DetailedTracker customTracker(&pool);
+  std::pmr::polymorphic_allocator<std::byte> alloc(&customTracker);
+  tree::ArtTrie<std::string> trie(alloc);
+
+  trie.insert("abc");
+  // root + 3 nodes, and a Node4 child table for every node but the last
+  CHECK(customTracker.allocationCount() == 1 + 3 + 3);
+  trie.insert("abd");
+  CHECK(customTracker.allocationCount() == 1 + 3 + 3 + 1);
+  // only the monotonic pool's own buffer comes from the default resource
+  CHECK(fallbackTracker.allocationCount() == 1);
+}
+
+TEST_CASE("RadixTrie basic operations", "[trie][radix]") {
+  tree::RadixTrie<std::string> t;
+  t.insert("romane");
+  t.insert("romanus");
+  t.insert("romulus");
+  t.insert("rubens");
+
+  REQUIRE(t.size() == 4);
+  CHECK(t.search("romanus"));
+  CHECK_FALSE(t.search("roman"));
+  CHECK_FALSE(t.search("romanusx"));
+  CHECK(t.startsWith("roma"));
+  // prefixes ending inside an edge
+  CHECK(t.startsWith("rube"));
+  CHECK_FALSE(t.startsWith("rubx"));
+  CHECK(t.startsWith(""));
+
+  SECTION("Duplicates aren't counted twice") {
+    t.insert("rubens");
+    CHECK(t.size() == 4);
+  }
+
+  SECTION("Edges split on insert") {
+    // root, r, om, an, e, us, ulus, ubens
+    CHECK(t.nodeCount() == 8);
+    t.insert("roman");
+    CHECK(t.nodeCount() == 8);
+    CHECK(t.search("roman"));
+    t.insert("ro");
+    CHECK(t.nodeCount() == 9);
+    CHECK(t.search("ro"));
+  }
+
+  SECTION("Nodes merge on erase") {
+    CHECK(t.erase("romane"));
+    CHECK_FALSE(t.erase("romane"));
+    CHECK_FALSE(t.erase("rom"));
+    // "an" + "us" merged into "anus"
+    CHECK(t.nodeCount() == 6);
+    CHECK(t.erase("romulus"));
+    // "om" + "anus" merged into "omanus"
+    CHECK(t.nodeCount() == 4);
+    CHECK(t.search("romanus"));
+    CHECK(t.size() == 2);
+
+    CHECK(t.erase("romanus"));
+    CHECK(t.erase("rubens"));
+    CHECK(t.empty());
+    CHECK(t.nodeCount() == 1);
+  }
+
+  SECTION("getAllWithPrefix and iteration are in lexicographic order") {
+    array::DynamicArray<std::string> expected{"romane", "romanus", "romulus"};
+    CHECK_THAT(t.getAllWithPrefix("ro"), Catch::Matchers::RangeEquals(expected));
+    CHECK_THAT(t.getAllWithPrefix("rom"), Catch::Matchers::RangeEquals(expected));
+    CHECK(t.getAllWithPrefix("rub").size() == 1);
+    CHECK(t.getAllWithPrefix("rubx").empty());
+
+    array::DynamicArray<std::string> all;
+    for (std::string_view word : t) all.pushBack(std::string(word));
+    CHECK_THAT(all, Catch::Matchers::RangeEquals(array::DynamicArray<std::string>{
+                        "romane", "romanus", "romulus", "rubens"
+                    }));
+  }
+}
+
+TEST_CASE("RadixTrie with custom sequence", "[trie][radix]") {
+  using IntSeq = array::DynamicArray<int>;
+  tree::RadixTrie<IntSeq> t;
+  t.insert(IntSeq{1, 2, 3, 4});
+  t.insert(IntSeq{1, 2, 5});
+
+  CHECK(t.search(IntSeq{1, 2, 5}));
+  CHECK_FALSE(t.search(IntSeq{1, 2}));
+  CHECK(t.startsWith(IntSeq{1, 2, 3}));
+  CHECK(t.getAllWithPrefix(IntSeq{1}).size() == 2);
+  for (std::span<const int> seq : t) CHECK(seq.front() == 1);
+}
+
+TEST_CASE("RadixTrie uses PMR allocator without global escapes", "[trie][radix][pmr]") {
+  test::FallbackTracker fallbackTracker;
+  test::DefaultResourceGuard defaultResourceGuard(&fallbackTracker);
+
+  std::pmr::monotonic_buffer_resource pool{4096};
+  test::DetailedTracker customTracker(&pool);
+  std::pmr::polymorphic_allocator<std::byte> alloc(&customTracker);
+  tree::RadixTrie<std::string> t(alloc);
+
+  // root
+  CHECK(customTracker.allocationCount() == 1);
+  t.insert("https://example.com/a");
+  // leaf node, its label and the root's child table
+  CHECK(customTracker.allocationCount() == 1 + 3);
+  for (int i = 0; i < 20; ++i) t.insert("https://example.com/" + std::to_string(i));
+  CHECK(t.size() == 21);
+  // only the monotonic pool's own buffer comes from the default resource
+  CHECK(fallbackTracker.allocationCount() == 1);
+
+  SECTION("Copies with another allocator are deep") {
+    std::pmr::monotonic_buffer_resource pool2{4096};
+    std::pmr::polymorphic_allocator<std::byte> alloc2(&pool2);
+    tree::RadixTrie<std::string> copy(t, alloc2);
+    tree::RadixTrie<std::string> moved(std::move(t), alloc2);
+    CHECK(copy.search("https://example.com/17"));
+    CHECK(moved.search("https://example.com/a"));
+    CHECK(t.empty());
+    // the two monotonic pools' buffers
+    CHECK(fallbackTracker.allocationCount() == 2);
+  }
+}
+
+TEST_CASE("FrozenTrie answers like the trie it was built from", "[trie][frozen]") {
+  tree::Trie<std::string> t;
+  for (const char* word : {"car", "cart", "carbon", "cat", "dog", "do", ""}) t.insert(word);
+  t.insert(std::string{'\0', '\xff'});
+  tree::FrozenTrie frozen = tree::FrozenTrie::build(t);
+
+  auto checkQueries = [](const tree::FrozenTrie& f) {
+    CHECK(f.size() == 8);
+    CHECK(f.search("cart"));
+    CHECK(f.search("do"));
+    CHECK(f.search(""));
+    CHECK(f.search(std::string{'\0', '\xff'}));
+    CHECK_FALSE(f.search("ca"));
+    CHECK_FALSE(f.search("carts"));
+    CHECK(f.startsWith("carb"));
+    CHECK_FALSE(f.startsWith("cb"));
+    CHECK_THAT(
+        f.getAllWithPrefix("car"), Catch::Matchers::RangeEquals(array::DynamicArray<std::string>{
+                                       "car", "carbon", "cart"
+                                   })
+    );
+    CHECK(f.getAllWithPrefix("x").empty());
+  };
+
+  SECTION("Built in memory") { checkQueries(frozen); }
+
+  SECTION("Viewed in place") { checkQueries(tree::FrozenTrie::view(frozen.image())); }
+
+  SECTION("Saved and mapped back") {
+    auto path = (std::filesystem::temp_directory_path() / "dsa_frozen_trie_test.dat").string();
+    frozen.save(path);
+    {
+      tree::FrozenTrie mapped = tree::FrozenTrie::open(path);
+      checkQueries(mapped);
+      tree::FrozenTrie moved = std::move(mapped);
+      CHECK(moved.search("dog"));
+      CHECK(mapped.empty());
+    }
+    std::filesystem::remove(path);
+  }
+
+  SECTION("Rejects what isn't an image") {
+    std::string junk(64, 'x');
+    CHECK_THROWS_AS(tree::FrozenTrie::view(std::as_bytes(std::span{junk})), std::invalid_argument);
+    CHECK_THROWS_AS(tree::FrozenTrie::view(frozen.image().first(10)), std::invalid_argument);
+    CHECK_THROWS_AS(tree::FrozenTrie::open("/nonexistent/frozen.dat"), std::system_error);
+  }
+
+  SECTION("Empty key sets") {
+    tree::FrozenTrie empty = tree::FrozenTrie::build(tree::RadixTrie<std::string>{});
+    CHECK(empty.empty());
+    CHECK_FALSE(empty.search(""));
+    CHECK(empty.startsWith(""));
+  }
+
+  SECTION("Keys longer than the call stack is deep") {
+    // building and visiting take no stack per key byte
+    std::string longKey(200'000, 'a');
+    std::string branch = longKey.substr(0, 100'000) + 'b';
+    tree::FrozenTrie deep = tree::FrozenTrie::build(array::DynamicArray<std::string>{longKey, branch, "a"});
+    CHECK(deep.search(longKey));
+    CHECK(deep.search(branch));
+    CHECK_FALSE(deep.search(longKey.substr(1)));
+    CHECK_THAT(
+        deep.getAllWithPrefix("aa"),
+        Catch::Matchers::RangeEquals(array::DynamicArray<std::string>{longKey, branch})
+    );
+  }
+}
+
+TEST_CASE("AhoCorasick finds every occurrence", "[trie][aho_corasick]") {
+  using Match = tree::AhoCorasick::Match;
+  tree::Trie<std::string> keywords;
+  for (const char* word : {"he", "she", "his", "hers", ""}) keywords.insert(word);
+  tree::AhoCorasick automaton = tree::AhoCorasick::build(keywords);
+  // sorted, the empty key is dropped
+  REQUIRE_THAT(
+      automaton.patterns(),
+      Catch::Matchers::RangeEquals(array::DynamicArray<std::string>{"he", "hers", "his", "she"})
+  );
+
+  SECTION("Overlapping matches are all reported, by end offset") {
+    CHECK_THAT(
+        automaton.findAll("ushers"),
+        Catch::Matchers::RangeEquals(array::DynamicArray<Match>{{3, 1, 4}, {0, 2, 4}, {1, 2, 6}})
+    );
+    CHECK(automaton.findAll("").empty());
+    CHECK(automaton.findAll("xyz").empty());
+  }
+
+  SECTION("Streaming keeps state across chunk boundaries") {
+    std::string text = "ahishers shell his hershey";
+    array::DynamicArray<Match> whole = automaton.findAll(text);
+    for (size_t cut = 0; cut <= text.size(); ++cut) {
+      array::DynamicArray<Match> streamed;
+      auto scanner = automaton.scanner();
+      auto collect = [&](Match m) { streamed.pushBack(m); };
+      scanner.scan(std::string_view(text).substr(0, cut), collect);
+      scanner.scan(std::string_view(text).substr(cut), collect);
+      CHECK(scanner.offset() == text.size());
+      CHECK_THAT(streamed, Catch::Matchers::RangeEquals(whole));
+    }
+  }
+
+  SECTION("Matches a naive search on random text") {
+    std::mt19937 gen{7};
+    std::uniform_int_distribution<int> letter('a', 'c');
+    std::uniform_int_distribution<size_t> length(1, 5);
+    array::DynamicArray<std::string> patterns;
+    for (int i = 0; i < 30; ++i) {
+      std::string pattern(length(gen), ' ');
+      for (char& c : pattern) c = static_cast<char>(letter(gen));
+      patterns.pushBack(std::move(pattern));
+    }
+    std::string text(2000, ' ');
+    for (char& c : text) c = static_cast<char>(letter(gen));
+
+    tree::AhoCorasick random = tree::AhoCorasick::build(patterns);
+    size_t expected = 0;
+    for (const std::string& pattern : random.patterns()) {
+      for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+        ++expected;
+      }
+    }
+    size_t found = 0;
+    random.findAll(text, [&](Match m) {
+      CHECK(std::string_view(text).substr(m.begin, m.end - m.begin) == random.patterns()[m.pattern]);
+      ++found;
+    });
+    CHECK(found == expected);
+  }
+}
+
+TEST_CASE("Trie fuzzy search", "[trie][fuzzy]") {
+  tree::Trie<std::string> t;
+  for (const char* word : {"kitten", "sitting", "mitten", "kitchen", "bitten", "kit", "", "smitten"}) {
+    t.insert(word);
+  }
+
+  auto sorted = [](array::DynamicArray<std::pair<std::string, size_t>> matches) {
+    std::sort(matches.begin(), matches.end());
+    return matches;
+  };
+
+  SECTION("Distance 0 is an exact search") {
+    CHECK_THAT(
+        t.searchWithinDistance("kitten", 0),
+        Catch::Matchers::RangeEquals(array::DynamicArray<std::pair<std::string, size_t>>{{"kitten", 0}})
+    );
+    CHECK(t.searchWithinDistance("kitte", 0).empty());
+  }
+
+  SECTION("Substitutions, insertions and deletions") {
+    CHECK_THAT(
+        sorted(t.searchWithinDistance("kitten", 1)),
+        Catch::Matchers::RangeEquals(array::DynamicArray<std::pair<std::string, size_t>>{
+            {"bitten", 1}, {"kitten", 0}, {"mitten", 1}
+        })
+    );
+    CHECK_THAT(
+        sorted(t.searchWithinDistance("kitten", 2)),
+        Catch::Matchers::RangeEquals(array::DynamicArray<std::pair<std::string, size_t>>{
+            {"bitten", 1}, {"kitchen", 2}, {"kitten", 0}, {"mitten", 1}, {"smitten", 2}
+        })
+    );
+    // the empty sequence is within distance |query|
+    CHECK(t.searchWithinDistance("ki", 2).size() == 2);
+  }
+
+  SECTION("Matches brute force on random words") {
+    std::mt19937 gen{3};
+    std::uniform_int_distribution<int> letter('a', 'd');
+    std::uniform_int_distribution<size_t> length(0, 7);
+    auto randomWord = [&] {
+      std::string word(length(gen), ' ');
+      for (char& c : word) c = static_cast<char>(letter(gen));
+      return word;
+    };
+    tree::ArtTrie<std::string> words;
+    for (int i = 0; i < 500; ++i) words.insert(randomWord());
+
+    for (int q = 0; q < 20; ++q) {
+      std::string query = randomWord();
+      for (size_t k = 0; k <= 3; ++k) {
+        array::DynamicArray<std::pair<std::string, size_t>> expected;
+        for (std::string_view word : words) {
+          size_t distance = levenshtein(word, query);
+          if (distance <= k) expected.emplaceBack(std::string(word), distance);
+        }
+        CHECK_THAT(
+            sorted(words.searchWithinDistance(query, k)), Catch::Matchers::RangeEquals(sorted(expected))
+        );
+      }
+    }
+  }
+}
+
+TEST_CASE("Trie ranked autocomplete", "[trie][topk]") {
+  using Ranked = array::DynamicArray<std::pair<std::string, double>>;
+  tree::Trie<std::string> t;
+  t.insert("car", 5);
+  t.insert("card", 9);
+  t.insert("care", 2);
+  t.insert("careful", 7);
+  t.insert("cat", 8);
+  t.insert("dog", 10);
+  t.insert("cargo");
+  REQUIRE(t.size() == 7);
+
+  SECTION("Best first within the prefix") {
+    Ranked expected{{"card", 9}, {"careful", 7}, {"car", 5}};
+    CHECK_THAT(t.topKWithPrefix("car", 3), Catch::Matchers::RangeEquals(expected));
+    CHECK_THAT(t.topKWithPrefix("", 2), Catch::Matchers::RangeEquals(Ranked{{"dog", 10}, {"card", 9}}));
+    CHECK(t.topKWithPrefix("ca", 100).size() == 6);
+    CHECK(t.topKWithPrefix("x", 3).empty());
+    CHECK(t.topKWithPrefix("car", 0).empty());
+  }
+
+  SECTION("Unscored words rank at 0, scores can be read back") {
+    CHECK(t.score("cargo") == 0);
+    CHECK(t.score("careful") == 7);
+    CHECK_FALSE(t.score("ca").has_value());
+    CHECK(t.topKWithPrefix("carg", 1)[0].second == 0);
+    // inserting again without a score keeps it
+    t.insert("card");
+    CHECK(t.score("card") == 9);
+    CHECK(t.size() == 7);
+  }
+
+  SECTION("Rescoring moves words up and down") {
+    t.insert("card", 1);
+    CHECK_THAT(t.topKWithPrefix("car", 2), Catch::Matchers::RangeEquals(Ranked{{"careful", 7}, {"car", 5}}));
+    t.insert("care", 20);
+    CHECK_THAT(t.topKWithPrefix("", 1), Catch::Matchers::RangeEquals(Ranked{{"care", 20}}));
+    // a new score for a stored word doesn't add a word
+    CHECK(t.size() == 7);
+  }
+
+  SECTION("Copies keep the scores") {
+    tree::Trie<std::string> copy(t);
+    CHECK(copy.topKWithPrefix("", 1)[0].first == "dog");
+  }
+
+  SECTION("ArtTrie nodes rank too, matching a full sort on random scores") {
+    std::mt19937 gen{5};
+    std::uniform_int_distribution<int> letter('a', 'e');
+    std::uniform_int_distribution<int> score(0, 1000);
+    std::uniform_int_distribution<size_t> length(1, 6);
+    tree::ArtTrie<std::string> words;
+    for (int i = 0; i < 2000; ++i) {
+      std::string word(length(gen), ' ');
+      for (char& c : word) c = static_cast<char>(letter(gen));
+      words.insert(word, score(gen));
+    }
+    for (const char* prefix : {"", "a", "bc", "eee"}) {
+      Ranked expected;
+      for (std::string_view word : words) {
+        if (!word.starts_with(prefix)) continue;
+        expected.emplaceBack(std::string(word), *words.score(std::string(word)));
+      }
+      std::stable_sort(expected.begin(), expected.end(), [](const auto& a, const auto& b) {
+        return a.second > b.second;
+      });
+      Ranked top = words.topKWithPrefix(prefix, 10);
+      REQUIRE(top.size() == std::min<size_t>(10, expected.size()));
+      for (size_t i = 0; i < top.size(); ++i) CHECK(top[i].second == expected[i].second);
+    }
+  }
+}
+
+TEST_CASE("Trie prefix ranges and counts", "[trie][prefix]") {
+  tree::Trie<std::string> t;
+  for (const char* word : {"car", "card", "care", "careful", "cat", "dog", ""}) t.insert(word);
+
+  SECTION("prefixRange yields the words with the prefix, like getAllWithPrefix") {
+    for (const char* prefix : {"", "ca", "car", "care", "dog", "x", "carefully"}) {
+      array::DynamicArray<std::string> lazy;
+      for (std::string_view word : t.prefixRange(prefix)) lazy.emplaceBack(word);
+      CHECK_THAT(lazy, Catch::Matchers::UnorderedRangeEquals(t.getAllWithPrefix(prefix)));
+    }
+    CHECK(t.prefixRange("x").empty());
+    CHECK_FALSE(t.prefixRange("dog").empty());
+    STATIC_CHECK(std::same_as<decltype(*t.prefixRange("").begin()), std::string_view>);
+  }
+
+  SECTION("countWithPrefix counts each word once") {
+    CHECK(t.countWithPrefix("") == 7);
+    CHECK(t.countWithPrefix("ca") == 5);
+    CHECK(t.countWithPrefix("care") == 2);
+    CHECK(t.countWithPrefix("careful") == 1);
+    CHECK(t.countWithPrefix("x") == 0);
+    t.insert("care");
+    t.insert("care", 3);
+    CHECK(t.countWithPrefix("care") == 2);
+    CHECK(t.size() == 7);
+    tree::Trie<std::string> copy(t);
+    CHECK(copy.countWithPrefix("car") == 4);
+  }
+
+  SECTION("ArtTrie counts match its prefix ranges") {
+    std::mt19937 gen{11};
+    std::uniform_int_distribution<int> letter('a', 'd');
+    std::uniform_int_distribution<size_t> length(0, 5);
+    tree::ArtTrie<std::string> words;
+    for (int i = 0; i < 3000; ++i) {
+      std::string word(length(gen), ' ');
+      for (char& c : word) c = static_cast<char>(letter(gen));
+      words.insert(word);
+    }
+    for (const char* prefix : {"", "a", "bd", "ccc", "dddd"}) {
+      size_t visited = 0;
+      for (std::string_view word : words.prefixRange(prefix)) {
+        CHECK(word.starts_with(prefix));
+        ++visited;
+      }
+      CHECK(words.countWithPrefix(prefix) == visited);
+    }
+  }
+
+  SECTION("Iteration state comes from the trie's allocator") {
+    test::FallbackTracker fallbackTracker;
+    test::DefaultResourceGuard defaultResourceGuard(&fallbackTracker);
+    std::pmr::monotonic_buffer_resource pool{4096};
+    test::DetailedTracker customTracker(&pool);
+    tree::Trie<std::string> pmrTrie(std::pmr::polymorphic_allocator<std::byte>{&customTracker});
+    for (std::string_view word : t) pmrTrie.insert(std::string(word));
+
+    size_t fallbackBefore = fallbackTracker.allocationCount();
+    size_t nodeAllocations = customTracker.allocationCount();
+    size_t visited = 0;
+    for (std::string_view word : pmrTrie.prefixRange("car")) visited += word.empty() ? 0 : 1;
+    for ([[maybe_unused]] std::string_view word : pmrTrie) ++visited;
+    CHECK(visited == 4 + 7);
+    CHECK(customTracker.allocationCount() > nodeAllocations);
+    CHECK(fallbackTracker.allocationCount() == fallbackBefore);
+  }
+}
+
+TEST_CASE("Trie bulk load from sorted keys", "[trie][bulk]") {
+  std::mt19937 gen{12};
+  std::uniform_int_distribution<int> letter('a', 'e');
+  std::uniform_int_distribution<size_t> length(0, 6);
+  std::vector<std::string> keys;
+  for (int i = 0; i < 5000; ++i) {
+    std::string word(length(gen), ' ');
+    for (char& c : word) c = static_cast<char>(letter(gen));
+    keys.push_back(word);
+  }
+  std::ranges::sort(keys);
+
+  tree::Trie<std::string> inserted;
+  for (const std::string& key : keys) inserted.insert(key);
+  auto sortedWords = [](const auto& trie) {
+    std::vector<std::string> words;
+    for (std::string_view word : trie) words.emplace_back(word);
+    std::ranges::sort(words);
+    return words;
+  };
+
+  SECTION("fromSorted matches inserting, duplicates and the empty key included") {
+    auto loaded = tree::Trie<std::string>::fromSorted(keys);
+    CHECK(loaded.size() == inserted.size());
+    CHECK(sortedWords(loaded) == sortedWords(inserted));
+    for (const char* prefix : {"", "a", "bc", "eee"}) {
+      CHECK(loaded.countWithPrefix(prefix) == inserted.countWithPrefix(prefix));
+    }
+    CHECK(loaded.search(""));
+    CHECK(loaded.score("ab") == inserted.score("ab"));
+
+    loaded.insert("abc", 5);
+    CHECK(loaded.topKWithPrefix("a", 1)[0].first == "abc");
+  }
+
+  SECTION("ArtTrie and the parallel build agree") {
+    auto art = tree::ArtTrie<std::string>::fromSorted(keys);
+    auto parallel = tree::Trie<std::string>::fromSortedParallel(keys);
+    auto artParallel = tree::ArtTrie<std::string>::fromSortedParallel(keys);
+    CHECK(sortedWords(art) == sortedWords(inserted));
+    CHECK(sortedWords(parallel) == sortedWords(inserted));
+    CHECK(sortedWords(artParallel) == sortedWords(inserted));
+    CHECK(artParallel.countWithPrefix("d") == inserted.countWithPrefix("d"));
+  }
+
+  SECTION("Empty input and views as keys") {
+    CHECK(tree::Trie<std::string>::fromSorted(std::vector<std::string>{}).empty());
+    std::vector<std::string_view> views{"a", "ab", "b"};
+    auto loaded = tree::Trie<std::string>::fromSorted(views);
+    CHECK(loaded.size() == 3);
+    CHECK(loaded.search("ab"));
+  }
+
+  SECTION("Keys not grouped by prefix are rejected") {
+    using Keys = std::vector<std::string>;
+    CHECK_THROWS_AS(tree::Trie<std::string>::fromSorted(Keys{"ab", "b", "ac"}), std::invalid_argument);
+    CHECK_THROWS_AS(tree::Trie<std::string>::fromSorted(Keys{"ab", "a"}), std::invalid_argument);
+    CHECK_THROWS_AS(
+        tree::ArtTrie<std::string>::fromSortedParallel(Keys{"ba", "ab", "bb"}), std::invalid_argument
+    );
+  }
+}
+
+namespace {
+// the running totals behind memoryStats() agree with a full walk
+void checkFootprint(const stats::MemoryStats& fast, const stats::MemoryStats& detailed) {
+  CHECK(fast.nodeCount == detailed.nodeCount);
+  CHECK(fast.elementCount == detailed.elementCount);
+  CHECK(fast.capacity == detailed.capacity);
+  CHECK(fast.bytesAllocated == detailed.bytesAllocated);
+  CHECK(fast.averageFanOut == Catch::Approx(detailed.averageFanOut));
+  CHECK(fast.loadFactor == Catch::Approx(detailed.loadFactor));
+}
+} // namespace
+
+TEST_CASE("Trie memory stats", "[trie][memory_stats]") {
+  tree::Trie<std::string> t;
+  CHECK(t.memoryStats().nodeCount == 1);
+  for (const char* word : {"car", "card", "care", "cat", "dog"}) t.insert(word);
+
+  SECTION("Nodes, fan-out and child tables") {
+    stats::MemoryStats stats = t.detailedMemoryStats();
+    // root, c, ca, car, card, care, cat, d, do, dog
+    CHECK(stats.nodeCount == 10);
+    CHECK(stats.elementCount == 5);
+    // 9 edges out of root, c, ca, car, d, do
+    CHECK(stats.averageFanOut == Catch::Approx(9.0 / 6));
+    CHECK(stats.bytesUsed <= stats.bytesAllocated);
+    CHECK(stats.chainLengths[0] + stats.chainLengths[1] + stats.chainLengths[2] == stats.capacity);
+    CHECK(stats.loadFactor == Catch::Approx(9.0 / static_cast<double>(stats.capacity)));
+    checkFootprint(t.memoryStats(), stats);
+
+    tree::Trie<std::string> copy(t);
+    CHECK(copy.memoryStats().nodeCount == 10);
+    checkFootprint(copy.memoryStats(), copy.detailedMemoryStats());
+    CHECK(copy.search("care"));
+    CHECK_FALSE(copy.startsWith("cards"));
+  }
+
+  SECTION("Running totals follow inserts, bulk loads, moves and clear") {
+    std::mt19937 gen{11};
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::uniform_int_distribution<size_t> length(1, 8);
+    array::DynamicArray<std::string> keys;
+    for (int i = 0; i < 3000; ++i) {
+      std::string key(length(gen), ' ');
+      for (char& c : key) c = static_cast<char>(letter(gen));
+      t.insert(key);
+      keys.pushBack(std::move(key));
+    }
+    checkFootprint(t.memoryStats(), t.detailedMemoryStats());
+    std::sort(keys.begin(), keys.end());
+
+    auto sorted = tree::Trie<std::string>::fromSorted(keys);
+    checkFootprint(sorted.memoryStats(), sorted.detailedMemoryStats());
+    auto parallel = tree::ArtTrie<std::string>::fromSortedParallel(keys);
+    checkFootprint(parallel.memoryStats(), parallel.detailedMemoryStats());
+
+    std::pmr::monotonic_buffer_resource pool;
+    tree::Trie<std::string> moved(std::move(sorted), &pool);
+    checkFootprint(moved.memoryStats(), moved.detailedMemoryStats());
+    // a move across allocators rebuilds the nodes, the source keeps its own until it is destroyed
+    checkFootprint(sorted.memoryStats(), sorted.detailedMemoryStats());
+
+    tree::Trie<std::string> taken(std::move(moved));
+    CHECK(moved.memoryStats().nodeCount == 0);
+    taken.clear();
+    CHECK(taken.memoryStats().bytesAllocated == 0);
+  }
+
+  SECTION("ArtTrie nodes report their node kind's capacity") {
+    tree::ArtTrie<std::string> art;
+    for (char c = 'a'; c <= 'z'; ++c) art.insert(std::string(1, c));
+    stats::MemoryStats stats = art.memoryStats();
+    CHECK(stats.nodeCount == 27);
+    CHECK(stats.averageFanOut == Catch::Approx(26.0));
+    // the root is a Node48, the leaves have no body
+    CHECK(stats.capacity == 48);
+    CHECK(stats.bytesAllocated > 27 * sizeof(void*));
+    checkFootprint(stats, art.detailedMemoryStats());
+  }
+}
+
+TEST_CASE("ConcurrentTrie basic operations", "[trie][concurrent]") {
+  using Trie = tree::ConcurrentTrie<std::string>;
+  Trie t;
+  CHECK(t.empty());
+
+  SECTION("Single inserts and erases") {
+    CHECK(t.insert("car"));
+    CHECK(t.insert("cart"));
+    CHECK_FALSE(t.insert("car"));
+    CHECK(t.insert(""));
+    CHECK(t.size() == 3);
+    CHECK(t.search("car"));
+    CHECK(t.search(""));
+    CHECK_FALSE(t.search("ca"));
+    CHECK(t.startsWith("ca"));
+    CHECK(t.countWithPrefix("car") == 2);
+
+    CHECK(t.erase("car"));
+    CHECK_FALSE(t.erase("car"));
+    CHECK_FALSE(t.erase("ca"));
+    CHECK_FALSE(t.search("car"));
+    CHECK(t.search("cart"));
+    CHECK(t.erase("cart"));
+    CHECK_FALSE(t.startsWith("c"));
+    CHECK(t.size() == 1);
+  }
+
+  SECTION("Batches apply in order and iterate sorted") {
+    size_t changed =
+        t.apply(Trie::Batch{}.insert("dog").insert("cat").insert("dog").insert("ant").erase("cat"));
+    CHECK(changed == 4);
+    array::DynamicArray<std::string> words;
+    for (std::string_view word : t.snapshot()) words.emplaceBack(word);
+    CHECK_THAT(words, Catch::Matchers::RangeEquals(array::DynamicArray<std::string>{"ant", "dog"}));
+    CHECK(t.getAllWithPrefix("d").size() == 1);
+  }
+
+  SECTION("Snapshots keep the version they pinned") {
+    t.insert("old");
+    Trie::Snapshot before = t.snapshot();
+    t.apply(Trie::Batch{}.erase("old").insert("new"));
+    CHECK(before.search("old"));
+    CHECK_FALSE(before.search("new"));
+    CHECK(before.size() == 1);
+    CHECK(t.search("new"));
+    CHECK_FALSE(t.search("old"));
+  }
+
+  SECTION("Agrees with Trie on random batches") {
+    std::mt19937 gen{3};
+    std::uniform_int_distribution<int> letter('a', 'c');
+    std::uniform_int_distribution<size_t> length(0, 4);
+    std::bernoulli_distribution erase(0.4);
+    std::set<std::string> reference;
+    for (int round = 0; round < 50; ++round) {
+      Trie::Batch batch;
+      for (int i = 0; i < 20; ++i) {
+        std::string word(length(gen), ' ');
+        for (char& c : word) c = static_cast<char>(letter(gen));
+        if (erase(gen)) {
+          batch.erase(word);
+          reference.erase(word);
+        } else {
+          batch.insert(word);
+          reference.insert(word);
+        }
+      }
+      t.apply(batch);
+      array::DynamicArray<std::string> words;
+      for (std::string_view word : t.snapshot()) words.emplaceBack(word);
+      REQUIRE_THAT(words, Catch::Matchers::RangeEquals(reference));
+      size_t startingWithA = 0;
+      for (const std::string& word : reference) startingWithA += word.starts_with('a') ? 1 : 0;
+      CHECK(t.countWithPrefix("a") == startingWithA);
+    }
+  }
+}
+
+TEST_CASE("ConcurrentTrie readers run during batches", "[trie][concurrent]") {
+  // nodes freed while a snapshot can still reach them would show up as failures, or to a sanitizer
+  PoisoningResource poisoning;
+  std::pmr::polymorphic_allocator<std::byte> alloc(&poisoning);
+  tree::ConcurrentTrie<std::string> t(alloc);
+  // words "s0".."s99" are never erased, "t<i>" come and go in batches
+  for (int i = 0; i < 100; ++i) t.insert("s" + std::to_string(i));
+
+  std::atomic<bool> stop{false};
+  std::atomic<int> failures{0};
+  {
+    std::vector<std::jthread> readers;
+    for (int r = 0; r < 3; ++r) {
+      readers.emplace_back([&] {
+        while (!stop.load()) {
+          auto snapshot = t.snapshot();
+          size_t iterated = 0;
+          for ([[maybe_unused]] std::string_view word : snapshot) ++iterated;
+          bool consistent = iterated == snapshot.size() && snapshot.countWithPrefix("s") == 100 &&
+                            snapshot.search("s42") && snapshot.countWithPrefix("t") % 10 == 0;
+          if (!consistent) failures.fetch_add(1);
+        }
+      });
+    }
+
+    for (int round = 0; round < 300; ++round) {
+      tree::ConcurrentTrie<std::string>::Batch batch;
+      for (int i = 0; i < 10; ++i) {
+        std::string word = "t" + std::to_string((round * 10) + i);
+        batch.insert(word);
+        if (round > 0) batch.erase("t" + std::to_string(((round - 1) * 10) + i));
+      }
+      t.apply(batch);
+    }
+    stop.store(true);
+  }
+  CHECK(failures.load() == 0);
+  CHECK(t.countWithPrefix("t") == 10);
+  CHECK(t.size() == 110);
+}
+
+TEST_CASE("ArtTrie vs hash-map nodes", "[trie][art][.benchmark]") {
+  constexpr size_t keyCount = 200'000;
+  std::mt19937 gen{1};
+  std::uniform_int_distribution<int> letter('a', 'z');
+  std::uniform_int_distribution<size_t> length(4, 16);
+  array::DynamicArray<std::string> keys;
+  for (size_t i = 0; i < keyCount; ++i) {
+    std::string key(length(gen), ' ');
+    for (char& c : key) c = static_cast<char>(letter(gen));
+    keys.pushBack(std::move(key));
+  }
+
+  auto build = [&]<typename TrieType>(std::type_identity<TrieType>, const char* name) {
+    std::size_t before = heapInUse();
+    auto trie = std::make_unique<TrieType>();
+    for (const std::string& key : keys) trie->insert(key);
+    std::size_t after = heapInUse();
+    if (after > before) WARN(name << ": " << (after - before) / keyCount << " bytes per key");
+    return trie;
+  };
+
+  auto hashTrie = build(std::type_identity<tree::Trie<std::string>>{}, "hash-map nodes");
+  auto artTrie = build(std::type_identity<tree::ArtTrie<std::string>>{}, "ART nodes");
+
+  BENCHMARK("hash-map nodes: search") {
+    size_t found = 0;
+    for (const std::string& key : keys) found += hashTrie->search(key) ? 1 : 0;
+    return found;
+  };
+  BENCHMARK("ART nodes: search") {
+    size_t found = 0;
+    for (const std::string& key : keys) found += artTrie->search(key) ? 1 : 0;
+    return found;
+  };
+}
+
+TEST_CASE("RadixTrie vs per-element nodes", "[trie][radix][.benchmark]") {
+  // URL-like keys: a handful of long shared prefixes and long unique suffixes
+  constexpr size_t keyCount = 100'000;
+  std::mt19937 gen{1};
+  std::uniform_int_distribution<int> letter('a', 'z');
+  std::uniform_int_distribution<size_t> host(0, 7);
+  array::DynamicArray<std::string> keys;
+  for (size_t i = 0; i < keyCount; ++i) {
+    std::string key = "https://host" + std::to_string(host(gen)) + ".example.com/static/assets/";
+    for (int c = 0; c < 24; ++c) key += static_cast<char>(letter(gen));
+    keys.pushBack(std::move(key));
+  }
+
+  auto build = [&]<typename TrieType>(std::type_identity<TrieType>, const char* name) {
+    std::size_t before = heapInUse();
+    auto trie = std::make_unique<TrieType>();
+    for (const std::string& key : keys) trie->insert(key);
+    std::size_t after = heapInUse();
+    if (after > before) WARN(name << ": " << (after - before) / keyCount << " bytes per key");
+    return trie;
+  };
+
+  auto artTrie = build(std::type_identity<tree::ArtTrie<std::string>>{}, "ART nodes");
+  auto radixTrie = build(std::type_identity<tree::RadixTrie<std::string>>{}, "radix nodes");
+
+  BENCHMARK("ART nodes: search") {
+    size_t found = 0;
+    for (const std::string& key : keys) found += artTrie->search(key) ? 1 : 0;
+    return found;
+  };
+  BENCHMARK("radix nodes: search") {
+    size_t found = 0;
+    for (const std::string& key : keys) found += radixTrie->search(key) ? 1 : 0;
+    return found;
+  };
+}
+
+TEST_CASE("FrozenTrie startup vs rebuilding a Trie", "[trie][frozen][.benchmark]") {
+  constexpr size_t keyCount = 200'000;
+  std::mt19937 gen{1};
+  std::uniform_int_distribution<int> letter('a', 'z');
+  std::uniform_int_distribution<size_t> length(4, 16);
+  array::DynamicArray<std::string> keys;
+  for (size_t i = 0; i < keyCount; ++i) {
+    std::string key(length(gen), ' ');
+    for (char& c : key) c = static_cast<char>(letter(gen));
+    keys.pushBack(std::move(key));
+  }
+
+  auto path = (std::filesystem::temp_directory_path() / "dsa_frozen_trie_bench.dat").string();
+  tree::FrozenTrie::build(keys).save(path);
+  tree::FrozenTrie frozen = tree::FrozenTrie::open(path);
+  WARN("image: " << frozen.image().size() / keyCount << " bytes per key");
+
+  BENCHMARK("rebuild Trie") {
+    tree::ArtTrie<std::string> trie;
+    for (const std::string& key : keys) trie.insert(key);
+    return trie.size();
+  };
+  BENCHMARK("open FrozenTrie") { return tree::FrozenTrie::open(path).size(); };
+  BENCHMARK("FrozenTrie: search") {
+    size_t found = 0;
+    for (const std::string& key : keys) found += frozen.search(key) ? 1 : 0;
+    return found;
+  };
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("AhoCorasick scan throughput", "[trie][aho_corasick][.benchmark]") {
+  constexpr size_t keywordCount = 20'000;
+  constexpr size_t textBytes = size_t{1} << 26;
+  std::mt19937 gen{1};
+  std::uniform_int_distribution<int> letter('a', 'z');
+  std::uniform_int_distribution<size_t> length(5, 12);
+  tree::ArtTrie<std::string> keywords;
+  for (size_t i = 0; i < keywordCount; ++i) {
+    std::string key(length(gen), ' ');
+    for (char& c : key) c = static_cast<char>(letter(gen));
+    keywords.insert(key);
+  }
+  std::string text(textBytes, ' ');
+  for (char& c : text) c = static_cast<char>(letter(gen));
+
+  tree::AhoCorasick automaton = tree::AhoCorasick::build(keywords);
+  auto start = std::chrono::steady_clock::now();
+  size_t matches = 0;
+  automaton.findAll(text, [&](tree::AhoCorasick::Match) { ++matches; });
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  WARN(matches << " matches, " << static_cast<double>(textBytes) / elapsed.count() / 1e9 << " GB/s");
+
+  BENCHMARK("AhoCorasick: 64 MiB in 1 MiB chunks") {
+    size_t count = 0;
+    auto scanner = automaton.scanner();
+    for (size_t offset = 0; offset < text.size(); offset += size_t{1} << 20) {
+      scanner.scan(std::string_view(text).substr(offset, size_t{1} << 20), [&](tree::AhoCorasick::Match) {
+        ++count;
+      });
+    }
+    return count;
+  };
+  BENCHMARK("ArtTrie walk from every offset: first 4 MiB") {
+    size_t count = 0;
+    std::string_view head = std::string_view(text).substr(0, size_t{1} << 22);
+    for (size_t begin = 0; begin < head.size(); ++begin) {
+      for (size_t end = begin + 1; end <= std::min(head.size(), begin + 12); ++end) {
+        std::string candidate(head.substr(begin, end - begin));
+        if (!keywords.startsWith(candidate)) break;
+        count += keywords.search(candidate) ? 1 : 0;
+      }
+    }
+    return count;
+  };
+}
+
+TEST_CASE("Trie fuzzy search on a 1M word dictionary", "[trie][fuzzy][.benchmark]") {
+  constexpr size_t wordCount = 1'000'000;
+  std::mt19937 gen{1};
+  std::uniform_int_distribution<int> letter('a', 'z');
+  std::uniform_int_distribution<size_t> length(3, 12);
+  tree::ArtTrie<std::string> dictionary;
+  array::DynamicArray<std::string> queries;
+  for (size_t i = 0; i < wordCount; ++i) {
+    std::string word(length(gen), ' ');
+    for (char& c : word) c = static_cast<char>(letter(gen));
+    if (i % 10'000 == 0) queries.pushBack(word);
+    dictionary.insert(word);
+  }
+
+  BENCHMARK("searchWithinDistance k = 1, 100 queries") {
+    size_t found = 0;
+    for (const std::string& query : queries) found += dictionary.searchWithinDistance(query, 1).size();
+    return found;
+  };
+  BENCHMARK("searchWithinDistance k = 2, 100 queries") {
+    size_t found = 0;
+    for (const std::string& query : queries) found += dictionary.searchWithinDistance(query, 2).size();
+    return found;
+  };
+  BENCHMARK("Levenshtein over every word k = 2, 1 query") {
+    size_t found = 0;
+    for (std::string_view word : dictionary) found += levenshtein(word, queries[0]) <= 2 ? 1 : 0;
+    return found;
+  };
+}
+
+TEST_CASE("Trie top-k autocomplete vs collecting every match", "[trie][topk][.benchmark]") {
+  constexpr size_t wordCount = 500'000;
+  std::mt19937 gen{1};
+  std::uniform_int_distribution<int> letter('a', 'z');
+  std::uniform_int_distribution<size_t> length(3, 12);
+  std::uniform_real_distribution<double> score(0, 1);
+  tree::ArtTrie<std::string> dictionary;
+  for (size_t i = 0; i < wordCount; ++i) {
+    std::string word(length(gen), ' ');
+    for (char& c : word) c = static_cast<char>(letter(gen));
+    dictionary.insert(word, score(gen));
+  }
+
+  BENCHMARK("topKWithPrefix(\"s\", 10)") { return dictionary.topKWithPrefix("s", 10); };
+  BENCHMARK("getAllWithPrefix(\"s\") + partial sort") {
+    auto matches = dictionary.getAllWithPrefix("s");
+    array::DynamicArray<std::pair<double, std::string>> ranked;
+    for (std::string& match : matches) ranked.emplaceBack(*dictionary.score(match), std::move(match));
+    std::partial_sort(ranked.begin(), ranked.begin() + 10, ranked.end(), std::greater<>{});
+    return ranked[0].first;
+  };
+}
+
+TEST_CASE("Trie prefix counting vs collecting", "[trie][prefix][.benchmark]") {
+  constexpr size_t wordCount = 500'000;
+  std::mt19937 gen{2};
+  std::uniform_int_distribution<int> letter('a', 'z');
+  std::uniform_int_distribution<size_t> length(3, 12);
+  tree::ArtTrie<std::string> dictionary;
+  for (size_t i = 0; i < wordCount; ++i) {
+    std::string word(length(gen), ' ');
+    for (char& c : word) c = static_cast<char>(letter(gen));
+    dictionary.insert(word);
+  }
+
+  BENCHMARK("countWithPrefix(\"s\")") { return dictionary.countWithPrefix("s"); };
+  BENCHMARK("prefixRange(\"s\") walk") {
+    size_t bytes = 0;
+    for (std::string_view word : dictionary.prefixRange("s")) bytes += word.size();
+    return bytes;
+  };
+  BENCHMARK("getAllWithPrefix(\"s\")") { return dictionary.getAllWithPrefix("s").size(); };
+}
+
+TEST_CASE("Trie bulk load vs inserting", "[trie][bulk][.benchmark]") {
+  constexpr size_t wordCount = 1'000'000;
+  std::mt19937 gen{3};
+  std::uniform_int_distribution<int> letter('a', 'z');
+  std::uniform_int_distribution<size_t> length(3, 12);
+  std::vector<std::string> keys;
+  keys.reserve(wordCount);
+  for (size_t i = 0; i < wordCount; ++i) {
+    std::string word(length(gen), ' ');
+    for (char& c : word) c = static_cast<char>(letter(gen));
+    keys.push_back(std::move(word));
+  }
+  std::ranges::sort(keys);
+
+  BENCHMARK("insert each key") {
+    tree::Trie<std::string> trie;
+    for (const std::string& key : keys) trie.insert(key);
+    return trie.size();
+  };
+  BENCHMARK("fromSorted") { return tree::Trie<std::string>::fromSorted(keys).size(); };
+  BENCHMARK("fromSortedParallel") { return tree::Trie<std::string>::fromSortedParallel(keys).size(); };
+  BENCHMARK("ArtTrie insert each key") {
+    tree::ArtTrie<std::string> trie;
+    for (const std::string& key : keys) trie.insert(key);
+    return trie.size();
+  };
+  BENCHMARK("ArtTrie fromSorted") { return tree::ArtTrie<std::string>::fromSorted(keys).size(); };
+}
+
+TEST_CASE("ConcurrentTrie read scaling under updates", "[trie][concurrent][.benchmark]") {
+  constexpr size_t wordCount = 200'000;
+  constexpr size_t lookupsPerReader = 500'000;
+  std::mt19937 gen{4};
+  std::uniform_int_distribution<int> letter('a', 'z');
+  std::uniform_int_distribution<size_t> length(3, 12);
+  array::DynamicArray<std::string> words;
+  for (size_t i = 0; i < wordCount; ++i) {
+    std::string word(length(gen), ' ');
+    for (char& c : word) c = static_cast<char>(letter(gen));
+    words.emplaceBack(std::move(word));
+  }
+
+  tree::ConcurrentTrie<std::string> concurrent;
+  tree::Trie<std::string> locked;
+  std::shared_mutex lock;
+  tree::ConcurrentTrie<std::string>::Batch initial;
+  for (const std::string& word : words) {
+    initial.insert(word);
+    locked.insert(word);
+  }
+  concurrent.apply(initial);
+
+  // readers look up known words while a background writer inserts a batch of 100 fresh words every ms
+  auto measure = [&](unsigned readers, auto lookup, auto insertBatch) {
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> found{0};
+    auto start = std::chrono::steady_clock::now();
+    {
+      std::jthread writer([&] {
+        for (size_t round = 0; !stop.load(); ++round) {
+          insertBatch(round);
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+      });
+      std::vector<std::jthread> threads;
+      for (unsigned r = 0; r < readers; ++r) {
+        threads.emplace_back([&, r] {
+          size_t hits = 0;
+          for (size_t i = 0; i < lookupsPerReader; ++i) hits += lookup(words[((i * 7919) + r) % wordCount]);
+          found.fetch_add(hits);
+        });
+      }
+      threads.clear();
+      stop.store(true);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(readers * lookupsPerReader) / elapsed.count() / 1e6;
+  };
+
+  auto freshBatch = [](size_t round) {
+    array::DynamicArray<std::string> batch;
+    for (size_t i = 0; i < 100; ++i) batch.emplaceBack("~" + std::to_string((round * 100) + i));
+    return batch;
+  };
+
+  for (unsigned readers : {1U, 2U, 4U}) {
+    double concurrentRate = measure(
+        readers, [&](const std::string& word) { return concurrent.search(word); },
+        [&](size_t round) {
+          tree::ConcurrentTrie<std::string>::Batch batch;
+          for (std::string& word : freshBatch(round)) batch.insert(std::move(word));
+          concurrent.apply(batch);
+        }
+    );
+    double lockedRate = measure(
+        readers,
+        [&](const std::string& word) {
+          std::shared_lock reader(lock);
+          return locked.search(word);
+        },
+        [&](size_t round) {
+          auto batch = freshBatch(round);
+          std::unique_lock writer(lock);
+          for (const std::string& word : batch) locked.insert(word);
+        }
+    );
+    WARN(
+        readers << " readers: ConcurrentTrie " << concurrentRate << " M lookups/s, Trie + shared_mutex "
+                << lockedRate << " M lookups/s"
+    );
+  }
+}
@@ -0,0 +1,159 @@
+#pragma once
+#include "../array/dynamic_array.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+namespace unionfind {
+
+namespace detail {
+
+inline void checkSize(size_t n) {
+  if (n > std::numeric_limits<uint32_t>::max()) throw std::length_error("UnionFind: too many elements.");
+}
+
+inline array::DynamicArray<uint32_t> singletons(size_t n) {
+  checkSize(n);
+  array::DynamicArray<uint32_t> parents(n, 0);
+  std::iota(parents.begin(), parents.end(), uint32_t{0});
+  return parents;
+}
+
+} // namespace detail
+
+/**
+ * @brief Disjoint sets over the elements 0 .. n - 1, with union by rank and path halving: every find points
+ *        each node it passes at its grandparent, so later finds take half the steps without a second pass
+ *        or recursion. Any sequence of m operations runs in O(m α(n)). Parents are 32-bit and ranks 8-bit
+ *        (a rank never exceeds log2 n), 5 bytes per element keep large forests in cache.
+ */
+class UnionFind {
+private:
+  array::DynamicArray<uint32_t> m_parents;
+  array::DynamicArray<uint8_t> m_ranks;
+  size_t m_sets;
+
+  void checkElement(size_t x) const {
+    if (x >= size()) throw std::out_of_range("UnionFind: element out of range.");
+  }
+
+public:
+  /**
+   * @brief n singleton sets.
+   * @throw std::length_error if n doesn't fit 32 bits.
+   */
+  explicit UnionFind(size_t n) : m_parents(detail::singletons(n)), m_ranks(n, 0), m_sets(n) {}
+
+  // the representative of the set of x
+  [[nodiscard]] uint32_t find(size_t x) {
+    checkElement(x);
+    auto node = static_cast<uint32_t>(x);
+    while (m_parents[node] != node) {
+      m_parents[node] = m_parents[m_parents[node]];
+      node = m_parents[node];
+    }
+    return node;
+  }
+
+  /**
+   * @brief Merges the sets of a and b.
+   * @return false if they already were the same set.
+   */
+  bool unite(size_t a, size_t b) {
+    uint32_t rootA = find(a);
+    uint32_t rootB = find(b);
+    if (rootA == rootB) return false;
+    if (m_ranks[rootA] < m_ranks[rootB]) std::swap(rootA, rootB);
+    m_parents[rootB] = rootA;
+    if (m_ranks[rootA] == m_ranks[rootB]) ++m_ranks[rootA];
+    --m_sets;
+    return true;
+  }
+
+  [[nodiscard]] bool connected(size_t a, size_t b) { return find(a) == find(b); }
+
+  [[nodiscard]] size_t setCount() const noexcept { return m_sets; }
+  [[nodiscard]] size_t size() const noexcept { return m_parents.size(); }
+};
+
+/**
+ * @brief Lock-free disjoint sets for many threads uniting at once, e.g. to find connected components or in
+ *        parallel Borůvka. find() halves paths with compare-and-swap, a failed swap only means another thread
+ *        already shortened the path. unite() links the root with the smaller id under the other root by a
+ *        single CAS on its parent and retries from the new roots if it lost a race, linking by id keeps the
+ *        forest acyclic without ranks. All operations are linearizable; n threads doing m operations take
+ *        O(m log n) steps in expectation when the ids are in random order.
+ */
+class ConcurrentUnionFind {
+private:
+  array::DynamicArray<uint32_t> m_parents; // only accessed through std::atomic_ref
+  std::atomic<size_t> m_sets;
+
+  std::atomic_ref<uint32_t> parent(uint32_t x) noexcept { return std::atomic_ref<uint32_t>(m_parents[x]); }
+
+  void checkElement(size_t x) const {
+    if (x >= size()) throw std::out_of_range("ConcurrentUnionFind: element out of range.");
+  }
+
+public:
+  /**
+   * @brief n singleton sets.
+   * @throw std::length_error if n doesn't fit 32 bits.
+   */
+  explicit ConcurrentUnionFind(size_t n) : m_parents(detail::singletons(n)), m_sets(n) {}
+
+  // the current representative of the set of x, which other threads may link under another root right after
+  [[nodiscard]] uint32_t find(size_t x) {
+    checkElement(x);
+    auto node = static_cast<uint32_t>(x);
+    while (true) {
+      uint32_t up = parent(node).load(std::memory_order_acquire);
+      if (up == node) return node;
+      uint32_t grand = parent(up).load(std::memory_order_acquire);
+      if (up != grand) parent(node).compare_exchange_weak(up, grand, std::memory_order_release);
+      node = grand;
+    }
+  }
+
+  /**
+   * @brief Merges the sets of a and b.
+   * @return false if they already were the same set. Of several threads uniting the same two sets exactly
+   *         one gets true.
+   */
+  bool unite(size_t a, size_t b) {
+    uint32_t rootA = find(a);
+    uint32_t rootB = find(b);
+    while (rootA != rootB) {
+      if (rootA > rootB) std::swap(rootA, rootB);
+      uint32_t expected = rootA;
+      if (parent(rootA).compare_exchange_strong(expected, rootB, std::memory_order_acq_rel)) {
+        m_sets.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+      }
+      rootA = find(rootA);
+      rootB = find(rootB);
+    }
+    return false;
+  }
+
+  [[nodiscard]] bool connected(size_t a, size_t b) {
+    uint32_t rootA = find(a);
+    uint32_t rootB = find(b);
+    while (rootA != rootB) {
+      // rootA still being a root means the sets were apart when rootB was found
+      if (parent(rootA).load(std::memory_order_acquire) == rootA) return false;
+      rootA = find(rootA);
+      rootB = find(rootB);
+    }
+    return true;
+  }
+
+  // exact once the threads uniting sets are done
+  [[nodiscard]] size_t setCount() const noexcept { return m_sets.load(std::memory_order_relaxed); }
+  [[nodiscard]] size_t size() const noexcept { return m_parents.size(); }
+};
+
+} // namespace unionfind
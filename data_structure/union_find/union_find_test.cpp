@@ -0,0 +1,97 @@
+#include "./union_find.hpp"
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+TEST_CASE("UnionFind", "[union_find]") {
+  SECTION("Unites sets and counts them") {
+    unionfind::UnionFind sets(10);
+    CHECK(sets.setCount() == 10);
+    CHECK(sets.unite(0, 1));
+    CHECK(sets.unite(2, 3));
+    CHECK(sets.unite(1, 3));
+    CHECK_FALSE(sets.unite(0, 2));
+    CHECK(sets.connected(0, 3));
+    CHECK_FALSE(sets.connected(0, 4));
+    CHECK(sets.find(2) == sets.find(1));
+    CHECK(sets.setCount() == 7);
+    CHECK(sets.size() == 10);
+    CHECK_THROWS_AS(sets.find(10), std::out_of_range);
+  }
+
+  SECTION("Agrees with a naive labeling") {
+    constexpr size_t n = 2000;
+    std::mt19937 gen{3};
+    std::uniform_int_distribution<size_t> element(0, n - 1);
+    unionfind::UnionFind sets(n);
+    std::vector<size_t> label(n);
+    for (size_t i = 0; i < n; ++i) label[i] = i;
+    size_t count = n;
+    for (int op = 0; op < 3000; ++op) {
+      size_t a = element(gen);
+      size_t b = element(gen);
+      bool apart = label[a] != label[b];
+      REQUIRE(sets.unite(a, b) == apart);
+      if (apart) {
+        size_t old = label[b];
+        for (size_t& l : label) l = l == old ? label[a] : l;
+        --count;
+      }
+      size_t c = element(gen);
+      REQUIRE(sets.connected(a, c) == (label[a] == label[c]));
+    }
+    CHECK(sets.setCount() == count);
+  }
+}
+
+TEST_CASE("ConcurrentUnionFind", "[union_find]") {
+  SECTION("Behaves like UnionFind on one thread") {
+    unionfind::ConcurrentUnionFind sets(6);
+    CHECK(sets.unite(0, 5));
+    CHECK(sets.unite(5, 3));
+    CHECK_FALSE(sets.unite(3, 0));
+    CHECK(sets.connected(0, 3));
+    CHECK_FALSE(sets.connected(1, 2));
+    CHECK(sets.setCount() == 4);
+    CHECK_THROWS_AS(sets.unite(0, 6), std::out_of_range);
+  }
+
+  SECTION("Threads uniting overlapping edges find the components of a grid") {
+    // a 200 x 200 grid cut into 4 quadrants, every edge is given to two threads
+    constexpr uint32_t side = 200;
+    std::vector<std::pair<uint32_t, uint32_t>> edges;
+    for (uint32_t row = 0; row < side; ++row) {
+      for (uint32_t col = 0; col < side; ++col) {
+        uint32_t v = (row * side) + col;
+        if (col + 1 < side && col + 1 != side / 2) edges.emplace_back(v, v + 1);
+        if (row + 1 < side && row + 1 != side / 2) edges.emplace_back(v, v + side);
+      }
+    }
+    std::shuffle(edges.begin(), edges.end(), std::mt19937{4});
+
+    unionfind::ConcurrentUnionFind sets(side * side);
+    constexpr size_t threadCount = 4;
+    std::vector<size_t> merges(threadCount, 0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadCount; ++t) {
+      threads.emplace_back([&, t] {
+        for (size_t i = t / 2; i < edges.size(); i += threadCount / 2) {
+          if (sets.unite(edges[i].first, edges[i].second)) ++merges[t];
+        }
+      });
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    CHECK(sets.setCount() == 4);
+    CHECK(merges[0] + merges[1] + merges[2] + merges[3] == (side * side) - 4);
+    CHECK(sets.connected(0, (side / 2) - 1));
+    CHECK_FALSE(sets.connected(0, side / 2));
+    CHECK_FALSE(sets.connected(0, (side * side) - 1));
+  }
+}